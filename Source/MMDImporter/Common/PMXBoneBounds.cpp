@@ -0,0 +1,255 @@
+﻿#include "PMXBoneBounds.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    static constexpr int BoneBoundsVertexBatchSize = 4096;
+
+    // 분기 없는 최소/최대 누적. 컴파일러 자동 벡터화 대상
+    static void ReduceMinMax(const float* InValues, const int InCount, float& OutMin, float& OutMax)
+    {
+        float MinValue = InValues[0];
+        float MaxValue = InValues[0];
+
+        for (int i = 1; i < InCount; ++i)
+        {
+            MinValue = InValues[i] < MinValue ? InValues[i] : MinValue;
+            MaxValue = InValues[i] > MaxValue ? InValues[i] : MaxValue;
+        }
+
+        OutMin = MinValue;
+        OutMax = MaxValue;
+    }
+
+    static float ReduceSum(const float* InValues, const int InCount)
+    {
+        float Sum = 0;
+        for (int i = 0; i < InCount; ++i)
+            Sum += InValues[i];
+
+        return Sum;
+    }
+
+    BoneBoundsBuilder::~BoneBoundsBuilder()
+    {
+        Delete();
+    }
+
+    bool BoneBoundsBuilder::Build(const PMXMeshData& InMeshData, const BoneBoundsOptions& InOptions)
+    {
+        Delete();
+
+        const int VertexCount = InMeshData.GetVertexCount();
+        const VertexData* Vertices = InMeshData.GetVertices();
+        const BoneData* Bones = InMeshData.GetBones();
+
+        if (InMeshData.GetBoneCount() <= 0 || Bones == nullptr)
+            return false;
+
+        BoneCount = InMeshData.GetBoneCount();
+        ArrayBounds = new Bounds[BoneCount];
+
+        // 1. 정점별로 기준을 넘는 영향 본 (정점당 최대 4, 없으면 -1)
+        std::vector<int> InfluenceBone(static_cast<MemSize>(VertexCount) * 4, -1);
+
+        ParallelFor(VertexCount, BoneBoundsVertexBatchSize, [&](const int Begin, const int End)
+        {
+            for (int v = Begin; v < End; ++v)
+            {
+                int BoneIndex[4];
+                float Weight[4];
+                const int Count = Vertices[v].GetBoneWeights(BoneIndex, Weight);
+
+                float Sum = 0;
+                for (int k = 0; k < Count; ++k)
+                    Sum += Weight[k] > 0 ? Weight[k] : 0;
+
+                if (Sum <= 0)
+                    continue;
+
+                // 같은 본이 여러 슬롯에 있으면 가중치를 합쳐서 판정
+                for (int k = 0; k < Count; ++k)
+                {
+                    if (BoneIndex[k] < 0 || BoneIndex[k] >= BoneCount)
+                        continue;
+
+                    bool bDuplicate = false;
+                    float BoneWeight = 0;
+
+                    for (int j = 0; j < Count; ++j)
+                    {
+                        bDuplicate |= j < k && BoneIndex[j] == BoneIndex[k];
+                        BoneWeight += BoneIndex[j] == BoneIndex[k] && Weight[j] > 0 ? Weight[j] : 0;
+                    }
+
+                    if (bDuplicate == false && BoneWeight / Sum >= InOptions.WeightThreshold)
+                        InfluenceBone[static_cast<MemSize>(v) * 4 + k] = BoneIndex[k];
+                }
+            }
+        });
+
+        // 2. 본 순서로 정점 위치를 SoA 로 모음
+        std::vector<int> BoneBegin(BoneCount + 1, 0);
+        for (const int BoneIndex : InfluenceBone)
+        {
+            if (BoneIndex >= 0)
+                ++BoneBegin[BoneIndex + 1];
+        }
+
+        for (int b = 0; b < BoneCount; ++b)
+            BoneBegin[b + 1] += BoneBegin[b];
+
+        const int PointCount = BoneBegin[BoneCount];
+        std::vector<float> PositionX(PointCount);
+        std::vector<float> PositionY(PointCount);
+        std::vector<float> PositionZ(PointCount);
+        {
+            std::vector<int> Fill(BoneBegin.begin(), BoneBegin.end() - 1);
+            for (MemSize i = 0; i < InfluenceBone.size(); ++i)
+            {
+                const int BoneIndex = InfluenceBone[i];
+                if (BoneIndex < 0)
+                    continue;
+
+                const Vector3& Position = Vertices[i / 4].Position;
+                const int Slot = Fill[BoneIndex]++;
+                PositionX[Slot] = Position.X;
+                PositionY[Slot] = Position.Y;
+                PositionZ[Slot] = Position.Z;
+            }
+        }
+
+        // 3. 본 단위 병렬 계산
+        ParallelFor(BoneCount, 16, [&](const int Begin, const int End)
+        {
+            std::vector<float> Projection;
+            std::vector<float> Slack;
+
+            for (int b = Begin; b < End; ++b)
+            {
+                Bounds& Result = ArrayBounds[b];
+                const int Count = BoneBegin[b + 1] - BoneBegin[b];
+
+                Result.VertexCount = Count;
+
+                if (Count <= 0)
+                {
+                    Result.Min = Result.Max = Bones[b].Position;
+                    Result.CapsuleStart = Result.CapsuleEnd = Bones[b].Position;
+                    continue;
+                }
+
+                const float* X = PositionX.data() + BoneBegin[b];
+                const float* Y = PositionY.data() + BoneBegin[b];
+                const float* Z = PositionZ.data() + BoneBegin[b];
+
+                ReduceMinMax(X, Count, Result.Min.X, Result.Max.X);
+                ReduceMinMax(Y, Count, Result.Min.Y, Result.Max.Y);
+                ReduceMinMax(Z, Count, Result.Min.Z, Result.Max.Z);
+
+                // 공분산 행렬의 주축 (거듭제곱법)
+                const float InvCount = 1.0f / Count;
+                const Vector3 Mean = Math::MakeVector3(ReduceSum(X, Count) * InvCount, ReduceSum(Y, Count) * InvCount, ReduceSum(Z, Count) * InvCount);
+
+                float XX = 0, YY = 0, ZZ = 0, XY = 0, XZ = 0, YZ = 0;
+                for (int i = 0; i < Count; ++i)
+                {
+                    const float DX = X[i] - Mean.X;
+                    const float DY = Y[i] - Mean.Y;
+                    const float DZ = Z[i] - Mean.Z;
+
+                    XX += DX * DX; YY += DY * DY; ZZ += DZ * DZ;
+                    XY += DX * DY; XZ += DX * DZ; YZ += DY * DZ;
+                }
+
+                const Vector3 Extent = Math::Sub(Result.Max, Result.Min);
+                Vector3 Axis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? Math::MakeVector3(1, 0, 0)
+                    : (Extent.Y >= Extent.Z ? Math::MakeVector3(0, 1, 0) : Math::MakeVector3(0, 0, 1));
+
+                for (int Iteration = 0; Iteration < 16; ++Iteration)
+                {
+                    const Vector3 Next = Math::MakeVector3(
+                        XX * Axis.X + XY * Axis.Y + XZ * Axis.Z,
+                        XY * Axis.X + YY * Axis.Y + YZ * Axis.Z,
+                        XZ * Axis.X + YZ * Axis.Y + ZZ * Axis.Z);
+
+                    const Vector3 Normalized = Math::Normalize(Next, 0);
+                    if (Math::LengthSquared(Normalized) <= 0)
+                        break;
+
+                    Axis = Normalized;
+                }
+
+                // 축 방향 위치와 축까지 거리의 제곱
+                Projection.resize(Count);
+                Slack.resize(Count);
+
+                float RadiusSquared = 0;
+                for (int i = 0; i < Count; ++i)
+                {
+                    const float DX = X[i] - Mean.X;
+                    const float DY = Y[i] - Mean.Y;
+                    const float DZ = Z[i] - Mean.Z;
+                    const float T = DX * Axis.X + DY * Axis.Y + DZ * Axis.Z;
+                    const float DistanceSquared = DX * DX + DY * DY + DZ * DZ - T * T;
+
+                    Projection[i] = T;
+                    Slack[i] = DistanceSquared;
+                    RadiusSquared = DistanceSquared > RadiusSquared ? DistanceSquared : RadiusSquared;
+                }
+
+                // 반구 끝이 모든 점을 감싸도록 선분 양 끝을 가능한 만큼 안쪽으로
+                // : 점 i 를 감싸려면 Start <= T + sqrt(R^2 - D^2), End >= T - sqrt(R^2 - D^2)
+                for (int i = 0; i < Count; ++i)
+                {
+                    const float Remain = RadiusSquared - Slack[i];
+                    Slack[i] = sqrtf(Remain > 0 ? Remain : 0);
+                }
+
+                float Start = Projection[0] + Slack[0];
+                float End = Projection[0] - Slack[0];
+                for (int i = 1; i < Count; ++i)
+                {
+                    const float Low = Projection[i] + Slack[i];
+                    const float High = Projection[i] - Slack[i];
+                    Start = Low < Start ? Low : Start;
+                    End = High > End ? High : End;
+                }
+
+                float Radius = sqrtf(RadiusSquared);
+
+                // 선분이 뒤집히면 구로 대체
+                if (Start > End)
+                {
+                    Start = End = (Start + End) * 0.5f;
+
+                    float MaxSquared = 0;
+                    for (int i = 0; i < Count; ++i)
+                    {
+                        const float DT = Projection[i] - Start;
+                        const float DistanceSquared = Radius * Radius - Slack[i] * Slack[i] + DT * DT;
+                        MaxSquared = DistanceSquared > MaxSquared ? DistanceSquared : MaxSquared;
+                    }
+
+                    Radius = sqrtf(MaxSquared);
+                }
+
+                Result.CapsuleStart = Math::Add(Mean, Math::Scale(Axis, Start));
+                Result.CapsuleEnd = Math::Add(Mean, Math::Scale(Axis, End));
+                Result.CapsuleRadius = Radius;
+            }
+        });
+
+        return true;
+    }
+
+    void BoneBoundsBuilder::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayBounds);
+        BoneCount = 0;
+    }
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct BoneBoundsOptions
+    {
+        // 정규화한 가중치가 이 값 이상인 정점만 본에 포함
+        float WeightThreshold = 0.25f;
+    };
+
+    /**
+     * 본별 바인드 포즈 경계 볼륨
+     * : 본마다 가중치가 기준 이상인 정점 위치를 SoA 로 모은 뒤 본 단위로 병렬 계산하므로
+     *   전체 비용은 본 수와 상관 없이 정점 영향 수에 비례합니다.
+     */
+    class BoneBoundsBuilder
+    {
+    public:
+        struct Bounds
+        {
+            // 포함된 정점 수. 0 이면 나머지 값은 본 위치로 채워짐
+            int VertexCount = 0;
+
+            Vector3 Min;
+            Vector3 Max;
+
+            // 정점 분포의 주축을 따라 맞춘 캡슐. 양 끝은 반구
+            Vector3 CapsuleStart;
+            Vector3 CapsuleEnd;
+            float CapsuleRadius = 0;
+        };
+
+    public:
+        ~BoneBoundsBuilder();
+
+        bool Build(const PMXMeshData& InMeshData, const BoneBoundsOptions& InOptions = BoneBoundsOptions());
+        void Delete();
+
+        int GetBoneCount() const { return BoneCount; }
+        const Bounds* GetBounds() const { return ArrayBounds; }
+
+    protected:
+        int BoneCount = 0;
+        Bounds* ArrayBounds = nullptr;
+    };
+}
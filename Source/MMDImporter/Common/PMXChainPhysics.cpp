@@ -0,0 +1,556 @@
+﻿#include "PMXChainPhysics.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace PMX
+{
+    // 레인 수를 이 값의 배수로 맞춰 벡터 폭(AVX 8 float)만큼 나머지 없이 돌도록 함
+    static constexpr int ChainLaneAlignment = 8;
+
+    // 병렬 처리시 한 작업이 담당할 레인 수
+    static constexpr int ChainLaneBatchSize = 256;
+
+    // Stiffness 는 60Hz 한 스텝 기준의 복원 비율
+    static constexpr float ChainReferenceStepRate = 60.0f;
+
+    ChainPhysicsModel::~ChainPhysicsModel()
+    {
+        Delete();
+    }
+
+    bool ChainPhysicsModel::Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton, const ChainPhysicsOptions& InOptions)
+    {
+        Delete();
+
+        const int RigidbodyCount = InMeshData.GetRigidbodyCount();
+        const RigidbodyData* Rigidbodies = InMeshData.GetRigidbodies();
+        const int JointCount = InMeshData.GetJointCount();
+        const JointData* Joints = InMeshData.GetJoints();
+        const int BoneCount = InSkeleton.GetBoneCount();
+        const Vector3* BindPositions = InSkeleton.GetBindPositions();
+
+        SkeletonRef = &InSkeleton;
+        Gravity = InOptions.Gravity;
+
+        if (RigidbodyCount <= 0 || Rigidbodies == nullptr || BoneCount <= 0)
+            return false;
+
+        auto GetBone = [&](const int InRigidbodyIndex)
+        {
+            const int BoneIndex = Rigidbodies[InRigidbodyIndex].BoneIndexRelated;
+            return (BoneIndex >= 0 && BoneIndex < BoneCount) ? BoneIndex : -1;
+        };
+
+        std::vector<UInt8> Dynamic(RigidbodyCount, 0);
+        for (int i = 0; i < RigidbodyCount; ++i)
+            Dynamic[i] = (Rigidbodies[i].PhysicsMode != RigidbodyData::PhysicsMode::FollowBone && GetBone(i) >= 0) ? 1 : 0;
+
+        // 조인트 중 본 계층상 위/아래 관계인 것만 부모 → 자식 연결로 사용. 후보가 여럿이면 가장 가까운 조상
+        std::vector<int> ParentBody(RigidbodyCount, -1);
+        std::vector<int> ParentJoint(RigidbodyCount, -1);
+
+        for (int j = 0; j < JointCount; ++j)
+        {
+            int A = Joints[j].RigidbodyIndexA;
+            int B = Joints[j].RigidbodyIndexB;
+
+            if (A < 0 || A >= RigidbodyCount || B < 0 || B >= RigidbodyCount)
+                continue;
+
+            const int BoneA = GetBone(A);
+            const int BoneB = GetBone(B);
+            if (BoneA < 0 || BoneB < 0 || BoneA == BoneB)
+                continue;
+
+            if (InSkeleton.IsDescendantOf(BoneA, BoneB))
+                std::swap(A, B);
+            else if (InSkeleton.IsDescendantOf(BoneB, BoneA) == false)
+                continue;
+
+            if (Dynamic[B] == 0)
+                continue;
+
+            const int Current = ParentBody[B];
+            if (Current < 0 || InSkeleton.IsDescendantOf(GetBone(A), GetBone(Current)))
+            {
+                ParentBody[B] = A;
+                ParentJoint[B] = j;
+            }
+        }
+
+        std::vector<std::vector<int>> Children(RigidbodyCount);
+        for (int i = 0; i < RigidbodyCount; ++i)
+        {
+            if (Dynamic[i] != 0 && ParentBody[i] >= 0 && Dynamic[ParentBody[i]] != 0)
+                Children[ParentBody[i]].push_back(i);
+        }
+
+        struct PendingChain
+        {
+            int StartBody;
+            int AnchorBone;
+            Vector3 AnchorOffset;
+            Vector3 AnchorPosition;
+        };
+
+        std::vector<PendingChain> Pending;
+        for (int i = 0; i < RigidbodyCount; ++i)
+        {
+            if (Dynamic[i] == 0 || (ParentBody[i] >= 0 && Dynamic[ParentBody[i]] != 0))
+                continue;
+
+            PendingChain NewPending;
+            NewPending.StartBody = i;
+
+            if (ParentBody[i] >= 0)
+            {
+                // 본 추적 강체에 매달린 사슬
+                const int Parent = ParentBody[i];
+                NewPending.AnchorBone = GetBone(Parent);
+                NewPending.AnchorPosition = Rigidbodies[Parent].ShapePosition;
+            }
+            else
+            {
+                // 부모 강체가 없으면 자기 본의 위치에 매달림
+                NewPending.AnchorBone = GetBone(i);
+                NewPending.AnchorPosition = BindPositions[NewPending.AnchorBone];
+            }
+
+            NewPending.AnchorOffset = Math::Sub(NewPending.AnchorPosition, BindPositions[NewPending.AnchorBone]);
+            Pending.push_back(NewPending);
+        }
+
+        std::vector<Chain> Chains;
+        std::vector<Particle> Particles;
+        std::vector<UInt8> Visited(RigidbodyCount, 0);
+
+        for (size_t p = 0; p < Pending.size(); ++p)
+        {
+            const PendingChain CurPending = Pending[p];
+
+            Chain NewChain;
+            NewChain.AnchorBoneIndex = CurPending.AnchorBone;
+            NewChain.AnchorOffset = CurPending.AnchorOffset;
+            NewChain.ParticleBegin = static_cast<int>(Particles.size());
+
+            Vector3 PrevPosition = CurPending.AnchorPosition;
+
+            for (int Cur = CurPending.StartBody; Cur >= 0 && Visited[Cur] == 0; )
+            {
+                Visited[Cur] = 1;
+
+                const RigidbodyData& Rigidbody = Rigidbodies[Cur];
+                const int BoneIndex = GetBone(Cur);
+
+                float Stiffness = InOptions.DefaultStiffness;
+                if (ParentJoint[Cur] >= 0)
+                {
+                    const float Spring = Math::Length(Joints[ParentJoint[Cur]].RotationSpring);
+                    if (Spring > 0)
+                        Stiffness = Spring / (Spring + InOptions.SpringNormalizer);
+                }
+
+                Particle NewParticle;
+                NewParticle.RigidbodyIndex = Cur;
+                NewParticle.BoneIndex = BoneIndex;
+                NewParticle.Offset = Math::Sub(Rigidbody.ShapePosition, BindPositions[BoneIndex]);
+                NewParticle.RestLength = Math::Length(Math::Sub(Rigidbody.ShapePosition, PrevPosition));
+                NewParticle.Damping = Math::Clamp(Rigidbody.MoveAttenuation, 0.0f, 1.0f);
+                NewParticle.Stiffness = Math::Clamp(Stiffness, 0.0f, 1.0f);
+                Particles.push_back(NewParticle);
+
+                PrevPosition = Rigidbody.ShapePosition;
+
+                // 첫 자식으로 이어가고, 나머지 자식은 현재 강체의 본에 매단 새 사슬로 분리
+                int Next = -1;
+                for (const int Child : Children[Cur])
+                {
+                    if (Visited[Child] != 0)
+                        continue;
+
+                    if (Next < 0)
+                    {
+                        Next = Child;
+                        continue;
+                    }
+
+                    PendingChain Branch;
+                    Branch.StartBody = Child;
+                    Branch.AnchorBone = BoneIndex;
+                    Branch.AnchorPosition = Rigidbody.ShapePosition;
+                    Branch.AnchorOffset = NewParticle.Offset;
+                    Pending.push_back(Branch);
+                }
+
+                Cur = Next;
+            }
+
+            NewChain.ParticleCount = static_cast<int>(Particles.size()) - NewChain.ParticleBegin;
+            if (NewChain.ParticleCount > 0)
+            {
+                Chains.push_back(NewChain);
+                MaxChainLength = std::max(MaxChainLength, NewChain.ParticleCount);
+            }
+        }
+
+        ChainCount = static_cast<int>(Chains.size());
+        ArrayChain = ChainCount > 0 ? new Chain[ChainCount] : nullptr;
+        std::copy(Chains.begin(), Chains.end(), ArrayChain);
+
+        ParticleCount = static_cast<int>(Particles.size());
+        ArrayParticle = ParticleCount > 0 ? new Particle[ParticleCount] : nullptr;
+        std::copy(Particles.begin(), Particles.end(), ArrayParticle);
+
+        // 사슬 본을 덮어쓰면 그 아래 본들도 따라가야 하므로 계산 순서대로 모아 둠
+        // : 0 = 관계 없음, 1 = 사슬 본, 2 = 따라가는 본
+        const int* ParentIndices = InSkeleton.GetParentIndices();
+        const int* EvaluationOrder = InSkeleton.GetEvaluationOrder();
+
+        std::vector<UInt8> BoneState(BoneCount, 0);
+        for (const Particle& CurParticle : Particles)
+            BoneState[CurParticle.BoneIndex] = 1;
+
+        std::vector<int> Followers;
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const int BoneIndex = EvaluationOrder[i];
+            const int ParentIndex = ParentIndices[BoneIndex];
+
+            if (BoneState[BoneIndex] == 0 && ParentIndex >= 0 && BoneState[ParentIndex] != 0)
+            {
+                BoneState[BoneIndex] = 2;
+                Followers.push_back(BoneIndex);
+            }
+        }
+
+        FollowerBoneCount = static_cast<int>(Followers.size());
+        ArrayFollowerBone = FollowerBoneCount > 0 ? new int[FollowerBoneCount] : nullptr;
+        std::copy(Followers.begin(), Followers.end(), ArrayFollowerBone);
+
+        return true;
+    }
+
+    void ChainPhysicsModel::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayChain);
+        ChainCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayParticle);
+        ParticleCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayFollowerBone);
+        FollowerBoneCount = 0;
+
+        SkeletonRef = nullptr;
+        MaxChainLength = 0;
+    }
+
+    ChainPhysicsBatch::~ChainPhysicsBatch()
+    {
+        Delete();
+    }
+
+    bool ChainPhysicsBatch::Initialize(const ChainPhysicsModel& InModel, const int InInstanceCount)
+    {
+        Delete();
+
+        if (InModel.GetChainCount() <= 0 || InInstanceCount <= 0)
+            return false;
+
+        Model = &InModel;
+        InstanceCount = InInstanceCount;
+        LaneCount = InModel.GetChainCount() * InstanceCount;
+        LaneStride = (LaneCount + ChainLaneAlignment - 1) / ChainLaneAlignment * ChainLaneAlignment;
+        SlotCount = InModel.GetMaxChainLength();
+
+        // 슬롯 단위 배열 14개 + 레인 단위 배열 3개
+        const MemSize SlotElementCount = static_cast<MemSize>(SlotCount) * LaneStride;
+        Buffer = new float[SlotElementCount * 14 + static_cast<MemSize>(LaneStride) * 3]{ 0 };
+
+        float* Cursor = Buffer;
+        for (float*& Component : Position)      { Component = Cursor; Cursor += SlotElementCount; }
+        for (float*& Component : PrevPosition)  { Component = Cursor; Cursor += SlotElementCount; }
+        for (float*& Component : Target)        { Component = Cursor; Cursor += SlotElementCount; }
+        RestLength = Cursor;    Cursor += SlotElementCount;
+        Damping = Cursor;       Cursor += SlotElementCount;
+        Stiffness = Cursor;     Cursor += SlotElementCount;
+        KeepFactor = Cursor;    Cursor += SlotElementCount;
+        PullFactor = Cursor;    Cursor += SlotElementCount;
+        for (float*& Component : Anchor)        { Component = Cursor; Cursor += LaneStride; }
+
+        FactorDeltaTime = 0;
+
+        const ChainPhysicsModel::Chain* Chains = InModel.GetChains();
+        const ChainPhysicsModel::Particle* Particles = InModel.GetParticles();
+        const int ChainCount = InModel.GetChainCount();
+
+        // 남는 슬롯은 길이 0, 완전 감쇠로 두어 마지막 입자에 붙어 있도록 함
+        for (int Lane = 0; Lane < LaneCount; ++Lane)
+        {
+            const ChainPhysicsModel::Chain& CurChain = Chains[Lane % ChainCount];
+
+            for (int Slot = 0; Slot < SlotCount; ++Slot)
+            {
+                const int n = Slot * LaneStride + Lane;
+
+                if (Slot < CurChain.ParticleCount)
+                {
+                    const ChainPhysicsModel::Particle& CurParticle = Particles[CurChain.ParticleBegin + Slot];
+                    RestLength[n] = CurParticle.RestLength;
+                    Damping[n] = CurParticle.Damping;
+                    Stiffness[n] = CurParticle.Stiffness;
+                }
+                else
+                {
+                    Damping[n] = 1.0f;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void ChainPhysicsBatch::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(Buffer);
+
+        for (float*& Component : Position)      Component = nullptr;
+        for (float*& Component : PrevPosition)  Component = nullptr;
+        for (float*& Component : Target)        Component = nullptr;
+        for (float*& Component : Anchor)        Component = nullptr;
+        RestLength = nullptr;
+        Damping = nullptr;
+        Stiffness = nullptr;
+        KeepFactor = nullptr;
+        PullFactor = nullptr;
+        FactorDeltaTime = 0;
+
+        Model = nullptr;
+        InstanceCount = 0;
+        LaneCount = 0;
+        LaneStride = 0;
+        SlotCount = 0;
+    }
+
+    void ChainPhysicsBatch::Reset(const PoseBatch& InPose)
+    {
+        if (Model == nullptr || InPose.GetInstanceCount() != InstanceCount)
+            return;
+
+        GatherTargets(InPose, 0, LaneCount);
+
+        const MemSize SlotElementCount = static_cast<MemSize>(SlotCount) * LaneStride;
+        for (int c = 0; c < 3; ++c)
+        {
+            std::copy(Target[c], Target[c] + SlotElementCount, Position[c]);
+            std::copy(Target[c], Target[c] + SlotElementCount, PrevPosition[c]);
+        }
+    }
+
+    void ChainPhysicsBatch::Step(const PoseBatch& InPose, const float InDeltaTime)
+    {
+        if (Model == nullptr || InPose.GetInstanceCount() != InstanceCount || InDeltaTime <= 0)
+            return;
+
+        // 스텝 간격이 바뀔 때만 감쇠 / 복원 계수를 다시 계산
+        const bool bUpdateFactors = InDeltaTime != FactorDeltaTime;
+        FactorDeltaTime = InDeltaTime;
+
+        // 레인 블록은 ChainLaneAlignment 배수라서 블록 경계에서도 벡터 폭이 맞음
+        ParallelFor(LaneCount, ChainLaneBatchSize, [this, &InPose, InDeltaTime, bUpdateFactors](const int Begin, const int End)
+        {
+            if (bUpdateFactors)
+                UpdateFactors(InDeltaTime, Begin, End);
+
+            GatherTargets(InPose, Begin, End);
+            StepLanes(InDeltaTime, Begin, End);
+        });
+    }
+
+    void ChainPhysicsBatch::UpdateFactors(const float InDeltaTime, const int InLaneBegin, const int InLaneEnd)
+    {
+        const float StepScale = InDeltaTime * ChainReferenceStepRate;
+
+        for (int Slot = 0; Slot < SlotCount; ++Slot)
+        {
+            const int Base = Slot * LaneStride;
+
+            for (int Lane = InLaneBegin; Lane < InLaneEnd; ++Lane)
+            {
+                const int n = Base + Lane;
+
+                KeepFactor[n] = powf(1.0f - Damping[n], InDeltaTime);
+                PullFactor[n] = 1.0f - powf(1.0f - Stiffness[n], StepScale);
+            }
+        }
+    }
+
+    void ChainPhysicsBatch::GatherTargets(const PoseBatch& InPose, const int InLaneBegin, const int InLaneEnd)
+    {
+        const ChainPhysicsModel::Chain* Chains = Model->GetChains();
+        const ChainPhysicsModel::Particle* Particles = Model->GetParticles();
+        const int ChainCount = Model->GetChainCount();
+
+        for (int Lane = InLaneBegin; Lane < InLaneEnd; ++Lane)
+        {
+            const int Instance = Lane / ChainCount;
+            const ChainPhysicsModel::Chain& CurChain = Chains[Lane % ChainCount];
+
+            const int AnchorIndex = InPose.GetIndex(CurChain.AnchorBoneIndex, Instance);
+            const Vector3 AnchorPosition = Math::Add(InPose.GetGlobalPosition(AnchorIndex), Math::QuatRotate(InPose.GetGlobalRotation(AnchorIndex), CurChain.AnchorOffset));
+            Anchor[0][Lane] = AnchorPosition.X;
+            Anchor[1][Lane] = AnchorPosition.Y;
+            Anchor[2][Lane] = AnchorPosition.Z;
+
+            Vector3 TargetPosition = AnchorPosition;
+            for (int Slot = 0; Slot < SlotCount; ++Slot)
+            {
+                if (Slot < CurChain.ParticleCount)
+                {
+                    const ChainPhysicsModel::Particle& CurParticle = Particles[CurChain.ParticleBegin + Slot];
+                    const int BoneIndex = InPose.GetIndex(CurParticle.BoneIndex, Instance);
+                    TargetPosition = Math::Add(InPose.GetGlobalPosition(BoneIndex), Math::QuatRotate(InPose.GetGlobalRotation(BoneIndex), CurParticle.Offset));
+                }
+
+                const int n = Slot * LaneStride + Lane;
+                Target[0][n] = TargetPosition.X;
+                Target[1][n] = TargetPosition.Y;
+                Target[2][n] = TargetPosition.Z;
+            }
+        }
+    }
+
+    void ChainPhysicsBatch::StepLanes(const float InDeltaTime, const int InLaneBegin, const int InLaneEnd)
+    {
+        const Vector3& Gravity = Model->GetGravity();
+        const float DeltaTimeSquared = InDeltaTime * InDeltaTime;
+        const float GravityStep[3] = { Gravity.X * DeltaTimeSquared, Gravity.Y * DeltaTimeSquared, Gravity.Z * DeltaTimeSquared };
+
+        float* PX = Position[0];
+        float* PY = Position[1];
+        float* PZ = Position[2];
+
+        // Verlet 적분 + 애니메이션 위치로의 복원. 슬롯 안에서는 레인 방향으로 분기 없이 계산
+        // : 축마다 따로 돌려야 한 루프가 다루는 배열이 적어 컴파일러가 겹침 검사 후 벡터화함
+
+        for (int Slot = 0; Slot < SlotCount; ++Slot)
+        {
+            const int Base = Slot * LaneStride;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                float* P = Position[c] + Base;
+                float* O = PrevPosition[c] + Base;
+                const float* T = Target[c] + Base;
+                const float* K = KeepFactor + Base;
+                const float* L = PullFactor + Base;
+                const float G = GravityStep[c];
+
+                for (int Lane = InLaneBegin; Lane < InLaneEnd; ++Lane)
+                {
+                    const float Moved = P[Lane] + (P[Lane] - O[Lane]) * K[Lane] + G;
+
+                    O[Lane] = P[Lane];
+                    P[Lane] = Moved + (T[Lane] - Moved) * L[Lane];
+                }
+            }
+        }
+
+        // 길이 구속. 부모(고정점 또는 이전 입자)에서 위→아래로 한번 훑음
+        for (int Slot = 0; Slot < SlotCount; ++Slot)
+        {
+            const int Base = Slot * LaneStride;
+            const float* ParentX = Slot == 0 ? Anchor[0] : PX + Base - LaneStride;
+            const float* ParentY = Slot == 0 ? Anchor[1] : PY + Base - LaneStride;
+            const float* ParentZ = Slot == 0 ? Anchor[2] : PZ + Base - LaneStride;
+
+            for (int Lane = InLaneBegin; Lane < InLaneEnd; ++Lane)
+            {
+                const int n = Base + Lane;
+
+                const float DX = PX[n] - ParentX[Lane];
+                const float DY = PY[n] - ParentY[Lane];
+                const float DZ = PZ[n] - ParentZ[Lane];
+                const float LengthSquared = DX * DX + DY * DY + DZ * DZ;
+                const float Ratio = RestLength[n] / sqrtf(LengthSquared > Math::SmallNumber ? LengthSquared : Math::SmallNumber);
+
+                PX[n] = ParentX[Lane] + DX * Ratio;
+                PY[n] = ParentY[Lane] + DY * Ratio;
+                PZ[n] = ParentZ[Lane] + DZ * Ratio;
+            }
+        }
+    }
+
+    void ChainPhysicsBatch::WriteToPose(PoseBatch& InOutPose) const
+    {
+        if (Model == nullptr || InOutPose.GetInstanceCount() != InstanceCount)
+            return;
+
+        const ChainPhysicsModel::Chain* Chains = Model->GetChains();
+        const ChainPhysicsModel::Particle* Particles = Model->GetParticles();
+        const int ChainCount = Model->GetChainCount();
+
+        // 인스턴스가 다르면 쓰는 본 위치가 겹치지 않으므로 인스턴스 단위로 병렬 처리
+        ParallelFor(InstanceCount, 16, [&](const int Begin, const int End)
+        {
+            for (int Instance = Begin; Instance < End; ++Instance)
+            {
+                for (int c = 0; c < ChainCount; ++c)
+                {
+                    const ChainPhysicsModel::Chain& CurChain = Chains[c];
+                    const int Lane = Instance * ChainCount + c;
+
+                    Vector3 Parent = Math::MakeVector3(Anchor[0][Lane], Anchor[1][Lane], Anchor[2][Lane]);
+                    Vector3 TargetParent = Parent;
+
+                    for (int Slot = 0; Slot < CurChain.ParticleCount; ++Slot)
+                    {
+                        const ChainPhysicsModel::Particle& CurParticle = Particles[CurChain.ParticleBegin + Slot];
+                        const int n = Slot * LaneStride + Lane;
+
+                        const Vector3 Simulated = Math::MakeVector3(Position[0][n], Position[1][n], Position[2][n]);
+                        const Vector3 Animated = Math::MakeVector3(Target[0][n], Target[1][n], Target[2][n]);
+
+                        // 부모 → 입자 방향이 애니메이션 대비 얼마나 돌았는지를 본 회전에 반영
+                        const Vector4 Delta = Math::QuatFromTo(Math::Normalize(Math::Sub(Animated, TargetParent)), Math::Normalize(Math::Sub(Simulated, Parent)));
+
+                        const int BoneIndex = InOutPose.GetIndex(CurParticle.BoneIndex, Instance);
+                        const Vector4 Rotation = Math::QuatNormalize(Math::QuatMultiply(Delta, InOutPose.GetGlobalRotation(BoneIndex)));
+
+                        InOutPose.SetGlobalRotation(BoneIndex, Rotation);
+                        InOutPose.SetGlobalPosition(BoneIndex, Math::Sub(Simulated, Math::QuatRotate(Rotation, CurParticle.Offset)));
+
+                        Parent = Simulated;
+                        TargetParent = Animated;
+                    }
+                }
+            }
+
+            // 사슬 본 아래의 본들은 로컬 포즈로 덮어쓴 부모를 따라감
+            if (Model->GetFollowerBoneCount() > 0)
+                Model->GetSkeleton()->UpdateGlobalPose(InOutPose, Model->GetFollowerBones(), Model->GetFollowerBoneCount(), Begin, End);
+        });
+    }
+
+    Vector3 ChainPhysicsBatch::GetParticlePosition(const int InInstanceIndex, const int InParticleIndex) const
+    {
+        if (Model == nullptr || InInstanceIndex < 0 || InInstanceIndex >= InstanceCount)
+            return Vector3();
+
+        const ChainPhysicsModel::Chain* Chains = Model->GetChains();
+        for (int c = 0; c < Model->GetChainCount(); ++c)
+        {
+            const int Slot = InParticleIndex - Chains[c].ParticleBegin;
+            if (Slot < 0 || Slot >= Chains[c].ParticleCount)
+                continue;
+
+            const int n = Slot * LaneStride + InInstanceIndex * Model->GetChainCount() + c;
+            return Math::MakeVector3(Position[0][n], Position[1][n], Position[2][n]);
+        }
+
+        return Vector3();
+    }
+}
@@ -0,0 +1,151 @@
+﻿#pragma once
+
+#include "PMXSkeleton.h"
+
+namespace PMX
+{
+    struct ChainPhysicsOptions
+    {
+        // 조인트 RotationSpring 크기를 0 ~ 1 의 복원 강도로 바꿀 때의 기준 값
+        // : Stiffness = Spring / (Spring + SpringNormalizer)
+        float SpringNormalizer = 100.0f;
+
+        // 조인트 스프링이 없을 때의 복원 강도
+        float DefaultStiffness = 0.02f;
+
+        // 중력 (MMD 단위, 1 = 8cm 정도)
+        Vector3 Gravity = { 0, -98.0f, 0 };
+    };
+
+    /**
+     * 머리카락/치마처럼 조인트로 이어진 강체 사슬을 스프링/Verlet 입자로 단순화 한 모델
+     * : 강체 → 본 → 조인트 그래프에서 본 계층을 따라 이어지는 동적 강체를 사슬로 묶습니다.
+     *   같은 본 계층 위에 있지 않은 조인트(치마의 가로 연결 등)는 사용하지 않으며,
+     *   사슬이 갈라지면 첫 자식만 이어가고 나머지는 갈라진 강체의 본에 고정된 새 사슬이 됩니다.
+     */
+    class ChainPhysicsModel
+    {
+    public:
+        struct Chain
+        {
+            // 사슬 시작점이 붙어 있는 본과 그 본 기준 위치
+            int AnchorBoneIndex = -1;
+            Vector3 AnchorOffset;
+
+            // ArrayParticle 범위
+            int ParticleBegin = 0;
+            int ParticleCount = 0;
+        };
+
+        struct Particle
+        {
+            int RigidbodyIndex = -1;
+            int BoneIndex = -1;
+
+            // 본 기준 강체 중심 위치 (바인드 포즈의 본 회전은 단위 회전)
+            Vector3 Offset;
+
+            // 이전 입자(또는 고정점)까지의 거리
+            float RestLength = 0;
+
+            float Damping = 0;
+            float Stiffness = 0;
+        };
+
+    public:
+        ~ChainPhysicsModel();
+
+        // InSkeleton 은 모델보다 오래 유지되어야 합니다.
+        bool Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton, const ChainPhysicsOptions& InOptions = ChainPhysicsOptions());
+        void Delete();
+
+        int GetChainCount() const { return ChainCount; }
+        const Chain* GetChains() const { return ArrayChain; }
+
+        int GetParticleCount() const { return ParticleCount; }
+        const Particle* GetParticles() const { return ArrayParticle; }
+
+        // 사슬 본 아래에 있지만 입자가 없는 본 (계산 순서)
+        int GetFollowerBoneCount() const { return FollowerBoneCount; }
+        const int* GetFollowerBones() const { return ArrayFollowerBone; }
+
+        int GetMaxChainLength() const { return MaxChainLength; }
+        const Vector3& GetGravity() const { return Gravity; }
+        const Skeleton* GetSkeleton() const { return SkeletonRef; }
+
+    protected:
+        const Skeleton* SkeletonRef = nullptr;
+
+        int ChainCount = 0;
+        Chain* ArrayChain = nullptr;
+
+        int ParticleCount = 0;
+        Particle* ArrayParticle = nullptr;
+
+        int FollowerBoneCount = 0;
+        int* ArrayFollowerBone = nullptr;
+
+        int MaxChainLength = 0;
+        Vector3 Gravity;
+    };
+
+    /**
+     * 여러 인스턴스의 사슬을 한번에 진행시키는 SoA 시뮬레이터
+     * : 레인 하나가 사슬 하나이며, 입자 슬롯마다 [Slot * LaneStride + Lane] 으로 배치해
+     *   같은 슬롯의 모든 사슬을 레인 방향으로 벡터화해서 계산합니다.
+     */
+    class ChainPhysicsBatch
+    {
+    public:
+        ~ChainPhysicsBatch();
+
+        // InModel 은 시뮬레이터보다 오래 유지되어야 합니다.
+        bool Initialize(const ChainPhysicsModel& InModel, const int InInstanceCount);
+        void Delete();
+
+        // 현재 애니메이션 포즈 위치로 입자를 옮기고 속도를 0 으로 초기화
+        void Reset(const PoseBatch& InPose);
+
+        // InPose 는 글로벌 포즈가 계산되어 있어야 합니다.
+        void Step(const PoseBatch& InPose, const float InDeltaTime);
+
+        // 시뮬레이션 결과를 사슬 본들의 글로벌 회전/위치에 덮어쓰고, 그 아래 본들의 글로벌 포즈를 다시 계산합니다.
+        void WriteToPose(PoseBatch& InOutPose) const;
+
+        int GetLaneCount() const { return LaneCount; }
+        Vector3 GetParticlePosition(const int InInstanceIndex, const int InParticleIndex) const;
+
+    protected:
+        void UpdateFactors(const float InDeltaTime, const int InLaneBegin, const int InLaneEnd);
+        void GatherTargets(const PoseBatch& InPose, const int InLaneBegin, const int InLaneEnd);
+        void StepLanes(const float InDeltaTime, const int InLaneBegin, const int InLaneEnd);
+
+    protected:
+        const ChainPhysicsModel* Model = nullptr;
+
+        int InstanceCount = 0;
+
+        // 실제 사슬 수와, 벡터 폭에 맞춰 올린 레인 간격
+        int LaneCount = 0;
+        int LaneStride = 0;
+        int SlotCount = 0;
+
+        float* Buffer = nullptr;
+
+        // [Slot * LaneStride + Lane]
+        float* Position[3]{ nullptr };
+        float* PrevPosition[3]{ nullptr };
+        float* Target[3]{ nullptr };
+        float* RestLength = nullptr;
+        float* Damping = nullptr;
+        float* Stiffness = nullptr;
+
+        // FactorDeltaTime 스텝 간격으로 미리 계산한 속도 유지 / 복원 비율
+        float* KeepFactor = nullptr;
+        float* PullFactor = nullptr;
+        float FactorDeltaTime = 0;
+
+        // [Lane]
+        float* Anchor[3]{ nullptr };
+    };
+}
@@ -0,0 +1,300 @@
+﻿#include "PMXCollisionMatrix.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace PMX
+{
+    // NonCollisionGroupMask 가 16bit 이므로 그룹은 최대 16개
+    static constexpr int RigidbodyGroupCount = 16;
+
+    static float GetBoundingRadius(const RigidbodyData& InRigidbody)
+    {
+        const Vector3& Size = InRigidbody.ShapeSize;
+
+        switch (InRigidbody.ShapeType)
+        {
+            case RigidbodyData::ShapeType::Sphere:  return Size.X;
+            case RigidbodyData::ShapeType::Box:     return Math::Length(Size);
+            case RigidbodyData::ShapeType::Capsule: return Size.X + Size.Y * 0.5f;
+
+            default: return Math::Length(Size);
+        }
+    }
+
+    // 강체가 바인드 위치에서 움직일 수 있는 거리
+    // : 조인트를 따라 가장 가까운 FollowBone 강체까지의 경로 길이를 L 이라 하면 그 강체를 축으로 흔들리므로 최대 2L 만큼 움직입니다.
+    //   조인트의 이동 한도도 경로 길이에 더하고, FollowBone 강체에 닿지 않는 강체는 -1 로 둡니다.
+    static void BuildTravelDistances(const PMXMeshData& InMeshData, std::vector<float>& OutTravel)
+    {
+        const int Count = InMeshData.GetRigidbodyCount();
+        const RigidbodyData* Rigidbodies = InMeshData.GetRigidbodies();
+        const int JointCount = InMeshData.GetJointCount();
+        const JointData* Joints = InMeshData.GetJoints();
+
+        struct Edge
+        {
+            int To;
+            float Length;
+        };
+
+        std::vector<std::vector<Edge>> Edges(Count);
+        for (int j = 0; j < JointCount; ++j)
+        {
+            const JointData& Joint = Joints[j];
+            const int A = Joint.RigidbodyIndexA;
+            const int B = Joint.RigidbodyIndexB;
+
+            if (A < 0 || A >= Count || B < 0 || B >= Count || A == B)
+                continue;
+
+            const Vector3 Slide = Math::MakeVector3(
+                std::max(fabsf(Joint.PositionMin.X), fabsf(Joint.PositionMax.X)),
+                std::max(fabsf(Joint.PositionMin.Y), fabsf(Joint.PositionMax.Y)),
+                std::max(fabsf(Joint.PositionMin.Z), fabsf(Joint.PositionMax.Z)));
+            const float Length = Math::Length(Math::Sub(Rigidbodies[A].ShapePosition, Rigidbodies[B].ShapePosition)) + Math::Length(Slide);
+
+            Edges[A].push_back({ B, Length });
+            Edges[B].push_back({ A, Length });
+        }
+
+        std::vector<float> PathLength(Count, -1.0f);
+
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> Queue;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            if (Rigidbodies[i].PhysicsMode != RigidbodyData::PhysicsMode::FollowBone)
+                continue;
+
+            PathLength[i] = 0.0f;
+            Queue.push(Entry(0.0f, i));
+        }
+
+        while (Queue.empty() == false)
+        {
+            const Entry Top = Queue.top();
+            Queue.pop();
+
+            if (Top.first > PathLength[Top.second])
+                continue;
+
+            for (const Edge& Next : Edges[Top.second])
+            {
+                const float NextLength = Top.first + Next.Length;
+                if (PathLength[Next.To] >= 0 && PathLength[Next.To] <= NextLength)
+                    continue;
+
+                PathLength[Next.To] = NextLength;
+                Queue.push(Entry(NextLength, Next.To));
+            }
+        }
+
+        OutTravel.resize(Count);
+        for (int i = 0; i < Count; ++i)
+            OutTravel[i] = PathLength[i] >= 0 ? PathLength[i] * 2.0f : -1.0f;
+    }
+
+    CollisionMatrix::~CollisionMatrix()
+    {
+        Delete();
+    }
+
+    bool CollisionMatrix::Build(const PMXMeshData& InMeshData, const CollisionMatrixOptions& InOptions)
+    {
+        Delete();
+
+        const int Count = InMeshData.GetRigidbodyCount();
+        const RigidbodyData* Rigidbodies = InMeshData.GetRigidbodies();
+
+        if (Count <= 0 || Rigidbodies == nullptr)
+            return false;
+
+        RigidbodyCount = Count;
+        WordsPerRow = (RigidbodyCount + 63) / 64;
+
+        const MemSize WordCount = static_cast<MemSize>(RigidbodyCount) * WordsPerRow;
+        ArrayCollisionBits = new UInt64[WordCount]{ 0 };
+        ArrayJointLinkBits = new UInt64[WordCount]{ 0 };
+
+        // 그룹별 소속 강체 집합과, 그룹과 충돌을 허용하는 강체 집합
+        std::vector<UInt64> GroupMembers(RigidbodyGroupCount * WordsPerRow, 0);
+        std::vector<UInt64> GroupAccepted(RigidbodyGroupCount * WordsPerRow, 0);
+
+        for (int i = 0; i < RigidbodyCount; ++i)
+        {
+            const RigidbodyData& Rigidbody = Rigidbodies[i];
+            const UInt64 Bit = 1ull << (i & 63);
+            const int Word = i >> 6;
+
+            if (Rigidbody.GroupID < RigidbodyGroupCount)
+                GroupMembers[Rigidbody.GroupID * WordsPerRow + Word] |= Bit;
+
+            for (int g = 0; g < RigidbodyGroupCount; ++g)
+            {
+                if ((Rigidbody.NonCollisionGroupMask & (1 << g)) == 0)
+                    GroupAccepted[g * WordsPerRow + Word] |= Bit;
+            }
+        }
+
+        // 행 A = (A 의 그룹을 허용하는 강체) & ~(A 가 거부하는 그룹의 강체)
+        ParallelFor(RigidbodyCount, 64, [&](const int Begin, const int End)
+        {
+            std::vector<UInt64> Rejected(WordsPerRow);
+
+            for (int a = Begin; a < End; ++a)
+            {
+                const RigidbodyData& Rigidbody = Rigidbodies[a];
+                UInt64* Row = ArrayCollisionBits + static_cast<MemSize>(a) * WordsPerRow;
+
+                if (Rigidbody.GroupID >= RigidbodyGroupCount)
+                    continue;
+
+                std::fill(Rejected.begin(), Rejected.end(), 0);
+                for (int g = 0; g < RigidbodyGroupCount; ++g)
+                {
+                    if ((Rigidbody.NonCollisionGroupMask & (1 << g)) == 0)
+                        continue;
+
+                    for (int w = 0; w < WordsPerRow; ++w)
+                        Rejected[w] |= GroupMembers[g * WordsPerRow + w];
+                }
+
+                const UInt64* Accepted = GroupAccepted.data() + Rigidbody.GroupID * WordsPerRow;
+                for (int w = 0; w < WordsPerRow; ++w)
+                    Row[w] = Accepted[w] & ~Rejected[w];
+
+                Row[a >> 6] &= ~(1ull << (a & 63));
+            }
+        });
+
+        const int JointCount = InMeshData.GetJointCount();
+        const JointData* Joints = InMeshData.GetJoints();
+
+        for (int j = 0; j < JointCount; ++j)
+        {
+            const int A = Joints[j].RigidbodyIndexA;
+            const int B = Joints[j].RigidbodyIndexB;
+
+            if (A < 0 || A >= RigidbodyCount || B < 0 || B >= RigidbodyCount)
+                continue;
+
+            ArrayJointLinkBits[static_cast<MemSize>(A) * WordsPerRow + (B >> 6)] |= 1ull << (B & 63);
+            ArrayJointLinkBits[static_cast<MemSize>(B) * WordsPerRow + (A >> 6)] |= 1ull << (A & 63);
+        }
+
+        // 바인드 포즈 경계 구
+        std::vector<float> Radius(RigidbodyCount);
+        for (int i = 0; i < RigidbodyCount; ++i)
+            Radius[i] = GetBoundingRadius(Rigidbodies[i]);
+
+        // 이동 거리를 지정하지 않으면 조인트 체인으로 강체마다 구함
+        const bool bAutoTravel = InOptions.bSkipDistantPairs && InOptions.MaxTravelDistance < 0;
+
+        std::vector<float> Travel;
+        if (bAutoTravel)
+            BuildTravelDistances(InMeshData, Travel);
+
+        std::vector<std::vector<Pair>> RowPairs(RigidbodyCount);
+
+        ParallelFor(RigidbodyCount, 16, [&](const int Begin, const int End)
+        {
+            std::vector<UInt64> Candidates(WordsPerRow);
+
+            for (int a = Begin; a < End; ++a)
+            {
+                const MemSize RowOffset = static_cast<MemSize>(a) * WordsPerRow;
+                const bool bKinematicA = Rigidbodies[a].PhysicsMode == RigidbodyData::PhysicsMode::FollowBone;
+
+                for (int w = 0; w < WordsPerRow; ++w)
+                {
+                    Candidates[w] = ArrayCollisionBits[RowOffset + w];
+
+                    if (InOptions.bSkipJointLinkedPairs)
+                        Candidates[w] &= ~ArrayJointLinkBits[RowOffset + w];
+                }
+
+                // a 보다 큰 인덱스만 남김
+                for (int w = 0; w <= (a >> 6); ++w)
+                    Candidates[w] = (w < (a >> 6)) ? 0 : Candidates[w] & ~((2ull << (a & 63)) - 1);
+
+                for (int w = 0; w < WordsPerRow; ++w)
+                {
+                    for (UInt64 Bits = Candidates[w]; Bits != 0; Bits &= Bits - 1)
+                    {
+                        const int b = (w << 6) + Math::CountTrailingZeros(Bits);
+
+                        if (InOptions.bSkipKinematicPairs && bKinematicA && Rigidbodies[b].PhysicsMode == RigidbodyData::PhysicsMode::FollowBone)
+                            continue;
+
+                        // 자동일 때 둘 다 FollowBone 이거나 FollowBone 강체에 닿지 않는 강체가 낀 쌍은 이동 범위를 알 수 없으므로 남김
+                        const bool bKnownTravel = bAutoTravel == false ||
+                            (Travel[a] >= 0 && Travel[b] >= 0 && (bKinematicA == false || Rigidbodies[b].PhysicsMode != RigidbodyData::PhysicsMode::FollowBone));
+
+                        if (InOptions.bSkipDistantPairs && bKnownTravel)
+                        {
+                            const float MaxTravel = bAutoTravel ? Travel[a] + Travel[b] : InOptions.MaxTravelDistance;
+                            const float Reach = Radius[a] + Radius[b] + MaxTravel;
+                            if (Math::LengthSquared(Math::Sub(Rigidbodies[a].ShapePosition, Rigidbodies[b].ShapePosition)) > Reach * Reach)
+                                continue;
+                        }
+
+                        Pair NewPair;
+                        NewPair.RigidbodyIndexA = a;
+                        NewPair.RigidbodyIndexB = b;
+                        RowPairs[a].push_back(NewPair);
+                    }
+                }
+            }
+        });
+
+        for (const std::vector<Pair>& Pairs : RowPairs)
+            PairCount += static_cast<int>(Pairs.size());
+
+        if (PairCount > 0)
+        {
+            ArrayPair = new Pair[PairCount];
+
+            int Cursor = 0;
+            for (const std::vector<Pair>& Pairs : RowPairs)
+            {
+                for (const Pair& CurPair : Pairs)
+                    ArrayPair[Cursor++] = CurPair;
+            }
+        }
+
+        return true;
+    }
+
+    void CollisionMatrix::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayCollisionBits);
+        PMX_SAFE_DELETE_ARRAY(ArrayJointLinkBits);
+        PMX_SAFE_DELETE_ARRAY(ArrayPair);
+
+        RigidbodyCount = 0;
+        WordsPerRow = 0;
+        PairCount = 0;
+    }
+
+    bool CollisionMatrix::CanCollide(const int InIndexA, const int InIndexB) const
+    {
+        if (InIndexA < 0 || InIndexA >= RigidbodyCount || InIndexB < 0 || InIndexB >= RigidbodyCount)
+            return false;
+
+        return (GetRow(InIndexA)[InIndexB >> 6] >> (InIndexB & 63)) & 1;
+    }
+
+    bool CollisionMatrix::IsJointLinked(const int InIndexA, const int InIndexB) const
+    {
+        if (InIndexA < 0 || InIndexA >= RigidbodyCount || InIndexB < 0 || InIndexB >= RigidbodyCount)
+            return false;
+
+        return (ArrayJointLinkBits[static_cast<MemSize>(InIndexA) * WordsPerRow + (InIndexB >> 6)] >> (InIndexB & 63)) & 1;
+    }
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct CollisionMatrixOptions
+    {
+        // JointData 로 직접 연결된 쌍 제외
+        bool bSkipJointLinkedPairs = true;
+
+        // 둘 다 FollowBone(본 추적) 인 쌍은 서로 밀어낼 수 없으므로 제외
+        bool bSkipKinematicPairs = true;
+
+        // 바인드 포즈에서 서로 닿을 수 없을 만큼 먼 쌍을 제외
+        bool bSkipDistantPairs = true;
+
+        // 0 이상이면 경계 구 사이 거리가 이 값보다 먼 모든 쌍을 제외
+        // : 강체가 바인드 위치에서 움직일 수 있는 최대 거리의 두 배 정도를 지정합니다.
+        //   기본값(음수)은 FollowBone 강체까지의 조인트 체인 길이로 강체마다 이동 범위를 구해 적용합니다.
+        //   본 애니메이션에 의한 이동은 포함하지 않으며, 둘 다 FollowBone 인 쌍과 FollowBone 강체에 닿지 않는 강체는 제외하지 않습니다.
+        float MaxTravelDistance = -1.0f;
+    };
+
+    /**
+     * 강체 간 충돌 가능 여부를 로드 시점에 미리 계산한 비트셋 행렬
+     * : GroupID / NonCollisionGroupMask 로 정해지는 충돌 여부를 행마다 64bit 워드 단위로 저장하고,
+     *   조인트로 연결된 쌍이나 겹칠 수 없는 쌍을 제외한 후보 쌍 목록을 함께 만듭니다.
+     */
+    class CollisionMatrix
+    {
+    public:
+        struct Pair
+        {
+            int RigidbodyIndexA = 0;
+            int RigidbodyIndexB = 0;
+        };
+
+    public:
+        ~CollisionMatrix();
+
+        bool Build(const PMXMeshData& InMeshData, const CollisionMatrixOptions& InOptions = CollisionMatrixOptions());
+        void Delete();
+
+        int GetRigidbodyCount() const { return RigidbodyCount; }
+        int GetWordsPerRow() const { return WordsPerRow; }
+
+        // 그룹 마스크 기준 충돌 여부. 자기 자신과는 충돌하지 않습니다.
+        bool CanCollide(const int InIndexA, const int InIndexB) const;
+        const UInt64* GetRow(const int InIndex) const { return ArrayCollisionBits + static_cast<MemSize>(InIndex) * WordsPerRow; }
+
+        bool IsJointLinked(const int InIndexA, const int InIndexB) const;
+
+        // 후보 쌍 목록. 항상 RigidbodyIndexA < RigidbodyIndexB
+        int GetPairCount() const { return PairCount; }
+        const Pair* GetPairs() const { return ArrayPair; }
+
+    protected:
+        int RigidbodyCount = 0;
+        int WordsPerRow = 0;
+
+        // [Row * WordsPerRow + Word]
+        UInt64* ArrayCollisionBits = nullptr;
+        UInt64* ArrayJointLinkBits = nullptr;
+
+        int PairCount = 0;
+        Pair* ArrayPair = nullptr;
+    };
+}
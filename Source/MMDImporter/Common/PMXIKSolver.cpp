@@ -0,0 +1,344 @@
+﻿#include "PMXIKSolver.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <cstring>
+#include <vector>
+
+namespace PMX
+{
+    // 병렬 처리시 한 작업이 담당할 인스턴스 수
+    static constexpr int IKInstanceBatchSize = 64;
+
+    // 이 거리(제곱) 안에 들어오면 수렴한 것으로 판단
+    static constexpr float IKConvergeDistanceSquared = 1.e-8f;
+
+    IKSolver::~IKSolver()
+    {
+        Delete();
+    }
+
+    bool IKSolver::Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton)
+    {
+        Delete();
+
+        const int BoneCount = InSkeleton.GetBoneCount();
+        const BoneData* Bones = InMeshData.GetBones();
+
+        if (BoneCount <= 0 || Bones == nullptr || InMeshData.GetBoneCount() != BoneCount)
+            return false;
+
+        SkeletonRef = &InSkeleton;
+
+        const int* ParentIndices = InSkeleton.GetParentIndices();
+        const int* EvaluationOrder = InSkeleton.GetEvaluationOrder();
+
+        std::vector<Chain> Chains;
+        std::vector<Link> Links;
+        std::vector<int> PathBones;
+        std::vector<int> AffectedBones;
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const BoneData& Bone = Bones[i];
+            const BoneData::IK& IKData = Bone.IKData;
+
+            if ((Bone.Flags & BoneData::Flag::UseIK) == 0)
+                continue;
+
+            if (IKData.TargetIndex < 0 || IKData.TargetIndex >= BoneCount || IKData.LinkCount <= 0 || IKData.ArrayLink == nullptr)
+                continue;
+
+            // 타깃에서 루트 방향으로 올라가며 경로 수집
+            std::vector<int> Path;
+            for (int Cur = IKData.TargetIndex; Cur >= 0 && static_cast<int>(Path.size()) <= BoneCount; Cur = ParentIndices[Cur])
+                Path.push_back(Cur);
+
+            // 경로 위에 있는 링크 중 가장 위쪽 링크까지만 남김
+            int TopPathIndex = -1;
+            for (int j = 0; j < IKData.LinkCount; ++j)
+            {
+                for (int k = 1; k < static_cast<int>(Path.size()); ++k)
+                {
+                    if (Path[k] == IKData.ArrayLink[j].BoneIndex && k > TopPathIndex)
+                        TopPathIndex = k;
+                }
+            }
+
+            if (TopPathIndex < 0)
+                continue;
+
+            Path.resize(TopPathIndex + 1);
+
+            Chain NewChain;
+            NewChain.IKBoneIndex = i;
+            NewChain.TargetBoneIndex = IKData.TargetIndex;
+            NewChain.LoopCount = IKData.LoopCount;
+            NewChain.LimitRadian = IKData.LimitRadian;
+            NewChain.LinkBegin = static_cast<int>(Links.size());
+            NewChain.PathBegin = static_cast<int>(PathBones.size());
+            NewChain.PathCount = static_cast<int>(Path.size());
+
+            // 위 → 아래 순서로 저장
+            for (int k = TopPathIndex; k >= 0; --k)
+                PathBones.push_back(Path[k]);
+
+            // 링크는 PMX 에 기록된 순서(보통 타깃에 가까운 링크부터)를 유지
+            for (int j = 0; j < IKData.LinkCount; ++j)
+            {
+                const BoneData::IK::LinkData& LinkData = IKData.ArrayLink[j];
+
+                int PathIndex = -1;
+                for (int k = 1; k <= TopPathIndex; ++k)
+                {
+                    if (Path[k] == LinkData.BoneIndex)
+                        PathIndex = TopPathIndex - k;
+                }
+
+                // 타깃의 조상이 아닌 링크는 타깃을 움직일 수 없으므로 제외
+                if (PathIndex < 0)
+                    continue;
+
+                Link NewLink;
+                NewLink.BoneIndex = LinkData.BoneIndex;
+                NewLink.PathIndex = PathIndex;
+                NewLink.bHasLimit = LinkData.HasLimit != 0;
+                NewLink.Min = Math::Min(LinkData.LimitData.Min, LinkData.LimitData.Max);
+                NewLink.Max = Math::Max(LinkData.LimitData.Min, LinkData.LimitData.Max);
+                Links.push_back(NewLink);
+            }
+
+            NewChain.LinkCount = static_cast<int>(Links.size()) - NewChain.LinkBegin;
+
+            // 최상위 링크 아래의 모든 본은 체인 계산 후 갱신 필요
+            const int TopBone = Path[TopPathIndex];
+            NewChain.AffectedBegin = static_cast<int>(AffectedBones.size());
+            for (int k = 0; k < BoneCount; ++k)
+            {
+                if (InSkeleton.IsDescendantOf(EvaluationOrder[k], TopBone))
+                    AffectedBones.push_back(EvaluationOrder[k]);
+            }
+            NewChain.AffectedCount = static_cast<int>(AffectedBones.size()) - NewChain.AffectedBegin;
+
+            Chains.push_back(NewChain);
+        }
+
+        // 다른 체인이 푸는 링크의 아래(링크 자신은 제외)에 있는 체인(예: 발끝 IK ← 다리 IK)은 뒤에서 계산
+        const int Count = static_cast<int>(Chains.size());
+        std::vector<std::vector<int>> Dependents(Count);
+        std::vector<int> InDegree(Count, 0);
+
+        auto IsBelowLinks = [&](const int InBoneIndex, const Chain& InChain)
+        {
+            for (int j = InChain.LinkBegin; j < InChain.LinkBegin + InChain.LinkCount; ++j)
+            {
+                const int LinkBone = Links[j].BoneIndex;
+                if (InBoneIndex != LinkBone && InSkeleton.IsDescendantOf(InBoneIndex, LinkBone))
+                    return true;
+            }
+
+            return false;
+        };
+
+        for (int a = 0; a < Count; ++a)
+        {
+            for (int b = 0; b < Count; ++b)
+            {
+                if (a == b)
+                    continue;
+
+                if (IsBelowLinks(Chains[b].TargetBoneIndex, Chains[a]) || IsBelowLinks(Chains[b].IKBoneIndex, Chains[a]))
+                {
+                    Dependents[a].push_back(b);
+                    ++InDegree[b];
+                }
+            }
+        }
+
+        std::vector<int> Sorted;
+        std::vector<UInt8> Visited(Count, 0);
+        Sorted.reserve(Count);
+
+        while (static_cast<int>(Sorted.size()) < Count)
+        {
+            // 진입 차수가 0인 가장 앞의 체인. 체인은 IK 본 인덱스 순으로 모았으므로 서로 관계 없는 체인은 본 순서대로 계산
+            // : 순환이 있으면 남은 것 중 가장 앞의 체인
+            int Next = -1;
+            for (int c = 0; c < Count && Next < 0; ++c)
+            {
+                if (Visited[c] == 0 && InDegree[c] == 0)
+                    Next = c;
+            }
+            for (int c = 0; c < Count && Next < 0; ++c)
+            {
+                if (Visited[c] == 0)
+                    Next = c;
+            }
+
+            Visited[Next] = 1;
+            Sorted.push_back(Next);
+
+            for (const int Dependent : Dependents[Next])
+                --InDegree[Dependent];
+        }
+
+        ChainCount = Count;
+        ArrayChain = ChainCount > 0 ? new Chain[ChainCount] : nullptr;
+        for (int c = 0; c < ChainCount; ++c)
+            ArrayChain[c] = Chains[Sorted[c]];
+
+        LinkCount = static_cast<int>(Links.size());
+        ArrayLink = LinkCount > 0 ? new Link[LinkCount] : nullptr;
+        for (int j = 0; j < LinkCount; ++j)
+            ArrayLink[j] = Links[j];
+
+        PathBoneCount = static_cast<int>(PathBones.size());
+        ArrayPathBone = PathBoneCount > 0 ? new int[PathBoneCount] : nullptr;
+        for (int j = 0; j < PathBoneCount; ++j)
+            ArrayPathBone[j] = PathBones[j];
+
+        AffectedBoneCount = static_cast<int>(AffectedBones.size());
+        ArrayAffectedBone = AffectedBoneCount > 0 ? new int[AffectedBoneCount] : nullptr;
+        for (int j = 0; j < AffectedBoneCount; ++j)
+            ArrayAffectedBone[j] = AffectedBones[j];
+
+        return true;
+    }
+
+    void IKSolver::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayChain);
+        ChainCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayLink);
+        LinkCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayPathBone);
+        PathBoneCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayAffectedBone);
+        AffectedBoneCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayConverged);
+        ConvergedCapacity = 0;
+
+        SkeletonRef = nullptr;
+    }
+
+    void IKSolver::ReserveInstances(const int InInstanceCount) const
+    {
+        if (InInstanceCount <= ConvergedCapacity)
+            return;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayConverged);
+        ArrayConverged = new UInt8[InInstanceCount];
+        ConvergedCapacity = InInstanceCount;
+    }
+
+    void IKSolver::Solve(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        if (SkeletonRef == nullptr || InOutPose.GetBoneCount() != SkeletonRef->GetBoneCount())
+            return;
+
+        ReserveInstances(InOutPose.GetInstanceCount());
+
+        SkeletonRef->UpdateGlobalPose(InOutPose, InInstanceBegin, InInstanceEnd);
+
+        for (int c = 0; c < ChainCount; ++c)
+        {
+            SolveChain(c, InOutPose, InInstanceBegin, InInstanceEnd);
+
+            const Chain& CurChain = ArrayChain[c];
+            SkeletonRef->UpdateGlobalPose(InOutPose, ArrayAffectedBone + CurChain.AffectedBegin, CurChain.AffectedCount, InInstanceBegin, InInstanceEnd);
+        }
+    }
+
+    void IKSolver::SolveBatch(PoseBatch& InOutPose) const
+    {
+        // 작업들이 버퍼를 다시 잡지 않도록 먼저 준비
+        ReserveInstances(InOutPose.GetInstanceCount());
+
+        ParallelFor(InOutPose.GetInstanceCount(), IKInstanceBatchSize, [this, &InOutPose](const int Begin, const int End)
+        {
+            Solve(InOutPose, Begin, End);
+        });
+    }
+
+    void IKSolver::SolveChain(const int InChainIndex, PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        const Chain& CurChain = ArrayChain[InChainIndex];
+        const int* PathBones = ArrayPathBone + CurChain.PathBegin;
+
+        // 인스턴스 번호로 접근하므로 인스턴스 범위가 겹치지 않는 작업끼리는 같이 써도 됨
+        UInt8* Converged = ArrayConverged;
+        memset(Converged + InInstanceBegin, 0, InInstanceEnd - InInstanceBegin);
+
+        for (int Loop = 0; Loop < CurChain.LoopCount; ++Loop)
+        {
+            for (int j = 0; j < CurChain.LinkCount; ++j)
+            {
+                const Link& CurLink = ArrayLink[CurChain.LinkBegin + j];
+
+                // 모든 인스턴스의 링크 회전을 먼저 구한 뒤, 경로 갱신은 인스턴스 방향으로 한번에 처리
+                for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+                {
+                    if (Converged[i] != 0)
+                        continue;
+
+                    const int LinkIndex = InOutPose.GetIndex(CurLink.BoneIndex, i);
+
+                    const Vector3 LinkPosition = InOutPose.GetGlobalPosition(LinkIndex);
+                    const Vector4 InvLinkRotation = Math::QuatConjugate(InOutPose.GetGlobalRotation(LinkIndex));
+                    const Vector3 TargetPosition = InOutPose.GetGlobalPosition(InOutPose.GetIndex(CurChain.TargetBoneIndex, i));
+                    const Vector3 GoalPosition = InOutPose.GetGlobalPosition(InOutPose.GetIndex(CurChain.IKBoneIndex, i));
+
+                    // 링크 로컬 공간에서 타깃 방향을 목표 방향으로 회전
+                    const Vector3 ToTarget = Math::Normalize(Math::QuatRotate(InvLinkRotation, Math::Sub(TargetPosition, LinkPosition)));
+                    const Vector3 ToGoal = Math::Normalize(Math::QuatRotate(InvLinkRotation, Math::Sub(GoalPosition, LinkPosition)));
+
+                    float Angle = acosf(Math::Clamp(Math::Dot(ToTarget, ToGoal), -1.0f, 1.0f));
+                    if (Angle < 1.e-5f)
+                        continue;
+
+                    if (CurChain.LimitRadian > 0 && Angle > CurChain.LimitRadian)
+                        Angle = CurChain.LimitRadian;
+
+                    const Vector3 Axis = Math::Normalize(Math::Cross(ToTarget, ToGoal));
+                    if (Math::LengthSquared(Axis) < 0.5f)
+                        continue;
+
+                    const int LocalIndex = InOutPose.GetIndex(CurLink.BoneIndex, i);
+                    Vector4 NewRotation = Math::QuatNormalize(Math::QuatMultiply(InOutPose.GetLocalRotation(LocalIndex), Math::QuatFromAxisAngle(Axis, Angle)));
+
+                    if (CurLink.bHasLimit)
+                    {
+                        Vector3 Euler = Math::QuatToEuler(NewRotation);
+                        Euler.X = Math::Clamp(Euler.X, CurLink.Min.X, CurLink.Max.X);
+                        Euler.Y = Math::Clamp(Euler.Y, CurLink.Min.Y, CurLink.Max.Y);
+                        Euler.Z = Math::Clamp(Euler.Z, CurLink.Min.Z, CurLink.Max.Z);
+                        NewRotation = Math::QuatFromEuler(Euler);
+                    }
+
+                    InOutPose.SetLocalRotation(LocalIndex, NewRotation);
+                }
+
+                SkeletonRef->UpdateGlobalPose(InOutPose, PathBones + CurLink.PathIndex, CurChain.PathCount - CurLink.PathIndex, InInstanceBegin, InInstanceEnd);
+            }
+
+            bool bAllConverged = true;
+            for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+            {
+                const Vector3 TargetPosition = InOutPose.GetGlobalPosition(InOutPose.GetIndex(CurChain.TargetBoneIndex, i));
+                const Vector3 GoalPosition = InOutPose.GetGlobalPosition(InOutPose.GetIndex(CurChain.IKBoneIndex, i));
+
+                if (Math::LengthSquared(Math::Sub(TargetPosition, GoalPosition)) < IKConvergeDistanceSquared)
+                    Converged[i] = 1;
+                else
+                    bAllConverged = false;
+            }
+
+            if (bAllConverged)
+                break;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include "PMXSkeleton.h"
+
+namespace PMX
+{
+    /**
+     * BoneData::IK 기반 CCD IK 솔버
+     * : 모델의 모든 IK 체인을 의존 순서대로 정렬해 두고, 링크 각도 제한을 적용하며 풉니다.
+     *   PoseBatch 의 여러 인스턴스를 한번에 처리할 수 있습니다.
+     */
+    class IKSolver
+    {
+    public:
+        ~IKSolver();
+
+        // InSkeleton 은 솔버보다 오래 유지되어야 합니다.
+        bool Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton);
+        void Delete();
+
+        int GetChainCount() const { return ChainCount; }
+
+        // 수렴 기록용 버퍼를 인스턴스 수만큼 잡아 둠
+        // : Solve 를 여러 스레드에서 나눠 직접 호출할 때는 먼저 한번 호출해야 합니다.
+        void ReserveInstances(const int InInstanceCount) const;
+
+        // [InInstanceBegin, InInstanceEnd) 인스턴스의 IK 계산. 글로벌 포즈도 함께 갱신됩니다.
+        void Solve(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const;
+
+        // 전체 인스턴스를 블록 단위로 나눠 병렬로 계산
+        void SolveBatch(PoseBatch& InOutPose) const;
+
+    protected:
+        void SolveChain(const int InChainIndex, PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const;
+
+    protected:
+        struct Chain
+        {
+            int IKBoneIndex = -1;
+            int TargetBoneIndex = -1;
+            int LoopCount = 0;
+            float LimitRadian = 0;
+
+            // ArrayLink 범위
+            int LinkBegin = 0;
+            int LinkCount = 0;
+
+            // 최상위 링크 → 타깃 까지의 본 경로. ArrayPathBone 범위
+            int PathBegin = 0;
+            int PathCount = 0;
+
+            // 체인 계산 후 다시 계산해야 하는 본들. ArrayAffectedBone 범위
+            int AffectedBegin = 0;
+            int AffectedCount = 0;
+        };
+
+        struct Link
+        {
+            int BoneIndex = -1;
+
+            // Chain 경로 안에서의 위치
+            int PathIndex = 0;
+
+            bool bHasLimit = false;
+            Vector3 Min;
+            Vector3 Max;
+        };
+
+        const Skeleton* SkeletonRef = nullptr;
+
+        int ChainCount = 0;
+        Chain* ArrayChain = nullptr;
+
+        int LinkCount = 0;
+        Link* ArrayLink = nullptr;
+
+        int PathBoneCount = 0;
+        int* ArrayPathBone = nullptr;
+
+        int AffectedBoneCount = 0;
+        int* ArrayAffectedBone = nullptr;
+
+        // [InstanceIndex] 체인 계산 중 수렴한 인스턴스. SolveChain 마다 다시 씀
+        mutable int ConvergedCapacity = 0;
+        mutable UInt8* ArrayConverged = nullptr;
+    };
+}
@@ -0,0 +1,288 @@
+﻿#include "PMXInheritEvaluator.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    // 병렬 처리시 한 작업이 담당할 인스턴스 수
+    static constexpr int InheritInstanceBatchSize = 256;
+
+    InheritEvaluator::~InheritEvaluator()
+    {
+        Delete();
+    }
+
+    bool InheritEvaluator::Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton)
+    {
+        Delete();
+
+        const int Count = InSkeleton.GetBoneCount();
+        const BoneData* Bones = InMeshData.GetBones();
+
+        if (Count <= 0 || Bones == nullptr || InMeshData.GetBoneCount() != Count)
+            return false;
+
+        SkeletonRef = &InSkeleton;
+        BoneCount = Count;
+
+        // 부여 관계만 뽑아서 부여 부모 → 대상 순서로 위상 정렬
+        std::vector<int> Source(BoneCount, -1);
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const BoneData& Bone = Bones[i];
+
+            if ((Bone.Flags & (BoneData::Flag::InheritRotation | BoneData::Flag::InheritTranslation)) == 0 || Bone.InheritBoneData == nullptr)
+                continue;
+
+            const int ParentIndex = Bone.InheritBoneData->ParentBoneIndex;
+            if (ParentIndex < 0 || ParentIndex >= BoneCount || ParentIndex == i)
+                continue;
+
+            Source[i] = ParentIndex;
+        }
+
+        // 0 : 미방문, 1 : 방문 중, 2 : 완료
+        std::vector<UInt8> State(BoneCount, 0);
+        std::vector<int> Order;
+        std::vector<int> Stack;
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            if (Source[i] < 0 || State[i] != 0)
+                continue;
+
+            // 부여 부모를 따라 올라가며 아직 처리되지 않은 대상들을 쌓음. 순환은 방문 중 상태로 끊음
+            for (int Cur = i; Cur >= 0 && Source[Cur] >= 0 && State[Cur] == 0; Cur = Source[Cur])
+            {
+                State[Cur] = 1;
+                Stack.push_back(Cur);
+            }
+
+            while (Stack.empty() == false)
+            {
+                State[Stack.back()] = 2;
+                Order.push_back(Stack.back());
+                Stack.pop_back();
+            }
+        }
+
+        // 변형 순서 : 물리 후 변형, Layer, 인덱스 순
+        auto IsDeformedAfter = [Bones](const int A, const int B)
+        {
+            const bool bAfterPhysicsA = (Bones[A].Flags & BoneData::Flag::PhysicsAfterDeform) != 0;
+            const bool bAfterPhysicsB = (Bones[B].Flags & BoneData::Flag::PhysicsAfterDeform) != 0;
+
+            if (bAfterPhysicsA != bAfterPhysicsB)
+                return bAfterPhysicsA;
+
+            if (Bones[A].Layer != Bones[B].Layer)
+                return Bones[A].Layer > Bones[B].Layer;
+
+            return A > B;
+        };
+
+        // 링크 본마다 그 링크를 움직이는 IK 본 중 변형 순서가 가장 빠른 본
+        std::vector<int> LinkIK(BoneCount, -1);
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const BoneData::IK& IKData = Bones[i].IKData;
+
+            if ((Bones[i].Flags & BoneData::Flag::UseIK) == 0 || IKData.ArrayLink == nullptr)
+                continue;
+
+            for (int j = 0; j < IKData.LinkCount; ++j)
+            {
+                const int LinkBone = IKData.ArrayLink[j].BoneIndex;
+                if (LinkBone < 0 || LinkBone >= BoneCount)
+                    continue;
+
+                if (LinkIK[LinkBone] < 0 || IsDeformedAfter(LinkIK[LinkBone], i))
+                    LinkIK[LinkBone] = i;
+            }
+        }
+
+        // IK 뒤로 미룰 대상. Order 는 부여 부모가 먼저 오므로 부여 부모가 미뤄진 대상도 한번에 따라감
+        std::vector<UInt8> AfterIK(BoneCount, 0);
+        for (const int Target : Order)
+        {
+            const int SourceBone = Source[Target];
+            const bool bSourceIK = LinkIK[SourceBone] >= 0 && IsDeformedAfter(Target, LinkIK[SourceBone]);
+
+            AfterIK[Target] = (AfterIK[SourceBone] != 0 || bSourceIK) ? 1 : 0;
+        }
+
+        // 각 묶음 안의 순서는 그대로 두고 IK 전 / 후로 나눔
+        const auto AfterIKBegin = std::stable_partition(Order.begin(), Order.end(), [&AfterIK](const int Target) { return AfterIK[Target] == 0; });
+        AfterIKEntryBegin = static_cast<int>(AfterIKBegin - Order.begin());
+
+        // 미룬 대상과 그 자손은 IK 뒤에 글로벌 포즈를 다시 계산
+        const int* ParentIndices = InSkeleton.GetParentIndices();
+        const int* EvaluationOrder = InSkeleton.GetEvaluationOrder();
+
+        std::vector<int> AfterIKBones;
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const int BoneIndex = EvaluationOrder[i];
+            const int ParentIndex = ParentIndices[BoneIndex];
+
+            if (AfterIK[BoneIndex] == 0 && ParentIndex >= 0 && AfterIK[ParentIndex] != 0)
+                AfterIK[BoneIndex] = 1;
+
+            if (AfterIK[BoneIndex] != 0)
+                AfterIKBones.push_back(BoneIndex);
+        }
+
+        AfterIKBoneCount = static_cast<int>(AfterIKBones.size());
+        ArrayAfterIKBone = AfterIKBoneCount > 0 ? new int[AfterIKBoneCount] : nullptr;
+        std::copy(AfterIKBones.begin(), AfterIKBones.end(), ArrayAfterIKBone);
+
+        EntryCount = static_cast<int>(Order.size());
+        if (EntryCount <= 0)
+            return true;
+
+        ArrayTargetBone = new int[EntryCount];
+        ArraySourceBone = new int[EntryCount];
+        ArrayInfluence = new float[EntryCount];
+        ArrayFlags = new UInt8[EntryCount];
+
+        for (int e = 0; e < EntryCount; ++e)
+        {
+            const BoneData& Bone = Bones[Order[e]];
+
+            ArrayTargetBone[e] = Order[e];
+            ArraySourceBone[e] = Source[Order[e]];
+            ArrayInfluence[e] = Bone.InheritBoneData->ParentInfluence;
+            ArrayFlags[e] = ((Bone.Flags & BoneData::Flag::InheritRotation) ? EntryFlag::Rotation : 0)
+                          | ((Bone.Flags & BoneData::Flag::InheritTranslation) ? EntryFlag::Translation : 0);
+        }
+
+        return true;
+    }
+
+    void InheritEvaluator::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayTargetBone);
+        PMX_SAFE_DELETE_ARRAY(ArraySourceBone);
+        PMX_SAFE_DELETE_ARRAY(ArrayInfluence);
+        PMX_SAFE_DELETE_ARRAY(ArrayFlags);
+        EntryCount = 0;
+        AfterIKEntryBegin = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayAfterIKBone);
+        AfterIKBoneCount = 0;
+
+        BoneCount = 0;
+        SkeletonRef = nullptr;
+    }
+
+    void InheritEvaluator::Apply(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        if (InOutPose.GetBoneCount() != BoneCount)
+            return;
+
+        ApplyEntries(InOutPose, 0, AfterIKEntryBegin, InInstanceBegin, InInstanceEnd);
+    }
+
+    void InheritEvaluator::ApplyAfterIK(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        if (SkeletonRef == nullptr || InOutPose.GetBoneCount() != BoneCount || AfterIKEntryBegin >= EntryCount)
+            return;
+
+        ApplyEntries(InOutPose, AfterIKEntryBegin, EntryCount, InInstanceBegin, InInstanceEnd);
+
+        SkeletonRef->UpdateGlobalPose(InOutPose, ArrayAfterIKBone, AfterIKBoneCount, InInstanceBegin, InInstanceEnd);
+    }
+
+    void InheritEvaluator::ApplyEntries(PoseBatch& InOutPose, const int InEntryBegin, const int InEntryEnd, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        const int InstanceCount = InOutPose.GetInstanceCount();
+
+        float* RX = InOutPose.LocalRotation[0];
+        float* RY = InOutPose.LocalRotation[1];
+        float* RZ = InOutPose.LocalRotation[2];
+        float* RW = InOutPose.LocalRotation[3];
+        float* TX = InOutPose.LocalTranslation[0];
+        float* TY = InOutPose.LocalTranslation[1];
+        float* TZ = InOutPose.LocalTranslation[2];
+
+        for (int e = InEntryBegin; e < InEntryEnd; ++e)
+        {
+            const int Target = ArrayTargetBone[e] * InstanceCount;
+            const int Source = ArraySourceBone[e] * InstanceCount;
+            const float Influence = ArrayInfluence[e];
+
+            if (ArrayFlags[e] & EntryFlag::Rotation)
+            {
+                // Slerp(Identity, Source, Influence) * Target. 인스턴스 방향으로 벡터화 되도록 분기 없이 계산
+                for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+                {
+                    const int s = Source + i;
+                    const int t = Target + i;
+
+                    // 최단 경로를 위해 W 가 음수면 부호 반전
+                    const float Sign = RW[s] < 0 ? -1.0f : 1.0f;
+                    const float SX = RX[s] * Sign, SY = RY[s] * Sign, SZ = RZ[s] * Sign, SW = RW[s] * Sign;
+
+                    const float CosTheta = SW < 1.0f ? SW : 1.0f;
+                    const float Theta = acosf(CosTheta);
+                    const float SinTheta = sinf(Theta);
+
+                    // 각이 작으면 선형 보간 계수 사용
+                    const bool bLinear = SinTheta < 1.e-4f;
+                    const float InvSin = bLinear ? 0.0f : 1.0f / SinTheta;
+                    const float ScaleI = bLinear ? 1.0f - Influence : sinf((1.0f - Influence) * Theta) * InvSin;
+                    const float ScaleS = bLinear ? Influence : sinf(Influence * Theta) * InvSin;
+
+                    float AX = SX * ScaleS;
+                    float AY = SY * ScaleS;
+                    float AZ = SZ * ScaleS;
+                    float AW = SW * ScaleS + ScaleI;
+
+                    const float InvLen = 1.0f / sqrtf(AX * AX + AY * AY + AZ * AZ + AW * AW);
+                    AX *= InvLen;
+                    AY *= InvLen;
+                    AZ *= InvLen;
+                    AW *= InvLen;
+
+                    const float LX = RX[t], LY = RY[t], LZ = RZ[t], LW = RW[t];
+                    RX[t] = AW * LX + AX * LW + AY * LZ - AZ * LY;
+                    RY[t] = AW * LY - AX * LZ + AY * LW + AZ * LX;
+                    RZ[t] = AW * LZ + AX * LY - AY * LX + AZ * LW;
+                    RW[t] = AW * LW - AX * LX - AY * LY - AZ * LZ;
+                }
+            }
+
+            if (ArrayFlags[e] & EntryFlag::Translation)
+            {
+                for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+                {
+                    TX[Target + i] += TX[Source + i] * Influence;
+                    TY[Target + i] += TY[Source + i] * Influence;
+                    TZ[Target + i] += TZ[Source + i] * Influence;
+                }
+            }
+        }
+    }
+
+    void InheritEvaluator::ApplyBatch(PoseBatch& InOutPose) const
+    {
+        ParallelFor(InOutPose.GetInstanceCount(), InheritInstanceBatchSize, [this, &InOutPose](const int Begin, const int End)
+        {
+            Apply(InOutPose, Begin, End);
+        });
+    }
+
+    void InheritEvaluator::ApplyAfterIKBatch(PoseBatch& InOutPose) const
+    {
+        if (AfterIKEntryBegin >= EntryCount)
+            return;
+
+        ParallelFor(InOutPose.GetInstanceCount(), InheritInstanceBatchSize, [this, &InOutPose](const int Begin, const int End)
+        {
+            ApplyAfterIK(InOutPose, Begin, End);
+        });
+    }
+}
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include "PMXSkeleton.h"
+
+namespace PMX
+{
+    /**
+     * 회전/이동 부여(InheritRotation/InheritTranslation) 계산
+     * : 부여 관계의 의존 순서를 미리 정렬해 두고, 포즈마다 한번의 선형 순회로 적용합니다.
+     *   부여 부모의 로컬 값에 ParentInfluence 만큼 보간한 값을 대상 본의 로컬 값에 더합니다.
+     *   부여 부모가 IK 링크이고 대상 본이 그 IK 본보다 변형 순서(물리 후 변형, Layer, 인덱스)가 늦으면
+     *   IK 결과를 받아야 하므로 ApplyAfterIK 에서 따로 적용합니다 (그런 대상을 부여 부모로 쓰는 본도 함께).
+     *   NOTE: 로컬 부여(LocalInheritance) 는 구분하지 않고 일반 부여와 같게 계산하며,
+     *         물리 후 변형 본도 물리 계산 뒤로 미루지 않습니다. 물리는 호출하는 쪽에서 마지막에 적용합니다.
+     */
+    class InheritEvaluator
+    {
+    public:
+        ~InheritEvaluator();
+
+        // InSkeleton 은 계산기보다 오래 유지되어야 합니다.
+        bool Build(const PMXMeshData& InMeshData, const Skeleton& InSkeleton);
+        void Delete();
+
+        int GetEntryCount() const { return EntryCount; }
+        int GetAfterIKEntryCount() const { return EntryCount - AfterIKEntryBegin; }
+
+        // 로컬 포즈에 부여 값을 누적합니다. 글로벌 포즈 계산(및 IK) 전에 포즈당 한번만 호출해야 합니다.
+        void Apply(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const;
+
+        // IK 결과를 받는 부여를 누적하고 영향받는 본의 글로벌 포즈를 갱신합니다. IK 계산 후에 호출해야 합니다.
+        void ApplyAfterIK(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const;
+
+        // 전체 인스턴스를 블록 단위로 나눠 병렬로 계산
+        void ApplyBatch(PoseBatch& InOutPose) const;
+        void ApplyAfterIKBatch(PoseBatch& InOutPose) const;
+
+    protected:
+        void ApplyEntries(PoseBatch& InOutPose, const int InEntryBegin, const int InEntryEnd, const int InInstanceBegin, const int InInstanceEnd) const;
+
+    protected:
+        enum EntryFlag : UInt8
+        {
+            Rotation    = 1 << 0,
+            Translation = 1 << 1,
+        };
+
+        const Skeleton* SkeletonRef = nullptr;
+
+        int BoneCount = 0;
+
+        // 계산 순서대로 정렬된 SoA. [AfterIKEntryBegin, EntryCount) 는 IK 뒤에 적용
+        int EntryCount = 0;
+        int AfterIKEntryBegin = 0;
+        int* ArrayTargetBone = nullptr;
+        int* ArraySourceBone = nullptr;
+        float* ArrayInfluence = nullptr;
+        UInt8* ArrayFlags = nullptr;
+
+        // IK 뒤의 부여로 다시 계산해야 하는 본 (대상과 그 자손, 계산 순서)
+        int AfterIKBoneCount = 0;
+        int* ArrayAfterIKBone = nullptr;
+    };
+}
@@ -0,0 +1,207 @@
+﻿#pragma once
+
+#include "PMXTypes.h"
+
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace PMX
+{
+    /**
+     * 본/물리 연산에서 공통으로 쓰는 벡터, 쿼터니언 연산
+     * : 쿼터니언은 Vector4(X, Y, Z, W)로 표현합니다.
+     */
+    namespace Math
+    {
+        constexpr float SmallNumber = 1.e-8f;
+        constexpr float Pi = 3.14159265358979323846f;
+
+        inline Vector3 MakeVector3(const float X, const float Y, const float Z)
+        {
+            Vector3 Result;
+            Result.X = X;
+            Result.Y = Y;
+            Result.Z = Z;
+            return Result;
+        }
+
+        inline Vector4 MakeVector4(const float X, const float Y, const float Z, const float W)
+        {
+            Vector4 Result;
+            Result.X = X;
+            Result.Y = Y;
+            Result.Z = Z;
+            Result.W = W;
+            return Result;
+        }
+
+        inline Vector3 Add(const Vector3& A, const Vector3& B) { return MakeVector3(A.X + B.X, A.Y + B.Y, A.Z + B.Z); }
+        inline Vector3 Sub(const Vector3& A, const Vector3& B) { return MakeVector3(A.X - B.X, A.Y - B.Y, A.Z - B.Z); }
+        inline Vector3 Scale(const Vector3& A, const float S) { return MakeVector3(A.X * S, A.Y * S, A.Z * S); }
+        inline Vector3 Min(const Vector3& A, const Vector3& B) { return MakeVector3(fminf(A.X, B.X), fminf(A.Y, B.Y), fminf(A.Z, B.Z)); }
+        inline Vector3 Max(const Vector3& A, const Vector3& B) { return MakeVector3(fmaxf(A.X, B.X), fmaxf(A.Y, B.Y), fmaxf(A.Z, B.Z)); }
+
+        inline float Dot(const Vector3& A, const Vector3& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+
+        inline Vector3 Cross(const Vector3& A, const Vector3& B)
+        {
+            return MakeVector3(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X);
+        }
+
+        inline float LengthSquared(const Vector3& A) { return Dot(A, A); }
+        inline float Length(const Vector3& A) { return sqrtf(Dot(A, A)); }
+
+        // 길이가 0에 가까우면 영벡터를 반환
+        inline Vector3 Normalize(const Vector3& A)
+        {
+            const float LenSq = LengthSquared(A);
+            if (LenSq < SmallNumber)
+                return Vector3();
+
+            return Scale(A, 1.0f / sqrtf(LenSq));
+        }
+
+        // 길이 제곱이 InTolerance 이하일 때만 영벡터. 크기를 정규화한 좌표의 작은 삼각형 법선용
+        inline Vector3 Normalize(const Vector3& A, const float InTolerance)
+        {
+            const float LenSq = LengthSquared(A);
+            if (LenSq <= InTolerance)
+                return Vector3();
+
+            return Scale(A, 1.0f / sqrtf(LenSq));
+        }
+
+        inline float Clamp(const float Value, const float MinValue, const float MaxValue)
+        {
+            return Value < MinValue ? MinValue : (Value > MaxValue ? MaxValue : Value);
+        }
+
+        // Value 는 0 이 아니어야 합니다.
+        inline int CountTrailingZeros(const UInt64 Value)
+        {
+#if defined(_MSC_VER)
+            unsigned long Index = 0;
+            _BitScanForward64(&Index, Value);
+            return static_cast<int>(Index);
+#else
+            return __builtin_ctzll(Value);
+#endif
+        }
+
+        inline Vector4 QuatIdentity() { return MakeVector4(0, 0, 0, 1); }
+
+        inline Vector4 QuatMultiply(const Vector4& A, const Vector4& B)
+        {
+            return MakeVector4(
+                A.W * B.X + A.X * B.W + A.Y * B.Z - A.Z * B.Y,
+                A.W * B.Y - A.X * B.Z + A.Y * B.W + A.Z * B.X,
+                A.W * B.Z + A.X * B.Y - A.Y * B.X + A.Z * B.W,
+                A.W * B.W - A.X * B.X - A.Y * B.Y - A.Z * B.Z);
+        }
+
+        inline Vector4 QuatConjugate(const Vector4& A) { return MakeVector4(-A.X, -A.Y, -A.Z, A.W); }
+
+        inline Vector4 QuatNormalize(const Vector4& A)
+        {
+            const float LenSq = A.X * A.X + A.Y * A.Y + A.Z * A.Z + A.W * A.W;
+            if (LenSq < SmallNumber)
+                return QuatIdentity();
+
+            const float InvLen = 1.0f / sqrtf(LenSq);
+            return MakeVector4(A.X * InvLen, A.Y * InvLen, A.Z * InvLen, A.W * InvLen);
+        }
+
+        // 단위 축 기준 회전
+        inline Vector4 QuatFromAxisAngle(const Vector3& Axis, const float Radian)
+        {
+            const float S = sinf(Radian * 0.5f);
+            return MakeVector4(Axis.X * S, Axis.Y * S, Axis.Z * S, cosf(Radian * 0.5f));
+        }
+
+        inline Vector3 QuatRotate(const Vector4& Q, const Vector3& V)
+        {
+            // v' = v + 2w(q x v) + 2(q x (q x v))
+            const Vector3 QV = MakeVector3(Q.X, Q.Y, Q.Z);
+            const Vector3 T = Scale(Cross(QV, V), 2.0f);
+            return Add(Add(V, Scale(T, Q.W)), Cross(QV, T));
+        }
+
+        // 단위 벡터 From 을 단위 벡터 To 로 돌리는 최소 회전
+        inline Vector4 QuatFromTo(const Vector3& From, const Vector3& To)
+        {
+            const float CosTheta = Dot(From, To);
+            if (CosTheta < -0.9999f)
+            {
+                // 반대 방향이면 From 에 수직인 아무 축으로 180도
+                Vector3 Axis = Cross(MakeVector3(1, 0, 0), From);
+                if (LengthSquared(Axis) < 1.e-6f)
+                    Axis = Cross(MakeVector3(0, 1, 0), From);
+
+                return QuatFromAxisAngle(Normalize(Axis), Pi);
+            }
+
+            const Vector3 Axis = Cross(From, To);
+            return QuatNormalize(MakeVector4(Axis.X, Axis.Y, Axis.Z, 1.0f + CosTheta));
+        }
+
+        // 오일러 각(라디안)은 X → Y → Z 순서로 적용 (R = Rz * Ry * Rx)
+        inline Vector4 QuatFromEuler(const Vector3& Euler)
+        {
+            const float CX = cosf(Euler.X * 0.5f), SX = sinf(Euler.X * 0.5f);
+            const float CY = cosf(Euler.Y * 0.5f), SY = sinf(Euler.Y * 0.5f);
+            const float CZ = cosf(Euler.Z * 0.5f), SZ = sinf(Euler.Z * 0.5f);
+
+            return MakeVector4(
+                SX * CY * CZ - CX * SY * SZ,
+                CX * SY * CZ + SX * CY * SZ,
+                CX * CY * SZ - SX * SY * CZ,
+                CX * CY * CZ + SX * SY * SZ);
+        }
+
+        inline Vector3 QuatToEuler(const Vector4& Q)
+        {
+            return MakeVector3(
+                atan2f(2.0f * (Q.W * Q.X + Q.Y * Q.Z), 1.0f - 2.0f * (Q.X * Q.X + Q.Y * Q.Y)),
+                asinf(Clamp(2.0f * (Q.W * Q.Y - Q.Z * Q.X), -1.0f, 1.0f)),
+                atan2f(2.0f * (Q.W * Q.Z + Q.X * Q.Y), 1.0f - 2.0f * (Q.Y * Q.Y + Q.Z * Q.Z)));
+        }
+
+        // 최단 경로 구면 선형 보간. 각이 작으면 정규화 선형 보간으로 대체
+        inline Vector4 QuatSlerp(const Vector4& A, const Vector4& B, const float Alpha)
+        {
+            float CosTheta = A.X * B.X + A.Y * B.Y + A.Z * B.Z + A.W * B.W;
+            const float Sign = CosTheta < 0 ? -1.0f : 1.0f;
+            CosTheta *= Sign;
+
+            float ScaleA = 1.0f - Alpha;
+            float ScaleB = Alpha * Sign;
+
+            if (CosTheta < 0.9995f)
+            {
+                const float Theta = acosf(CosTheta);
+                const float InvSin = 1.0f / sinf(Theta);
+                ScaleA = sinf((1.0f - Alpha) * Theta) * InvSin;
+                ScaleB = sinf(Alpha * Theta) * InvSin * Sign;
+            }
+
+            return QuatNormalize(MakeVector4(
+                A.X * ScaleA + B.X * ScaleB,
+                A.Y * ScaleA + B.Y * ScaleB,
+                A.Z * ScaleA + B.Z * ScaleB,
+                A.W * ScaleA + B.W * ScaleB));
+        }
+
+        // 두 단위 쿼터니언 회전 사이 각 (라디안)
+        // : acos(내적) 은 1 근처에서 float 정밀도가 모자라 작은 각을 잘못 재므로 두 쿼터니언 사이 거리로 계산
+        inline float QuatAngle(const Vector4& A, const Vector4& B)
+        {
+            const float Sign = A.X * B.X + A.Y * B.Y + A.Z * B.Z + A.W * B.W < 0 ? -1.0f : 1.0f;
+            const float DX = A.X - B.X * Sign, DY = A.Y - B.Y * Sign, DZ = A.Z - B.Z * Sign, DW = A.W - B.W * Sign;
+
+            return 4.0f * asinf(fminf(sqrtf(DX * DX + DY * DY + DZ * DZ + DW * DW) * 0.5f, 1.0f));
+        }
+    }
+}
@@ -1,10 +1,17 @@
 ﻿#include "PMXMeshData.h"
 
+#include <algorithm>
 #include <memory>
 #include <cassert>
+#include <cstring>
+#include <type_traits>
+#include <vector>
 
 namespace PMX
 {
+    // 진행 보고와 취소 확인 간격 (정점, 삼각형)
+    static constexpr int LoadProgressBatchSize = 4096;
+
     void ReadBuffer(void* const OutDest, const Byte*& InOutBufferCursor, const PMX::MemSize ReadSize)
     {
         memcpy(OutDest, InOutBufferCursor, ReadSize);
@@ -36,6 +43,15 @@ namespace PMX
         }
     }
 
+    UInt8 GetIndexSize(const IndexType InIndexType, const int InCount)
+    {
+        // 가장 큰 인덱스는 InCount - 1
+        if (InIndexType == IndexType::Vertex)
+            return InCount <= 0x100 ? 1 : (InCount <= 0x10000 ? 2 : 4);
+
+        return InCount <= 0x80 ? 1 : (InCount <= 0x8000 ? 2 : 4);
+    }
+
     template <class T>
     T* AllocDataArray(int Size)
     {
@@ -46,42 +62,96 @@ namespace PMX
         return reinterpret_cast<T*>(memset(Array, 0, sizeof(T) * Size));
     }
 
+    const char* LoadProgress::GetSectionName(const SectionType InSection)
+    {
+        static const char* const SectionNames[static_cast<int>(SectionType::Count)] =
+        {
+            "Header", "ModelInfo", "Vertices", "Surfaces", "Textures", "Materials", "Bones",
+            "Morphs", "DisplayFrames", "Rigidbodies", "Joints", "SoftBodies",
+        };
+
+        const int Index = static_cast<int>(InSection);
+        return Index >= 0 && Index < static_cast<int>(SectionType::Count) ? SectionNames[Index] : "Unknown";
+    }
+
     PMXMeshData::~PMXMeshData()
     {
         Delete();
     }
 
-    bool PMXMeshData::LoadBinary(const Byte* const InBuffer, const PMX::MemSize InBufferSize)
+    bool PMXMeshData::LoadBinary(const Byte* const InBuffer, const PMX::MemSize InBufferSize, LoadProgress* InOutProgress, const LoadOptions& InOptions)
     {
+        LoadMemory = MemoryReport();
+
         if (InBuffer == nullptr || InBufferSize == 0)
             return false;
 
         const Byte* BufferCur = InBuffer;
         const Byte* BufferEnd = InBuffer + InBufferSize;
 
-        ReadHeader(BufferCur);
+        Progress = InOutProgress;
+        LoadBuffer = InBuffer;
+
+        PMX_TRACE_SCOPE(LoadScope, Progress != nullptr ? Progress->Stats : nullptr, "LoadBinary");
+        PMX_TRACE_BYTES(LoadScope, InBufferSize);
+
+        if (Progress != nullptr)
+        {
+            Progress->Section = LoadProgress::SectionType::Header;
+            Progress->ItemsRead = 0;
+            Progress->ItemCount = 0;
+            Progress->BytesRead = 0;
+        }
+
+        // NOTE: 예상은 할당하기 전에 끝내야 상한을 넘는 모델이 메모리를 잡지 않음.
+        if (InOptions.MemoryBudget > 0 || InOptions.SkipSections != 0)
+        {
+            PMX_TRACE_SCOPE(PredictScope, Progress != nullptr ? Progress->Stats : nullptr, "PredictMemory");
+            PMX_TRACE_BYTES(PredictScope, InBufferSize);
+
+            if (PredictMemory(InBuffer, InBufferSize, LoadMemory) == false || ApplyLoadOptions(InOptions) == false)
+            {
+                Progress = nullptr;
+                LoadBuffer = nullptr;
+                return false;
+            }
+        }
+
+        {
+            PMX_TRACE_SCOPE(HeaderScope, Progress != nullptr ? Progress->Stats : nullptr, LoadProgress::GetSectionName(LoadProgress::SectionType::Header));
+            ReadHeader(BufferCur);
+            PMX_TRACE_BYTES(HeaderScope, static_cast<MemSize>(BufferCur - InBuffer));
+        }
 
         if (IsValidPMXFile(HeaderData) == false)
+        {
+            Progress = nullptr;
+            LoadBuffer = nullptr;
             return false;
+        }
 
-        ReadModelInfo(BufferCur);
-        ReadVertices(BufferCur);
-        ReadSurfaces(BufferCur);
-        ReadTextures(BufferCur);
-        ReadMaterials(BufferCur);
-        ReadBones(BufferCur);
-        ReadMorphs(BufferCur);
-        ReadDisplayFrames(BufferCur);
-        ReadRigidbodies(BufferCur);
-        ReadJoints(BufferCur);
-
-        if (HeaderData.Version > 2.0f)
+        bool bCompleted =
+            BeginSection(LoadProgress::SectionType::ModelInfo, &PMXMeshData::ReadModelInfo, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Vertices, &PMXMeshData::ReadVertices, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Surfaces, &PMXMeshData::ReadSurfaces, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Textures, &PMXMeshData::ReadTextures, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Materials, &PMXMeshData::ReadMaterials, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Bones, &PMXMeshData::ReadBones, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Morphs, &PMXMeshData::ReadMorphs, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::DisplayFrames, &PMXMeshData::ReadDisplayFrames, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Rigidbodies, &PMXMeshData::ReadRigidbodies, BufferCur) &&
+            BeginSection(LoadProgress::SectionType::Joints, &PMXMeshData::ReadJoints, BufferCur);
+
+        if (bCompleted && HeaderData.Version > 2.0f)
         {
-            ReadSoftBodies(BufferCur);
+            bCompleted = BeginSection(LoadProgress::SectionType::SoftBodies, &PMXMeshData::ReadSoftBodies, BufferCur);
         }
 
+        Progress = nullptr;
+        LoadBuffer = nullptr;
+
         // 끝까지 정상적으로 읽었는지 검사
-        if (BufferCur != BufferEnd)
+        if (bCompleted == false || BufferCur != BufferEnd)
         {
             Delete();
             return false;
@@ -92,6 +162,10 @@ namespace PMX
 
     void PMXMeshData::Delete()
     {
+        // 예상값과 상한 결과는 실패 이유로 남김
+        for (MemSize& Bytes : LoadMemory.ActualBytes)
+            Bytes = 0;
+
         ModelInfoData.Delete();
 
         PMX_SAFE_DELETE_ARRAY(ArrayVertex);
@@ -125,6 +199,125 @@ namespace PMX
         SoftBodyCount = 0;
     }
 
+    bool PMXMeshData::RemapVertices(const int* InOldToNew, const int InNewVertexCount)
+    {
+        if (InOldToNew == nullptr || InNewVertexCount < 0)
+            return false;
+
+        // 새 번호마다 옮겨올 정점이 있는지, 삼각형이 제거된 정점을 쓰지 않는지 먼저 확인
+        std::vector<int> NewToOld(InNewVertexCount, -1);
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            const int NewIndex = InOldToNew[i];
+            if (NewIndex >= InNewVertexCount)
+                return false;
+
+            if (NewIndex >= 0 && NewToOld[NewIndex] < 0)
+                NewToOld[NewIndex] = i;
+        }
+
+        for (int i = 0; i < InNewVertexCount; ++i)
+        {
+            if (NewToOld[i] < 0)
+                return false;
+        }
+
+        for (int i = 0; i < SurfaceCount; ++i)
+        {
+            for (const int VertexIndex : ArraySurface[i].VertexIndex)
+            {
+                if (VertexIndex < 0 || VertexIndex >= VertexCount || InOldToNew[VertexIndex] < 0)
+                    return false;
+            }
+        }
+
+        // Deform 소유권을 새 배열로 넘김
+        VertexData* NewArrayVertex = AllocDataArray<VertexData>(InNewVertexCount);
+        for (int i = 0; i < InNewVertexCount; ++i)
+        {
+            NewArrayVertex[i] = ArrayVertex[NewToOld[i]];
+            ArrayVertex[NewToOld[i]].Deform = nullptr;
+        }
+
+        PMX_SAFE_DELETE_ARRAY(ArrayVertex);
+        ArrayVertex = NewArrayVertex;
+
+        for (int i = 0; i < SurfaceCount; ++i)
+        {
+            for (int& VertexIndex : ArraySurface[i].VertexIndex)
+                VertexIndex = InOldToNew[VertexIndex];
+        }
+
+        // 정점/UV 모프는 제거된 정점과, 합쳐져서 중복된 정점의 오프셋을 빼고 앞으로 당김
+        std::vector<int> Seen(InNewVertexCount, -1);
+
+        auto RemapOffsets = [&](auto* Offsets, int& InOutOffsetCount, const int InMorphIndex)
+        {
+            int Count = 0;
+            for (int j = 0; j < InOutOffsetCount; ++j)
+            {
+                const int OldIndex = Offsets[j].VertexIndex;
+                const int NewIndex = (OldIndex >= 0 && OldIndex < VertexCount) ? InOldToNew[OldIndex] : -1;
+
+                if (NewIndex < 0 || Seen[NewIndex] == InMorphIndex)
+                    continue;
+
+                Seen[NewIndex] = InMorphIndex;
+                Offsets[Count] = Offsets[j];
+                Offsets[Count].VertexIndex = NewIndex;
+                ++Count;
+            }
+
+            InOutOffsetCount = Count;
+        };
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            MorphData& Morph = ArrayMorph[i];
+
+            if (Morph.ArrayOffset == nullptr)
+                continue;
+
+            switch (Morph.Type)
+            {
+                case MorphData::MorphType::Vertex:
+                    RemapOffsets(static_cast<MorphData::OffsetVertex*>(Morph.ArrayOffset), Morph.OffsetCount, i);
+                    break;
+
+                case MorphData::MorphType::UV:
+                case MorphData::MorphType::AdditionalUV1:
+                case MorphData::MorphType::AdditionalUV2:
+                case MorphData::MorphType::AdditionalUV3:
+                case MorphData::MorphType::AdditionalUV4:
+                    RemapOffsets(static_cast<MorphData::OffsetUV*>(Morph.ArrayOffset), Morph.OffsetCount, i);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        for (int i = 0; i < SoftBodyCount; ++i)
+        {
+            SoftBodyData& SoftBody = ArraySoftBody[i];
+
+            for (int j = 0; j < SoftBody.AnchorRigidbodyCount; ++j)
+            {
+                int& VertexIndex = SoftBody.ArrayAnchorRigidbody[j].VertexIndex;
+                VertexIndex = (VertexIndex >= 0 && VertexIndex < VertexCount) ? InOldToNew[VertexIndex] : -1;
+            }
+
+            for (int j = 0; j < SoftBody.VertexPinCount; ++j)
+            {
+                int& VertexIndex = SoftBody.ArrayVertexPin[j].VertexIndex;
+                VertexIndex = (VertexIndex >= 0 && VertexIndex < VertexCount) ? InOldToNew[VertexIndex] : -1;
+            }
+        }
+
+        VertexCount = InNewVertexCount;
+        return true;
+    }
+
     void PMXMeshData::ReadText(Text* OutString, const Byte*& InOutBufferCursor)
     {
         const Text::EncodingType Encoding = HeaderData.TextEncoding;
@@ -163,6 +356,79 @@ namespace PMX
         return (Header.Signature[0] == 'P' && Header.Signature[1] == 'M' && Header.Signature[2] == 'X' && Header.Signature[3] == 0x20);
     }
 
+    bool PMXMeshData::BeginSection(const LoadProgress::SectionType InSection, void (PMXMeshData::*InReadFunction)(const Byte*&), const Byte*& InOutBufferCursor)
+    {
+        if (Progress != nullptr)
+        {
+            if (Progress->bCancelRequested)
+                return false;
+
+            Progress->ItemsRead = 0;
+            Progress->ItemCount = 0;
+            Progress->Section = InSection;
+        }
+
+        {
+            PMX_TRACE_SCOPE(SectionScope, Progress != nullptr ? Progress->Stats : nullptr, LoadProgress::GetSectionName(InSection));
+            [[maybe_unused]] const Byte* SectionBegin = InOutBufferCursor;
+
+            // 읽지 않는 섹션은 예상할 때 찾은 끝으로 바로 이동. 개수는 0 으로 남음
+            if (LoadMemory.IsSkipped(InSection))
+                InOutBufferCursor = LoadBuffer + LoadMemory.SectionEnd[static_cast<int>(InSection)];
+            else
+                (this->*InReadFunction)(InOutBufferCursor);
+
+            if (LoadMemory.bPredicted)
+                LoadMemory.ActualBytes[static_cast<int>(InSection)] = GetSectionMemory(InSection);
+
+            PMX_TRACE_BYTES(SectionScope, static_cast<MemSize>(InOutBufferCursor - SectionBegin));
+            PMX_TRACE_COUNT(SectionScope, GetSectionItemCount(InSection));
+        }
+
+        if (Progress == nullptr)
+            return true;
+
+        if (Progress->bCancelRequested)
+            return false;
+
+        Progress->BytesRead = static_cast<MemSize>(InOutBufferCursor - LoadBuffer);
+
+        if (Progress->OnSectionLoaded)
+            Progress->OnSectionLoaded(InSection, *this);
+
+        return true;
+    }
+
+    int PMXMeshData::GetSectionItemCount(const LoadProgress::SectionType InSection) const
+    {
+        switch (InSection)
+        {
+            case LoadProgress::SectionType::ModelInfo:      return 1;
+            case LoadProgress::SectionType::Vertices:       return VertexCount;
+            case LoadProgress::SectionType::Surfaces:       return SurfaceCount;
+            case LoadProgress::SectionType::Textures:       return TextureCount;
+            case LoadProgress::SectionType::Materials:      return MaterialCount;
+            case LoadProgress::SectionType::Bones:          return BoneCount;
+            case LoadProgress::SectionType::Morphs:         return MorphCount;
+            case LoadProgress::SectionType::DisplayFrames:  return DisplayFrameCount;
+            case LoadProgress::SectionType::Rigidbodies:    return RigidbodyCount;
+            case LoadProgress::SectionType::Joints:         return JointCount;
+            case LoadProgress::SectionType::SoftBodies:     return SoftBodyCount;
+            default:                                        return 0;
+        }
+    }
+
+    bool PMXMeshData::ReportProgress(const int InItemsRead, const int InItemCount)
+    {
+        if (Progress == nullptr)
+            return true;
+
+        Progress->ItemsRead = InItemsRead;
+        Progress->ItemCount = InItemCount;
+
+        return Progress->bCancelRequested == false;
+    }
+
     void PMXMeshData::ReadHeader(const Byte*& InOutBufferCursor)
     {
         ReadBuffer(&HeaderData.Signature, InOutBufferCursor, sizeof(HeaderData.Signature));
@@ -193,6 +459,10 @@ namespace PMX
 
         for (int i = 0; i < VertexCount; ++i)
         {
+            // 취소되면 남은 정점은 비워 둔 채 중단. LoadBinary 에서 전체를 지움
+            if (i % LoadProgressBatchSize == 0 && ReportProgress(i, VertexCount) == false)
+                return;
+
             VertexData& Vertex = ArrayVertex[i];
 
             ReadBuffer(&Vertex.Position, InOutBufferCursor, sizeof(Vertex.Position));
@@ -294,6 +564,9 @@ namespace PMX
 
         for (int i = 0; i < SurfaceCount; ++i)
         {
+            if (i % LoadProgressBatchSize == 0 && ReportProgress(i, SurfaceCount) == false)
+                return;
+
             ReadIndex(&ArraySurface[i].VertexIndex[0], InOutBufferCursor, IndexType::Vertex, HeaderData.VertexIndexSize);
             ReadIndex(&ArraySurface[i].VertexIndex[1], InOutBufferCursor, IndexType::Vertex, HeaderData.VertexIndexSize);
             ReadIndex(&ArraySurface[i].VertexIndex[2], InOutBufferCursor, IndexType::Vertex, HeaderData.VertexIndexSize);
@@ -341,7 +614,18 @@ namespace PMX
             ReadIndex(&MaterialData.EnvironmentTextureIndex, InOutBufferCursor, IndexType::Texture, HeaderData.TextureIndexSize);
             ReadBuffer(&MaterialData.EnvironmentBlendMode, InOutBufferCursor, sizeof(MaterialData.EnvironmentBlendMode));
             ReadBuffer(&MaterialData.ToonReference, InOutBufferCursor, sizeof(MaterialData.ToonReference));
-            ReadBuffer(&MaterialData.ToonValue, InOutBufferCursor, sizeof(MaterialData.ToonValue));
+
+            if (MaterialData.ToonReference == MaterialData::ToonReferenceType::Internal)
+            {
+                UInt8 InternalToon = 0;
+                ReadBuffer(&InternalToon, InOutBufferCursor, sizeof(InternalToon));
+                MaterialData.ToonValue = InternalToon;
+            }
+            else
+            {
+                ReadIndex(&MaterialData.ToonValue, InOutBufferCursor, IndexType::Texture, HeaderData.TextureIndexSize);
+            }
+
             ReadText(&MaterialData.MetaData, InOutBufferCursor);
             ReadBuffer(&MaterialData.SurfaceCount, InOutBufferCursor, sizeof(MaterialData.SurfaceCount));
         }
@@ -447,6 +731,9 @@ namespace PMX
 
         for (int i = 0; i < MorphCount; ++i)
         {
+            if (ReportProgress(i, MorphCount) == false)
+                return;
+
             MorphData& MorphData = ArrayMorph[i];
 
             ReadText(&MorphData.NameLocal, InOutBufferCursor);
@@ -561,6 +848,14 @@ namespace PMX
                         break;
                     case MorphData::MorphType::Impulse:
                         {
+                            // 강체 섹션을 읽지 않으면 가리킬 강체가 없으므로 오프셋도 건너뜀
+                            if (LoadMemory.IsSkipped(LoadProgress::SectionType::Rigidbodies))
+                            {
+                                InOutBufferCursor += (HeaderData.RigidbodyIndexSize + sizeof(UInt8) + sizeof(Vector3) * 2) * MorphData.OffsetCount;
+                                MorphData.OffsetCount = 0;
+                                break;
+                            }
+
                             Offsets = new MorphData::OffsetImpulse[MorphData.OffsetCount];
                             memset(Offsets, 0, sizeof(MorphData::OffsetImpulse) * MorphData.OffsetCount);
 
@@ -710,6 +1005,7 @@ namespace PMX
             ReadIndex(&SoftBodyData.MaterialIndex, InOutBufferCursor, IndexType::Material, HeaderData.MaterialIndexSize);
             ReadBuffer(&SoftBodyData.Group, InOutBufferCursor, sizeof(SoftBodyData.Group));
             ReadBuffer(&SoftBodyData.NonCollisionGroupMask, InOutBufferCursor, sizeof(SoftBodyData.NonCollisionGroupMask));
+            ReadBuffer(&SoftBodyData.Flags, InOutBufferCursor, sizeof(SoftBodyData.Flags));
             ReadBuffer(&SoftBodyData.B_LinkCreateDistance, InOutBufferCursor, sizeof(SoftBodyData.B_LinkCreateDistance));
             ReadBuffer(&SoftBodyData.NumberOfClusters, InOutBufferCursor, sizeof(SoftBodyData.NumberOfClusters));
             ReadBuffer(&SoftBodyData.TotalMass, InOutBufferCursor, sizeof(SoftBodyData.TotalMass));
@@ -741,13 +1037,1627 @@ namespace PMX
             ReadBuffer(&SoftBodyData.MaterialAST, InOutBufferCursor, sizeof(SoftBodyData.MaterialAST));
             ReadBuffer(&SoftBodyData.MaterialVST, InOutBufferCursor, sizeof(SoftBodyData.MaterialVST));
 
+            // 앵커와 고정 정점의 인덱스는 헤더의 인덱스 크기로 저장됨
             ReadBuffer(&SoftBodyData.AnchorRigidbodyCount, InOutBufferCursor, sizeof(SoftBodyData.AnchorRigidbodyCount));
             SoftBodyData.ArrayAnchorRigidbody = AllocDataArray<SoftBodyData::AnchorRigidbody>(SoftBodyData.AnchorRigidbodyCount);
-            ReadBuffer(SoftBodyData.ArrayAnchorRigidbody, InOutBufferCursor, sizeof(SoftBodyData::AnchorRigidbody)* SoftBodyData.AnchorRigidbodyCount);
+
+            for (int j = 0; j < SoftBodyData.AnchorRigidbodyCount; ++j)
+            {
+                SoftBodyData::AnchorRigidbody& Anchor = SoftBodyData.ArrayAnchorRigidbody[j];
+
+                ReadIndex(&Anchor.RigidbodyIndex, InOutBufferCursor, IndexType::Rigidbody, HeaderData.RigidbodyIndexSize);
+                ReadIndex(&Anchor.VertexIndex, InOutBufferCursor, IndexType::Vertex, HeaderData.VertexIndexSize);
+                ReadBuffer(&Anchor.NearMode, InOutBufferCursor, sizeof(Anchor.NearMode));
+            }
 
             ReadBuffer(&SoftBodyData.VertexPinCount, InOutBufferCursor, sizeof(SoftBodyData.VertexPinCount));
             SoftBodyData.ArrayVertexPin = AllocDataArray<SoftBodyData::VertexPin>(SoftBodyData.VertexPinCount);
-            ReadBuffer(SoftBodyData.ArrayVertexPin, InOutBufferCursor, sizeof(SoftBodyData::VertexPin) * SoftBodyData.VertexPinCount);
+
+            for (int j = 0; j < SoftBodyData.VertexPinCount; ++j)
+            {
+                ReadIndex(&SoftBodyData.ArrayVertexPin[j].VertexIndex, InOutBufferCursor, IndexType::Vertex, HeaderData.VertexIndexSize);
+            }
+        }
+    }
+
+    // new T[InCount] 가 요청하는 크기
+    // : 소멸자가 있는 타입은 delete[] 를 위해 개수를 앞에 저장함 (Itanium / MSVC ABI 모두 size_t 하나).
+    template <class T>
+    MemSize GetArrayAllocSize(const int InCount)
+    {
+        if (InCount <= 0)
+            return 0;
+
+        return sizeof(T) * static_cast<MemSize>(InCount) + (std::is_trivially_destructible<T>::value ? 0 : sizeof(MemSize));
+    }
+
+    static MemSize GetTextAllocSize(const Text& InText)
+    {
+        switch (InText.GetEncodingType())
+        {
+            case Text::UTF16LE: return InText.GetUTF16LE() != nullptr ? static_cast<MemSize>(InText.GetLength()) * 2 + 2 : 0;
+            case Text::UTF8:    return InText.GetUTF8() != nullptr ? strlen(InText.GetUTF8()) + 3 : 0;
+            default:            return 0;
+        }
+    }
+
+    static MemSize GetDeformAllocSize(const VertexData::WeightDeformType InType)
+    {
+        switch (InType)
+        {
+            case VertexData::WeightDeformType::BDEF1:   return sizeof(VertexData::BDEF1);
+            case VertexData::WeightDeformType::BDEF2:   return sizeof(VertexData::BDEF2);
+            case VertexData::WeightDeformType::BDEF4:   return sizeof(VertexData::BDEF4);
+            case VertexData::WeightDeformType::SDEF:    return sizeof(VertexData::SDEF);
+            case VertexData::WeightDeformType::QDEF:    return sizeof(VertexData::QDEF);
+            default:                                    return 0;
+        }
+    }
+
+    static MemSize GetMorphOffsetSize(const MorphData::MorphType InType)
+    {
+        switch (InType)
+        {
+            case MorphData::MorphType::Group:           return sizeof(MorphData::OffsetGroup);
+            case MorphData::MorphType::Vertex:          return sizeof(MorphData::OffsetVertex);
+            case MorphData::MorphType::Bone:            return sizeof(MorphData::OffsetBone);
+            case MorphData::MorphType::UV:
+            case MorphData::MorphType::AdditionalUV1:
+            case MorphData::MorphType::AdditionalUV2:
+            case MorphData::MorphType::AdditionalUV3:
+            case MorphData::MorphType::AdditionalUV4:   return sizeof(MorphData::OffsetUV);
+            case MorphData::MorphType::Material:        return sizeof(MorphData::OffsetMaterial);
+            case MorphData::MorphType::Flip:            return sizeof(MorphData::OffsetFlip);
+            case MorphData::MorphType::Impulse:         return sizeof(MorphData::OffsetImpulse);
+            default:                                    return 0;
+        }
+    }
+
+    /**
+     * 할당 없이 PMX 를 훑으며 할당 크기를 계산
+     * : Read* 와 같은 순서로 건너뛰고, 버퍼를 벗어나면 그 뒤로는 아무것도 읽지 않고 IsFailed() 가 true 입니다.
+     */
+    class MemoryScanner
+    {
+    public:
+        MemoryScanner(const Byte* const InBuffer, const MemSize InBufferSize)
+            : Begin(InBuffer), Cursor(InBuffer), End(InBuffer + InBufferSize)
+        {
+        }
+
+        bool IsFailed() const { return bFailed; }
+        MemSize GetOffset() const { return static_cast<MemSize>(Cursor - Begin); }
+        MemSize GetRemaining() const { return static_cast<MemSize>(End - Cursor); }
+
+        void Skip(const MemSize InSize)
+        {
+            if (bFailed || GetRemaining() < InSize)
+            {
+                bFailed = true;
+                return;
+            }
+
+            Cursor += InSize;
+        }
+
+        template <class T>
+        T Read()
+        {
+            T Value = T();
+
+            if (bFailed == false && GetRemaining() >= sizeof(T))
+                memcpy(&Value, Cursor, sizeof(T));
+
+            Skip(sizeof(T));
+            return Value;
+        }
+
+        // 항목 수. 0 이하면 0 (Read* 도 아무것도 만들지 않음)
+        // : 항목마다 최소 InMinItemSize 바이트가 필요하므로 남은 크기로 담을 수 없는 수면 실패
+        int ReadCount(const MemSize InMinItemSize)
+        {
+            const int Count = Read<int>();
+            if (Count <= 0 || bFailed)
+                return 0;
+
+            if (static_cast<MemSize>(Count) > GetRemaining() / InMinItemSize)
+            {
+                bFailed = true;
+                return 0;
+            }
+
+            return Count;
+        }
+
+        MemSize SkipText(const Text::EncodingType InEncoding)
+        {
+            const int TextBytesSize = Read<int>();
+            if (TextBytesSize == 0 || bFailed)
+                return 0;
+
+            if (TextBytesSize < 0)
+            {
+                bFailed = true;
+                return 0;
+            }
+
+            // NOTE: ReadText 는 알 수 없는 인코딩이면 길이만 읽고 본문은 남겨 둠.
+            switch (InEncoding)
+            {
+                case Text::UTF16LE:
+                    Skip(TextBytesSize);
+                    return static_cast<MemSize>(TextBytesSize) + 2;
+
+                case Text::UTF8:
+                    Skip(TextBytesSize);
+                    return static_cast<MemSize>(TextBytesSize) + 3;
+
+                default:
+                    return 0;
+            }
+        }
+
+    public:
+        // Morphs 섹션에서 찾은 Impulse 오프셋 크기. 강체 섹션 예상 크기에 더함
+        MemSize ImpulseOffsetBytes = 0;
+
+    private:
+        const Byte* Begin = nullptr;
+        const Byte* Cursor = nullptr;
+        const Byte* End = nullptr;
+
+        bool bFailed = false;
+    };
+
+    static MemSize ScanModelInfoMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        MemSize Bytes = 0;
+
+        for (int i = 0; i < 4; ++i)
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+        return Bytes;
+    }
+
+    static MemSize ScanVertexMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const MemSize FixedSize = sizeof(Vector3) * 2 + sizeof(Vector2) + sizeof(Vector4) * InHeader.AdditionalVectorCount;
+        const MemSize BoneIndexSize = InHeader.BoneIndexSize;
+
+        const int Count = InOutScanner.ReadCount(FixedSize + sizeof(UInt8) + sizeof(float));
+        MemSize Bytes = GetArrayAllocSize<VertexData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            InOutScanner.Skip(FixedSize);
+
+            const VertexData::WeightDeformType DeformType = InOutScanner.Read<VertexData::WeightDeformType>();
+            Bytes += GetDeformAllocSize(DeformType);
+
+            switch (DeformType)
+            {
+                case VertexData::WeightDeformType::BDEF1:   InOutScanner.Skip(BoneIndexSize); break;
+                case VertexData::WeightDeformType::BDEF2:   InOutScanner.Skip(BoneIndexSize * 2 + sizeof(float)); break;
+                case VertexData::WeightDeformType::BDEF4:   InOutScanner.Skip(BoneIndexSize * 4 + sizeof(float) * 4); break;
+                case VertexData::WeightDeformType::SDEF:    InOutScanner.Skip(BoneIndexSize * 2 + sizeof(float) + sizeof(Vector3) * 3); break;
+                case VertexData::WeightDeformType::QDEF:    InOutScanner.Skip(BoneIndexSize * 4 + sizeof(float) * 4); break;
+                default:                                    break;
+            }
+
+            InOutScanner.Skip(sizeof(float));
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanSurfaceMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const int IndexCount = InOutScanner.ReadCount(InHeader.VertexIndexSize);
+        const int SurfaceCount = IndexCount / 3;
+
+        InOutScanner.Skip(static_cast<MemSize>(SurfaceCount) * 3 * InHeader.VertexIndexSize);
+
+        return GetArrayAllocSize<SurfaceData>(SurfaceCount);
+    }
+
+    static MemSize ScanTextureMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const int Count = InOutScanner.ReadCount(sizeof(int));
+        MemSize Bytes = GetArrayAllocSize<TextureData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+        return Bytes;
+    }
+
+    static MemSize ScanMaterialMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        // 색상, 반사, 플래그, 윤곽선
+        const MemSize FixedSize = sizeof(Vector4) + sizeof(Vector3) + sizeof(float) + sizeof(Vector3) + sizeof(UInt8) + sizeof(Vector4) + sizeof(float);
+
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 3 + FixedSize + sizeof(UInt8) * 3 + sizeof(int));
+        MemSize Bytes = GetArrayAllocSize<MaterialData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(FixedSize + InHeader.TextureIndexSize * 2 + sizeof(UInt8));
+
+            const MaterialData::ToonReferenceType ToonReference = InOutScanner.Read<MaterialData::ToonReferenceType>();
+            InOutScanner.Skip(ToonReference == MaterialData::ToonReferenceType::Internal ? sizeof(UInt8) : InHeader.TextureIndexSize);
+
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            InOutScanner.Skip(sizeof(int));
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanBoneMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const MemSize BoneIndexSize = InHeader.BoneIndexSize;
+
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + sizeof(Vector3) + BoneIndexSize + sizeof(int) + sizeof(UInt16));
+        MemSize Bytes = GetArrayAllocSize<BoneData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(sizeof(Vector3) + BoneIndexSize + sizeof(int));
+
+            const UInt16 Flags = InOutScanner.Read<UInt16>();
+
+            InOutScanner.Skip((Flags & BoneData::Flag::IndexedTailPosition) ? BoneIndexSize : sizeof(Vector3));
+
+            if (Flags & (BoneData::Flag::InheritRotation | BoneData::Flag::InheritTranslation))
+            {
+                Bytes += sizeof(struct BoneData::InheritBone);
+                InOutScanner.Skip(BoneIndexSize + sizeof(float));
+            }
+
+            if (Flags & BoneData::Flag::FixedAxis)
+            {
+                Bytes += sizeof(struct BoneData::FixedAxis);
+                InOutScanner.Skip(sizeof(Vector3));
+            }
+
+            if (Flags & BoneData::Flag::LocalCoordinate)
+            {
+                Bytes += sizeof(struct BoneData::LocalCoordinate);
+                InOutScanner.Skip(sizeof(Vector3) * 2);
+            }
+
+            if (Flags & BoneData::Flag::ExternalParentDeform)
+            {
+                Bytes += sizeof(struct BoneData::ExternalParent);
+                InOutScanner.Skip(BoneIndexSize);
+            }
+
+            if (Flags & BoneData::Flag::UseIK)
+            {
+                InOutScanner.Skip(BoneIndexSize + sizeof(int) + sizeof(float));
+
+                const int LinkCount = InOutScanner.ReadCount(BoneIndexSize + sizeof(Byte));
+                Bytes += GetArrayAllocSize<BoneData::IK::LinkData>(LinkCount);
+
+                for (int j = 0; j < LinkCount && InOutScanner.IsFailed() == false; ++j)
+                {
+                    InOutScanner.Skip(BoneIndexSize);
+
+                    if (InOutScanner.Read<Byte>() != 0)
+                        InOutScanner.Skip(sizeof(Vector3) * 2);
+                }
+            }
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanMorphMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + sizeof(UInt8) * 2 + sizeof(int));
+        MemSize Bytes = GetArrayAllocSize<MorphData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(sizeof(UInt8));
+
+            const MorphData::MorphType Type = InOutScanner.Read<MorphData::MorphType>();
+
+            MemSize OffsetSize = 0;
+            switch (Type)
+            {
+                case MorphData::MorphType::Group:           OffsetSize = InHeader.MorphIndexSize + sizeof(float); break;
+                case MorphData::MorphType::Vertex:          OffsetSize = InHeader.VertexIndexSize + sizeof(Vector3); break;
+                case MorphData::MorphType::Bone:            OffsetSize = InHeader.BoneIndexSize + sizeof(Vector3) + sizeof(Vector4); break;
+                case MorphData::MorphType::UV:
+                case MorphData::MorphType::AdditionalUV1:
+                case MorphData::MorphType::AdditionalUV2:
+                case MorphData::MorphType::AdditionalUV3:
+                case MorphData::MorphType::AdditionalUV4:   OffsetSize = InHeader.VertexIndexSize + sizeof(Vector4); break;
+                case MorphData::MorphType::Material:        OffsetSize = InHeader.MaterialIndexSize + sizeof(UInt8) + sizeof(Vector4) * 5 + sizeof(Vector3) * 2 + sizeof(float) * 2; break;
+                case MorphData::MorphType::Flip:            OffsetSize = InHeader.MorphIndexSize + sizeof(float); break;
+                case MorphData::MorphType::Impulse:         OffsetSize = InHeader.RigidbodyIndexSize + sizeof(UInt8) + sizeof(Vector3) * 2; break;
+                default:                                    break;
+            }
+
+            // NOTE: ReadMorphs 는 알 수 없는 종류면 오프셋을 읽지 않음.
+            if (OffsetSize == 0)
+            {
+                InOutScanner.Skip(sizeof(int));
+                continue;
+            }
+
+            const int OffsetCount = InOutScanner.ReadCount(OffsetSize);
+
+            // Impulse 오프셋은 강체를 뺄 때 함께 빠지므로 강체 섹션에 셈
+            if (Type == MorphData::MorphType::Impulse)
+                InOutScanner.ImpulseOffsetBytes += GetMorphOffsetSize(Type) * OffsetCount;
+            else
+                Bytes += GetMorphOffsetSize(Type) * OffsetCount;
+
+            InOutScanner.Skip(OffsetSize * OffsetCount);
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanDisplayFrameMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + sizeof(UInt8) + sizeof(int));
+        MemSize Bytes = GetArrayAllocSize<DisplayFrameData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(sizeof(UInt8));
+
+            const int FrameCount = InOutScanner.ReadCount(sizeof(UInt8));
+            Bytes += GetArrayAllocSize<DisplayFrameData::Frame>(FrameCount);
+
+            for (int j = 0; j < FrameCount && InOutScanner.IsFailed() == false; ++j)
+            {
+                switch (InOutScanner.Read<DisplayFrameData::Frame::FrameType>())
+                {
+                    case DisplayFrameData::Frame::FrameType::Bone:  InOutScanner.Skip(InHeader.BoneIndexSize); break;
+                    case DisplayFrameData::Frame::FrameType::Morph: InOutScanner.Skip(InHeader.MorphIndexSize); break;
+                }
+            }
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanRigidbodyMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        // 그룹, 충돌 마스크, 모양, 크기/위치/회전, 질량 ~ 마찰, 물리 모드
+        const MemSize FixedSize = InHeader.BoneIndexSize + sizeof(UInt8) + sizeof(UInt16) + sizeof(UInt8) + sizeof(Vector3) * 3 + sizeof(float) * 5 + sizeof(UInt8);
+
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + FixedSize);
+        MemSize Bytes = GetArrayAllocSize<RigidbodyData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(FixedSize);
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanJointMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        const MemSize FixedSize = sizeof(UInt8) + InHeader.RigidbodyIndexSize * 2 + sizeof(Vector3) * 8;
+
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + FixedSize);
+        MemSize Bytes = GetArrayAllocSize<JointData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(FixedSize);
+        }
+
+        return Bytes;
+    }
+
+    static MemSize ScanSoftBodyMemory(MemoryScanner& InOutScanner, const Header& InHeader)
+    {
+        // 모양 ~ 강성 계수. 앵커와 고정 정점 앞까지
+        const MemSize FixedSize = sizeof(Int8) + InHeader.MaterialIndexSize + sizeof(UInt8) + sizeof(UInt16) + sizeof(UInt8)
+            + sizeof(int) * 2 + sizeof(float) * 2 + sizeof(Int32) + sizeof(float) * 18 + sizeof(int) * 7;
+
+        const MemSize AnchorSize = InHeader.RigidbodyIndexSize + InHeader.VertexIndexSize + sizeof(UInt8);
+
+        const int Count = InOutScanner.ReadCount(sizeof(int) * 2 + FixedSize + sizeof(int) * 2);
+        MemSize Bytes = GetArrayAllocSize<SoftBodyData>(Count);
+
+        for (int i = 0; i < Count && InOutScanner.IsFailed() == false; ++i)
+        {
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+            Bytes += InOutScanner.SkipText(InHeader.TextEncoding);
+
+            InOutScanner.Skip(FixedSize);
+
+            const int AnchorCount = InOutScanner.ReadCount(AnchorSize);
+            Bytes += GetArrayAllocSize<SoftBodyData::AnchorRigidbody>(AnchorCount);
+            InOutScanner.Skip(AnchorSize * AnchorCount);
+
+            const int PinCount = InOutScanner.ReadCount(InHeader.VertexIndexSize);
+            Bytes += GetArrayAllocSize<SoftBodyData::VertexPin>(PinCount);
+            InOutScanner.Skip(static_cast<MemSize>(InHeader.VertexIndexSize) * PinCount);
+        }
+
+        return Bytes;
+    }
+
+    MemSize MemoryReport::GetPredictedTotal() const
+    {
+        MemSize Total = 0;
+        for (int i = 0; i < SectionCount; ++i)
+        {
+            if ((SkippedSections & (1u << i)) == 0)
+                Total += PredictedBytes[i];
+        }
+
+        return Total;
+    }
+
+    MemSize MemoryReport::GetActualTotal() const
+    {
+        MemSize Total = 0;
+        for (int i = 0; i < SectionCount; ++i)
+            Total += ActualBytes[i];
+
+        return Total;
+    }
+
+    bool PMXMeshData::PredictMemory(const Byte* const InBuffer, const PMX::MemSize InBufferSize, MemoryReport& OutReport)
+    {
+        OutReport = MemoryReport();
+
+        if (InBuffer == nullptr || InBufferSize == 0)
+            return false;
+
+        MemoryScanner Scanner(InBuffer, InBufferSize);
+
+        // ReadHeader 와 같게 읽되, 전역 설정이 구조체보다 길면 남는 바이트는 버림
+        Header ScanHeader;
+        for (UInt8& Signature : ScanHeader.Signature)
+            Signature = Scanner.Read<UInt8>();
+
+        ScanHeader.Version = Scanner.Read<float>();
+
+        const int GlobalsCount = Scanner.Read<Int8>();
+        const MemSize GlobalsSize = sizeof(Header) - offsetof(Header, TextEncoding);
+
+        if (GlobalsCount < 0 || static_cast<MemSize>(GlobalsCount) > Scanner.GetRemaining())
+            return false;
+
+        memcpy(&ScanHeader.TextEncoding, InBuffer + Scanner.GetOffset(), std::min<MemSize>(GlobalsCount, GlobalsSize));
+        Scanner.Skip(GlobalsCount);
+
+        if (Scanner.IsFailed() || IsValidPMXFile(ScanHeader) == false)
+            return false;
+
+        // ReadIndex 가 다룰 수 있는 크기만
+        for (const UInt8 IndexSize : { ScanHeader.VertexIndexSize, ScanHeader.TextureIndexSize, ScanHeader.MaterialIndexSize, ScanHeader.BoneIndexSize, ScanHeader.MorphIndexSize, ScanHeader.RigidbodyIndexSize })
+        {
+            if (IndexSize != 1 && IndexSize != 2 && IndexSize != 4)
+                return false;
+        }
+
+        OutReport.SectionEnd[static_cast<int>(LoadProgress::SectionType::Header)] = Scanner.GetOffset();
+
+        typedef MemSize (*ScanFunction)(MemoryScanner&, const Header&);
+
+        static const ScanFunction ScanFunctions[MemoryReport::SectionCount] =
+        {
+            nullptr,
+            &ScanModelInfoMemory,
+            &ScanVertexMemory,
+            &ScanSurfaceMemory,
+            &ScanTextureMemory,
+            &ScanMaterialMemory,
+            &ScanBoneMemory,
+            &ScanMorphMemory,
+            &ScanDisplayFrameMemory,
+            &ScanRigidbodyMemory,
+            &ScanJointMemory,
+            &ScanSoftBodyMemory,
+        };
+
+        const int LastSection = static_cast<int>(ScanHeader.Version > 2.0f ? LoadProgress::SectionType::SoftBodies : LoadProgress::SectionType::Joints);
+
+        for (int i = 1; i <= LastSection; ++i)
+        {
+            OutReport.SectionBegin[i] = Scanner.GetOffset();
+            OutReport.PredictedBytes[i] = ScanFunctions[i](Scanner, ScanHeader);
+            OutReport.SectionEnd[i] = Scanner.GetOffset();
+
+            if (Scanner.IsFailed())
+                return false;
+        }
+
+        // 2.0 에는 소프트 바디 섹션이 없으므로 빈 구간
+        for (int i = LastSection + 1; i < MemoryReport::SectionCount; ++i)
+        {
+            OutReport.SectionBegin[i] = Scanner.GetOffset();
+            OutReport.SectionEnd[i] = Scanner.GetOffset();
+        }
+
+        if (Scanner.GetRemaining() != 0)
+            return false;
+
+        OutReport.PredictedBytes[static_cast<int>(LoadProgress::SectionType::Rigidbodies)] += Scanner.ImpulseOffsetBytes;
+
+        OutReport.bPredicted = true;
+        return true;
+    }
+
+    MemSize PMXMeshData::GetSectionMemory(const LoadProgress::SectionType InSection) const
+    {
+        MemSize Bytes = 0;
+
+        switch (InSection)
+        {
+            case LoadProgress::SectionType::ModelInfo:
+                Bytes += GetTextAllocSize(ModelInfoData.NameLocal) + GetTextAllocSize(ModelInfoData.NameUniversal);
+                Bytes += GetTextAllocSize(ModelInfoData.CommentsLocal) + GetTextAllocSize(ModelInfoData.CommentsUniversal);
+                break;
+
+            case LoadProgress::SectionType::Vertices:
+                Bytes += GetArrayAllocSize<VertexData>(VertexCount);
+
+                for (int i = 0; i < VertexCount; ++i)
+                {
+                    if (ArrayVertex[i].Deform != nullptr)
+                        Bytes += GetDeformAllocSize(ArrayVertex[i].DeformType);
+                }
+                break;
+
+            case LoadProgress::SectionType::Surfaces:
+                Bytes += GetArrayAllocSize<SurfaceData>(SurfaceCount);
+                break;
+
+            case LoadProgress::SectionType::Textures:
+                Bytes += GetArrayAllocSize<TextureData>(TextureCount);
+
+                for (int i = 0; i < TextureCount; ++i)
+                    Bytes += GetTextAllocSize(ArrayTexture[i].Path);
+                break;
+
+            case LoadProgress::SectionType::Materials:
+                Bytes += GetArrayAllocSize<MaterialData>(MaterialCount);
+
+                for (int i = 0; i < MaterialCount; ++i)
+                {
+                    const MaterialData& Material = ArrayMaterial[i];
+                    Bytes += GetTextAllocSize(Material.NameLocal) + GetTextAllocSize(Material.NameUniversal) + GetTextAllocSize(Material.MetaData);
+                }
+                break;
+
+            case LoadProgress::SectionType::Bones:
+                Bytes += GetArrayAllocSize<BoneData>(BoneCount);
+
+                for (int i = 0; i < BoneCount; ++i)
+                {
+                    const BoneData& Bone = ArrayBone[i];
+                    Bytes += GetTextAllocSize(Bone.NameLocal) + GetTextAllocSize(Bone.NameUniversal);
+
+                    Bytes += Bone.InheritBoneData != nullptr ? sizeof(struct BoneData::InheritBone) : 0;
+                    Bytes += Bone.FixedAxisData != nullptr ? sizeof(struct BoneData::FixedAxis) : 0;
+                    Bytes += Bone.LocalCoordinateData != nullptr ? sizeof(struct BoneData::LocalCoordinate) : 0;
+                    Bytes += Bone.ExternalParentData != nullptr ? sizeof(struct BoneData::ExternalParent) : 0;
+
+                    if (Bone.IKData.ArrayLink != nullptr)
+                        Bytes += GetArrayAllocSize<BoneData::IK::LinkData>(Bone.IKData.LinkCount);
+                }
+                break;
+
+            case LoadProgress::SectionType::Morphs:
+                Bytes += GetArrayAllocSize<MorphData>(MorphCount);
+
+                for (int i = 0; i < MorphCount; ++i)
+                {
+                    const MorphData& Morph = ArrayMorph[i];
+                    Bytes += GetTextAllocSize(Morph.NameLocal) + GetTextAllocSize(Morph.NameUniversal);
+
+                    // NOTE: RemapVertices 로 줄어든 오프셋은 배열을 다시 잡지 않으므로 실제보다 작게 잼.
+                    // Impulse 오프셋은 강체 섹션에 셈
+                    if (Morph.ArrayOffset != nullptr && Morph.Type != MorphData::MorphType::Impulse)
+                        Bytes += GetMorphOffsetSize(Morph.Type) * Morph.OffsetCount;
+                }
+                break;
+
+            case LoadProgress::SectionType::DisplayFrames:
+                Bytes += GetArrayAllocSize<DisplayFrameData>(DisplayFrameCount);
+
+                for (int i = 0; i < DisplayFrameCount; ++i)
+                {
+                    const DisplayFrameData& DisplayFrame = ArrayDisplayFrame[i];
+                    Bytes += GetTextAllocSize(DisplayFrame.NameLocal) + GetTextAllocSize(DisplayFrame.NameUniversal);
+
+                    if (DisplayFrame.ArrayFrame != nullptr)
+                        Bytes += GetArrayAllocSize<DisplayFrameData::Frame>(DisplayFrame.FrameCount);
+                }
+                break;
+
+            case LoadProgress::SectionType::Rigidbodies:
+                Bytes += GetArrayAllocSize<RigidbodyData>(RigidbodyCount);
+
+                for (int i = 0; i < RigidbodyCount; ++i)
+                    Bytes += GetTextAllocSize(ArrayRigidbody[i].NameLocal) + GetTextAllocSize(ArrayRigidbody[i].NameUniversal);
+
+                for (int i = 0; i < MorphCount; ++i)
+                {
+                    const MorphData& Morph = ArrayMorph[i];
+
+                    if (Morph.ArrayOffset != nullptr && Morph.Type == MorphData::MorphType::Impulse)
+                        Bytes += GetMorphOffsetSize(Morph.Type) * Morph.OffsetCount;
+                }
+                break;
+
+            case LoadProgress::SectionType::Joints:
+                Bytes += GetArrayAllocSize<JointData>(JointCount);
+
+                for (int i = 0; i < JointCount; ++i)
+                    Bytes += GetTextAllocSize(ArrayJoint[i].NameLocal) + GetTextAllocSize(ArrayJoint[i].NameUniversal);
+                break;
+
+            case LoadProgress::SectionType::SoftBodies:
+                Bytes += GetArrayAllocSize<SoftBodyData>(SoftBodyCount);
+
+                for (int i = 0; i < SoftBodyCount; ++i)
+                {
+                    const SoftBodyData& SoftBody = ArraySoftBody[i];
+                    Bytes += GetTextAllocSize(SoftBody.NameLocal) + GetTextAllocSize(SoftBody.NameUniversal);
+
+                    if (SoftBody.ArrayAnchorRigidbody != nullptr)
+                        Bytes += GetArrayAllocSize<SoftBodyData::AnchorRigidbody>(SoftBody.AnchorRigidbodyCount);
+
+                    if (SoftBody.ArrayVertexPin != nullptr)
+                        Bytes += GetArrayAllocSize<SoftBodyData::VertexPin>(SoftBody.VertexPinCount);
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        return Bytes;
+    }
+
+    // 헤더 ~ 본. 메시, 재질, 스키닝에 필요하므로 빼지 않음
+    static constexpr UInt32 RequiredSectionMask = (1u << (static_cast<UInt32>(LoadProgress::SectionType::Bones) + 1)) - 1;
+
+    // 빼는 섹션을 참조하는 섹션도 함께 뺌
+    static UInt32 ExpandSkippedSections(UInt32 InSkippedSections)
+    {
+        typedef LoadProgress::SectionType SectionType;
+
+        InSkippedSections &= ~RequiredSectionMask;
+
+        if (InSkippedSections & MemoryReport::GetSectionBit(SectionType::Rigidbodies))
+            InSkippedSections |= MemoryReport::GetSectionBit(SectionType::Joints) | MemoryReport::GetSectionBit(SectionType::SoftBodies);
+
+        if (InSkippedSections & MemoryReport::GetSectionBit(SectionType::Morphs))
+            InSkippedSections |= MemoryReport::GetSectionBit(SectionType::DisplayFrames);
+
+        return InSkippedSections;
+    }
+
+    bool PMXMeshData::ApplyLoadOptions(const LoadOptions& InOptions)
+    {
+        typedef LoadProgress::SectionType SectionType;
+
+        LoadMemory.SkippedSections = ExpandSkippedSections(InOptions.SkipSections);
+
+        if (InOptions.MemoryBudget == 0 || LoadMemory.GetPredictedTotal() <= InOptions.MemoryBudget)
+            return true;
+
+        // 상한을 넘으면 임포트에 덜 중요한 섹션부터 뺌
+        static const SectionType OverBudgetSkipOrder[] = { SectionType::SoftBodies, SectionType::Rigidbodies, SectionType::Morphs };
+
+        if (InOptions.bSkipSectionsOverBudget)
+        {
+            for (const SectionType Section : OverBudgetSkipOrder)
+            {
+                LoadMemory.SkippedSections = ExpandSkippedSections(LoadMemory.SkippedSections | MemoryReport::GetSectionBit(Section));
+
+                if (LoadMemory.GetPredictedTotal() <= InOptions.MemoryBudget)
+                    return true;
+            }
+        }
+
+        LoadMemory.bOverBudget = true;
+        return false;
+    }
+
+    // 저장 버퍼 크기. 찰 때마다 WriteFunction 으로 넘김
+    static constexpr MemSize SaveChunkSize = 64 * 1024;
+
+    /**
+     * PMX 저장용 버퍼
+     * : 처음 실패한 뒤로는 아무것도 쓰지 않고, Finish 가 false 를 반환합니다.
+     */
+    class BinaryWriter
+    {
+    public:
+        BinaryWriter(const PMXMeshData::WriteFunction& InWrite, const Header& InHeader)
+            : Write(InWrite), HeaderData(InHeader)
+        {
+            Buffer.reserve(SaveChunkSize);
+        }
+
+        const Header& GetHeader() const { return HeaderData; }
+
+        void Fail() { bFailed = true; }
+
+        void WriteBuffer(const void* const InSource, const MemSize InSize)
+        {
+            if (bFailed || InSize == 0)
+                return;
+
+            const Byte* Source = static_cast<const Byte*>(InSource);
+
+            // 한 번에 큰 블록이 오면 버퍼를 거치지 않고 바로 넘김
+            if (InSize >= SaveChunkSize)
+            {
+                Flush();
+
+                if (bFailed == false && Write(Source, InSize) == false)
+                    bFailed = true;
+
+                return;
+            }
+
+            if (Buffer.size() + InSize > SaveChunkSize)
+                Flush();
+
+            Buffer.insert(Buffer.end(), Source, Source + InSize);
+        }
+
+        template <class T>
+        void WriteValue(const T& InValue)
+        {
+            WriteBuffer(&InValue, sizeof(T));
+        }
+
+        // 읽을 때와 같은 부호 규칙으로 InIndexSize 바이트에 담기지 않으면 실패
+        void WriteIndex(const int InIndex, const IndexType InIndexType, const UInt8 InIndexSize)
+        {
+            const bool bUnsigned = InIndexType == IndexType::Vertex;
+
+            switch (InIndexSize)
+            {
+                case 1:
+                    if (bUnsigned ? (InIndex < 0 || InIndex > 0xFF) : (InIndex < -0x80 || InIndex > 0x7F))
+                        break;
+
+                    WriteValue(static_cast<Int8>(InIndex));
+                    return;
+
+                case 2:
+                    if (bUnsigned ? (InIndex < 0 || InIndex > 0xFFFF) : (InIndex < -0x8000 || InIndex > 0x7FFF))
+                        break;
+
+                    WriteValue(static_cast<Int16>(InIndex));
+                    return;
+
+                case 4:
+                    WriteValue(InIndex);
+                    return;
+            }
+
+            bFailed = true;
+        }
+
+        // 헤더 인코딩으로 바꿔서 저장. 바이트 수 (int) 뒤에 Null 없는 문자열
+        void WriteText(const Text& InText)
+        {
+            const Byte* Source = nullptr;
+            MemSize SourceSize = 0;
+
+            if (InText.GetEncodingType() == Text::UTF16LE && InText.GetUTF16LE() != nullptr)
+            {
+                Source = reinterpret_cast<const Byte*>(InText.GetUTF16LE());
+                SourceSize = static_cast<MemSize>(InText.GetLength()) * 2;
+            }
+            else if (InText.GetEncodingType() == Text::UTF8 && InText.GetUTF8() != nullptr)
+            {
+                Source = InText.GetUTF8();
+                SourceSize = strlen(Source);
+            }
+
+            if (SourceSize > 0 && InText.GetEncodingType() != HeaderData.TextEncoding)
+            {
+                Converted.clear();
+
+                if (HeaderData.TextEncoding == Text::UTF8)
+                    ConvertUTF16LEToUTF8(Source, SourceSize, Converted);
+                else
+                    ConvertUTF8ToUTF16LE(Source, SourceSize, Converted);
+
+                Source = Converted.data();
+                SourceSize = Converted.size();
+            }
+
+            WriteValue(static_cast<int>(SourceSize));
+            WriteBuffer(Source, SourceSize);
+        }
+
+        bool Finish()
+        {
+            Flush();
+            return bFailed == false;
+        }
+
+    protected:
+        void Flush()
+        {
+            if (bFailed == false && Buffer.empty() == false && Write(Buffer.data(), Buffer.size()) == false)
+                bFailed = true;
+
+            Buffer.clear();
+        }
+
+        static void AppendUTF8(const UInt32 InCodePoint, std::vector<Byte>& OutBytes)
+        {
+            if (InCodePoint < 0x80)
+            {
+                OutBytes.push_back(static_cast<Byte>(InCodePoint));
+            }
+            else if (InCodePoint < 0x800)
+            {
+                OutBytes.push_back(static_cast<Byte>(0xC0 | (InCodePoint >> 6)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | (InCodePoint & 0x3F)));
+            }
+            else if (InCodePoint < 0x10000)
+            {
+                OutBytes.push_back(static_cast<Byte>(0xE0 | (InCodePoint >> 12)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | ((InCodePoint >> 6) & 0x3F)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | (InCodePoint & 0x3F)));
+            }
+            else
+            {
+                OutBytes.push_back(static_cast<Byte>(0xF0 | (InCodePoint >> 18)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | ((InCodePoint >> 12) & 0x3F)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | ((InCodePoint >> 6) & 0x3F)));
+                OutBytes.push_back(static_cast<Byte>(0x80 | (InCodePoint & 0x3F)));
+            }
+        }
+
+        static void AppendUTF16LE(const UInt32 InCodePoint, std::vector<Byte>& OutBytes)
+        {
+            auto AppendUnit = [&OutBytes](const UInt32 InUnit)
+            {
+                OutBytes.push_back(static_cast<Byte>(InUnit & 0xFF));
+                OutBytes.push_back(static_cast<Byte>(InUnit >> 8));
+            };
+
+            if (InCodePoint < 0x10000)
+            {
+                AppendUnit(InCodePoint);
+            }
+            else
+            {
+                AppendUnit(0xD800 + ((InCodePoint - 0x10000) >> 10));
+                AppendUnit(0xDC00 + ((InCodePoint - 0x10000) & 0x3FF));
+            }
+        }
+
+        // 잘못된 서로게이트는 U+FFFD 로 바꿈
+        static void ConvertUTF16LEToUTF8(const Byte* InSource, const MemSize InSize, std::vector<Byte>& OutBytes)
+        {
+            const UByte* Source = reinterpret_cast<const UByte*>(InSource);
+            const MemSize UnitCount = InSize / 2;
+
+            for (MemSize i = 0; i < UnitCount; ++i)
+            {
+                UInt32 CodePoint = Source[i * 2] | (Source[i * 2 + 1] << 8);
+
+                if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && i + 1 < UnitCount)
+                {
+                    const UInt32 Low = Source[i * 2 + 2] | (Source[i * 2 + 3] << 8);
+                    if (Low >= 0xDC00 && Low < 0xE000)
+                    {
+                        CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+                        ++i;
+                    }
+                }
+
+                if (CodePoint >= 0xD800 && CodePoint < 0xE000)
+                    CodePoint = 0xFFFD;
+
+                AppendUTF8(CodePoint, OutBytes);
+            }
+        }
+
+        // 잘못된 바이트열은 U+FFFD 로 바꿈
+        static void ConvertUTF8ToUTF16LE(const Byte* InSource, const MemSize InSize, std::vector<Byte>& OutBytes)
+        {
+            const UByte* Source = reinterpret_cast<const UByte*>(InSource);
+
+            for (MemSize i = 0; i < InSize;)
+            {
+                const UByte Lead = Source[i];
+                const int TrailCount = Lead < 0x80 ? 0 : (Lead >= 0xF0 ? 3 : (Lead >= 0xE0 ? 2 : (Lead >= 0xC0 ? 1 : -1)));
+
+                UInt32 CodePoint = TrailCount == 0 ? Lead : (Lead & (0x3F >> TrailCount));
+                bool bValid = TrailCount >= 0 && i + TrailCount < InSize;
+
+                for (int t = 1; bValid && t <= TrailCount; ++t)
+                {
+                    bValid = (Source[i + t] & 0xC0) == 0x80;
+                    CodePoint = (CodePoint << 6) | (Source[i + t] & 0x3F);
+                }
+
+                if (bValid == false || CodePoint > 0x10FFFF || (CodePoint >= 0xD800 && CodePoint < 0xE000))
+                {
+                    AppendUTF16LE(0xFFFD, OutBytes);
+                    ++i;
+                    continue;
+                }
+
+                AppendUTF16LE(CodePoint, OutBytes);
+                i += TrailCount + 1;
+            }
+        }
+
+    protected:
+        const PMXMeshData::WriteFunction& Write;
+        const Header HeaderData;
+
+        std::vector<Byte> Buffer;
+        std::vector<Byte> Converted;
+
+        bool bFailed = false;
+    };
+
+    bool PMXMeshData::HasVersion21Data() const
+    {
+        if (SoftBodyCount > 0)
+            return true;
+
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            if (ArrayVertex[i].DeformType == VertexData::WeightDeformType::QDEF)
+                return true;
+        }
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            if (ArrayMorph[i].Type == MorphData::MorphType::Flip || ArrayMorph[i].Type == MorphData::MorphType::Impulse)
+                return true;
+        }
+
+        for (int i = 0; i < JointCount; ++i)
+        {
+            if (ArrayJoint[i].Type != JointData::JointType::Spring6DOF)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool PMXMeshData::SaveBinary(const WriteFunction& InWrite, const SaveOptions& InOptions) const
+    {
+        if (!InWrite)
+            return false;
+
+        const bool bVersion21Data = HasVersion21Data();
+
+        float Version = InOptions.Version;
+        if (Version == 0)
+            Version = bVersion21Data ? 2.1f : 2.0f;
+
+        if ((Version != 2.0f && Version != 2.1f) || (Version == 2.0f && bVersion21Data))
+            return false;
+
+        // 삼각형 인덱스 수가 int 에 담겨야 함
+        if (static_cast<long long>(SurfaceCount) * 3 > 0x7FFFFFFF)
+            return false;
+
+        Header SaveHeader = HeaderData;
+        SaveHeader.Signature[0] = 'P';
+        SaveHeader.Signature[1] = 'M';
+        SaveHeader.Signature[2] = 'X';
+        SaveHeader.Signature[3] = ' ';
+        SaveHeader.Version = Version;
+
+        if (InOptions.bKeepTextEncoding == false)
+            SaveHeader.TextEncoding = InOptions.TextEncoding;
+
+        if (SaveHeader.TextEncoding != Text::UTF16LE && SaveHeader.TextEncoding != Text::UTF8)
+            SaveHeader.TextEncoding = Text::UTF16LE;
+
+        if (SaveHeader.AdditionalVectorCount > 4)
+            return false;
+
+        SaveHeader.VertexIndexSize = GetIndexSize(IndexType::Vertex, VertexCount);
+        SaveHeader.TextureIndexSize = GetIndexSize(IndexType::Texture, TextureCount);
+        SaveHeader.MaterialIndexSize = GetIndexSize(IndexType::Material, MaterialCount);
+        SaveHeader.BoneIndexSize = GetIndexSize(IndexType::Bone, BoneCount);
+        SaveHeader.MorphIndexSize = GetIndexSize(IndexType::Morph, MorphCount);
+        SaveHeader.RigidbodyIndexSize = GetIndexSize(IndexType::Rigidbody, RigidbodyCount);
+
+        BinaryWriter Writer(InWrite, SaveHeader);
+
+        WriteHeader(Writer);
+        WriteModelInfo(Writer);
+        WriteVertices(Writer);
+        WriteSurfaces(Writer);
+        WriteTextures(Writer);
+        WriteMaterials(Writer);
+        WriteBones(Writer);
+        WriteMorphs(Writer);
+        WriteDisplayFrames(Writer);
+        WriteRigidbodies(Writer);
+        WriteJoints(Writer);
+
+        if (Version > 2.0f)
+            WriteSoftBodies(Writer);
+
+        return Writer.Finish();
+    }
+
+    bool PMXMeshData::SaveBinary(std::vector<Byte>& OutBuffer, const SaveOptions& InOptions) const
+    {
+        OutBuffer.clear();
+
+        const bool bSaved = SaveBinary([&OutBuffer](const Byte* InData, const MemSize InSize)
+        {
+            OutBuffer.insert(OutBuffer.end(), InData, InData + InSize);
+            return true;
+        }, InOptions);
+
+        if (bSaved == false)
+            OutBuffer.clear();
+
+        return bSaved;
+    }
+
+    void PMXMeshData::WriteHeader(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteBuffer(SaveHeader.Signature, sizeof(SaveHeader.Signature));
+        InOutWriter.WriteValue(SaveHeader.Version);
+
+        // TextEncoding ~ RigidbodyIndexSize
+        const UInt8 Globals[] =
+        {
+            static_cast<UInt8>(SaveHeader.TextEncoding),
+            SaveHeader.AdditionalVectorCount,
+            SaveHeader.VertexIndexSize,
+            SaveHeader.TextureIndexSize,
+            SaveHeader.MaterialIndexSize,
+            SaveHeader.BoneIndexSize,
+            SaveHeader.MorphIndexSize,
+            SaveHeader.RigidbodyIndexSize,
+        };
+
+        InOutWriter.WriteValue(static_cast<Int8>(sizeof(Globals)));
+        InOutWriter.WriteBuffer(Globals, sizeof(Globals));
+    }
+
+    void PMXMeshData::WriteModelInfo(BinaryWriter& InOutWriter) const
+    {
+        InOutWriter.WriteText(ModelInfoData.NameLocal);
+        InOutWriter.WriteText(ModelInfoData.NameUniversal);
+        InOutWriter.WriteText(ModelInfoData.CommentsLocal);
+        InOutWriter.WriteText(ModelInfoData.CommentsUniversal);
+    }
+
+    void PMXMeshData::WriteVertices(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(VertexCount);
+
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            const VertexData& Vertex = ArrayVertex[i];
+
+            if (Vertex.Deform == nullptr)
+            {
+                InOutWriter.Fail();
+                return;
+            }
+
+            InOutWriter.WriteValue(Vertex.Position);
+            InOutWriter.WriteValue(Vertex.Normal);
+            InOutWriter.WriteValue(Vertex.UV);
+            InOutWriter.WriteBuffer(Vertex.Additional, sizeof(Vertex.Additional[0]) * SaveHeader.AdditionalVectorCount);
+            InOutWriter.WriteValue(Vertex.DeformType);
+
+            switch (Vertex.DeformType)
+            {
+                case VertexData::WeightDeformType::BDEF1:
+                    {
+                        const VertexData::BDEF1* BDef1 = static_cast<const VertexData::BDEF1*>(Vertex.Deform);
+
+                        InOutWriter.WriteIndex(BDef1->BoneIndex0, IndexType::Bone, SaveHeader.BoneIndexSize);
+                    }
+                    break;
+                case VertexData::WeightDeformType::BDEF2:
+                    {
+                        const VertexData::BDEF2* BDef2 = static_cast<const VertexData::BDEF2*>(Vertex.Deform);
+
+                        InOutWriter.WriteIndex(BDef2->BoneIndex0, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(BDef2->BoneIndex1, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteValue(BDef2->Weight0);
+                    }
+                    break;
+                case VertexData::WeightDeformType::BDEF4:
+                    {
+                        const VertexData::BDEF4* BDef4 = static_cast<const VertexData::BDEF4*>(Vertex.Deform);
+
+                        InOutWriter.WriteIndex(BDef4->BoneIndex0, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(BDef4->BoneIndex1, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(BDef4->BoneIndex2, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(BDef4->BoneIndex3, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteValue(BDef4->Weight0);
+                        InOutWriter.WriteValue(BDef4->Weight1);
+                        InOutWriter.WriteValue(BDef4->Weight2);
+                        InOutWriter.WriteValue(BDef4->Weight3);
+                    }
+                    break;
+                case VertexData::WeightDeformType::SDEF:
+                    {
+                        const VertexData::SDEF* SDef = static_cast<const VertexData::SDEF*>(Vertex.Deform);
+
+                        InOutWriter.WriteIndex(SDef->BoneIndex0, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(SDef->BoneIndex1, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteValue(SDef->Weight0);
+                        InOutWriter.WriteValue(SDef->C);
+                        InOutWriter.WriteValue(SDef->R0);
+                        InOutWriter.WriteValue(SDef->R1);
+                    }
+                    break;
+                case VertexData::WeightDeformType::QDEF:
+                    {
+                        const VertexData::QDEF* QDef = static_cast<const VertexData::QDEF*>(Vertex.Deform);
+
+                        InOutWriter.WriteIndex(QDef->BoneIndex0, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(QDef->BoneIndex1, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(QDef->BoneIndex2, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteIndex(QDef->BoneIndex3, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        InOutWriter.WriteValue(QDef->Weight0);
+                        InOutWriter.WriteValue(QDef->Weight1);
+                        InOutWriter.WriteValue(QDef->Weight2);
+                        InOutWriter.WriteValue(QDef->Weight3);
+                    }
+                    break;
+                default:
+                    InOutWriter.Fail();
+                    return;
+            }
+
+            InOutWriter.WriteValue(Vertex.EdgeScale);
+        }
+    }
+
+    void PMXMeshData::WriteSurfaces(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(SurfaceCount * 3);
+
+        for (int i = 0; i < SurfaceCount; ++i)
+        {
+            InOutWriter.WriteIndex(ArraySurface[i].VertexIndex[0], IndexType::Vertex, SaveHeader.VertexIndexSize);
+            InOutWriter.WriteIndex(ArraySurface[i].VertexIndex[1], IndexType::Vertex, SaveHeader.VertexIndexSize);
+            InOutWriter.WriteIndex(ArraySurface[i].VertexIndex[2], IndexType::Vertex, SaveHeader.VertexIndexSize);
+        }
+    }
+
+    void PMXMeshData::WriteTextures(BinaryWriter& InOutWriter) const
+    {
+        InOutWriter.WriteValue(TextureCount);
+
+        for (int i = 0; i < TextureCount; ++i)
+        {
+            InOutWriter.WriteText(ArrayTexture[i].Path);
+        }
+    }
+
+    void PMXMeshData::WriteMaterials(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(MaterialCount);
+
+        for (int i = 0; i < MaterialCount; ++i)
+        {
+            const MaterialData& MaterialData = ArrayMaterial[i];
+
+            InOutWriter.WriteText(MaterialData.NameLocal);
+            InOutWriter.WriteText(MaterialData.NameUniversal);
+            InOutWriter.WriteValue(MaterialData.DiffuseColor);
+            InOutWriter.WriteValue(MaterialData.SpecularColor);
+            InOutWriter.WriteValue(MaterialData.SpecularStrength);
+            InOutWriter.WriteValue(MaterialData.AmbientColor);
+            InOutWriter.WriteValue(MaterialData.DrawingFlags);
+            InOutWriter.WriteValue(MaterialData.EdgeColor);
+            InOutWriter.WriteValue(MaterialData.EdgeScale);
+            InOutWriter.WriteIndex(MaterialData.TextureIndex, IndexType::Texture, SaveHeader.TextureIndexSize);
+            InOutWriter.WriteIndex(MaterialData.EnvironmentTextureIndex, IndexType::Texture, SaveHeader.TextureIndexSize);
+            InOutWriter.WriteValue(MaterialData.EnvironmentBlendMode);
+            InOutWriter.WriteValue(MaterialData.ToonReference);
+
+            if (MaterialData.ToonReference == MaterialData::ToonReferenceType::Internal)
+                InOutWriter.WriteValue(static_cast<UInt8>(MaterialData.ToonValue));
+            else
+                InOutWriter.WriteIndex(MaterialData.ToonValue, IndexType::Texture, SaveHeader.TextureIndexSize);
+
+            InOutWriter.WriteText(MaterialData.MetaData);
+            InOutWriter.WriteValue(MaterialData.SurfaceCount);
+        }
+    }
+
+    void PMXMeshData::WriteBones(BinaryWriter& InOutWriter) const
+    {
+        const UInt8 BoneIndexSize = InOutWriter.GetHeader().BoneIndexSize;
+
+        InOutWriter.WriteValue(BoneCount);
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const BoneData& BoneData = ArrayBone[i];
+
+            InOutWriter.WriteText(BoneData.NameLocal);
+            InOutWriter.WriteText(BoneData.NameUniversal);
+            InOutWriter.WriteValue(BoneData.Position);
+            InOutWriter.WriteIndex(BoneData.ParentBoneIndex, IndexType::Bone, BoneIndexSize);
+            InOutWriter.WriteValue(BoneData.Layer);
+            InOutWriter.WriteValue(BoneData.Flags);
+
+            if (BoneData.Flags & (BoneData::Flag::IndexedTailPosition))
+                InOutWriter.WriteIndex(BoneData.TailPositionData.BoneIndex, IndexType::Bone, BoneIndexSize);
+            else
+                InOutWriter.WriteValue(BoneData.TailPositionData.Vector3);
+
+            // 플래그에 딸린 데이터가 없으면 저장할 수 없음
+            if (((BoneData.Flags & (BoneData::Flag::InheritRotation | BoneData::Flag::InheritTranslation)) && BoneData.InheritBoneData == nullptr) ||
+                ((BoneData.Flags & BoneData::Flag::FixedAxis) && BoneData.FixedAxisData == nullptr) ||
+                ((BoneData.Flags & BoneData::Flag::LocalCoordinate) && BoneData.LocalCoordinateData == nullptr) ||
+                ((BoneData.Flags & BoneData::Flag::ExternalParentDeform) && BoneData.ExternalParentData == nullptr))
+            {
+                InOutWriter.Fail();
+                return;
+            }
+
+            if (BoneData.Flags & (BoneData::Flag::InheritRotation | BoneData::Flag::InheritTranslation))
+            {
+                InOutWriter.WriteIndex(BoneData.InheritBoneData->ParentBoneIndex, IndexType::Bone, BoneIndexSize);
+                InOutWriter.WriteValue(BoneData.InheritBoneData->ParentInfluence);
+            }
+
+            if (BoneData.Flags & (BoneData::Flag::FixedAxis))
+            {
+                InOutWriter.WriteValue(BoneData.FixedAxisData->AxisDirection);
+            }
+
+            if (BoneData.Flags & (BoneData::Flag::LocalCoordinate))
+            {
+                InOutWriter.WriteValue(BoneData.LocalCoordinateData->XVector);
+                InOutWriter.WriteValue(BoneData.LocalCoordinateData->ZVector);
+            }
+
+            if (BoneData.Flags & (BoneData::Flag::ExternalParentDeform))
+            {
+                InOutWriter.WriteIndex(BoneData.ExternalParentData->ParentBoneIndex, IndexType::Bone, BoneIndexSize);
+            }
+
+            if (BoneData.Flags & (BoneData::Flag::UseIK))
+            {
+                const int LinkCount = BoneData.IKData.ArrayLink != nullptr ? BoneData.IKData.LinkCount : 0;
+
+                InOutWriter.WriteIndex(BoneData.IKData.TargetIndex, IndexType::Bone, BoneIndexSize);
+                InOutWriter.WriteValue(BoneData.IKData.LoopCount);
+                InOutWriter.WriteValue(BoneData.IKData.LimitRadian);
+                InOutWriter.WriteValue(LinkCount);
+
+                for (int j = 0; j < LinkCount; ++j)
+                {
+                    const auto& LinkData = BoneData.IKData.ArrayLink[j];
+
+                    InOutWriter.WriteIndex(LinkData.BoneIndex, IndexType::Bone, BoneIndexSize);
+                    InOutWriter.WriteValue(LinkData.HasLimit);
+
+                    if (LinkData.HasLimit != 0)
+                    {
+                        InOutWriter.WriteValue(LinkData.LimitData.Min);
+                        InOutWriter.WriteValue(LinkData.LimitData.Max);
+                    }
+                }
+            }
+        }
+    }
+
+    void PMXMeshData::WriteMorphs(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(MorphCount);
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            const MorphData& MorphData = ArrayMorph[i];
+            const int OffsetCount = MorphData.ArrayOffset != nullptr ? MorphData.OffsetCount : 0;
+
+            InOutWriter.WriteText(MorphData.NameLocal);
+            InOutWriter.WriteText(MorphData.NameUniversal);
+            InOutWriter.WriteValue(MorphData.PanelType);
+            InOutWriter.WriteValue(MorphData.Type);
+            InOutWriter.WriteValue(OffsetCount);
+
+            for (int j = 0; j < OffsetCount; ++j)
+            {
+                switch (MorphData.Type)
+                {
+                    case MorphData::MorphType::Group:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetGroup*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.MorphIndex, IndexType::Morph, SaveHeader.MorphIndexSize);
+                            InOutWriter.WriteValue(OffsetData.Rate);
+                        }
+                        break;
+                    case MorphData::MorphType::Vertex:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetVertex*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.VertexIndex, IndexType::Vertex, SaveHeader.VertexIndexSize);
+                            InOutWriter.WriteValue(OffsetData.PositionOffset);
+                        }
+                        break;
+                    case MorphData::MorphType::Bone:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetBone*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.BoneIndex, IndexType::Bone, SaveHeader.BoneIndexSize);
+                            InOutWriter.WriteValue(OffsetData.MoveValue);
+                            InOutWriter.WriteValue(OffsetData.RotationValue);
+                        }
+                        break;
+                    case MorphData::MorphType::UV:
+                    case MorphData::MorphType::AdditionalUV1:
+                    case MorphData::MorphType::AdditionalUV2:
+                    case MorphData::MorphType::AdditionalUV3:
+                    case MorphData::MorphType::AdditionalUV4:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetUV*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.VertexIndex, IndexType::Vertex, SaveHeader.VertexIndexSize);
+                            InOutWriter.WriteValue(OffsetData.UVOffset);
+                        }
+                        break;
+                    case MorphData::MorphType::Material:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetMaterial*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.MaterialIndex, IndexType::Material, SaveHeader.MaterialIndexSize);
+                            InOutWriter.WriteValue(OffsetData.OffsetMethod);
+                            InOutWriter.WriteValue(OffsetData.DiffuseColor);
+                            InOutWriter.WriteValue(OffsetData.SpecularColor);
+                            InOutWriter.WriteValue(OffsetData.Specularity);
+                            InOutWriter.WriteValue(OffsetData.AmbientColor);
+                            InOutWriter.WriteValue(OffsetData.EdgeColor);
+                            InOutWriter.WriteValue(OffsetData.EdgeSize);
+                            InOutWriter.WriteValue(OffsetData.TextureTint);
+                            InOutWriter.WriteValue(OffsetData.EnvironmentTint);
+                            InOutWriter.WriteValue(OffsetData.ToonTint);
+                        }
+                        break;
+                    case MorphData::MorphType::Flip:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetFlip*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.MorphIndex, IndexType::Morph, SaveHeader.MorphIndexSize);
+                            InOutWriter.WriteValue(OffsetData.Influence);
+                        }
+                        break;
+                    case MorphData::MorphType::Impulse:
+                        {
+                            const auto& OffsetData = static_cast<const MorphData::OffsetImpulse*>(MorphData.ArrayOffset)[j];
+
+                            InOutWriter.WriteIndex(OffsetData.RigidbodyIndex, IndexType::Rigidbody, SaveHeader.RigidbodyIndexSize);
+                            InOutWriter.WriteValue(OffsetData.LocalFlag);
+                            InOutWriter.WriteValue(OffsetData.MovementSpeed);
+                            InOutWriter.WriteValue(OffsetData.RotationTorque);
+                        }
+                        break;
+                    default:
+                        InOutWriter.Fail();
+                        return;
+                }
+            }
+        }
+    }
+
+    void PMXMeshData::WriteDisplayFrames(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(DisplayFrameCount);
+
+        for (int i = 0; i < DisplayFrameCount; ++i)
+        {
+            const DisplayFrameData& DisplayFrameData = ArrayDisplayFrame[i];
+            const int FrameCount = DisplayFrameData.ArrayFrame != nullptr ? DisplayFrameData.FrameCount : 0;
+
+            InOutWriter.WriteText(DisplayFrameData.NameLocal);
+            InOutWriter.WriteText(DisplayFrameData.NameUniversal);
+            InOutWriter.WriteValue(DisplayFrameData.SpecialFlag);
+            InOutWriter.WriteValue(FrameCount);
+
+            for (int j = 0; j < FrameCount; ++j)
+            {
+                const DisplayFrameData::Frame& FrameData = DisplayFrameData.ArrayFrame[j];
+
+                InOutWriter.WriteValue(FrameData.Type);
+
+                switch (FrameData.Type)
+                {
+                    case DisplayFrameData::Frame::FrameType::Bone:
+                        InOutWriter.WriteIndex(FrameData.Index, IndexType::Bone, SaveHeader.BoneIndexSize);
+                        break;
+
+                    case DisplayFrameData::Frame::FrameType::Morph:
+                        InOutWriter.WriteIndex(FrameData.Index, IndexType::Morph, SaveHeader.MorphIndexSize);
+                        break;
+
+                    default:
+                        InOutWriter.Fail();
+                        return;
+                }
+            }
+        }
+    }
+
+    void PMXMeshData::WriteRigidbodies(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(RigidbodyCount);
+
+        for (int i = 0; i < RigidbodyCount; ++i)
+        {
+            const RigidbodyData& RigidbodyData = ArrayRigidbody[i];
+
+            InOutWriter.WriteText(RigidbodyData.NameLocal);
+            InOutWriter.WriteText(RigidbodyData.NameUniversal);
+
+            InOutWriter.WriteIndex(RigidbodyData.BoneIndexRelated, IndexType::Bone, SaveHeader.BoneIndexSize);
+
+            InOutWriter.WriteValue(RigidbodyData.GroupID);
+            InOutWriter.WriteValue(RigidbodyData.NonCollisionGroupMask);
+
+            InOutWriter.WriteValue(RigidbodyData.ShapeType);
+            InOutWriter.WriteValue(RigidbodyData.ShapeSize);
+            InOutWriter.WriteValue(RigidbodyData.ShapePosition);
+            InOutWriter.WriteValue(RigidbodyData.ShapeRotation);
+
+            InOutWriter.WriteValue(RigidbodyData.Mass);
+            InOutWriter.WriteValue(RigidbodyData.MoveAttenuation);
+            InOutWriter.WriteValue(RigidbodyData.RotationDamping);
+            InOutWriter.WriteValue(RigidbodyData.Repulsion);
+            InOutWriter.WriteValue(RigidbodyData.FrictionForce);
+            InOutWriter.WriteValue(RigidbodyData.PhysicsMode);
+        }
+    }
+
+    void PMXMeshData::WriteJoints(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(JointCount);
+
+        for (int i = 0; i < JointCount; ++i)
+        {
+            const JointData& JointData = ArrayJoint[i];
+
+            InOutWriter.WriteText(JointData.NameLocal);
+            InOutWriter.WriteText(JointData.NameUniversal);
+
+            InOutWriter.WriteValue(JointData.Type);
+            InOutWriter.WriteIndex(JointData.RigidbodyIndexA, IndexType::Rigidbody, SaveHeader.RigidbodyIndexSize);
+            InOutWriter.WriteIndex(JointData.RigidbodyIndexB, IndexType::Rigidbody, SaveHeader.RigidbodyIndexSize);
+            InOutWriter.WriteValue(JointData.Position);
+            InOutWriter.WriteValue(JointData.Rotation);
+            InOutWriter.WriteValue(JointData.PositionMin);
+            InOutWriter.WriteValue(JointData.PositionMax);
+            InOutWriter.WriteValue(JointData.RotationMin);
+            InOutWriter.WriteValue(JointData.RotationMax);
+            InOutWriter.WriteValue(JointData.PositionSpring);
+            InOutWriter.WriteValue(JointData.RotationSpring);
+        }
+    }
+
+    void PMXMeshData::WriteSoftBodies(BinaryWriter& InOutWriter) const
+    {
+        const Header& SaveHeader = InOutWriter.GetHeader();
+
+        InOutWriter.WriteValue(SoftBodyCount);
+
+        for (int i = 0; i < SoftBodyCount; ++i)
+        {
+            const SoftBodyData& SoftBodyData = ArraySoftBody[i];
+            const int AnchorRigidbodyCount = SoftBodyData.ArrayAnchorRigidbody != nullptr ? SoftBodyData.AnchorRigidbodyCount : 0;
+            const int VertexPinCount = SoftBodyData.ArrayVertexPin != nullptr ? SoftBodyData.VertexPinCount : 0;
+
+            InOutWriter.WriteText(SoftBodyData.NameLocal);
+            InOutWriter.WriteText(SoftBodyData.NameUniversal);
+            InOutWriter.WriteValue(SoftBodyData.Shape);
+            InOutWriter.WriteIndex(SoftBodyData.MaterialIndex, IndexType::Material, SaveHeader.MaterialIndexSize);
+            InOutWriter.WriteValue(SoftBodyData.Group);
+            InOutWriter.WriteValue(SoftBodyData.NonCollisionGroupMask);
+            InOutWriter.WriteValue(SoftBodyData.Flags);
+            InOutWriter.WriteValue(SoftBodyData.B_LinkCreateDistance);
+            InOutWriter.WriteValue(SoftBodyData.NumberOfClusters);
+            InOutWriter.WriteValue(SoftBodyData.TotalMass);
+            InOutWriter.WriteValue(SoftBodyData.CollisionMargin);
+            InOutWriter.WriteValue(SoftBodyData.AerodynamicsModel);
+            InOutWriter.WriteValue(SoftBodyData.ConfigVCF);
+            InOutWriter.WriteValue(SoftBodyData.ConfigDP);
+            InOutWriter.WriteValue(SoftBodyData.ConfigDG);
+            InOutWriter.WriteValue(SoftBodyData.ConfigLF);
+            InOutWriter.WriteValue(SoftBodyData.ConfigPR);
+            InOutWriter.WriteValue(SoftBodyData.ConfigVC);
+            InOutWriter.WriteValue(SoftBodyData.ConfigDF);
+            InOutWriter.WriteValue(SoftBodyData.ConfigMT);
+            InOutWriter.WriteValue(SoftBodyData.ConfigCHR);
+            InOutWriter.WriteValue(SoftBodyData.ConfigKHR);
+            InOutWriter.WriteValue(SoftBodyData.ConfigSHR);
+            InOutWriter.WriteValue(SoftBodyData.ConfigAHR);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSRHR_CL);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSKHR_CL);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSSHR_CL);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSR_SPLT_CL);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSK_SPLT_CL);
+            InOutWriter.WriteValue(SoftBodyData.ClusterSS_SPLT_CL);
+            InOutWriter.WriteValue(SoftBodyData.InterationV_IT);
+            InOutWriter.WriteValue(SoftBodyData.InterationP_IT);
+            InOutWriter.WriteValue(SoftBodyData.InterationD_IT);
+            InOutWriter.WriteValue(SoftBodyData.InterationC_IT);
+            InOutWriter.WriteValue(SoftBodyData.MaterialLST);
+            InOutWriter.WriteValue(SoftBodyData.MaterialAST);
+            InOutWriter.WriteValue(SoftBodyData.MaterialVST);
+
+            InOutWriter.WriteValue(AnchorRigidbodyCount);
+
+            for (int j = 0; j < AnchorRigidbodyCount; ++j)
+            {
+                const SoftBodyData::AnchorRigidbody& Anchor = SoftBodyData.ArrayAnchorRigidbody[j];
+
+                InOutWriter.WriteIndex(Anchor.RigidbodyIndex, IndexType::Rigidbody, SaveHeader.RigidbodyIndexSize);
+                InOutWriter.WriteIndex(Anchor.VertexIndex, IndexType::Vertex, SaveHeader.VertexIndexSize);
+                InOutWriter.WriteValue(Anchor.NearMode);
+            }
+
+            InOutWriter.WriteValue(VertexPinCount);
+
+            for (int j = 0; j < VertexPinCount; ++j)
+            {
+                InOutWriter.WriteIndex(SoftBodyData.ArrayVertexPin[j].VertexIndex, IndexType::Vertex, SaveHeader.VertexIndexSize);
+            }
         }
     }
 }
@@ -1,24 +1,223 @@
 ﻿#pragma once
 
 #include "PMXTypes.h"
+#include "PMXTrace.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
 
 namespace PMX
 {
+    class PMXMeshData;
+    class BinaryWriter;
+    struct StressModelOptions;
+
+    // 개수가 InCount 인 배열을 가리키는 인덱스를 담을 수 있는 가장 작은 크기 (1 / 2 / 4)
+    // : 정점 인덱스는 부호 없음, 나머지는 -1 을 담아야 하므로 부호 있음
+    UInt8 GetIndexSize(const IndexType InIndexType, const int InCount);
+
+    /**
+     * 파싱 진행 상황과 취소 요청
+     * : 다른 스레드에서 읽고 쓸 수 있습니다. 섹션 사이와 정점/삼각형/모프 묶음 사이에서 갱신되고 취소 요청을 확인합니다.
+     */
+    struct LoadProgress
+    {
+        enum class SectionType : UInt8
+        {
+            Header,
+            ModelInfo,
+            Vertices,
+            Surfaces,
+            Textures,
+            Materials,
+            Bones,
+            Morphs,
+            DisplayFrames,
+            Rigidbodies,
+            Joints,
+            SoftBodies,
+
+            Count
+        };
+
+        std::atomic<SectionType> Section { SectionType::Header };
+
+        // 현재 섹션에서 읽은 항목 수 / 전체 항목 수
+        std::atomic<int> ItemsRead { 0 };
+        std::atomic<int> ItemCount { 0 };
+
+        // 지금까지 읽은 바이트 수. 섹션이 끝날 때마다 갱신
+        std::atomic<MemSize> BytesRead { 0 };
+
+        // true 로 바꾸면 다음 확인 지점에서 파싱을 멈추고 LoadBinary 가 false 를 반환
+        std::atomic<bool> bCancelRequested { false };
+
+        // 섹션을 다 읽을 때마다 파싱 스레드에서 호출. 읽은 섹션까지만 접근해야 합니다.
+        // : 예) Textures 직후 텍스처 읽기를 시작해 나머지 파싱과 겹치게 함
+        std::function<void(SectionType, const PMXMeshData&)> OnSectionLoaded;
+
+        // 있으면 섹션마다 시간, 읽은 바이트, 항목 수를 기록 (PMX_ENABLE_TRACE 가 0 이면 기록 안 함)
+        LoadStats* Stats = nullptr;
+
+        static const char* GetSectionName(const SectionType InSection);
+    };
+
+    /**
+     * 섹션별 메모리 사용량 (바이트)
+     * : new 로 요청한 크기의 합입니다. new[] 가 앞에 붙이는 개수 저장 공간은 포함하고, 할당기 오버헤드와 원본 파일 버퍼는 뺍니다.
+     *   예상값은 파일을 한 번 훑어 항목 수와 가변 길이 항목 (텍스트, 정점 변형, IK 링크, 모프 오프셋 등) 으로 계산하며 아무것도 할당하지 않습니다.
+     */
+    struct MemoryReport
+    {
+        static constexpr int SectionCount = static_cast<int>(LoadProgress::SectionType::Count);
+
+        // 파일 안의 섹션 구간 [Begin, End)
+        MemSize SectionBegin[SectionCount] = { 0, };
+        MemSize SectionEnd[SectionCount] = { 0, };
+
+        MemSize PredictedBytes[SectionCount] = { 0, };
+
+        // 읽은 뒤의 사용량. 읽지 않은 섹션은 0
+        MemSize ActualBytes[SectionCount] = { 0, };
+
+        // 읽지 않은 섹션 (GetSectionBit 조합)
+        UInt32 SkippedSections = 0;
+
+        bool bPredicted = false;
+
+        // 섹션을 빼도 상한을 넘어서 읽지 않았음
+        bool bOverBudget = false;
+
+        static UInt32 GetSectionBit(const LoadProgress::SectionType InSection) { return 1u << static_cast<UInt32>(InSection); }
+
+        bool IsSkipped(const LoadProgress::SectionType InSection) const { return (SkippedSections & GetSectionBit(InSection)) != 0; }
+
+        // 읽지 않은 섹션은 빼고 합산
+        MemSize GetPredictedTotal() const;
+        MemSize GetActualTotal() const;
+    };
+
+    struct LoadOptions
+    {
+        // 예상 메모리 상한 (바이트). 0 이면 제한 없음
+        // : 상한이나 SkipSections 가 있으면 할당하기 전에 파일을 한 번 훑어 섹션별 사용량을 예상합니다.
+        //   형식이 깨진 파일도 이 단계에서 걸러지므로 잘못된 개수로 큰 배열을 잡지 않습니다.
+        MemSize MemoryBudget = 0;
+
+        // 예상이 상한을 넘으면 소프트 바디 -> 물리 (강체, 조인트) -> 모프 (표시 프레임 포함) 순서로 빼서 맞춤
+        // : false 거나 다 빼도 넘으면 아무것도 할당하지 않고 실패하며 MemoryReport::bOverBudget 이 true 입니다.
+        bool bSkipSectionsOverBudget = true;
+
+        // 처음부터 읽지 않을 섹션 (MemoryReport::GetSectionBit 조합)
+        // : 헤더 ~ 본은 필수라서 무시합니다. 강체를 빼면 조인트, 소프트 바디도, 모프를 빼면 표시 프레임도 뺍니다.
+        UInt32 SkipSections = 0;
+    };
+
+    struct SaveOptions
+    {
+        // 2.0 / 2.1. 0 이면 2.1 전용 데이터 (소프트 바디, QDEF, 플립/임펄스 모프, 2.1 조인트) 가 있을 때만 2.1
+        // : 2.0 을 지정했는데 2.1 전용 데이터가 있으면 저장하지 않습니다.
+        float Version = 0;
+
+        // false 면 TextEncoding 으로 바꿔서 저장
+        bool bKeepTextEncoding = true;
+        Text::EncodingType TextEncoding = Text::EncodingType::UTF16LE;
+    };
+
     /**
      * PMX Mesh Data
      */
     class PMXMeshData
     {
+        friend bool GenerateStressModel(const StressModelOptions& InOptions, PMXMeshData& OutMeshData);
+
+    public:
+        // 저장할 바이트를 순서대로 받음. false 를 반환하면 저장을 멈춤
+        typedef std::function<bool(const Byte* InData, const MemSize InSize)> WriteFunction;
+
     public:
         ~PMXMeshData();
 
-        bool LoadBinary(const Byte* const InBuffer, const PMX::MemSize InBufferSize);
+        bool LoadBinary(const Byte* const InBuffer, const PMX::MemSize InBufferSize, LoadProgress* InOutProgress = nullptr, const LoadOptions& InOptions = LoadOptions());
         void Delete();
 
+        // 할당 없이 섹션별 구간과 예상 사용량 계산. 형식이 깨졌거나 버퍼 끝과 맞지 않으면 false
+        static bool PredictMemory(const Byte* const InBuffer, const PMX::MemSize InBufferSize, MemoryReport& OutReport);
+
+        // 지금 들고 있는 섹션 데이터의 사용량. 예상값과 같은 기준
+        MemSize GetSectionMemory(const LoadProgress::SectionType InSection) const;
+
+        // 마지막 LoadBinary 의 예상 / 실제 사용량. 상한이나 SkipSections 없이 읽었으면 bPredicted 가 false
+        const MemoryReport& GetMemoryReport() const { return LoadMemory; }
+
+        // PMX 로 저장. 인덱스 크기는 항목 수에 맞는 가장 작은 크기를 씁니다.
+        // : 일정 크기씩 InWrite 로 넘기므로 전체를 메모리에 만들지 않고 파일에 바로 쓸 수 있습니다.
+        //   인덱스가 그 크기에 담기지 않거나 변형 정보가 없는 정점이 있으면 실패합니다.
+        bool SaveBinary(const WriteFunction& InWrite, const SaveOptions& InOptions = SaveOptions()) const;
+        bool SaveBinary(std::vector<Byte>& OutBuffer, const SaveOptions& InOptions = SaveOptions()) const;
+
+        const Header& GetHeader() const { return HeaderData; }
+        const ModelInfo& GetModelInfo() const { return ModelInfoData; }
+
+        int GetVertexCount() const { return VertexCount; }
+        const VertexData* GetVertices() const { return ArrayVertex; }
+
+        // 정점 속성 수정용. 정점 수와 순서는 RemapVertices 로만 바꿔야 합니다.
+        VertexData* GetVertices() { return ArrayVertex; }
+
+        int GetSurfaceCount() const { return SurfaceCount; }
+        const SurfaceData* GetSurfaces() const { return ArraySurface; }
+
+        // 삼각형 순서 변경용. 재질별 구간을 벗어나 옮기면 안 됩니다.
+        SurfaceData* GetSurfaces() { return ArraySurface; }
+
+        int GetTextureCount() const { return TextureCount; }
+        const TextureData* GetTextures() const { return ArrayTexture; }
+
+        int GetMaterialCount() const { return MaterialCount; }
+        const MaterialData* GetMaterials() const { return ArrayMaterial; }
+
+        int GetBoneCount() const { return BoneCount; }
+        const BoneData* GetBones() const { return ArrayBone; }
+
+        int GetMorphCount() const { return MorphCount; }
+        const MorphData* GetMorphs() const { return ArrayMorph; }
+
+        int GetRigidbodyCount() const { return RigidbodyCount; }
+        const RigidbodyData* GetRigidbodies() const { return ArrayRigidbody; }
+
+        int GetJointCount() const { return JointCount; }
+        const JointData* GetJoints() const { return ArrayJoint; }
+
+        int GetDisplayFrameCount() const { return DisplayFrameCount; }
+        const DisplayFrameData* GetDisplayFrames() const { return ArrayDisplayFrame; }
+
+        int GetSoftBodyCount() const { return SoftBodyCount; }
+        const SoftBodyData* GetSoftBodies() const { return ArraySoftBody; }
+
+        // 정점 번호 재배치. InOldToNew[이전 번호] = 새 번호 (-1 이면 제거)
+        // : 여러 정점이 같은 새 번호로 합쳐지면 가장 앞 정점의 데이터를 사용합니다.
+        //   삼각형, 정점/UV 모프, 소프트 바디 정점 참조를 함께 바꾸며, 제거된 정점을 쓰는 삼각형이 있으면 실패합니다.
+        bool RemapVertices(const int* InOldToNew, const int InNewVertexCount);
+
     protected:
         void ReadText(Text* OutString, const Byte*& InOutBufferCursor);
 
-        bool IsValidPMXFile(const Header& Header);
+        // 상한과 SkipSections 로 읽지 않을 섹션을 정함. 맞출 수 없으면 false
+        bool ApplyLoadOptions(const LoadOptions& InOptions);
+
+        // 섹션 시작. 취소 요청이 있으면 false
+        // : 읽지 않기로 한 섹션은 건너뜀
+        bool BeginSection(const LoadProgress::SectionType InSection, void (PMXMeshData::*InReadFunction)(const Byte*&), const Byte*& InOutBufferCursor);
+
+        // 섹션의 항목 수 (정점 수, 삼각형 수 등). 측정 기록용
+        int GetSectionItemCount(const LoadProgress::SectionType InSection) const;
+
+        // 묶음 단위 진행 보고. 취소 요청이 있으면 false
+        bool ReportProgress(const int InItemsRead, const int InItemCount);
+
+        static bool IsValidPMXFile(const Header& Header);
 
         void ReadHeader(const Byte*& InOutBufferCursor);
         void ReadModelInfo(const Byte*& InOutBufferCursor);
@@ -33,7 +232,29 @@ namespace PMX
         void ReadJoints(const Byte*& InOutBufferCursor);
         void ReadSoftBodies(const Byte*& InOutBufferCursor);
 
+        // 2.1 에만 있는 데이터가 있는지
+        bool HasVersion21Data() const;
+
+        void WriteHeader(BinaryWriter& InOutWriter) const;
+        void WriteModelInfo(BinaryWriter& InOutWriter) const;
+        void WriteVertices(BinaryWriter& InOutWriter) const;
+        void WriteSurfaces(BinaryWriter& InOutWriter) const;
+        void WriteTextures(BinaryWriter& InOutWriter) const;
+        void WriteMaterials(BinaryWriter& InOutWriter) const;
+        void WriteBones(BinaryWriter& InOutWriter) const;
+        void WriteMorphs(BinaryWriter& InOutWriter) const;
+        void WriteDisplayFrames(BinaryWriter& InOutWriter) const;
+        void WriteRigidbodies(BinaryWriter& InOutWriter) const;
+        void WriteJoints(BinaryWriter& InOutWriter) const;
+        void WriteSoftBodies(BinaryWriter& InOutWriter) const;
+
     protected:
+        // LoadBinary 중에만 유효
+        LoadProgress* Progress = nullptr;
+        const Byte* LoadBuffer = nullptr;
+
+        MemoryReport LoadMemory;
+
         Header HeaderData = { 0, };
 
         ModelInfo ModelInfoData;
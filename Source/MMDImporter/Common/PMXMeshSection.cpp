@@ -0,0 +1,147 @@
+﻿#include "PMXMeshSection.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace PMX
+{
+    MeshSectionBuilder::~MeshSectionBuilder()
+    {
+        Delete();
+    }
+
+    bool MeshSectionBuilder::Build(const PMXMeshData& InMeshData)
+    {
+        Delete();
+
+        const int VertexCount = InMeshData.GetVertexCount();
+        const int SurfaceCount = InMeshData.GetSurfaceCount();
+        const int MaterialCount = InMeshData.GetMaterialCount();
+        const SurfaceData* Surfaces = InMeshData.GetSurfaces();
+        const MaterialData* Materials = InMeshData.GetMaterials();
+
+        if (VertexCount <= 0 || SurfaceCount <= 0 || MaterialCount <= 0 || Surfaces == nullptr || Materials == nullptr)
+        {
+            Error = ErrorType::NoGeometry;
+            return false;
+        }
+
+        // 재질 SurfaceCount(인덱스 수)의 누적 합으로 각 섹션의 시작 위치 결정
+        SectionCount = MaterialCount;
+        ArraySection = new Section[SectionCount];
+
+        long long IndexOffset = 0;
+        for (int m = 0; m < MaterialCount; ++m)
+        {
+            const int MaterialIndexCount = Materials[m].SurfaceCount;
+            if (MaterialIndexCount < 0 || MaterialIndexCount % 3 != 0)
+            {
+                Delete();
+                Error = ErrorType::SurfaceCountNotMultipleOfThree;
+                return false;
+            }
+
+            Section& CurSection = ArraySection[m];
+            CurSection.MaterialIndex = m;
+            CurSection.FirstSurface = static_cast<int>(IndexOffset / 3);
+            CurSection.TriangleCount = MaterialIndexCount / 3;
+            CurSection.IndexBegin = static_cast<int>(IndexOffset);
+
+            IndexOffset += MaterialIndexCount;
+        }
+
+        if (IndexOffset != static_cast<long long>(SurfaceCount) * 3)
+        {
+            Delete();
+            Error = ErrorType::SurfaceCountMismatch;
+            return false;
+        }
+
+        IndexCount = static_cast<int>(IndexOffset);
+        ArrayIndex = new int[IndexCount];
+
+        // 재질별로 병렬 압축. 정점 번호 테이블은 작업 단위마다 하나만 두고 섹션 번호로 구분해 다시 비우지 않음
+        std::vector<std::vector<int>> SectionVertices(SectionCount);
+        std::atomic<bool> bOutOfRange(false);
+
+        const int BatchSize = std::max(1, SectionCount / (GetWorkerCount() * 4));
+
+        ParallelFor(SectionCount, BatchSize, [&](const int Begin, const int End)
+        {
+            std::vector<int> Stamp(VertexCount, -1);
+            std::vector<int> LocalIndex(VertexCount);
+
+            for (int s = Begin; s < End; ++s)
+            {
+                const Section& CurSection = ArraySection[s];
+                std::vector<int>& Vertices = SectionVertices[s];
+                int* Indices = ArrayIndex + CurSection.IndexBegin;
+
+                for (int t = 0; t < CurSection.TriangleCount; ++t)
+                {
+                    const SurfaceData& Surface = Surfaces[CurSection.FirstSurface + t];
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        const int VertexIndex = Surface.VertexIndex[k];
+                        if (VertexIndex < 0 || VertexIndex >= VertexCount)
+                        {
+                            bOutOfRange = true;
+                            Indices[t * 3 + k] = 0;
+                            continue;
+                        }
+
+                        if (Stamp[VertexIndex] != s)
+                        {
+                            Stamp[VertexIndex] = s;
+                            LocalIndex[VertexIndex] = static_cast<int>(Vertices.size());
+                            Vertices.push_back(VertexIndex);
+                        }
+
+                        Indices[t * 3 + k] = LocalIndex[VertexIndex];
+                    }
+                }
+            }
+        });
+
+        if (bOutOfRange)
+        {
+            Delete();
+            Error = ErrorType::VertexIndexOutOfRange;
+            return false;
+        }
+
+        for (int s = 0; s < SectionCount; ++s)
+        {
+            ArraySection[s].VertexBegin = VertexIndexCount;
+            ArraySection[s].VertexCount = static_cast<int>(SectionVertices[s].size());
+            VertexIndexCount += ArraySection[s].VertexCount;
+        }
+
+        ArrayVertexIndex = VertexIndexCount > 0 ? new int[VertexIndexCount] : nullptr;
+
+        ParallelFor(SectionCount, BatchSize, [&](const int Begin, const int End)
+        {
+            for (int s = Begin; s < End; ++s)
+                std::copy(SectionVertices[s].begin(), SectionVertices[s].end(), ArrayVertexIndex + ArraySection[s].VertexBegin);
+        });
+
+        return true;
+    }
+
+    void MeshSectionBuilder::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArraySection);
+        SectionCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayVertexIndex);
+        VertexIndexCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayIndex);
+        IndexCount = 0;
+
+        Error = ErrorType::None;
+    }
+}
@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    /**
+     * 재질별 메시 섹션
+     * : MaterialData::SurfaceCount 로 나뉜 ArraySurface 의 연속 구간을 엔진에서 바로 쓸 수 있는 형태로 정리합니다.
+     *   섹션마다 사용하는 정점만 처음 사용된 순서로 모으고, 인덱스는 그 목록 기준으로 다시 매깁니다.
+     */
+    class MeshSectionBuilder
+    {
+    public:
+        enum class ErrorType : UInt8
+        {
+            None,
+            NoGeometry,
+            SurfaceCountNotMultipleOfThree, // 재질의 SurfaceCount 가 3의 배수가 아님
+            SurfaceCountMismatch,           // 재질 SurfaceCount 의 합이 전체 인덱스 수와 다름
+            VertexIndexOutOfRange,
+        };
+
+        struct Section
+        {
+            int MaterialIndex = 0;
+
+            // ArraySurface 기준 첫 삼각형과 삼각형 수
+            int FirstSurface = 0;
+            int TriangleCount = 0;
+
+            // ArrayVertexIndex 범위
+            int VertexBegin = 0;
+            int VertexCount = 0;
+
+            // ArrayIndex 범위 (TriangleCount * 3)
+            int IndexBegin = 0;
+        };
+
+    public:
+        ~MeshSectionBuilder();
+
+        bool Build(const PMXMeshData& InMeshData);
+        void Delete();
+
+        ErrorType GetError() const { return Error; }
+
+        int GetSectionCount() const { return SectionCount; }
+        const Section* GetSections() const { return ArraySection; }
+
+        // 섹션별 원본 정점 인덱스 목록
+        int GetVertexIndexCount() const { return VertexIndexCount; }
+        const int* GetVertexIndices() const { return ArrayVertexIndex; }
+
+        // 섹션 로컬 정점 번호로 바꾼 인덱스
+        int GetIndexCount() const { return IndexCount; }
+        const int* GetIndices() const { return ArrayIndex; }
+
+    protected:
+        ErrorType Error = ErrorType::None;
+
+        int SectionCount = 0;
+        Section* ArraySection = nullptr;
+
+        int VertexIndexCount = 0;
+        int* ArrayVertexIndex = nullptr;
+
+        int IndexCount = 0;
+        int* ArrayIndex = nullptr;
+    };
+}
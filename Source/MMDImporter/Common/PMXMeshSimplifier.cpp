@@ -0,0 +1,858 @@
+﻿#include "PMXMeshSimplifier.h"
+#include "PMXMeshSection.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    // 열린 경계가 안쪽으로 말려 들어가지 않도록 경계 수직 평면에 주는 가중치
+    static constexpr float SimplifyBorderWeight = 10.0f;
+
+    // 축약 후 삼각형 법선이 이 값보다 많이 돌아가면 뒤집힌 것으로 보고 거부
+    static constexpr float SimplifyMinNormalDot = 0.25f;
+
+    struct SimplifyQuadric
+    {
+        double A00 = 0, A11 = 0, A22 = 0;
+        double A10 = 0, A20 = 0, A21 = 0;
+        double B0 = 0, B1 = 0, B2 = 0;
+        double C = 0;
+        double Weight = 0;
+
+        // 단위 법선 InNormal, dot(InNormal, P) + InDistance = 0 인 평면
+        void AddPlane(const Vector3& InNormal, const float InDistance, const float InWeight)
+        {
+            A00 += InWeight * InNormal.X * InNormal.X;
+            A11 += InWeight * InNormal.Y * InNormal.Y;
+            A22 += InWeight * InNormal.Z * InNormal.Z;
+            A10 += InWeight * InNormal.Y * InNormal.X;
+            A20 += InWeight * InNormal.Z * InNormal.X;
+            A21 += InWeight * InNormal.Z * InNormal.Y;
+            B0 += InWeight * InNormal.X * InDistance;
+            B1 += InWeight * InNormal.Y * InDistance;
+            B2 += InWeight * InNormal.Z * InDistance;
+            C += InWeight * InDistance * InDistance;
+            Weight += InWeight;
+        }
+
+        void Add(const SimplifyQuadric& InOther)
+        {
+            A00 += InOther.A00; A11 += InOther.A11; A22 += InOther.A22;
+            A10 += InOther.A10; A20 += InOther.A20; A21 += InOther.A21;
+            B0 += InOther.B0; B1 += InOther.B1; B2 += InOther.B2;
+            C += InOther.C;
+            Weight += InOther.Weight;
+        }
+
+        // 평면까지 거리 제곱의 가중 합
+        double Evaluate(const Vector3& P) const
+        {
+            const double RX = A00 * P.X + A10 * P.Y + A20 * P.Z;
+            const double RY = A10 * P.X + A11 * P.Y + A21 * P.Z;
+            const double RZ = A20 * P.X + A21 * P.Y + A22 * P.Z;
+
+            return fabs(RX * P.X + RY * P.Y + RZ * P.Z + 2.0 * (B0 * P.X + B1 * P.Y + B2 * P.Z) + C);
+        }
+    };
+
+    enum class SimplifyVertexKind : UInt8
+    {
+        Manifold,   // 안쪽 정점. 어느 이웃으로든 축약 가능
+        Border,     // 열린 경계. 경계 간선을 따라서만 축약
+        Seam,       // 같은 위치에 쌍둥이 정점이 있는 UV 이음새. 쌍둥이와 함께 축약
+        Locked,     // 고정
+    };
+
+    // 합이 1 로 정규화된 스킨 가중치
+    struct SimplifySkin
+    {
+        int BoneIndex[4]{ -1, -1, -1, -1 };
+        float Weight[4]{ 0 };
+        int Count = 0;
+    };
+
+    struct SimplifyMorph
+    {
+        int MorphIndex = 0;
+        Vector3 Offset;
+    };
+
+    // 모든 섹션이 읽기만 하는 정점 정보
+    struct SimplifyContext
+    {
+        SimplifyOptions Options;
+
+        Vector3 Origin;
+        float Scale = 1.0f;
+
+        std::vector<SimplifySkin> Skins;
+
+        // 정점별 정점 모프 오프셋 (모프 순서, 정규화 좌표)
+        std::vector<int> MorphBegin;
+        std::vector<SimplifyMorph> Morphs;
+
+        // 두 개 이상의 재질이 함께 쓰는 정점
+        std::vector<UInt8> Shared;
+    };
+
+    struct SimplifySection
+    {
+        int VertexCount = 0;
+        const int* VertexIndices = nullptr;
+
+        std::vector<Vector3> Positions;
+        std::vector<SimplifyQuadric> Quadrics;
+        std::vector<SimplifyVertexKind> Kinds;
+        std::vector<int> Twins;
+
+        // 현재 LOD 의 로컬 인덱스
+        std::vector<int> Indices;
+
+        // 적용한 축약 중 가장 큰 오차 (거리 제곱)
+        double Error = 0;
+
+        // 정점 → 삼각형 인접 목록. 패스마다 다시 만듦
+        std::vector<int> AdjacencyBegin;
+        std::vector<int> Adjacency;
+
+        void BuildAdjacency()
+        {
+            const int IndexCount = static_cast<int>(Indices.size());
+
+            AdjacencyBegin.assign(VertexCount + 1, 0);
+            for (int i = 0; i < IndexCount; ++i)
+                ++AdjacencyBegin[Indices[i] + 1];
+
+            for (int v = 0; v < VertexCount; ++v)
+                AdjacencyBegin[v + 1] += AdjacencyBegin[v];
+
+            Adjacency.resize(IndexCount);
+
+            std::vector<int> Fill(AdjacencyBegin.begin(), AdjacencyBegin.end() - 1);
+            for (int i = 0; i < IndexCount; ++i)
+                Adjacency[Fill[Indices[i]]++] = i / 3;
+        }
+
+        // 방향 간선 A → B 가 있는 삼각형이 있는지
+        bool HasEdge(const int A, const int B) const
+        {
+            for (int a = AdjacencyBegin[A]; a < AdjacencyBegin[A + 1]; ++a)
+            {
+                const int* Triangle = &Indices[Adjacency[a] * 3];
+                const int Corner = Triangle[0] == A ? 0 : (Triangle[1] == A ? 1 : 2);
+
+                if (Triangle[(Corner + 1) % 3] == B)
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool IsBorderEdge(const int A, const int B) const
+        {
+            return HasEdge(A, B) != HasEdge(B, A);
+        }
+
+        // A 를 B 로 옮겼을 때 없어지는 삼각형 수
+        int CountSharedTriangles(const int A, const int B) const
+        {
+            int Count = 0;
+            for (int a = AdjacencyBegin[A]; a < AdjacencyBegin[A + 1]; ++a)
+            {
+                const int* Triangle = &Indices[Adjacency[a] * 3];
+                Count += (Triangle[0] == B || Triangle[1] == B || Triangle[2] == B) ? 1 : 0;
+            }
+
+            return Count;
+        }
+
+        // A 를 B 위치로 옮겨도 주변 삼각형이 뒤집히지 않는지
+        // : 같은 패스에서 먼저 적용한 축약으로 옮겨진 주변 정점은 InRemap 으로 현재 위치를 찾음
+        bool IsFlipFree(const int A, const int B, const std::vector<int>& InRemap) const
+        {
+            const Vector3& Target = Positions[B];
+
+            for (int a = AdjacencyBegin[A]; a < AdjacencyBegin[A + 1]; ++a)
+            {
+                const int* Triangle = &Indices[Adjacency[a] * 3];
+                const int Corner = Triangle[0] == A ? 0 : (Triangle[1] == A ? 1 : 2);
+                const int V1 = InRemap[Triangle[(Corner + 1) % 3]];
+                const int V2 = InRemap[Triangle[(Corner + 2) % 3]];
+
+                // 이번 축약이나 앞선 축약으로 없어지는 삼각형
+                if (V1 == B || V2 == B || V1 == V2)
+                    continue;
+
+                const Vector3& P1 = Positions[V1];
+                const Vector3& P2 = Positions[V2];
+
+                const Vector3 Before = Math::Cross(Math::Sub(P1, Positions[A]), Math::Sub(P2, Positions[A]));
+                const Vector3 After = Math::Cross(Math::Sub(P1, Target), Math::Sub(P2, Target));
+
+                if (Math::Dot(Before, After) < SimplifyMinNormalDot * Math::Length(Before) * Math::Length(After))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    struct SimplifyCollapse
+    {
+        float Cost = 0;
+        int From = 0;
+        int To = 0;
+    };
+
+    static float GetSkinDifference(const SimplifySkin& A, const SimplifySkin& B)
+    {
+        float Difference = 0;
+
+        for (int i = 0; i < A.Count; ++i)
+        {
+            float Other = 0;
+            for (int j = 0; j < B.Count; ++j)
+                Other += B.BoneIndex[j] == A.BoneIndex[i] ? B.Weight[j] : 0;
+
+            Difference += fabsf(A.Weight[i] - Other);
+        }
+
+        for (int j = 0; j < B.Count; ++j)
+        {
+            bool bFound = false;
+            for (int i = 0; i < A.Count; ++i)
+                bFound |= A.BoneIndex[i] == B.BoneIndex[j];
+
+            Difference += bFound ? 0 : B.Weight[j];
+        }
+
+        return Difference;
+    }
+
+    // 두 정점의 모프 오프셋 차이 중 가장 큰 것 (거리 제곱)
+    static float GetMorphDifference(const SimplifyContext& InContext, const int A, const int B)
+    {
+        int IndexA = InContext.MorphBegin[A];
+        int IndexB = InContext.MorphBegin[B];
+        const int EndA = InContext.MorphBegin[A + 1];
+        const int EndB = InContext.MorphBegin[B + 1];
+
+        float MaxDifference = 0;
+
+        while (IndexA < EndA || IndexB < EndB)
+        {
+            const int MorphA = IndexA < EndA ? InContext.Morphs[IndexA].MorphIndex : INT_MAX;
+            const int MorphB = IndexB < EndB ? InContext.Morphs[IndexB].MorphIndex : INT_MAX;
+
+            Vector3 Difference;
+            if (MorphA == MorphB)
+                Difference = Math::Sub(InContext.Morphs[IndexA++].Offset, InContext.Morphs[IndexB++].Offset);
+            else if (MorphA < MorphB)
+                Difference = InContext.Morphs[IndexA++].Offset;
+            else
+                Difference = InContext.Morphs[IndexB++].Offset;
+
+            MaxDifference = std::max(MaxDifference, Math::LengthSquared(Difference));
+        }
+
+        return MaxDifference;
+    }
+
+    static void InitializeSection(const SimplifyContext& InContext, const VertexData* InVertices, const MeshSectionBuilder& InSections, const int InSectionIndex, SimplifySection& OutSection)
+    {
+        const MeshSectionBuilder::Section& CurSection = InSections.GetSections()[InSectionIndex];
+        const int VertexCount = CurSection.VertexCount;
+
+        OutSection.VertexCount = VertexCount;
+        OutSection.VertexIndices = InSections.GetVertexIndices() + CurSection.VertexBegin;
+        OutSection.Indices.assign(InSections.GetIndices() + CurSection.IndexBegin, InSections.GetIndices() + CurSection.IndexBegin + CurSection.TriangleCount * 3);
+
+        OutSection.Positions.resize(VertexCount);
+        for (int v = 0; v < VertexCount; ++v)
+            OutSection.Positions[v] = Math::Scale(Math::Sub(InVertices[OutSection.VertexIndices[v]].Position, InContext.Origin), InContext.Scale);
+
+        OutSection.Quadrics.assign(VertexCount, SimplifyQuadric());
+        OutSection.Kinds.assign(VertexCount, SimplifyVertexKind::Manifold);
+        OutSection.Twins.assign(VertexCount, -1);
+
+        if (VertexCount <= 0)
+            return;
+
+        OutSection.BuildAdjacency();
+
+        const std::vector<Vector3>& Positions = OutSection.Positions;
+        const std::vector<int>& Indices = OutSection.Indices;
+
+        // 면 평면과, 경계 간선에 수직인 평면
+        std::vector<int> BorderEdgeCount(VertexCount, 0);
+
+        for (int t = 0; t < CurSection.TriangleCount; ++t)
+        {
+            const int* Triangle = &Indices[t * 3];
+            const Vector3 Normal = Math::Cross(Math::Sub(Positions[Triangle[1]], Positions[Triangle[0]]), Math::Sub(Positions[Triangle[2]], Positions[Triangle[0]]));
+            const float Area = Math::Length(Normal) * 0.5f;
+            const Vector3 UnitNormal = Math::Normalize(Normal, 0);
+            const float Distance = -Math::Dot(UnitNormal, Positions[Triangle[0]]);
+
+            for (int k = 0; k < 3; ++k)
+                OutSection.Quadrics[Triangle[k]].AddPlane(UnitNormal, Distance, Area);
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const int A = Triangle[k];
+                const int B = Triangle[(k + 1) % 3];
+
+                if (OutSection.HasEdge(B, A))
+                    continue;
+
+                ++BorderEdgeCount[A];
+                ++BorderEdgeCount[B];
+
+                const Vector3 Edge = Math::Sub(Positions[B], Positions[A]);
+                const Vector3 BorderNormal = Math::Normalize(Math::Cross(Edge, UnitNormal), 0);
+                const float BorderDistance = -Math::Dot(BorderNormal, Positions[A]);
+                const float Weight = Math::LengthSquared(Edge) * SimplifyBorderWeight;
+
+                OutSection.Quadrics[A].AddPlane(BorderNormal, BorderDistance, Weight);
+                OutSection.Quadrics[B].AddPlane(BorderNormal, BorderDistance, Weight);
+            }
+        }
+
+        // 위치가 정확히 같은 정점 묶음으로 이음새 판별
+        std::vector<int> Order(VertexCount);
+        for (int v = 0; v < VertexCount; ++v)
+            Order[v] = v;
+
+        auto IsLess = [&Positions](const int A, const int B)
+        {
+            const Vector3& PA = Positions[A];
+            const Vector3& PB = Positions[B];
+            return PA.X != PB.X ? PA.X < PB.X : (PA.Y != PB.Y ? PA.Y < PB.Y : PA.Z < PB.Z);
+        };
+
+        std::sort(Order.begin(), Order.end(), IsLess);
+
+        for (int Begin = 0; Begin < VertexCount;)
+        {
+            int End = Begin + 1;
+            while (End < VertexCount && IsLess(Order[Begin], Order[End]) == false)
+                ++End;
+
+            const int GroupSize = End - Begin;
+            for (int i = Begin; i < End; ++i)
+            {
+                const int v = Order[i];
+                const bool bShared = InContext.Shared[OutSection.VertexIndices[v]] != 0;
+
+                if (bShared || GroupSize > 2 || BorderEdgeCount[v] > 2)
+                    OutSection.Kinds[v] = SimplifyVertexKind::Locked;
+                else if (GroupSize == 2)
+                {
+                    OutSection.Kinds[v] = BorderEdgeCount[v] == 2 ? SimplifyVertexKind::Seam : SimplifyVertexKind::Locked;
+                    OutSection.Twins[v] = Order[i == Begin ? End - 1 : Begin];
+                }
+                else if (BorderEdgeCount[v] > 0)
+                    OutSection.Kinds[v] = SimplifyVertexKind::Border;
+            }
+
+            Begin = End;
+        }
+
+        // 쌍둥이 중 하나라도 고정이면 함께 고정
+        for (int v = 0; v < VertexCount; ++v)
+        {
+            const int Twin = OutSection.Twins[v];
+            if (Twin >= 0 && OutSection.Kinds[Twin] == SimplifyVertexKind::Locked)
+                OutSection.Kinds[v] = SimplifyVertexKind::Locked;
+        }
+    }
+
+    // From → To 축약 비용. 허용되지 않으면 음수
+    static float GetCollapseCost(const SimplifyContext& InContext, const SimplifySection& InSection, const int From, const int To)
+    {
+        const SimplifyVertexKind Kind = InSection.Kinds[From];
+        int TwinFrom = -1;
+        int TwinTo = -1;
+
+        switch (Kind)
+        {
+            case SimplifyVertexKind::Manifold:
+                break;
+
+            case SimplifyVertexKind::Border:
+                if (InSection.IsBorderEdge(From, To) == false)
+                    return -1.0f;
+                break;
+
+            case SimplifyVertexKind::Seam:
+                TwinFrom = InSection.Twins[From];
+                TwinTo = InSection.Twins[To];
+
+                if (InSection.Kinds[To] != SimplifyVertexKind::Seam || TwinTo < 0 || TwinFrom == To || TwinTo == From)
+                    return -1.0f;
+
+                if (InSection.IsBorderEdge(From, To) == false || InSection.IsBorderEdge(TwinFrom, TwinTo) == false)
+                    return -1.0f;
+                break;
+
+            default:
+                return -1.0f;
+        }
+
+        const int GlobalFrom = InSection.VertexIndices[From];
+        const int GlobalTo = InSection.VertexIndices[To];
+
+        if (GetSkinDifference(InContext.Skins[GlobalFrom], InContext.Skins[GlobalTo]) > InContext.Options.MaxSkinWeightDifference)
+            return -1.0f;
+
+        SimplifyQuadric Quadric = InSection.Quadrics[From];
+        float MorphDifference = GetMorphDifference(InContext, GlobalFrom, GlobalTo);
+
+        if (TwinFrom >= 0)
+        {
+            Quadric.Add(InSection.Quadrics[TwinFrom]);
+            MorphDifference = std::max(MorphDifference, GetMorphDifference(InContext, InSection.VertexIndices[TwinFrom], InSection.VertexIndices[TwinTo]));
+        }
+
+        const double Error = Quadric.Evaluate(InSection.Positions[To]) / std::max(Quadric.Weight, static_cast<double>(FLT_MIN));
+        return static_cast<float>(Error) + MorphDifference * InContext.Options.MorphErrorScale;
+    }
+
+    // 한 번의 패스. 비용 순으로 서로 겹치지 않는 축약을 적용하고 적용한 수를 반환
+    static int SimplifySectionPass(const SimplifyContext& InContext, SimplifySection& InOutSection, const int InTargetTriangleCount, const float InMaxErrorSquared)
+    {
+        InOutSection.BuildAdjacency();
+
+        const std::vector<int>& Indices = InOutSection.Indices;
+        const int TriangleCount = static_cast<int>(Indices.size() / 3);
+
+        std::vector<SimplifyCollapse> Collapses;
+        Collapses.reserve(TriangleCount * 3 / 2);
+
+        for (int t = 0; t < TriangleCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const int A = Indices[t * 3 + k];
+                const int B = Indices[t * 3 + (k + 1) % 3];
+
+                // 양쪽 삼각형에서 두 번 보지 않도록
+                if (A > B && InOutSection.HasEdge(B, A))
+                    continue;
+
+                const float CostAB = GetCollapseCost(InContext, InOutSection, A, B);
+                const float CostBA = GetCollapseCost(InContext, InOutSection, B, A);
+
+                SimplifyCollapse Collapse;
+                if (CostAB >= 0 && (CostBA < 0 || CostAB <= CostBA))
+                {
+                    Collapse.Cost = CostAB;
+                    Collapse.From = A;
+                    Collapse.To = B;
+                }
+                else if (CostBA >= 0)
+                {
+                    Collapse.Cost = CostBA;
+                    Collapse.From = B;
+                    Collapse.To = A;
+                }
+                else
+                    continue;
+
+                if (Collapse.Cost <= InMaxErrorSquared)
+                    Collapses.push_back(Collapse);
+            }
+        }
+
+        std::sort(Collapses.begin(), Collapses.end(), [](const SimplifyCollapse& A, const SimplifyCollapse& B)
+        {
+            return A.Cost < B.Cost;
+        });
+
+        std::vector<int> Remap(InOutSection.VertexCount);
+        for (int v = 0; v < InOutSection.VertexCount; ++v)
+            Remap[v] = v;
+
+        std::vector<UInt8> Touched(InOutSection.VertexCount, 0);
+
+        int RemainingTriangles = TriangleCount;
+        int AppliedCount = 0;
+
+        for (const SimplifyCollapse& Collapse : Collapses)
+        {
+            if (RemainingTriangles <= InTargetTriangleCount)
+                break;
+
+            const int From = Collapse.From;
+            const int To = Collapse.To;
+            const int TwinFrom = InOutSection.Kinds[From] == SimplifyVertexKind::Seam ? InOutSection.Twins[From] : -1;
+            const int TwinTo = TwinFrom >= 0 ? InOutSection.Twins[To] : -1;
+
+            if (Touched[From] != 0 || Touched[To] != 0 || (TwinFrom >= 0 && (Touched[TwinFrom] != 0 || Touched[TwinTo] != 0)))
+                continue;
+
+            if (InOutSection.IsFlipFree(From, To, Remap) == false || (TwinFrom >= 0 && InOutSection.IsFlipFree(TwinFrom, TwinTo, Remap) == false))
+                continue;
+
+            Remap[From] = To;
+            InOutSection.Quadrics[To].Add(InOutSection.Quadrics[From]);
+            Touched[From] = Touched[To] = 1;
+            RemainingTriangles -= InOutSection.CountSharedTriangles(From, To);
+
+            if (TwinFrom >= 0)
+            {
+                Remap[TwinFrom] = TwinTo;
+                InOutSection.Quadrics[TwinTo].Add(InOutSection.Quadrics[TwinFrom]);
+                Touched[TwinFrom] = Touched[TwinTo] = 1;
+                RemainingTriangles -= InOutSection.CountSharedTriangles(TwinFrom, TwinTo);
+            }
+
+            InOutSection.Error = std::max(InOutSection.Error, static_cast<double>(Collapse.Cost));
+            ++AppliedCount;
+        }
+
+        if (AppliedCount == 0)
+            return 0;
+
+        // 인덱스를 옮기고 면적이 없어진 삼각형 제거
+        std::vector<int>& OutIndices = InOutSection.Indices;
+        int Count = 0;
+
+        for (int t = 0; t < TriangleCount; ++t)
+        {
+            const int A = Remap[OutIndices[t * 3]];
+            const int B = Remap[OutIndices[t * 3 + 1]];
+            const int C = Remap[OutIndices[t * 3 + 2]];
+
+            if (A == B || B == C || C == A)
+                continue;
+
+            OutIndices[Count * 3] = A;
+            OutIndices[Count * 3 + 1] = B;
+            OutIndices[Count * 3 + 2] = C;
+            ++Count;
+        }
+
+        OutIndices.resize(Count * 3);
+        return AppliedCount;
+    }
+
+    MeshLOD::~MeshLOD()
+    {
+        Delete();
+    }
+
+    void MeshLOD::Delete()
+    {
+        Error = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayVertexIndex);
+        VertexCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArraySurface);
+        SurfaceCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayMaterialSurfaceCount);
+        MaterialCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayMorphOffsetBegin);
+        PMX_SAFE_DELETE_ARRAY(ArrayMorphOffset);
+        MorphCount = 0;
+    }
+
+    MeshSimplifier::~MeshSimplifier()
+    {
+        Delete();
+    }
+
+    bool MeshSimplifier::Build(const PMXMeshData& InMeshData, const SimplifyOptions& InOptions)
+    {
+        Delete();
+
+        if (InOptions.LODCount <= 0)
+            return false;
+
+        MeshSectionBuilder Sections;
+        if (Sections.Build(InMeshData) == false)
+            return false;
+
+        const int VertexCount = InMeshData.GetVertexCount();
+        const VertexData* Vertices = InMeshData.GetVertices();
+
+        SimplifyContext Context;
+        Context.Options = InOptions;
+
+        // 메시 크기를 1 로 맞춘 좌표에서 오차 계산
+        Vector3 BoundsMin = Vertices[0].Position;
+        Vector3 BoundsMax = BoundsMin;
+        for (int v = 1; v < VertexCount; ++v)
+        {
+            BoundsMin = Math::Min(BoundsMin, Vertices[v].Position);
+            BoundsMax = Math::Max(BoundsMax, Vertices[v].Position);
+        }
+
+        const Vector3 Extent = Math::Sub(BoundsMax, BoundsMin);
+        const float MaxExtent = std::max(std::max(Extent.X, Extent.Y), Extent.Z);
+
+        Context.Origin = BoundsMin;
+        Context.Scale = MaxExtent > 0 ? 1.0f / MaxExtent : 1.0f;
+
+        Context.Skins.resize(VertexCount);
+        ParallelFor(VertexCount, 4096, [&](const int Begin, const int End)
+        {
+            for (int v = Begin; v < End; ++v)
+            {
+                int BoneIndex[4];
+                float Weight[4];
+                const int Count = Vertices[v].GetBoneWeights(BoneIndex, Weight);
+
+                SimplifySkin& Skin = Context.Skins[v];
+                float Sum = 0;
+
+                for (int i = 0; i < Count; ++i)
+                {
+                    if (Weight[i] <= 0)
+                        continue;
+
+                    // 같은 본이 여러 번 나오면 합침
+                    int Slot = 0;
+                    while (Slot < Skin.Count && Skin.BoneIndex[Slot] != BoneIndex[i])
+                        ++Slot;
+
+                    if (Slot == Skin.Count)
+                    {
+                        Skin.BoneIndex[Slot] = BoneIndex[i];
+                        ++Skin.Count;
+                    }
+
+                    Skin.Weight[Slot] += Weight[i];
+                    Sum += Weight[i];
+                }
+
+                for (int i = 0; i < Skin.Count; ++i)
+                    Skin.Weight[i] /= Sum;
+            }
+        });
+
+        // 정점별 정점 모프 목록
+        const int MorphCount = InMeshData.GetMorphCount();
+        const MorphData* Morphs = InMeshData.GetMorphs();
+
+        auto IsVertexMorph = [](const MorphData& InMorph)
+        {
+            return InMorph.Type == MorphData::MorphType::Vertex && InMorph.ArrayOffset != nullptr;
+        };
+
+        Context.MorphBegin.assign(VertexCount + 1, 0);
+        for (int m = 0; m < MorphCount; ++m)
+        {
+            if (IsVertexMorph(Morphs[m]) == false)
+                continue;
+
+            const MorphData::OffsetVertex* Offsets = static_cast<const MorphData::OffsetVertex*>(Morphs[m].ArrayOffset);
+            for (int i = 0; i < Morphs[m].OffsetCount; ++i)
+            {
+                if (Offsets[i].VertexIndex >= 0 && Offsets[i].VertexIndex < VertexCount)
+                    ++Context.MorphBegin[Offsets[i].VertexIndex + 1];
+            }
+        }
+
+        for (int v = 0; v < VertexCount; ++v)
+            Context.MorphBegin[v + 1] += Context.MorphBegin[v];
+
+        Context.Morphs.resize(Context.MorphBegin[VertexCount]);
+        {
+            std::vector<int> Fill(Context.MorphBegin.begin(), Context.MorphBegin.end() - 1);
+            for (int m = 0; m < MorphCount; ++m)
+            {
+                if (IsVertexMorph(Morphs[m]) == false)
+                    continue;
+
+                const MorphData::OffsetVertex* Offsets = static_cast<const MorphData::OffsetVertex*>(Morphs[m].ArrayOffset);
+                for (int i = 0; i < Morphs[m].OffsetCount; ++i)
+                {
+                    const int VertexIndex = Offsets[i].VertexIndex;
+                    if (VertexIndex < 0 || VertexIndex >= VertexCount)
+                        continue;
+
+                    SimplifyMorph& Morph = Context.Morphs[Fill[VertexIndex]++];
+                    Morph.MorphIndex = m;
+                    Morph.Offset = Math::Scale(Offsets[i].PositionOffset, Context.Scale);
+                }
+            }
+        }
+
+        // 재질 경계 정점 : 여러 섹션이 같은 정점을 쓰거나, 다른 섹션에 같은 위치의 정점이 있으면 고정
+        // 섹션마다 따로 단순화하므로 경계가 움직이면 틈이 생김
+        const int SectionCount = Sections.GetSectionCount();
+        {
+            std::vector<int> VertexSection(VertexCount, -1);
+            Context.Shared.assign(VertexCount, 0);
+
+            for (int s = 0; s < SectionCount; ++s)
+            {
+                const MeshSectionBuilder::Section& CurSection = Sections.GetSections()[s];
+                for (int i = 0; i < CurSection.VertexCount; ++i)
+                {
+                    const int VertexIndex = Sections.GetVertexIndices()[CurSection.VertexBegin + i];
+                    if (VertexSection[VertexIndex] >= 0)
+                        Context.Shared[VertexIndex] = 1;
+
+                    VertexSection[VertexIndex] = s;
+                }
+            }
+
+            std::vector<int> Order;
+            Order.reserve(VertexCount);
+            for (int v = 0; v < VertexCount; ++v)
+            {
+                if (VertexSection[v] >= 0)
+                    Order.push_back(v);
+            }
+
+            auto IsLess = [Vertices](const int A, const int B)
+            {
+                const Vector3& PA = Vertices[A].Position;
+                const Vector3& PB = Vertices[B].Position;
+                return PA.X != PB.X ? PA.X < PB.X : (PA.Y != PB.Y ? PA.Y < PB.Y : PA.Z < PB.Z);
+            };
+
+            std::sort(Order.begin(), Order.end(), IsLess);
+
+            for (MemSize Begin = 0; Begin < Order.size();)
+            {
+                MemSize End = Begin + 1;
+                bool bCrossSection = Context.Shared[Order[Begin]] != 0;
+
+                while (End < Order.size() && IsLess(Order[Begin], Order[End]) == false)
+                {
+                    bCrossSection |= VertexSection[Order[End]] != VertexSection[Order[Begin]] || Context.Shared[Order[End]] != 0;
+                    ++End;
+                }
+
+                if (bCrossSection)
+                {
+                    for (MemSize i = Begin; i < End; ++i)
+                        Context.Shared[Order[i]] = 1;
+                }
+
+                Begin = End;
+            }
+        }
+
+        std::vector<SimplifySection> SectionStates(SectionCount);
+        ParallelFor(SectionCount, 1, [&](const int Begin, const int End)
+        {
+            for (int s = Begin; s < End; ++s)
+                InitializeSection(Context, Vertices, Sections, s, SectionStates[s]);
+        });
+
+        const float MaxErrorSquared = InOptions.MaxError * InOptions.MaxError;
+
+        LODCount = InOptions.LODCount;
+        ArrayLOD = new MeshLOD[LODCount];
+
+        std::vector<int> OldToLOD(VertexCount, -1);
+
+        for (int l = 0; l < LODCount; ++l)
+        {
+            ParallelFor(SectionCount, 1, [&](const int Begin, const int End)
+            {
+                for (int s = Begin; s < End; ++s)
+                {
+                    SimplifySection& Section = SectionStates[s];
+                    const int TargetTriangleCount = static_cast<int>(Section.Indices.size() / 3 * InOptions.TriangleRatio);
+
+                    while (static_cast<int>(Section.Indices.size() / 3) > TargetTriangleCount)
+                    {
+                        if (SimplifySectionPass(Context, Section, TargetTriangleCount, MaxErrorSquared) == 0)
+                            break;
+                    }
+                }
+            });
+
+            // 섹션 결과를 합쳐 원본 정점 번호로 되돌리고, 처음 사용되는 순서로 LOD 정점 번호를 매김
+            MeshLOD& LOD = ArrayLOD[l];
+            std::fill(OldToLOD.begin(), OldToLOD.end(), -1);
+
+            LOD.MaterialCount = SectionCount;
+            LOD.ArrayMaterialSurfaceCount = new int[SectionCount];
+
+            for (int s = 0; s < SectionCount; ++s)
+            {
+                LOD.SurfaceCount += static_cast<int>(SectionStates[s].Indices.size() / 3);
+                LOD.ArrayMaterialSurfaceCount[s] = static_cast<int>(SectionStates[s].Indices.size());
+                LOD.Error = std::max(LOD.Error, static_cast<float>(sqrt(SectionStates[s].Error)));
+            }
+
+            LOD.ArraySurface = new SurfaceData[LOD.SurfaceCount];
+            std::vector<int> VertexIndices;
+
+            int SurfaceCursor = 0;
+            for (const SimplifySection& Section : SectionStates)
+            {
+                for (MemSize i = 0; i < Section.Indices.size(); ++i)
+                {
+                    const int VertexIndex = Section.VertexIndices[Section.Indices[i]];
+                    if (OldToLOD[VertexIndex] < 0)
+                    {
+                        OldToLOD[VertexIndex] = static_cast<int>(VertexIndices.size());
+                        VertexIndices.push_back(VertexIndex);
+                    }
+
+                    LOD.ArraySurface[SurfaceCursor + i / 3].VertexIndex[i % 3] = OldToLOD[VertexIndex];
+                }
+
+                SurfaceCursor += static_cast<int>(Section.Indices.size() / 3);
+            }
+
+            LOD.VertexCount = static_cast<int>(VertexIndices.size());
+            LOD.ArrayVertexIndex = new int[std::max(LOD.VertexCount, 1)];
+            std::copy(VertexIndices.begin(), VertexIndices.end(), LOD.ArrayVertexIndex);
+
+            // 남은 정점의 모프 오프셋만 LOD 정점 번호로 옮김
+            LOD.MorphCount = MorphCount;
+            LOD.ArrayMorphOffsetBegin = new int[MorphCount + 1];
+
+            std::vector<MorphData::OffsetVertex> MorphOffsets;
+            for (int m = 0; m < MorphCount; ++m)
+            {
+                LOD.ArrayMorphOffsetBegin[m] = static_cast<int>(MorphOffsets.size());
+
+                if (IsVertexMorph(Morphs[m]) == false)
+                    continue;
+
+                const MorphData::OffsetVertex* Offsets = static_cast<const MorphData::OffsetVertex*>(Morphs[m].ArrayOffset);
+                for (int i = 0; i < Morphs[m].OffsetCount; ++i)
+                {
+                    const int VertexIndex = Offsets[i].VertexIndex;
+                    if (VertexIndex < 0 || VertexIndex >= VertexCount || OldToLOD[VertexIndex] < 0)
+                        continue;
+
+                    MorphData::OffsetVertex Offset;
+                    Offset.VertexIndex = OldToLOD[VertexIndex];
+                    Offset.PositionOffset = Offsets[i].PositionOffset;
+                    MorphOffsets.push_back(Offset);
+                }
+            }
+
+            LOD.ArrayMorphOffsetBegin[MorphCount] = static_cast<int>(MorphOffsets.size());
+            LOD.ArrayMorphOffset = new MorphData::OffsetVertex[std::max<MemSize>(MorphOffsets.size(), 1)];
+            std::copy(MorphOffsets.begin(), MorphOffsets.end(), LOD.ArrayMorphOffset);
+        }
+
+        return true;
+    }
+
+    void MeshSimplifier::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayLOD);
+        LODCount = 0;
+    }
+}
@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct SimplifyOptions
+    {
+        // 원본을 제외하고 만들 LOD 수
+        int LODCount = 3;
+
+        // 이전 LOD 대비 목표 삼각형 비율
+        float TriangleRatio = 0.5f;
+
+        // 허용 오차. 메시 바운딩 박스의 가장 긴 변 대비 거리
+        float MaxError = 0.02f;
+
+        // 합칠 수 있는 두 정점의 스킨 가중치 차이 (본별 가중치 차의 절대값 합, 0 ~ 2)
+        float MaxSkinWeightDifference = 0.5f;
+
+        // 정점 모프 오프셋 차이를 오차에 더할 때의 배율
+        float MorphErrorScale = 1.0f;
+    };
+
+    /**
+     * 단순화된 LOD 하나
+     * : 정점은 원본 정점을 그대로 쓰며 위치나 속성을 새로 만들지 않으므로 스킨/UV/모프 값이 그대로 유지됩니다.
+     */
+    class MeshLOD
+    {
+        friend class MeshSimplifier;
+
+    public:
+        ~MeshLOD();
+
+        void Delete();
+
+        // 원본 대비 오차 (메시 크기 대비 거리)
+        float GetError() const { return Error; }
+
+        // LOD 정점 → 원본 정점 인덱스. 처음 사용되는 순서
+        int GetVertexCount() const { return VertexCount; }
+        const int* GetVertexIndices() const { return ArrayVertexIndex; }
+
+        // LOD 정점 번호 기준 삼각형. 재질 순서로 정렬
+        int GetSurfaceCount() const { return SurfaceCount; }
+        const SurfaceData* GetSurfaces() const { return ArraySurface; }
+
+        // 재질별 인덱스 수 (MaterialData::SurfaceCount 와 같은 단위)
+        int GetMaterialCount() const { return MaterialCount; }
+        const int* GetMaterialSurfaceCounts() const { return ArrayMaterialSurfaceCount; }
+
+        // 정점 모프별 오프셋 범위 [Begin[i], Begin[i + 1]). 정점 모프가 아니면 비어 있음
+        // : VertexIndex 는 LOD 정점 번호
+        int GetMorphCount() const { return MorphCount; }
+        const int* GetMorphOffsetBegins() const { return ArrayMorphOffsetBegin; }
+        const MorphData::OffsetVertex* GetMorphOffsets() const { return ArrayMorphOffset; }
+
+    protected:
+        float Error = 0;
+
+        int VertexCount = 0;
+        int* ArrayVertexIndex = nullptr;
+
+        int SurfaceCount = 0;
+        SurfaceData* ArraySurface = nullptr;
+
+        int MaterialCount = 0;
+        int* ArrayMaterialSurfaceCount = nullptr;
+
+        int MorphCount = 0;
+        int* ArrayMorphOffsetBegin = nullptr;
+        MorphData::OffsetVertex* ArrayMorphOffset = nullptr;
+    };
+
+    /**
+     * Quadric 오차 기반 간선 축약으로 LOD 체인 생성
+     * : 한쪽 정점을 다른 정점으로 옮기는 half-edge 축약만 사용합니다.
+     *   재질끼리 공유하는 정점, 세 갈래 이상 겹친 이음새 정점은 고정하고,
+     *   UV 이음새는 양쪽 정점 쌍을 함께 축약하며, 열린 경계는 경계를 따라서만 축약합니다.
+     *   재질(섹션)별로 병렬 처리하고, 각 LOD 는 이전 LOD 를 이어서 단순화합니다.
+     */
+    class MeshSimplifier
+    {
+    public:
+        ~MeshSimplifier();
+
+        bool Build(const PMXMeshData& InMeshData, const SimplifyOptions& InOptions = SimplifyOptions());
+        void Delete();
+
+        int GetLODCount() const { return LODCount; }
+        const MeshLOD* GetLODs() const { return ArrayLOD; }
+
+    protected:
+        int LODCount = 0;
+        MeshLOD* ArrayLOD = nullptr;
+    };
+}
@@ -0,0 +1,344 @@
+﻿#include "PMXMeshletBuilder.h"
+#include "PMXMeshSection.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    // 섹션 하나의 결과. 합칠 때 오프셋만 다시 계산
+    struct MeshletSectionResult
+    {
+        std::vector<MeshletBuilder::Meshlet> Meshlets;
+        std::vector<int> Vertices;
+        std::vector<UInt8> Triangles;
+    };
+
+    static UInt32 ExpandMortonBits(UInt32 Value)
+    {
+        Value &= 0x3ff;
+        Value = (Value | (Value << 16)) & 0x030000ff;
+        Value = (Value | (Value << 8)) & 0x0300f00f;
+        Value = (Value | (Value << 4)) & 0x030c30c3;
+        Value = (Value | (Value << 2)) & 0x09249249;
+        return Value;
+    }
+
+    // 바운딩 구와 법선 원뿔 (meshoptimizer 의 meshopt_computeClusterBounds 와 같은 판정식)
+    static void ComputeMeshletBounds(const VertexData* InVertices, const int* InMeshletVertices, const UInt8* InTriangles, MeshletBuilder::Meshlet& InOutMeshlet)
+    {
+        Vector3 BoundsMin = InVertices[InMeshletVertices[0]].Position;
+        Vector3 BoundsMax = BoundsMin;
+
+        for (int v = 1; v < InOutMeshlet.VertexCount; ++v)
+        {
+            BoundsMin = Math::Min(BoundsMin, InVertices[InMeshletVertices[v]].Position);
+            BoundsMax = Math::Max(BoundsMax, InVertices[InMeshletVertices[v]].Position);
+        }
+
+        const Vector3 Center = Math::Scale(Math::Add(BoundsMin, BoundsMax), 0.5f);
+
+        float RadiusSquared = 0;
+        for (int v = 0; v < InOutMeshlet.VertexCount; ++v)
+            RadiusSquared = std::max(RadiusSquared, Math::LengthSquared(Math::Sub(InVertices[InMeshletVertices[v]].Position, Center)));
+
+        InOutMeshlet.Center = Center;
+        InOutMeshlet.Radius = sqrtf(RadiusSquared);
+        InOutMeshlet.ConeApex = Center;
+        InOutMeshlet.ConeCutoff = 1.0f;
+
+        std::vector<Vector3> Normals(InOutMeshlet.TriangleCount);
+        Vector3 Axis;
+
+        for (int t = 0; t < InOutMeshlet.TriangleCount; ++t)
+        {
+            const Vector3& P0 = InVertices[InMeshletVertices[InTriangles[t * 3]]].Position;
+            const Vector3& P1 = InVertices[InMeshletVertices[InTriangles[t * 3 + 1]]].Position;
+            const Vector3& P2 = InVertices[InMeshletVertices[InTriangles[t * 3 + 2]]].Position;
+
+            Normals[t] = Math::Normalize(Math::Cross(Math::Sub(P1, P0), Math::Sub(P2, P0)));
+            Axis = Math::Add(Axis, Normals[t]);
+        }
+
+        Axis = Math::Normalize(Axis);
+        InOutMeshlet.ConeAxis = Axis;
+
+        if (Math::LengthSquared(Axis) <= 0)
+            return;
+
+        float MinDot = 1.0f;
+        for (int t = 0; t < InOutMeshlet.TriangleCount; ++t)
+            MinDot = std::min(MinDot, Math::Dot(Normals[t], Axis));
+
+        // 원뿔이 반구에 가까우면 컬링에 쓸 수 없음
+        if (MinDot <= 0.1f)
+            return;
+
+        // 모든 삼각형 평면의 뒤쪽이 되도록 원뿔 꼭짓점을 축 반대 방향으로 이동
+        float MaxT = 0;
+        for (int t = 0; t < InOutMeshlet.TriangleCount; ++t)
+        {
+            const Vector3& P0 = InVertices[InMeshletVertices[InTriangles[t * 3]]].Position;
+            const float DotCenter = Math::Dot(Math::Sub(Center, P0), Normals[t]);
+            const float DotAxis = Math::Dot(Axis, Normals[t]);
+
+            MaxT = std::max(MaxT, DotCenter / DotAxis);
+        }
+
+        InOutMeshlet.ConeApex = Math::Sub(Center, Math::Scale(Axis, MaxT));
+        InOutMeshlet.ConeCutoff = sqrtf(1.0f - MinDot * MinDot);
+    }
+
+    static void BuildSectionMeshlets(const VertexData* InVertices, const MeshSectionBuilder& InSections, const int InSectionIndex, const MeshletOptions& InOptions, MeshletSectionResult& OutResult)
+    {
+        const MeshSectionBuilder::Section& CurSection = InSections.GetSections()[InSectionIndex];
+        const int TriangleCount = CurSection.TriangleCount;
+        const int VertexCount = CurSection.VertexCount;
+        const int* Indices = InSections.GetIndices() + CurSection.IndexBegin;
+        const int* VertexIndices = InSections.GetVertexIndices() + CurSection.VertexBegin;
+
+        if (TriangleCount <= 0)
+            return;
+
+        auto GetPosition = [&](const int InLocalVertex) -> const Vector3&
+        {
+            return InVertices[VertexIndices[InLocalVertex]].Position;
+        };
+
+        // 정점 → 삼각형 인접 목록
+        std::vector<int> AdjacencyOffset(VertexCount + 1, 0);
+        for (int i = 0; i < TriangleCount * 3; ++i)
+            ++AdjacencyOffset[Indices[i] + 1];
+
+        for (int v = 0; v < VertexCount; ++v)
+            AdjacencyOffset[v + 1] += AdjacencyOffset[v];
+
+        std::vector<int> Adjacency(TriangleCount * 3);
+        {
+            std::vector<int> Fill(AdjacencyOffset.begin(), AdjacencyOffset.end() - 1);
+            for (int i = 0; i < TriangleCount * 3; ++i)
+                Adjacency[Fill[Indices[i]]++] = i / 3;
+        }
+
+        // 삼각형 중심의 Morton 순서. 이웃이 끊겼을 때 다음 시작 삼각형으로 사용
+        std::vector<Vector3> Centroids(TriangleCount);
+        Vector3 BoundsMin = GetPosition(Indices[0]);
+        Vector3 BoundsMax = BoundsMin;
+
+        for (int t = 0; t < TriangleCount; ++t)
+        {
+            const Vector3 Sum = Math::Add(Math::Add(GetPosition(Indices[t * 3]), GetPosition(Indices[t * 3 + 1])), GetPosition(Indices[t * 3 + 2]));
+            Centroids[t] = Math::Scale(Sum, 1.0f / 3.0f);
+            BoundsMin = Math::Min(BoundsMin, Centroids[t]);
+            BoundsMax = Math::Max(BoundsMax, Centroids[t]);
+        }
+
+        const Vector3 Extent = Math::Sub(BoundsMax, BoundsMin);
+        const float MaxExtent = std::max(std::max(Extent.X, Extent.Y), std::max(Extent.Z, FLT_MIN));
+
+        std::vector<std::pair<UInt32, int>> SpatialOrder(TriangleCount);
+        for (int t = 0; t < TriangleCount; ++t)
+        {
+            const Vector3 Normalized = Math::Scale(Math::Sub(Centroids[t], BoundsMin), 1023.0f / MaxExtent);
+            const UInt32 Code = ExpandMortonBits(static_cast<UInt32>(Normalized.X)) | (ExpandMortonBits(static_cast<UInt32>(Normalized.Y)) << 1) | (ExpandMortonBits(static_cast<UInt32>(Normalized.Z)) << 2);
+            SpatialOrder[t] = std::make_pair(Code, t);
+        }
+
+        std::sort(SpatialOrder.begin(), SpatialOrder.end());
+
+        std::vector<UInt8> Used(TriangleCount, 0);
+        std::vector<int> SlotStamp(VertexCount, -1);
+        std::vector<int> Slot(VertexCount, 0);
+
+        std::vector<int> CurVertices;
+        std::vector<UInt8> CurTriangles;
+        Vector3 CentroidSum;
+        int SpatialCursor = 0;
+
+        auto Flush = [&]()
+        {
+            if (CurTriangles.empty())
+                return;
+
+            MeshletBuilder::Meshlet NewMeshlet;
+            NewMeshlet.MaterialIndex = CurSection.MaterialIndex;
+            NewMeshlet.VertexOffset = static_cast<int>(OutResult.Vertices.size());
+            NewMeshlet.VertexCount = static_cast<int>(CurVertices.size());
+            NewMeshlet.TriangleOffset = static_cast<int>(OutResult.Triangles.size());
+            NewMeshlet.TriangleCount = static_cast<int>(CurTriangles.size() / 3);
+
+            for (const int LocalVertex : CurVertices)
+                OutResult.Vertices.push_back(VertexIndices[LocalVertex]);
+
+            OutResult.Triangles.insert(OutResult.Triangles.end(), CurTriangles.begin(), CurTriangles.end());
+
+            ComputeMeshletBounds(InVertices, OutResult.Vertices.data() + NewMeshlet.VertexOffset, OutResult.Triangles.data() + NewMeshlet.TriangleOffset, NewMeshlet);
+            OutResult.Meshlets.push_back(NewMeshlet);
+
+            CurVertices.clear();
+            CurTriangles.clear();
+            CentroidSum = Vector3();
+        };
+
+        auto CountNewVertices = [&](const int InTriangle)
+        {
+            const int MeshletIndex = static_cast<int>(OutResult.Meshlets.size());
+            int Count = 0;
+
+            for (int k = 0; k < 3; ++k)
+                Count += SlotStamp[Indices[InTriangle * 3 + k]] != MeshletIndex ? 1 : 0;
+
+            return Count;
+        };
+
+        auto IsFit = [&](const int InNewVertices)
+        {
+            return static_cast<int>(CurVertices.size()) + InNewVertices <= InOptions.MaxVertices
+                && static_cast<int>(CurTriangles.size() / 3) + 1 <= InOptions.MaxTriangles;
+        };
+
+        for (int Added = 0; Added < TriangleCount; ++Added)
+        {
+            // 현재 메시렛 정점에 붙은 삼각형 중 새 정점이 가장 적고, 그 다음으로 중심에 가까운 것
+            int Best = -1;
+            int BestNewVertices = 4;
+            float BestDistance = FLT_MAX;
+
+            if (CurTriangles.empty() == false)
+            {
+                const Vector3 Center = Math::Scale(CentroidSum, 3.0f / CurTriangles.size());
+
+                for (const int LocalVertex : CurVertices)
+                {
+                    for (int a = AdjacencyOffset[LocalVertex]; a < AdjacencyOffset[LocalVertex + 1]; ++a)
+                    {
+                        const int t = Adjacency[a];
+                        if (Used[t] != 0)
+                            continue;
+
+                        const int NewVertices = CountNewVertices(t);
+                        if (IsFit(NewVertices) == false || NewVertices > BestNewVertices)
+                            continue;
+
+                        const float Distance = Math::LengthSquared(Math::Sub(Centroids[t], Center));
+                        if (NewVertices < BestNewVertices || Distance < BestDistance)
+                        {
+                            Best = t;
+                            BestNewVertices = NewVertices;
+                            BestDistance = Distance;
+                        }
+                    }
+                }
+            }
+
+            // 붙일 이웃이 없으면 떨어진 삼각형이 섞이지 않도록 현재 메시렛을 닫고 공간 순서상 다음 삼각형으로 새로 시작
+            if (Best < 0)
+            {
+                Flush();
+
+                while (Used[SpatialOrder[SpatialCursor].second] != 0)
+                    ++SpatialCursor;
+
+                Best = SpatialOrder[SpatialCursor].second;
+            }
+
+            const int MeshletIndex = static_cast<int>(OutResult.Meshlets.size());
+            for (int k = 0; k < 3; ++k)
+            {
+                const int LocalVertex = Indices[Best * 3 + k];
+                if (SlotStamp[LocalVertex] != MeshletIndex)
+                {
+                    SlotStamp[LocalVertex] = MeshletIndex;
+                    Slot[LocalVertex] = static_cast<int>(CurVertices.size());
+                    CurVertices.push_back(LocalVertex);
+                }
+
+                CurTriangles.push_back(static_cast<UInt8>(Slot[LocalVertex]));
+            }
+
+            Used[Best] = 1;
+            CentroidSum = Math::Add(CentroidSum, Centroids[Best]);
+        }
+
+        Flush();
+    }
+
+    MeshletBuilder::~MeshletBuilder()
+    {
+        Delete();
+    }
+
+    bool MeshletBuilder::Build(const PMXMeshData& InMeshData, const MeshletOptions& InOptions)
+    {
+        Delete();
+
+        MeshSectionBuilder Sections;
+        if (Sections.Build(InMeshData) == false)
+            return false;
+
+        // 로컬 정점 번호를 UInt8 로 저장하므로 256 개까지
+        MeshletOptions Options = InOptions;
+        Options.MaxVertices = std::min(std::max(Options.MaxVertices, 3), 256);
+        Options.MaxTriangles = std::max(Options.MaxTriangles, 1);
+
+        std::vector<MeshletSectionResult> Results(Sections.GetSectionCount());
+
+        ParallelFor(Sections.GetSectionCount(), 1, [&](const int Begin, const int End)
+        {
+            for (int s = Begin; s < End; ++s)
+                BuildSectionMeshlets(InMeshData.GetVertices(), Sections, s, Options, Results[s]);
+        });
+
+        for (const MeshletSectionResult& Result : Results)
+        {
+            MeshletCount += static_cast<int>(Result.Meshlets.size());
+            MeshletVertexCount += static_cast<int>(Result.Vertices.size());
+            MeshletTriangleCount += static_cast<int>(Result.Triangles.size() / 3);
+        }
+
+        if (MeshletCount <= 0)
+            return false;
+
+        ArrayMeshlet = new Meshlet[MeshletCount];
+        ArrayMeshletVertex = new int[MeshletVertexCount];
+        ArrayMeshletTriangle = new UInt8[static_cast<MemSize>(MeshletTriangleCount) * 3];
+
+        int MeshletCursor = 0;
+        int VertexCursor = 0;
+        int TriangleCursor = 0;
+
+        for (const MeshletSectionResult& Result : Results)
+        {
+            for (Meshlet CurMeshlet : Result.Meshlets)
+            {
+                CurMeshlet.VertexOffset += VertexCursor;
+                CurMeshlet.TriangleOffset += TriangleCursor;
+                ArrayMeshlet[MeshletCursor++] = CurMeshlet;
+            }
+
+            std::copy(Result.Vertices.begin(), Result.Vertices.end(), ArrayMeshletVertex + VertexCursor);
+            std::copy(Result.Triangles.begin(), Result.Triangles.end(), ArrayMeshletTriangle + TriangleCursor);
+
+            VertexCursor += static_cast<int>(Result.Vertices.size());
+            TriangleCursor += static_cast<int>(Result.Triangles.size());
+        }
+
+        return true;
+    }
+
+    void MeshletBuilder::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayMeshlet);
+        MeshletCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayMeshletVertex);
+        MeshletVertexCount = 0;
+
+        PMX_SAFE_DELETE_ARRAY(ArrayMeshletTriangle);
+        MeshletTriangleCount = 0;
+    }
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct MeshletOptions
+    {
+        // 메시 셰이더 출력 제한에 맞춘 기본값
+        int MaxVertices = 64;
+        int MaxTriangles = 124;
+    };
+
+    /**
+     * 재질별 삼각형을 정점/삼각형 수가 제한된 작은 묶음(메시렛)으로 나눔
+     * : 이웃 삼각형 중 새 정점이 가장 적게 늘어나는 것을 차례로 붙이고, 이웃이 없으면 메시렛을 닫고 공간 순서(Morton)상 다음 삼각형으로 새 메시렛을 시작합니다.
+     */
+    class MeshletBuilder
+    {
+    public:
+        struct Meshlet
+        {
+            int MaterialIndex = 0;
+
+            // ArrayMeshletVertex 범위. 원본 정점 인덱스
+            int VertexOffset = 0;
+            int VertexCount = 0;
+
+            // ArrayMeshletTriangle 의 TriangleOffset 부터 TriangleCount * 3 개. 메시렛 안의 로컬 정점 번호
+            int TriangleOffset = 0;
+            int TriangleCount = 0;
+
+            // 바운딩 구
+            Vector3 Center;
+            float Radius = 0;
+
+            // 법선 원뿔. dot(Normalize(ConeApex - CameraPosition), ConeAxis) > ConeCutoff 이면 모든 삼각형이 뒷면
+            // : 법선이 넓게 퍼져 있으면 ConeCutoff = 1 로 절대 컬링되지 않음
+            Vector3 ConeApex;
+            Vector3 ConeAxis;
+            float ConeCutoff = 1.0f;
+        };
+
+    public:
+        ~MeshletBuilder();
+
+        bool Build(const PMXMeshData& InMeshData, const MeshletOptions& InOptions = MeshletOptions());
+        void Delete();
+
+        int GetMeshletCount() const { return MeshletCount; }
+        const Meshlet* GetMeshlets() const { return ArrayMeshlet; }
+
+        int GetMeshletVertexCount() const { return MeshletVertexCount; }
+        const int* GetMeshletVertices() const { return ArrayMeshletVertex; }
+
+        int GetMeshletTriangleCount() const { return MeshletTriangleCount; }
+        const UInt8* GetMeshletTriangles() const { return ArrayMeshletTriangle; }
+
+    protected:
+        int MeshletCount = 0;
+        Meshlet* ArrayMeshlet = nullptr;
+
+        int MeshletVertexCount = 0;
+        int* ArrayMeshletVertex = nullptr;
+
+        // 삼각형 수. 배열 크기는 * 3
+        int MeshletTriangleCount = 0;
+        UInt8* ArrayMeshletTriangle = nullptr;
+    };
+}
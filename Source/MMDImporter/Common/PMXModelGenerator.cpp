@@ -0,0 +1,628 @@
+﻿#include "PMXModelGenerator.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace PMX
+{
+    static constexpr int StressVertexBatchSize = 16384;
+
+    // 원통 크기 (MMD 단위)
+    static constexpr float StressModelRadius = 2.0f;
+    static constexpr float StressModelHeight = 20.0f;
+
+    static constexpr float StressModelPI = 3.14159265358979f;
+
+    // 시드와 번호로 정하는 난수. 스레드 수와 관계없이 같은 값
+    static UInt64 StressHash(const UInt64 InSeed, const UInt64 InIndex)
+    {
+        UInt64 Value = InSeed * 0x9E3779B97F4A7C15ull + InIndex + 1;
+        Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+        return Value ^ (Value >> 31);
+    }
+
+    // [0, 1)
+    static float StressRandom(const UInt64 InSeed, const UInt64 InIndex)
+    {
+        return static_cast<float>(StressHash(InSeed, InIndex) >> 40) / static_cast<float>(1 << 24);
+    }
+
+    // ReadText 와 같은 규칙으로 버퍼를 만듦. ASCII 만 받음
+    static void SetStressText(Text& OutText, const char* InASCII, const Text::EncodingType InEncoding)
+    {
+        OutText.Delete();
+
+        const int Length = static_cast<int>(strlen(InASCII));
+        if (Length == 0)
+            return;
+
+        if (InEncoding == Text::UTF8)
+        {
+            Byte* Buffer = new Byte[Length + 3]{ 0 };
+            memcpy(Buffer, InASCII, Length);
+            OutText.SetText(Buffer, Length, InEncoding);
+        }
+        else
+        {
+            Byte* Buffer = new Byte[Length * 2 + 2]{ 0 };
+            for (int i = 0; i < Length; ++i)
+                Buffer[i * 2] = InASCII[i];
+
+            OutText.SetText(Buffer, Length * 2, InEncoding);
+        }
+    }
+
+    template <class T>
+    static T* AllocStressArray(const int InCount)
+    {
+        if (InCount <= 0)
+            return nullptr;
+
+        return new T[InCount]();
+    }
+
+    // BDEF4 / QDEF 공통. 가운데 두 본에 대부분, 바깥 두 본에 조금
+    template <class T>
+    static T* FillFourBones(T* OutData, const int InBoneBefore, const int InBone0, const int InBone1, const int InBoneAfter, const float InAlpha)
+    {
+        OutData->BoneIndex0 = InBoneBefore;
+        OutData->BoneIndex1 = InBone0;
+        OutData->BoneIndex2 = InBone1;
+        OutData->BoneIndex3 = InBoneAfter;
+        OutData->Weight0 = 0.2f * (1.0f - InAlpha);
+        OutData->Weight1 = 0.8f * (1.0f - InAlpha);
+        OutData->Weight2 = 0.8f * InAlpha;
+        OutData->Weight3 = 0.2f * InAlpha;
+        return OutData;
+    }
+
+    bool GenerateStressModel(const StressModelOptions& InOptions, PMXMeshData& OutMeshData)
+    {
+        OutMeshData.Delete();
+
+        const int VertexCount = InOptions.VertexCount;
+        const int BoneCount = InOptions.BoneCount;
+        const int MaterialCount = InOptions.MaterialCount;
+        const int MorphCount = InOptions.MorphCount > 0 ? InOptions.MorphCount : 0;
+        const int RigidbodyCount = InOptions.RigidbodyCount > 0 ? InOptions.RigidbodyCount : 0;
+        const int SoftBodyCount = InOptions.SoftBodyCount > 0 ? InOptions.SoftBodyCount : 0;
+        const Text::EncodingType Encoding = InOptions.TextEncoding == Text::UTF8 ? Text::UTF8 : Text::UTF16LE;
+
+        if (VertexCount < 4 || BoneCount < 1 || MaterialCount < 1 || InOptions.AdditionalVectorCount < 0 || InOptions.AdditionalVectorCount > 4)
+            return false;
+
+        // 원통 격자. 마지막 줄은 다 차지 않을 수 있음
+        const int Columns = std::max(2, static_cast<int>(ceil(sqrt(static_cast<double>(VertexCount)))));
+        const int Rows = (VertexCount + Columns - 1) / Columns;
+
+        long long CellCount = 0;
+        for (int r = 0; r + 1 < Rows; ++r)
+            CellCount += std::max(0, std::min(Columns - 1, VertexCount - (r + 1) * Columns - 1));
+
+        if (CellCount * 2 * 3 > 0x7FFFFFFF)
+            return false;
+
+        // 마지막 본은 IK
+        const bool bIK = BoneCount >= 4;
+        const int ChainCount = bIK ? BoneCount - 1 : BoneCount;
+
+        auto GetChainPosition = [&](const int InChainIndex)
+        {
+            const float Height = ChainCount > 1 ? StressModelHeight * InChainIndex / (ChainCount - 1) : 0.0f;
+            return Math::MakeVector3(0, Height, 0);
+        };
+
+        float DeformMixSum = 0;
+        for (const float Mix : InOptions.DeformMix)
+            DeformMixSum += Mix > 0 ? Mix : 0;
+
+        // 헤더
+        Header& HeaderData = OutMeshData.HeaderData;
+        HeaderData.Signature[0] = 'P';
+        HeaderData.Signature[1] = 'M';
+        HeaderData.Signature[2] = 'X';
+        HeaderData.Signature[3] = ' ';
+        HeaderData.Version = (SoftBodyCount > 0 || InOptions.DeformMix[4] > 0) ? 2.1f : 2.0f;
+        HeaderData.TextEncoding = Encoding;
+        HeaderData.AdditionalVectorCount = static_cast<UInt8>(InOptions.AdditionalVectorCount);
+        HeaderData.VertexIndexSize = GetIndexSize(IndexType::Vertex, VertexCount);
+        HeaderData.TextureIndexSize = GetIndexSize(IndexType::Texture, MaterialCount);
+        HeaderData.MaterialIndexSize = GetIndexSize(IndexType::Material, MaterialCount);
+        HeaderData.BoneIndexSize = GetIndexSize(IndexType::Bone, BoneCount);
+        HeaderData.MorphIndexSize = GetIndexSize(IndexType::Morph, MorphCount);
+        HeaderData.RigidbodyIndexSize = GetIndexSize(IndexType::Rigidbody, RigidbodyCount);
+
+        char Name[128];
+
+        SetStressText(OutMeshData.ModelInfoData.NameLocal, "StressModel", Encoding);
+        SetStressText(OutMeshData.ModelInfoData.NameUniversal, "StressModel", Encoding);
+
+        snprintf(Name, sizeof(Name), "vertices %d, bones %d, morphs %d, materials %d, seed %u", VertexCount, BoneCount, MorphCount, MaterialCount, InOptions.Seed);
+        SetStressText(OutMeshData.ModelInfoData.CommentsLocal, Name, Encoding);
+        SetStressText(OutMeshData.ModelInfoData.CommentsUniversal, Name, Encoding);
+
+        // 정점
+        OutMeshData.VertexCount = VertexCount;
+        OutMeshData.ArrayVertex = AllocStressArray<VertexData>(VertexCount);
+
+        ParallelFor(VertexCount, StressVertexBatchSize, [&](const int Begin, const int End)
+        {
+            for (int v = Begin; v < End; ++v)
+            {
+                VertexData& Vertex = OutMeshData.ArrayVertex[v];
+
+                const int Row = v / Columns;
+                const int Column = v % Columns;
+                const float U = static_cast<float>(Column) / (Columns - 1);
+                const float V = Rows > 1 ? static_cast<float>(Row) / (Rows - 1) : 0.0f;
+                const float Angle = U * 2.0f * StressModelPI;
+
+                Vertex.Normal = Math::MakeVector3(cosf(Angle), 0, sinf(Angle));
+                Vertex.Position = Math::MakeVector3(Vertex.Normal.X * StressModelRadius, V * StressModelHeight, Vertex.Normal.Z * StressModelRadius);
+                Vertex.UV.X = U;
+                Vertex.UV.Y = 1.0f - V;
+                Vertex.EdgeScale = 1.0f;
+
+                for (int k = 0; k < InOptions.AdditionalVectorCount; ++k)
+                    Vertex.Additional[k] = Math::MakeVector4(U, V, static_cast<float>(k), 1.0f);
+
+                // 높이에 따라 이웃한 사슬 본 두 개 사이를 보간
+                const float ChainPosition = V * (ChainCount - 1);
+                const int Bone0 = std::min(static_cast<int>(ChainPosition), ChainCount - 1);
+                const int Bone1 = std::min(Bone0 + 1, ChainCount - 1);
+                const int BoneBefore = std::max(Bone0 - 1, 0);
+                const int BoneAfter = std::min(Bone1 + 1, ChainCount - 1);
+                const float Alpha = ChainPosition - Bone0;
+
+                int DeformType = 0;
+                if (DeformMixSum > 0)
+                {
+                    float Pick = StressRandom(InOptions.Seed, v) * DeformMixSum;
+                    for (DeformType = 0; DeformType < 4; ++DeformType)
+                    {
+                        Pick -= InOptions.DeformMix[DeformType] > 0 ? InOptions.DeformMix[DeformType] : 0;
+                        if (Pick < 0)
+                            break;
+                    }
+                }
+
+                Vertex.DeformType = static_cast<VertexData::WeightDeformType>(DeformType);
+
+                switch (Vertex.DeformType)
+                {
+                    case VertexData::WeightDeformType::BDEF1:
+                        {
+                            VertexData::BDEF1* Data = new VertexData::BDEF1;
+                            Data->BoneIndex0 = Alpha < 0.5f ? Bone0 : Bone1;
+                            Vertex.Deform = Data;
+                        }
+                        break;
+                    case VertexData::WeightDeformType::BDEF2:
+                        {
+                            VertexData::BDEF2* Data = new VertexData::BDEF2;
+                            Data->BoneIndex0 = Bone0;
+                            Data->BoneIndex1 = Bone1;
+                            Data->Weight0 = 1.0f - Alpha;
+                            Data->Weight1 = Alpha;
+                            Vertex.Deform = Data;
+                        }
+                        break;
+                    case VertexData::WeightDeformType::SDEF:
+                        {
+                            VertexData::SDEF* Data = new VertexData::SDEF;
+                            Data->BoneIndex0 = Bone0;
+                            Data->BoneIndex1 = Bone1;
+                            Data->Weight0 = 1.0f - Alpha;
+                            Data->Weight1 = Alpha;
+                            Data->C = Math::MakeVector3(0, Vertex.Position.Y, 0);
+                            Data->R0 = GetChainPosition(Bone0);
+                            Data->R1 = GetChainPosition(Bone1);
+                            Vertex.Deform = Data;
+                        }
+                        break;
+                    case VertexData::WeightDeformType::BDEF4:
+                        Vertex.Deform = FillFourBones(new VertexData::BDEF4, BoneBefore, Bone0, Bone1, BoneAfter, Alpha);
+                        break;
+                    case VertexData::WeightDeformType::QDEF:
+                        Vertex.Deform = FillFourBones(new VertexData::QDEF, BoneBefore, Bone0, Bone1, BoneAfter, Alpha);
+                        break;
+                }
+            }
+        });
+
+        // 삼각형
+        OutMeshData.SurfaceCount = static_cast<int>(CellCount * 2);
+        OutMeshData.ArraySurface = AllocStressArray<SurfaceData>(OutMeshData.SurfaceCount);
+
+        int SurfaceIndex = 0;
+        for (int r = 0; r + 1 < Rows; ++r)
+        {
+            for (int c = 0; c + 1 < Columns; ++c)
+            {
+                const int V00 = r * Columns + c;
+                const int V01 = V00 + 1;
+                const int V10 = V00 + Columns;
+                const int V11 = V10 + 1;
+
+                if (V11 >= VertexCount)
+                    break;
+
+                SurfaceData* Surfaces = OutMeshData.ArraySurface + SurfaceIndex;
+                Surfaces[0].VertexIndex[0] = V00;
+                Surfaces[0].VertexIndex[1] = V10;
+                Surfaces[0].VertexIndex[2] = V01;
+                Surfaces[1].VertexIndex[0] = V01;
+                Surfaces[1].VertexIndex[1] = V10;
+                Surfaces[1].VertexIndex[2] = V11;
+
+                SurfaceIndex += 2;
+            }
+        }
+
+        // 텍스처, 재질. 삼각형을 순서대로 나눔
+        OutMeshData.TextureCount = MaterialCount;
+        OutMeshData.ArrayTexture = AllocStressArray<TextureData>(MaterialCount);
+        OutMeshData.MaterialCount = MaterialCount;
+        OutMeshData.ArrayMaterial = AllocStressArray<MaterialData>(MaterialCount);
+
+        for (int m = 0; m < MaterialCount; ++m)
+        {
+            snprintf(Name, sizeof(Name), "tex\\material_%03d.png", m);
+            SetStressText(OutMeshData.ArrayTexture[m].Path, Name, Encoding);
+
+            MaterialData& Material = OutMeshData.ArrayMaterial[m];
+
+            snprintf(Name, sizeof(Name), "Material_%03d", m);
+            SetStressText(Material.NameLocal, Name, Encoding);
+            SetStressText(Material.NameUniversal, Name, Encoding);
+
+            const float Tint = static_cast<float>(m) / MaterialCount;
+            Material.DiffuseColor = Math::MakeVector4(1.0f, 1.0f - Tint * 0.5f, 0.5f + Tint * 0.5f, 1.0f);
+            Material.SpecularColor = Math::MakeVector3(0.1f, 0.1f, 0.1f);
+            Material.SpecularStrength = 5.0f;
+            Material.AmbientColor = Math::MakeVector3(0.5f, 0.5f, 0.5f);
+            Material.DrawingFlags = static_cast<MaterialData::Flag>(
+                static_cast<UInt8>(MaterialData::Flag::NoCull) | static_cast<UInt8>(MaterialData::Flag::GroundShadow) |
+                static_cast<UInt8>(MaterialData::Flag::DrawShadow) | static_cast<UInt8>(MaterialData::Flag::ReceiveShadow) |
+                static_cast<UInt8>(MaterialData::Flag::HasEdge));
+            Material.EdgeColor = Math::MakeVector4(0, 0, 0, 1);
+            Material.EdgeScale = 1.0f;
+            Material.TextureIndex = m;
+            Material.EnvironmentTextureIndex = -1;
+            Material.EnvironmentBlendMode = MaterialData::BlendModeType::Disable;
+            Material.ToonReference = MaterialData::ToonReferenceType::Internal;
+            Material.ToonValue = m % 10;
+
+            const long long FirstSurface = static_cast<long long>(OutMeshData.SurfaceCount) * m / MaterialCount;
+            const long long EndSurface = static_cast<long long>(OutMeshData.SurfaceCount) * (m + 1) / MaterialCount;
+            Material.SurfaceCount = static_cast<int>((EndSurface - FirstSurface) * 3);
+        }
+
+        // 본. 0번은 루트, 사슬은 원통 축을 따라 올라감
+        OutMeshData.BoneCount = BoneCount;
+        OutMeshData.ArrayBone = AllocStressArray<BoneData>(BoneCount);
+
+        const UInt16 ChainFlags = BoneData::Flag::Rotatable | BoneData::Flag::IsVisible | BoneData::Flag::Enabled;
+
+        for (int b = 0; b < ChainCount; ++b)
+        {
+            BoneData& Bone = OutMeshData.ArrayBone[b];
+
+            snprintf(Name, sizeof(Name), b == 0 ? "Root" : "Bone_%03d", b);
+            SetStressText(Bone.NameLocal, Name, Encoding);
+            SetStressText(Bone.NameUniversal, Name, Encoding);
+
+            Bone.Position = GetChainPosition(b);
+            Bone.ParentBoneIndex = b - 1;
+
+            UInt16 Flags = ChainFlags | (b == 0 ? BoneData::Flag::Translatable : 0);
+
+            if (b + 1 < ChainCount)
+            {
+                Flags |= BoneData::Flag::IndexedTailPosition;
+                Bone.TailPositionData.BoneIndex = b + 1;
+            }
+            else
+            {
+                Bone.TailPositionData.Vector3 = Math::MakeVector3(0, 1.0f, 0);
+            }
+
+            // 선택 데이터가 있는 본도 섞음
+            if (b > 0 && b % 8 == 0)
+            {
+                Flags |= BoneData::Flag::InheritRotation;
+                Bone.InheritBoneData = new struct BoneData::InheritBone();
+                Bone.InheritBoneData->ParentBoneIndex = b - 1;
+                Bone.InheritBoneData->ParentInfluence = 0.5f;
+            }
+
+            if (b % 16 == 5)
+            {
+                Flags |= BoneData::Flag::FixedAxis;
+                Bone.FixedAxisData = new struct BoneData::FixedAxis();
+                Bone.FixedAxisData->AxisDirection = Math::MakeVector3(0, 1.0f, 0);
+            }
+
+            if (b % 16 == 9)
+            {
+                Flags |= BoneData::Flag::LocalCoordinate;
+                Bone.LocalCoordinateData = new struct BoneData::LocalCoordinate();
+                Bone.LocalCoordinateData->XVector = Math::MakeVector3(1.0f, 0, 0);
+                Bone.LocalCoordinateData->ZVector = Math::MakeVector3(0, 0, 1.0f);
+            }
+
+            Bone.Flags = static_cast<BoneData::Flag>(Flags);
+        }
+
+        if (bIK)
+        {
+            BoneData& Bone = OutMeshData.ArrayBone[ChainCount];
+
+            SetStressText(Bone.NameLocal, "Chain_IK", Encoding);
+            SetStressText(Bone.NameUniversal, "Chain_IK", Encoding);
+
+            Bone.Position = GetChainPosition(ChainCount - 1);
+            Bone.ParentBoneIndex = 0;
+            Bone.Flags = static_cast<BoneData::Flag>(ChainFlags | BoneData::Flag::Translatable | BoneData::Flag::UseIK);
+
+            Bone.IKData.TargetIndex = ChainCount - 1;
+            Bone.IKData.LoopCount = 40;
+            Bone.IKData.LimitRadian = 1.0f;
+            Bone.IKData.LinkCount = std::min(3, ChainCount - 2);
+            Bone.IKData.ArrayLink = AllocStressArray<BoneData::IK::LinkData>(Bone.IKData.LinkCount);
+
+            for (int l = 0; l < Bone.IKData.LinkCount; ++l)
+            {
+                auto& Link = Bone.IKData.ArrayLink[l];
+                Link.BoneIndex = ChainCount - 2 - l;
+
+                // 첫 링크는 무릎처럼 X 축으로만 굽힘
+                Link.HasLimit = l == 0 ? 1 : 0;
+                Link.LimitData.Min = Math::MakeVector3(-StressModelPI, 0, 0);
+                Link.LimitData.Max = Math::MakeVector3(-0.01f, 0, 0);
+            }
+        }
+
+        // 모프. 정점/정점/UV/본/재질 순서로 돌아가며, 마지막은 그룹
+        OutMeshData.MorphCount = MorphCount;
+        OutMeshData.ArrayMorph = AllocStressArray<MorphData>(MorphCount);
+
+        const int MorphOffsetCount = std::max(1, std::min(InOptions.MorphOffsetCount, VertexCount));
+        const int GroupedCount = std::min(MorphCount - 1, 8);
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            MorphData& Morph = OutMeshData.ArrayMorph[i];
+
+            snprintf(Name, sizeof(Name), "Morph_%03d", i);
+            SetStressText(Morph.NameLocal, Name, Encoding);
+            SetStressText(Morph.NameUniversal, Name, Encoding);
+
+            static const MorphData::MorphType CycleTypes[] =
+            {
+                MorphData::MorphType::Vertex,
+                MorphData::MorphType::Vertex,
+                MorphData::MorphType::UV,
+                MorphData::MorphType::Bone,
+                MorphData::MorphType::Material,
+            };
+
+            Morph.Type = (MorphCount >= 2 && i == MorphCount - 1) ? MorphData::MorphType::Group : CycleTypes[i % 5];
+            Morph.PanelType = Morph.Type == MorphData::MorphType::Vertex ? static_cast<UInt8>(1 + i % 3) : 4;
+
+            // 정점/UV 모프는 임의 위치부터 이어진 정점들
+            const int FirstVertex = static_cast<int>(StressHash(InOptions.Seed, 0x100000000ull + i) % static_cast<UInt64>(VertexCount - MorphOffsetCount + 1));
+
+            switch (Morph.Type)
+            {
+                case MorphData::MorphType::Vertex:
+                    {
+                        MorphData::OffsetVertex* Offsets = AllocStressArray<MorphData::OffsetVertex>(MorphOffsetCount);
+                        for (int j = 0; j < MorphOffsetCount; ++j)
+                        {
+                            Offsets[j].VertexIndex = FirstVertex + j;
+                            Offsets[j].PositionOffset = Math::Scale(OutMeshData.ArrayVertex[FirstVertex + j].Normal, 0.1f);
+                        }
+
+                        Morph.ArrayOffset = Offsets;
+                        Morph.OffsetCount = MorphOffsetCount;
+                    }
+                    break;
+                case MorphData::MorphType::UV:
+                    {
+                        MorphData::OffsetUV* Offsets = AllocStressArray<MorphData::OffsetUV>(MorphOffsetCount);
+                        for (int j = 0; j < MorphOffsetCount; ++j)
+                        {
+                            Offsets[j].VertexIndex = FirstVertex + j;
+                            Offsets[j].UVOffset = Math::MakeVector4(0.01f, 0, 0, 0);
+                        }
+
+                        Morph.ArrayOffset = Offsets;
+                        Morph.OffsetCount = MorphOffsetCount;
+                    }
+                    break;
+                case MorphData::MorphType::Bone:
+                    {
+                        const int Count = std::min(ChainCount, 4);
+                        MorphData::OffsetBone* Offsets = AllocStressArray<MorphData::OffsetBone>(Count);
+                        for (int j = 0; j < Count; ++j)
+                        {
+                            Offsets[j].BoneIndex = ChainCount - 1 - j;
+                            Offsets[j].MoveValue = Math::MakeVector3(0, 0.1f, 0);
+                            Offsets[j].RotationValue = Math::QuatFromAxisAngle(Math::MakeVector3(1.0f, 0, 0), 0.1f);
+                        }
+
+                        Morph.ArrayOffset = Offsets;
+                        Morph.OffsetCount = Count;
+                    }
+                    break;
+                case MorphData::MorphType::Material:
+                    {
+                        MorphData::OffsetMaterial* Offsets = AllocStressArray<MorphData::OffsetMaterial>(1);
+                        Offsets[0].MaterialIndex = i % MaterialCount;
+                        Offsets[0].OffsetMethod = MorphData::OffsetMaterial::MethodType::Multiply;
+                        Offsets[0].DiffuseColor = Math::MakeVector4(1.0f, 0.8f, 0.8f, 1.0f);
+                        Offsets[0].SpecularColor = Math::MakeVector3(1.0f, 1.0f, 1.0f);
+                        Offsets[0].Specularity = 1.0f;
+                        Offsets[0].AmbientColor = Math::MakeVector3(1.0f, 1.0f, 1.0f);
+                        Offsets[0].EdgeColor = Math::MakeVector4(1.0f, 1.0f, 1.0f, 1.0f);
+                        Offsets[0].EdgeSize = 1.0f;
+                        Offsets[0].TextureTint = Math::MakeVector4(1.0f, 1.0f, 1.0f, 1.0f);
+                        Offsets[0].EnvironmentTint = Math::MakeVector4(1.0f, 1.0f, 1.0f, 1.0f);
+                        Offsets[0].ToonTint = Math::MakeVector4(1.0f, 1.0f, 1.0f, 1.0f);
+
+                        Morph.ArrayOffset = Offsets;
+                        Morph.OffsetCount = 1;
+                    }
+                    break;
+                case MorphData::MorphType::Group:
+                    {
+                        MorphData::OffsetGroup* Offsets = AllocStressArray<MorphData::OffsetGroup>(GroupedCount);
+                        for (int j = 0; j < GroupedCount; ++j)
+                        {
+                            Offsets[j].MorphIndex = j;
+                            Offsets[j].Rate = 0.5f;
+                        }
+
+                        Morph.ArrayOffset = Offsets;
+                        Morph.OffsetCount = GroupedCount;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // 표시 프레임. 루트 / 표정 / 사슬 본
+        OutMeshData.DisplayFrameCount = 3;
+        OutMeshData.ArrayDisplayFrame = AllocStressArray<DisplayFrameData>(3);
+
+        const char* const FrameNames[3] = { "Root", "Exp", "Bones" };
+        const int FrameCounts[3] = { 1, MorphCount, BoneCount - 1 };
+
+        for (int f = 0; f < 3; ++f)
+        {
+            DisplayFrameData& DisplayFrame = OutMeshData.ArrayDisplayFrame[f];
+
+            SetStressText(DisplayFrame.NameLocal, FrameNames[f], Encoding);
+            SetStressText(DisplayFrame.NameUniversal, FrameNames[f], Encoding);
+
+            DisplayFrame.SpecialFlag = f < 2 ? 1 : 0;
+            DisplayFrame.FrameCount = FrameCounts[f];
+            DisplayFrame.ArrayFrame = AllocStressArray<DisplayFrameData::Frame>(FrameCounts[f]);
+
+            for (int j = 0; j < FrameCounts[f]; ++j)
+            {
+                DisplayFrame.ArrayFrame[j].Type = f == 1 ? DisplayFrameData::Frame::FrameType::Morph : DisplayFrameData::Frame::FrameType::Bone;
+                DisplayFrame.ArrayFrame[j].Index = f == 2 ? j + 1 : j;
+            }
+        }
+
+        // 강체. 사슬 본마다 캡슐을 두고 이웃끼리 조인트로 이음
+        OutMeshData.RigidbodyCount = RigidbodyCount;
+        OutMeshData.ArrayRigidbody = AllocStressArray<RigidbodyData>(RigidbodyCount);
+
+        for (int k = 0; k < RigidbodyCount; ++k)
+        {
+            RigidbodyData& Rigidbody = OutMeshData.ArrayRigidbody[k];
+
+            snprintf(Name, sizeof(Name), "Rigidbody_%03d", k);
+            SetStressText(Rigidbody.NameLocal, Name, Encoding);
+            SetStressText(Rigidbody.NameUniversal, Name, Encoding);
+
+            Rigidbody.BoneIndexRelated = ChainCount > 1 ? 1 + k % (ChainCount - 1) : 0;
+            Rigidbody.GroupID = static_cast<UInt8>(k % 16);
+            Rigidbody.NonCollisionGroupMask = static_cast<UInt16>(1 << Rigidbody.GroupID);
+            Rigidbody.ShapeType = RigidbodyData::ShapeType::Capsule;
+            Rigidbody.ShapeSize = Math::MakeVector3(0.3f, 1.0f, 0);
+            Rigidbody.ShapePosition = Math::Add(GetChainPosition(Rigidbody.BoneIndexRelated), Math::MakeVector3(StressModelRadius, 0, 0));
+            Rigidbody.Mass = 1.0f;
+            Rigidbody.MoveAttenuation = 0.5f;
+            Rigidbody.RotationDamping = 0.5f;
+            Rigidbody.FrictionForce = 0.5f;
+            Rigidbody.PhysicsMode = k == 0 ? RigidbodyData::PhysicsMode::FollowBone : RigidbodyData::PhysicsMode::Physics;
+        }
+
+        OutMeshData.JointCount = RigidbodyCount > 1 ? RigidbodyCount - 1 : 0;
+        OutMeshData.ArrayJoint = AllocStressArray<JointData>(OutMeshData.JointCount);
+
+        for (int k = 0; k < OutMeshData.JointCount; ++k)
+        {
+            JointData& Joint = OutMeshData.ArrayJoint[k];
+
+            snprintf(Name, sizeof(Name), "Joint_%03d", k);
+            SetStressText(Joint.NameLocal, Name, Encoding);
+            SetStressText(Joint.NameUniversal, Name, Encoding);
+
+            const RigidbodyData& RigidbodyA = OutMeshData.ArrayRigidbody[k];
+            const RigidbodyData& RigidbodyB = OutMeshData.ArrayRigidbody[k + 1];
+
+            Joint.Type = JointData::JointType::Spring6DOF;
+            Joint.RigidbodyIndexA = k;
+            Joint.RigidbodyIndexB = k + 1;
+            Joint.Position = Math::Scale(Math::Add(RigidbodyA.ShapePosition, RigidbodyB.ShapePosition), 0.5f);
+            Joint.RotationMin = Math::MakeVector3(-0.5f, -0.5f, -0.5f);
+            Joint.RotationMax = Math::MakeVector3(0.5f, 0.5f, 0.5f);
+        }
+
+        // 소프트 바디. 맨 아래 줄 정점을 고정
+        OutMeshData.SoftBodyCount = SoftBodyCount;
+        OutMeshData.ArraySoftBody = AllocStressArray<SoftBodyData>(SoftBodyCount);
+
+        for (int k = 0; k < SoftBodyCount; ++k)
+        {
+            SoftBodyData& SoftBody = OutMeshData.ArraySoftBody[k];
+
+            snprintf(Name, sizeof(Name), "SoftBody_%03d", k);
+            SetStressText(SoftBody.NameLocal, Name, Encoding);
+            SetStressText(SoftBody.NameUniversal, Name, Encoding);
+
+            SoftBody.Shape = SoftBodyData::ShapeType::TriMesh;
+            SoftBody.MaterialIndex = k % MaterialCount;
+            SoftBody.Flags = SoftBodyData::Flags::B_Link;
+            SoftBody.B_LinkCreateDistance = 2;
+            SoftBody.NumberOfClusters = 0;
+            SoftBody.TotalMass = 1.0f;
+            SoftBody.CollisionMargin = 0.05f;
+            SoftBody.AerodynamicsModel = SoftBodyData::AerodynamicModel::V_Point;
+            SoftBody.ConfigVCF = 1.0f;
+            SoftBody.ConfigDF = 0.2f;
+            SoftBody.ConfigCHR = 1.0f;
+            SoftBody.ConfigKHR = 0.1f;
+            SoftBody.ConfigSHR = 1.0f;
+            SoftBody.ConfigAHR = 0.7f;
+            SoftBody.ClusterSRHR_CL = 0.1f;
+            SoftBody.ClusterSKHR_CL = 1.0f;
+            SoftBody.ClusterSSHR_CL = 0.5f;
+            SoftBody.ClusterSR_SPLT_CL = 0.5f;
+            SoftBody.ClusterSK_SPLT_CL = 0.5f;
+            SoftBody.ClusterSS_SPLT_CL = 0.5f;
+            SoftBody.InterationP_IT = 1;
+            SoftBody.InterationC_IT = 4;
+            SoftBody.MaterialLST = 1;
+            SoftBody.MaterialAST = 1;
+            SoftBody.MaterialVST = 1;
+
+            if (RigidbodyCount > 0)
+            {
+                SoftBody.AnchorRigidbodyCount = 1;
+                SoftBody.ArrayAnchorRigidbody = AllocStressArray<SoftBodyData::AnchorRigidbody>(1);
+                SoftBody.ArrayAnchorRigidbody[0].RigidbodyIndex = 0;
+                SoftBody.ArrayAnchorRigidbody[0].VertexIndex = 0;
+            }
+
+            SoftBody.VertexPinCount = std::min(Columns, VertexCount);
+            SoftBody.ArrayVertexPin = AllocStressArray<SoftBodyData::VertexPin>(SoftBody.VertexPinCount);
+
+            for (int j = 0; j < SoftBody.VertexPinCount; ++j)
+                SoftBody.ArrayVertexPin[j].VertexIndex = j;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct StressModelOptions
+    {
+        // 원통 격자 정점 수. 삼각형은 약 2배
+        int VertexCount = 100000;
+
+        // 원통을 따라 세운 본 사슬 수. 4개 이상이면 마지막 본은 사슬 끝을 잡는 IK 본
+        int BoneCount = 64;
+
+        // 정점/UV/본/재질 모프를 돌아가며 만들고, 2개 이상이면 마지막은 그룹 모프
+        int MorphCount = 32;
+
+        // 정점/UV 모프 하나가 움직이는 정점 수
+        int MorphOffsetCount = 1000;
+
+        // 삼각형을 순서대로 나눠 가짐. 재질마다 텍스처 하나
+        int MaterialCount = 4;
+
+        // 0 ~ 4
+        int AdditionalVectorCount = 0;
+
+        // 본 사슬을 따라 둔 캡슐 강체 수와, 이웃끼리 잇는 조인트
+        int RigidbodyCount = 0;
+
+        // 0 보다 크면 2.1 로 만듦
+        int SoftBodyCount = 0;
+
+        // 정점 변형 방식 비율 (BDEF1, BDEF2, BDEF4, SDEF, QDEF). 합이 1 일 필요는 없음
+        // : QDEF 가 있으면 2.1 로 만듦
+        float DeformMix[5] = { 0.3f, 0.4f, 0.2f, 0.1f, 0.0f };
+
+        Text::EncodingType TextEncoding = Text::EncodingType::UTF16LE;
+
+        // 같은 옵션, 같은 시드면 항상 같은 모델
+        unsigned int Seed = 1;
+    };
+
+    /**
+     * 로더 벤치마크 / 부하 테스트용 모델 합성
+     * : 실제 모델에서 쓰는 섹션을 모두 채우며, 정점 수는 수천만까지 키울 수 있습니다.
+     *   정점은 여러 스레드에서 만들지만 결과는 스레드 수와 관계없이 같습니다.
+     */
+    bool GenerateStressModel(const StressModelOptions& InOptions, PMXMeshData& OutMeshData);
+}
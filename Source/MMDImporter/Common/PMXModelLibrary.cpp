@@ -0,0 +1,408 @@
+﻿#include "PMXModelLibrary.h"
+#include "PMXShiftJIS.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace PMX
+{
+    UInt64 HashBytes(const void* InData, const MemSize InSize, const UInt64 InSeed)
+    {
+        const UByte* Data = static_cast<const UByte*>(InData);
+
+        UInt64 Hash = InSeed ^ 0xcbf29ce484222325ull ^ (static_cast<UInt64>(InSize) * 0x9e3779b97f4a7c15ull);
+
+        // 8바이트씩 섞고 남은 바이트는 0 으로 채워 한 번 더 섞음
+        MemSize Offset = 0;
+        for (; Offset + 8 <= InSize; Offset += 8)
+        {
+            UInt64 Word;
+            memcpy(&Word, Data + Offset, 8);
+
+            Hash ^= Word * 0x9e3779b97f4a7c15ull;
+            Hash = ((Hash << 27) | (Hash >> 37)) * 0x100000001b3ull + 0x52dce729ull;
+        }
+
+        if (Offset < InSize)
+        {
+            UInt64 Word = 0;
+            memcpy(&Word, Data + Offset, InSize - Offset);
+
+            Hash ^= Word * 0x9e3779b97f4a7c15ull;
+            Hash = ((Hash << 27) | (Hash >> 37)) * 0x100000001b3ull + 0x52dce729ull;
+        }
+
+        // splitmix64 마무리
+        Hash ^= Hash >> 30;
+        Hash *= 0xbf58476d1ce4e5b9ull;
+        Hash ^= Hash >> 27;
+        Hash *= 0x94d049bb133111ebull;
+        Hash ^= Hash >> 31;
+
+        return Hash;
+    }
+
+    // '\' -> '/', 빈 조각과 "." 제거, ".." 은 앞 조각과 상쇄
+    // : 절대 경로 ('/' 로 시작하거나 "C:" 형태) 가 아니면 InDirectory 기준
+    static std::string NormalizeLibraryPath(const std::string& InDirectory, const std::string& InPath)
+    {
+        std::string Joined;
+
+        const bool bAbsolute = (InPath.empty() == false && (InPath[0] == '/' || InPath[0] == '\\'))
+            || (InPath.size() >= 2 && InPath[1] == ':');
+
+        if (bAbsolute == false && InDirectory.empty() == false)
+        {
+            Joined = InDirectory;
+            Joined.push_back('/');
+        }
+
+        Joined.append(InPath);
+
+        for (char& Character : Joined)
+        {
+            if (Character == '\\')
+                Character = '/';
+        }
+
+        // 루트 ("/" 또는 "C:") 위로는 올라가지 않음. 상대 경로의 앞쪽 ".." 은 남김
+        std::string Root;
+        std::vector<std::string> Segments;
+
+        MemSize Begin = 0;
+        if (Joined.empty() == false && Joined[0] == '/')
+        {
+            Root = "/";
+            Begin = 1;
+        }
+        else if (Joined.size() >= 2 && Joined[1] == ':')
+        {
+            Root = Joined.substr(0, 2);
+            Begin = 2;
+        }
+
+        while (Begin <= Joined.size())
+        {
+            MemSize End = Joined.find('/', Begin);
+            if (End == std::string::npos)
+                End = Joined.size();
+
+            const std::string Segment = Joined.substr(Begin, End - Begin);
+            Begin = End + 1;
+
+            if (Segment.empty() || Segment == ".")
+                continue;
+
+            if (Segment == "..")
+            {
+                if (Segments.empty() == false && Segments.back() != "..")
+                    Segments.pop_back();
+                else if (Root.empty())
+                    Segments.push_back(Segment);
+
+                continue;
+            }
+
+            Segments.push_back(Segment);
+        }
+
+        std::string Result = Root;
+        for (const std::string& Segment : Segments)
+        {
+            if (Result.empty() == false && Result.back() != '/')
+                Result.push_back('/');
+
+            Result.append(Segment);
+        }
+
+        return Result;
+    }
+
+    template<typename T>
+    static void AppendLibraryValue(const T& InValue, std::string& OutKey)
+    {
+        OutKey.append(reinterpret_cast<const char*>(&InValue), sizeof(T));
+    }
+
+    // 이름 경계가 다른 두 목록이 같은 키가 되지 않도록 길이를 먼저 붙임
+    static void AppendLibraryName(const Text& InText, std::string& OutKey, std::string& InOutScratch)
+    {
+        InOutScratch.clear();
+        AppendTextAsUTF8(InText, InOutScratch);
+
+        AppendLibraryValue(static_cast<UInt32>(InOutScratch.size()), OutKey);
+        OutKey.append(InOutScratch);
+    }
+
+    ModelLibrary::ModelLibrary(const ModelLibraryOptions& InOptions)
+        : Options(InOptions)
+    {
+    }
+
+    ModelLibrary::~ModelLibrary()
+    {
+        Delete();
+    }
+
+    int ModelLibrary::AddModel(PMXMeshData* InMeshData, const std::string& InModelDirectory)
+    {
+        if (InMeshData == nullptr)
+            return -1;
+
+        const int ModelIndex = static_cast<int>(Models.size());
+
+        Models.emplace_back();
+        ModelEntry& Entry = Models.back();
+        Entry.MeshData = InMeshData;
+        Entry.Directory = InModelDirectory;
+
+        std::string Scratch;
+
+        Entry.TextureMapping.resize(InMeshData->GetTextureCount(), -1);
+
+        for (int i = 0; i < InMeshData->GetTextureCount(); ++i)
+        {
+            Scratch.clear();
+            AppendTextAsUTF8(InMeshData->GetTextures()[i].Path, Scratch);
+
+            if (Scratch.empty() == false)
+                Entry.TextureMapping[i] = AddTexture(NormalizeLibraryPath(InModelDirectory, Scratch), false, ModelIndex);
+        }
+
+        // 재질: 이름, 메타 데이터, 삼각형 수를 뺀 파라미터 블록
+        // : 텍스처는 모델 번호 대신 공유 번호로 비교해서 텍스처 표 순서가 달라도 같은 재질이면 묶음
+        std::string Key;
+
+        Entry.MaterialMapping.resize(InMeshData->GetMaterialCount(), -1);
+
+        for (int i = 0; i < InMeshData->GetMaterialCount(); ++i)
+        {
+            const MaterialData& Material = InMeshData->GetMaterials()[i];
+
+            auto ToShared = [&Entry](const int InTexture)
+            {
+                return InTexture >= 0 && InTexture < static_cast<int>(Entry.TextureMapping.size()) ? Entry.TextureMapping[InTexture] : -1;
+            };
+
+            const int Texture = ToShared(Material.TextureIndex);
+            const int EnvironmentTexture = ToShared(Material.EnvironmentTextureIndex);
+
+            int ToonTexture = -1;
+            if (Material.ToonReference == MaterialData::ToonReferenceType::Internal)
+            {
+                if (Material.ToonValue >= 0 && Material.ToonValue < 10)
+                {
+                    char ToonPath[32];
+                    snprintf(ToonPath, sizeof(ToonPath), "<internal>/toon%02d.bmp", Material.ToonValue + 1);
+
+                    ToonTexture = AddTexture(ToonPath, true, ModelIndex);
+                }
+            }
+            else
+            {
+                ToonTexture = ToShared(Material.ToonValue);
+            }
+
+            Key.clear();
+            AppendLibraryValue(Material.DiffuseColor, Key);
+            AppendLibraryValue(Material.SpecularColor, Key);
+            AppendLibraryValue(Material.SpecularStrength, Key);
+            AppendLibraryValue(Material.AmbientColor, Key);
+            AppendLibraryValue(Material.DrawingFlags, Key);
+            AppendLibraryValue(Material.EdgeColor, Key);
+            AppendLibraryValue(Material.EdgeScale, Key);
+            AppendLibraryValue(Texture, Key);
+            AppendLibraryValue(EnvironmentTexture, Key);
+            AppendLibraryValue(Material.EnvironmentBlendMode, Key);
+            AppendLibraryValue(Material.ToonReference, Key);
+            AppendLibraryValue(ToonTexture, Key);
+
+            auto Found = MaterialByContent.find(Key);
+            if (Found == MaterialByContent.end())
+            {
+                SharedMaterial Shared;
+                Shared.ContentHash = HashBytes(Key.data(), Key.size());
+                Shared.Model = ModelIndex;
+                Shared.Material = i;
+                Shared.Texture = Texture;
+                Shared.EnvironmentTexture = EnvironmentTexture;
+                Shared.ToonTexture = ToonTexture;
+
+                Found = MaterialByContent.emplace(Key, static_cast<int>(Materials.size())).first;
+                Materials.push_back(Shared);
+            }
+
+            ++Materials[Found->second].ReferenceCount;
+            Entry.MaterialMapping[i] = Found->second;
+        }
+
+        MaterialReferenceCount += InMeshData->GetMaterialCount();
+
+        // 스켈레톤: 본 이름 (일본어), 부모, 위치, 플래그와 플래그에 딸린 데이터
+        if (InMeshData->GetBoneCount() > 0)
+        {
+            Key.clear();
+            AppendLibraryValue(InMeshData->GetBoneCount(), Key);
+
+            for (int i = 0; i < InMeshData->GetBoneCount(); ++i)
+            {
+                const BoneData& Bone = InMeshData->GetBones()[i];
+
+                AppendLibraryName(Bone.NameLocal, Key, Scratch);
+                AppendLibraryValue(Bone.Position, Key);
+                AppendLibraryValue(Bone.ParentBoneIndex, Key);
+                AppendLibraryValue(Bone.Layer, Key);
+                AppendLibraryValue(Bone.Flags, Key);
+
+                if (Bone.Flags & BoneData::Flag::IndexedTailPosition)
+                    AppendLibraryValue(Bone.TailPositionData.BoneIndex, Key);
+                else
+                    AppendLibraryValue(Bone.TailPositionData.Vector3, Key);
+
+                if (Bone.InheritBoneData != nullptr)
+                {
+                    AppendLibraryValue(Bone.InheritBoneData->ParentBoneIndex, Key);
+                    AppendLibraryValue(Bone.InheritBoneData->ParentInfluence, Key);
+                }
+
+                if (Bone.FixedAxisData != nullptr)
+                    AppendLibraryValue(Bone.FixedAxisData->AxisDirection, Key);
+
+                if (Bone.LocalCoordinateData != nullptr)
+                {
+                    AppendLibraryValue(Bone.LocalCoordinateData->XVector, Key);
+                    AppendLibraryValue(Bone.LocalCoordinateData->ZVector, Key);
+                }
+
+                if (Bone.ExternalParentData != nullptr)
+                    AppendLibraryValue(Bone.ExternalParentData->ParentBoneIndex, Key);
+
+                if (Bone.Flags & BoneData::Flag::UseIK)
+                {
+                    AppendLibraryValue(Bone.IKData.TargetIndex, Key);
+                    AppendLibraryValue(Bone.IKData.LoopCount, Key);
+                    AppendLibraryValue(Bone.IKData.LimitRadian, Key);
+                    AppendLibraryValue(Bone.IKData.LinkCount, Key);
+
+                    for (int j = 0; j < Bone.IKData.LinkCount && Bone.IKData.ArrayLink != nullptr; ++j)
+                    {
+                        const BoneData::IK::LinkData& Link = Bone.IKData.ArrayLink[j];
+
+                        AppendLibraryValue(Link.BoneIndex, Key);
+                        AppendLibraryValue(Link.HasLimit, Key);
+
+                        if (Link.HasLimit == 1)
+                        {
+                            AppendLibraryValue(Link.LimitData.Min, Key);
+                            AppendLibraryValue(Link.LimitData.Max, Key);
+                        }
+                    }
+                }
+            }
+
+            auto Found = SkeletonByContent.find(Key);
+            if (Found == SkeletonByContent.end())
+            {
+                SharedSkeleton Shared;
+                Shared.ContentHash = HashBytes(Key.data(), Key.size());
+                Shared.Model = ModelIndex;
+                Shared.BoneCount = InMeshData->GetBoneCount();
+
+                Found = SkeletonByContent.emplace(Key, static_cast<int>(Skeletons.size())).first;
+                Skeletons.push_back(Shared);
+            }
+
+            ++Skeletons[Found->second].ModelCount;
+            ++SkeletonReferenceCount;
+
+            Entry.Skeleton = Found->second;
+        }
+
+        return ModelIndex;
+    }
+
+    void ModelLibrary::Delete()
+    {
+        for (ModelEntry& Entry : Models)
+            PMX_SAFE_DELETE(Entry.MeshData);
+
+        Models.clear();
+
+        Textures.clear();
+        Materials.clear();
+        Skeletons.clear();
+
+        TextureLastModel.clear();
+        TextureByPath.clear();
+        TextureByContent.clear();
+        MaterialByContent.clear();
+        SkeletonByContent.clear();
+
+        TextureReferenceCount = 0;
+        MaterialReferenceCount = 0;
+        SkeletonReferenceCount = 0;
+    }
+
+    int ModelLibrary::AddTexture(const std::string& InPath, const bool bInInternalToon, const int InModel)
+    {
+        // 대소문자를 구분하지 않는 파일 시스템 기준 (MMD 는 Windows 용)
+        std::string Key = InPath;
+        for (char& Character : Key)
+        {
+            if (Character >= 'A' && Character <= 'Z')
+                Character = static_cast<char>(Character - 'A' + 'a');
+        }
+
+        int Index = -1;
+
+        auto Found = TextureByPath.find(Key);
+        if (Found != TextureByPath.end())
+        {
+            Index = Found->second;
+        }
+        else
+        {
+            UInt64 ContentHash = 0;
+            bool bHasContentHash = false;
+
+            if (bInInternalToon == false && Options.HashTextureContent)
+                bHasContentHash = Options.HashTextureContent(InPath, ContentHash);
+
+            if (bHasContentHash)
+            {
+                auto FoundContent = TextureByContent.find(ContentHash);
+                if (FoundContent != TextureByContent.end())
+                    Index = FoundContent->second;
+            }
+
+            if (Index < 0)
+            {
+                SharedTexture Shared;
+                Shared.Path = InPath;
+                Shared.ContentHash = bHasContentHash ? ContentHash : HashBytes(Key.data(), Key.size());
+                Shared.bInternalToon = bInInternalToon;
+
+                Index = static_cast<int>(Textures.size());
+                Textures.push_back(Shared);
+                TextureLastModel.push_back(-1);
+
+                if (bHasContentHash)
+                    TextureByContent.emplace(ContentHash, Index);
+            }
+
+            // 내용이 같은 다른 경로도 다음부터 바로 찾도록 기록
+            TextureByPath.emplace(Key, Index);
+        }
+
+        // 모델 안에서 같은 공유 텍스처를 여러 번 가리켜도 한 번만 셈
+        if (TextureLastModel[Index] != InModel)
+        {
+            TextureLastModel[Index] = InModel;
+
+            ++Textures[Index].ModelCount;
+            ++TextureReferenceCount;
+        }
+
+        return Index;
+    }
+}
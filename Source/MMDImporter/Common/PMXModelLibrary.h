@@ -0,0 +1,138 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PMX
+{
+    // 64비트 내용 해시. 암호용이 아니며 같은 입력이면 플랫폼과 관계없이 같은 값
+    UInt64 HashBytes(const void* InData, const MemSize InSize, const UInt64 InSeed = 0);
+
+    struct ModelLibraryOptions
+    {
+        // 있으면 텍스처 파일 내용 해시로도 비교해서 경로가 달라도 같은 파일이면 묶음
+        // : 팩마다 같은 텍스처를 복사해 둔 경우에 효과가 있습니다. 경로 (UTF-8) 마다 한 번만 호출하고
+        //   읽지 못하면 false 를 반환하면 됩니다 (경로로만 비교). Common 은 파일을 직접 읽지 않으므로 호출하는 쪽에서 제공합니다.
+        std::function<bool(const std::string& InPath, UInt64& OutHash)> HashTextureContent;
+    };
+
+    /**
+     * 여러 모델을 소유하고 모델 사이에 같은 내용을 공유 항목으로 묶음
+     * : 텍스처 참조 (정규화한 경로, 선택적으로 파일 내용), 재질 파라미터 블록, 스켈레톤 구성을 내용 해시로 비교해
+     *   고유 항목 번호를 붙입니다. 해시가 같으면 내용을 한 번 더 비교하므로 충돌로 잘못 묶이지 않습니다 (파일 내용 해시는 제외).
+     *   변환 쪽은 고유 항목마다 한 번만 에셋을 만들고 모델별 매핑으로 재사용하면 됩니다.
+     *   한 스레드에서 호출해야 합니다.
+     */
+    class ModelLibrary
+    {
+    public:
+        struct SharedTexture
+        {
+            // 모델 폴더와 합쳐 정규화한 경로 (UTF-8, '/' 구분). 내부 툰은 "<internal>/toon01.bmp" 형태
+            std::string Path;
+
+            UInt64 ContentHash = 0;
+
+            bool bInternalToon = false;
+
+            // 이 텍스처를 참조하는 모델 수
+            int ModelCount = 0;
+        };
+
+        struct SharedMaterial
+        {
+            UInt64 ContentHash = 0;
+
+            // 대표 재질 (처음 추가된 모델의 재질)
+            int Model = -1;
+            int Material = -1;
+
+            // 공유 텍스처 번호. 없으면 -1
+            int Texture = -1;
+            int EnvironmentTexture = -1;
+            int ToonTexture = -1;
+
+            // 이 블록을 쓰는 재질 수 (모든 모델 합)
+            int ReferenceCount = 0;
+        };
+
+        struct SharedSkeleton
+        {
+            UInt64 ContentHash = 0;
+
+            // 대표 모델
+            int Model = -1;
+            int BoneCount = 0;
+
+            int ModelCount = 0;
+        };
+
+    public:
+        explicit ModelLibrary(const ModelLibraryOptions& InOptions = ModelLibraryOptions());
+        ~ModelLibrary();
+
+        // InMeshData 의 소유권을 가져옴 (new 로 만든 것). 반환 값은 모델 번호, InMeshData 가 nullptr 이면 -1
+        // : InModelDirectory 는 텍스처 상대 경로의 기준 폴더 (UTF-8) 입니다.
+        int AddModel(PMXMeshData* InMeshData, const std::string& InModelDirectory);
+        void Delete();
+
+        int GetModelCount() const { return static_cast<int>(Models.size()); }
+        const PMXMeshData* GetModel(const int InModel) const { return Models[InModel].MeshData; }
+
+        // 모델의 텍스처 / 재질 번호 -> 공유 번호. 길이는 모델의 텍스처 / 재질 수
+        const std::vector<int>& GetTextureMapping(const int InModel) const { return Models[InModel].TextureMapping; }
+        const std::vector<int>& GetMaterialMapping(const int InModel) const { return Models[InModel].MaterialMapping; }
+
+        // 본이 없으면 -1
+        int GetSkeleton(const int InModel) const { return Models[InModel].Skeleton; }
+
+        const std::vector<SharedTexture>& GetTextures() const { return Textures; }
+        const std::vector<SharedMaterial>& GetMaterials() const { return Materials; }
+        const std::vector<SharedSkeleton>& GetSkeletons() const { return Skeletons; }
+
+        // 모든 모델의 참조 수 합. 고유 항목 수와 비교하면 공유 효과를 알 수 있음
+        int GetTextureReferenceCount() const { return TextureReferenceCount; }
+        int GetMaterialReferenceCount() const { return MaterialReferenceCount; }
+        int GetSkeletonReferenceCount() const { return SkeletonReferenceCount; }
+
+    protected:
+        struct ModelEntry
+        {
+            PMXMeshData* MeshData = nullptr;
+            std::string Directory;
+
+            std::vector<int> TextureMapping;
+            std::vector<int> MaterialMapping;
+            int Skeleton = -1;
+        };
+
+        int AddTexture(const std::string& InPath, const bool bInInternalToon, const int InModel);
+
+    protected:
+        ModelLibraryOptions Options;
+
+        std::vector<ModelEntry> Models;
+
+        std::vector<SharedTexture> Textures;
+        std::vector<SharedMaterial> Materials;
+        std::vector<SharedSkeleton> Skeletons;
+
+        // 공유 텍스처마다 마지막으로 센 모델 번호 (ModelCount 중복 방지)
+        std::vector<int> TextureLastModel;
+
+        // 비교용 키 -> 공유 번호
+        // : 텍스처는 소문자 경로, 재질과 스켈레톤은 내용을 이어 붙인 바이트열
+        std::unordered_map<std::string, int> TextureByPath;
+        std::unordered_map<UInt64, int> TextureByContent;
+        std::unordered_map<std::string, int> MaterialByContent;
+        std::unordered_map<std::string, int> SkeletonByContent;
+
+        int TextureReferenceCount = 0;
+        int MaterialReferenceCount = 0;
+        int SkeletonReferenceCount = 0;
+    };
+}
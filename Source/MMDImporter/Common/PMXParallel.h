@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace PMX
+{
+    // 병렬 작업에 사용할 스레드 수
+    inline int GetWorkerCount()
+    {
+        const unsigned int Count = std::thread::hardware_concurrency();
+        return Count > 0 ? static_cast<int>(Count) : 1;
+    }
+
+    /**
+     * [0, InCount) 범위를 InBatchSize 단위로 나눠 여러 스레드에서 처리
+     * : Func(Begin, End) 형태로 호출되며, 각 구간은 서로 겹치지 않습니다.
+     *   작업량이 적으면 호출 스레드에서 바로 처리합니다.
+     */
+    template <class FuncType>
+    void ParallelFor(const int InCount, const int InBatchSize, const FuncType& Func)
+    {
+        if (InCount <= 0)
+            return;
+
+        const int BatchSize = InBatchSize > 0 ? InBatchSize : 1;
+        const int BatchCount = (InCount + BatchSize - 1) / BatchSize;
+        const int ThreadCount = BatchCount < GetWorkerCount() ? BatchCount : GetWorkerCount();
+
+        if (ThreadCount <= 1)
+        {
+            Func(0, InCount);
+            return;
+        }
+
+        std::atomic<int> NextBatch(0);
+
+        auto Worker = [&]()
+        {
+            for (int Batch = NextBatch++; Batch < BatchCount; Batch = NextBatch++)
+            {
+                const int Begin = Batch * BatchSize;
+                const int End = (Begin + BatchSize < InCount) ? Begin + BatchSize : InCount;
+
+                Func(Begin, End);
+            }
+        };
+
+        std::vector<std::thread> Threads;
+        Threads.reserve(ThreadCount - 1);
+
+        for (int i = 1; i < ThreadCount; ++i)
+            Threads.emplace_back(Worker);
+
+        Worker();
+
+        for (std::thread& Thread : Threads)
+            Thread.join();
+    }
+}
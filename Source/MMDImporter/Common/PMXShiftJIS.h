@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include "PMXTypes.h"
+
+#include <string>
+
+namespace PMX
+{
+    // Shift-JIS (CP932) 바이트열을 UTF-8 로 바꿔 덧붙임. 0 바이트에서 멈춤
+    // : VMD 의 고정 길이 이름처럼 2바이트 문자 중간에서 잘린 끝은 버리고, 없는 문자는 U+FFFD 로 바꿉니다.
+    void AppendShiftJISAsUTF8(const Byte* InSource, const MemSize InSize, std::string& OutString);
+
+    // 문자 하나를 Shift-JIS 로 저장할 때의 바이트 수 (1 / 2)
+    // : VMD 이름 길이 제한으로 잘린 이름과 비교할 때 사용
+    int GetShiftJISCharSize(const UInt32 InCodePoint);
+
+    // PMX 텍스트를 인코딩에 상관없이 UTF-8 로 덧붙임
+    // : InMaxShiftJISBytes 가 0 보다 크면 Shift-JIS 로 그 바이트 수를 넘는 문자부터 버립니다 (VMD 이름은 15).
+    void AppendTextAsUTF8(const Text& InText, std::string& OutString, const int InMaxShiftJISBytes = 0);
+}
@@ -0,0 +1,285 @@
+﻿#include "PMXSkeleton.h"
+#include "PMXMath.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace PMX
+{
+    PoseBatch::~PoseBatch()
+    {
+        Delete();
+    }
+
+    void PoseBatch::Allocate(const int InBoneCount, const int InInstanceCount)
+    {
+        Delete();
+
+        if (InBoneCount <= 0 || InInstanceCount <= 0)
+            return;
+
+        BoneCount = InBoneCount;
+        InstanceCount = InInstanceCount;
+
+        // 회전 4 + 이동 3, 로컬/글로벌 각각
+        const MemSize ElementCount = static_cast<MemSize>(BoneCount) * InstanceCount;
+        Buffer = new float[ElementCount * 14];
+
+        float* Cursor = Buffer;
+        for (float*& Component : LocalRotation)     { Component = Cursor; Cursor += ElementCount; }
+        for (float*& Component : LocalTranslation)  { Component = Cursor; Cursor += ElementCount; }
+        for (float*& Component : GlobalRotation)    { Component = Cursor; Cursor += ElementCount; }
+        for (float*& Component : GlobalPosition)    { Component = Cursor; Cursor += ElementCount; }
+
+        Reset();
+    }
+
+    void PoseBatch::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(Buffer);
+
+        for (float*& Component : LocalRotation)     Component = nullptr;
+        for (float*& Component : LocalTranslation)  Component = nullptr;
+        for (float*& Component : GlobalRotation)    Component = nullptr;
+        for (float*& Component : GlobalPosition)    Component = nullptr;
+
+        BoneCount = 0;
+        InstanceCount = 0;
+    }
+
+    void PoseBatch::Reset()
+    {
+        if (Buffer == nullptr)
+            return;
+
+        const MemSize ElementCount = static_cast<MemSize>(BoneCount) * InstanceCount;
+
+        std::fill(LocalRotation[0], LocalRotation[0] + ElementCount * 3, 0.0f);
+        std::fill(LocalRotation[3], LocalRotation[3] + ElementCount, 1.0f);
+        std::fill(LocalTranslation[0], LocalTranslation[0] + ElementCount * 3, 0.0f);
+        std::fill(GlobalRotation[0], GlobalRotation[0] + ElementCount * 3, 0.0f);
+        std::fill(GlobalRotation[3], GlobalRotation[3] + ElementCount, 1.0f);
+        std::fill(GlobalPosition[0], GlobalPosition[0] + ElementCount * 3, 0.0f);
+    }
+
+    Vector4 PoseBatch::GetLocalRotation(const int InIndex) const
+    {
+        return Math::MakeVector4(LocalRotation[0][InIndex], LocalRotation[1][InIndex], LocalRotation[2][InIndex], LocalRotation[3][InIndex]);
+    }
+
+    void PoseBatch::SetLocalRotation(const int InIndex, const Vector4& InRotation)
+    {
+        LocalRotation[0][InIndex] = InRotation.X;
+        LocalRotation[1][InIndex] = InRotation.Y;
+        LocalRotation[2][InIndex] = InRotation.Z;
+        LocalRotation[3][InIndex] = InRotation.W;
+    }
+
+    Vector3 PoseBatch::GetLocalTranslation(const int InIndex) const
+    {
+        return Math::MakeVector3(LocalTranslation[0][InIndex], LocalTranslation[1][InIndex], LocalTranslation[2][InIndex]);
+    }
+
+    void PoseBatch::SetLocalTranslation(const int InIndex, const Vector3& InTranslation)
+    {
+        LocalTranslation[0][InIndex] = InTranslation.X;
+        LocalTranslation[1][InIndex] = InTranslation.Y;
+        LocalTranslation[2][InIndex] = InTranslation.Z;
+    }
+
+    Vector4 PoseBatch::GetGlobalRotation(const int InIndex) const
+    {
+        return Math::MakeVector4(GlobalRotation[0][InIndex], GlobalRotation[1][InIndex], GlobalRotation[2][InIndex], GlobalRotation[3][InIndex]);
+    }
+
+    void PoseBatch::SetGlobalRotation(const int InIndex, const Vector4& InRotation)
+    {
+        GlobalRotation[0][InIndex] = InRotation.X;
+        GlobalRotation[1][InIndex] = InRotation.Y;
+        GlobalRotation[2][InIndex] = InRotation.Z;
+        GlobalRotation[3][InIndex] = InRotation.W;
+    }
+
+    Vector3 PoseBatch::GetGlobalPosition(const int InIndex) const
+    {
+        return Math::MakeVector3(GlobalPosition[0][InIndex], GlobalPosition[1][InIndex], GlobalPosition[2][InIndex]);
+    }
+
+    void PoseBatch::SetGlobalPosition(const int InIndex, const Vector3& InPosition)
+    {
+        GlobalPosition[0][InIndex] = InPosition.X;
+        GlobalPosition[1][InIndex] = InPosition.Y;
+        GlobalPosition[2][InIndex] = InPosition.Z;
+    }
+
+    Skeleton::~Skeleton()
+    {
+        Delete();
+    }
+
+    bool Skeleton::Build(const PMXMeshData& InMeshData)
+    {
+        Delete();
+
+        const int Count = InMeshData.GetBoneCount();
+        const BoneData* Bones = InMeshData.GetBones();
+
+        if (Count <= 0 || Bones == nullptr)
+            return false;
+
+        BoneCount = Count;
+        ArrayParentIndex = new int[BoneCount];
+        ArrayBindPosition = new Vector3[BoneCount];
+        ArrayBindLocalTranslation = new Vector3[BoneCount];
+        ArrayEvaluationOrder = new int[BoneCount];
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const int ParentIndex = Bones[i].ParentBoneIndex;
+
+            // 범위를 벗어난 부모나 자기 자신을 가리키는 경우 루트로 취급
+            ArrayParentIndex[i] = (ParentIndex >= 0 && ParentIndex < BoneCount && ParentIndex != i) ? ParentIndex : -1;
+            ArrayBindPosition[i] = Bones[i].Position;
+        }
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const int ParentIndex = ArrayParentIndex[i];
+            ArrayBindLocalTranslation[i] = (ParentIndex < 0) ? ArrayBindPosition[i] : Math::Sub(ArrayBindPosition[i], ArrayBindPosition[ParentIndex]);
+        }
+
+        // Layer, 인덱스 순으로 정렬한 뒤 부모가 먼저 나오도록 배치
+        std::vector<int> SortedBones(BoneCount);
+        for (int i = 0; i < BoneCount; ++i)
+            SortedBones[i] = i;
+
+        std::stable_sort(SortedBones.begin(), SortedBones.end(), [Bones](const int A, const int B)
+        {
+            return Bones[A].Layer < Bones[B].Layer;
+        });
+
+        std::vector<UInt8> Emitted(BoneCount, 0);
+        std::vector<int> Stack;
+        int OrderCount = 0;
+
+        for (const int BoneIndex : SortedBones)
+        {
+            // 아직 배치되지 않은 조상부터 배치. 순환 참조는 BoneCount 깊이에서 끊음
+            for (int Cur = BoneIndex; Cur >= 0 && Emitted[Cur] == 0 && static_cast<int>(Stack.size()) < BoneCount; Cur = ArrayParentIndex[Cur])
+                Stack.push_back(Cur);
+
+            while (Stack.empty() == false)
+            {
+                const int Cur = Stack.back();
+                Stack.pop_back();
+
+                if (Emitted[Cur] != 0)
+                    continue;
+
+                Emitted[Cur] = 1;
+                ArrayEvaluationOrder[OrderCount++] = Cur;
+            }
+        }
+
+        return true;
+    }
+
+    void Skeleton::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayParentIndex);
+        PMX_SAFE_DELETE_ARRAY(ArrayBindPosition);
+        PMX_SAFE_DELETE_ARRAY(ArrayBindLocalTranslation);
+        PMX_SAFE_DELETE_ARRAY(ArrayEvaluationOrder);
+        BoneCount = 0;
+    }
+
+    bool Skeleton::IsDescendantOf(const int InBoneIndex, const int InAncestorIndex) const
+    {
+        int Depth = 0;
+        for (int Cur = InBoneIndex; Cur >= 0 && Depth <= BoneCount; Cur = ArrayParentIndex[Cur], ++Depth)
+        {
+            if (Cur == InAncestorIndex)
+                return true;
+        }
+
+        return false;
+    }
+
+    void Skeleton::UpdateGlobalPose(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        UpdateGlobalPose(InOutPose, ArrayEvaluationOrder, BoneCount, InInstanceBegin, InInstanceEnd);
+    }
+
+    void Skeleton::UpdateGlobalPose(PoseBatch& InOutPose, const int* InBones, const int InBoneCount, const int InInstanceBegin, const int InInstanceEnd) const
+    {
+        const int InstanceCount = InOutPose.GetInstanceCount();
+
+        const float* LRX = InOutPose.LocalRotation[0];
+        const float* LRY = InOutPose.LocalRotation[1];
+        const float* LRZ = InOutPose.LocalRotation[2];
+        const float* LRW = InOutPose.LocalRotation[3];
+        const float* LTX = InOutPose.LocalTranslation[0];
+        const float* LTY = InOutPose.LocalTranslation[1];
+        const float* LTZ = InOutPose.LocalTranslation[2];
+
+        float* GRX = InOutPose.GlobalRotation[0];
+        float* GRY = InOutPose.GlobalRotation[1];
+        float* GRZ = InOutPose.GlobalRotation[2];
+        float* GRW = InOutPose.GlobalRotation[3];
+        float* GPX = InOutPose.GlobalPosition[0];
+        float* GPY = InOutPose.GlobalPosition[1];
+        float* GPZ = InOutPose.GlobalPosition[2];
+
+        for (int b = 0; b < InBoneCount; ++b)
+        {
+            const int BoneIndex = InBones[b];
+            const int ParentIndex = ArrayParentIndex[BoneIndex];
+            const Vector3& Bind = ArrayBindLocalTranslation[BoneIndex];
+
+            const int Base = BoneIndex * InstanceCount;
+
+            if (ParentIndex < 0)
+            {
+                for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+                {
+                    const int n = Base + i;
+                    GRX[n] = LRX[n];
+                    GRY[n] = LRY[n];
+                    GRZ[n] = LRZ[n];
+                    GRW[n] = LRW[n];
+                    GPX[n] = Bind.X + LTX[n];
+                    GPY[n] = Bind.Y + LTY[n];
+                    GPZ[n] = Bind.Z + LTZ[n];
+                }
+                continue;
+            }
+
+            const int ParentBase = ParentIndex * InstanceCount;
+
+            // 인스턴스 방향으로 벡터화 되도록 분기 없이 성분별로 계산
+            for (int i = InInstanceBegin; i < InInstanceEnd; ++i)
+            {
+                const int n = Base + i;
+                const int p = ParentBase + i;
+
+                const float PX = GRX[p], PY = GRY[p], PZ = GRZ[p], PW = GRW[p];
+                const float LX = LRX[n], LY = LRY[n], LZ = LRZ[n], LW = LRW[n];
+
+                GRX[n] = PW * LX + PX * LW + PY * LZ - PZ * LY;
+                GRY[n] = PW * LY - PX * LZ + PY * LW + PZ * LX;
+                GRZ[n] = PW * LZ + PX * LY - PY * LX + PZ * LW;
+                GRW[n] = PW * LW - PX * LX - PY * LY - PZ * LZ;
+
+                // 부모 회전으로 로컬 이동 회전 : v + 2w(q x v) + 2(q x (q x v))
+                const float VX = Bind.X + LTX[n], VY = Bind.Y + LTY[n], VZ = Bind.Z + LTZ[n];
+                const float TX = 2.0f * (PY * VZ - PZ * VY);
+                const float TY = 2.0f * (PZ * VX - PX * VZ);
+                const float TZ = 2.0f * (PX * VY - PY * VX);
+
+                GPX[n] = GPX[p] + VX + PW * TX + (PY * TZ - PZ * TY);
+                GPY[n] = GPY[p] + VY + PW * TY + (PZ * TX - PX * TZ);
+                GPZ[n] = GPZ[p] + VZ + PW * TZ + (PX * TY - PY * TX);
+            }
+        }
+    }
+}
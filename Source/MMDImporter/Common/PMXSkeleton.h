@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    class Skeleton;
+
+    /**
+     * 여러 인스턴스의 포즈를 한번에 담는 SoA 버퍼
+     * : 모든 배열은 [BoneIndex * InstanceCount + InstanceIndex] 로 접근합니다.
+     *   같은 본의 인스턴스들이 연속으로 놓이므로 인스턴스 방향으로 벡터화됩니다.
+     */
+    class PoseBatch
+    {
+    public:
+        ~PoseBatch();
+
+        void Allocate(const int InBoneCount, const int InInstanceCount);
+        void Delete();
+
+        // 회전은 단위 회전, 이동은 0 으로 초기화
+        void Reset();
+
+        int GetBoneCount() const { return BoneCount; }
+        int GetInstanceCount() const { return InstanceCount; }
+        int GetIndex(const int InBoneIndex, const int InInstanceIndex) const { return InBoneIndex * InstanceCount + InInstanceIndex; }
+
+        Vector4 GetLocalRotation(const int InIndex) const;
+        void SetLocalRotation(const int InIndex, const Vector4& InRotation);
+        Vector3 GetLocalTranslation(const int InIndex) const;
+        void SetLocalTranslation(const int InIndex, const Vector3& InTranslation);
+
+        Vector4 GetGlobalRotation(const int InIndex) const;
+        void SetGlobalRotation(const int InIndex, const Vector4& InRotation);
+        Vector3 GetGlobalPosition(const int InIndex) const;
+        void SetGlobalPosition(const int InIndex, const Vector3& InPosition);
+
+    public:
+        // 애니메이션 값. 바인드 포즈 기준의 상대 회전/이동
+        float* LocalRotation[4]{ nullptr };
+        float* LocalTranslation[3]{ nullptr };
+
+        // 모델 공간 결과
+        float* GlobalRotation[4]{ nullptr };
+        float* GlobalPosition[3]{ nullptr };
+
+    protected:
+        int BoneCount = 0;
+        int InstanceCount = 0;
+
+        float* Buffer = nullptr;
+    };
+
+    /**
+     * 포즈 계산용으로 평탄화 한 본 계층
+     */
+    class Skeleton
+    {
+    public:
+        ~Skeleton();
+
+        bool Build(const PMXMeshData& InMeshData);
+        void Delete();
+
+        int GetBoneCount() const { return BoneCount; }
+        const int* GetParentIndices() const { return ArrayParentIndex; }
+        const Vector3* GetBindPositions() const { return ArrayBindPosition; }
+        const Vector3* GetBindLocalTranslations() const { return ArrayBindLocalTranslation; }
+
+        // 부모가 항상 자식보다 먼저 오는 계산 순서 (Layer, 인덱스 순)
+        const int* GetEvaluationOrder() const { return ArrayEvaluationOrder; }
+
+        // InBoneIndex 가 InAncestorIndex 자신이거나 그 자손인지
+        bool IsDescendantOf(const int InBoneIndex, const int InAncestorIndex) const;
+
+        // 전체 본의 글로벌 포즈 갱신
+        void UpdateGlobalPose(PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd) const;
+
+        // 지정한 본들만 순서대로 글로벌 포즈 갱신. InBones 는 부모가 먼저 오도록 정렬되어 있어야 합니다.
+        void UpdateGlobalPose(PoseBatch& InOutPose, const int* InBones, const int InBoneCount, const int InInstanceBegin, const int InInstanceEnd) const;
+
+    protected:
+        int BoneCount = 0;
+        int* ArrayParentIndex = nullptr;
+        Vector3* ArrayBindPosition = nullptr;
+        Vector3* ArrayBindLocalTranslation = nullptr;
+        int* ArrayEvaluationOrder = nullptr;
+    };
+}
@@ -0,0 +1,292 @@
+﻿#include "PMXSkinWeights.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    static constexpr int SkinWeightBatchSize = 4096;
+
+    // 원본과 같은지 비교할 때의 가중치 오차
+    static constexpr float SkinWeightCompareTolerance = 1.e-6f;
+
+    SkinWeightCleaner::~SkinWeightCleaner()
+    {
+        Delete();
+    }
+
+    bool SkinWeightCleaner::Process(PMXMeshData& InOutMeshData, const SkinWeightOptions& InOptions)
+    {
+        Delete();
+
+        VertexCount = InOutMeshData.GetVertexCount();
+        VertexData* Vertices = InOutMeshData.GetVertices();
+        const int BoneCount = InOutMeshData.GetBoneCount();
+
+        if (VertexCount <= 0 || Vertices == nullptr || BoneCount <= 0)
+            return false;
+
+        const int MaxInfluences = std::min(std::max(InOptions.MaxInfluences, 1), 8);
+        InfluenceWidth = MaxInfluences <= 4 ? 4 : 8;
+
+        BoneIndexBuffer = new int[static_cast<MemSize>(VertexCount) * InfluenceWidth];
+        WeightBuffer = new float[static_cast<MemSize>(VertexCount) * InfluenceWidth];
+
+        for (int k = 0; k < InfluenceWidth; ++k)
+        {
+            BoneIndex[k] = BoneIndexBuffer + static_cast<MemSize>(k) * VertexCount;
+            Weight[k] = WeightBuffer + static_cast<MemSize>(k) * VertexCount;
+        }
+
+        // 1. 정점별 유효 영향 정리 (중복 합치기, 정렬, 제거, 제한). 정규화는 다음 단계에서
+        ParallelFor(VertexCount, SkinWeightBatchSize, [&](const int Begin, const int End)
+        {
+            for (int v = Begin; v < End; ++v)
+            {
+                int SourceBone[4];
+                float SourceWeight[4];
+                const int SourceCount = Vertices[v].GetBoneWeights(SourceBone, SourceWeight);
+
+                int Bones[4];
+                float Weights[4];
+                int Count = 0;
+                float Sum = 0;
+
+                for (int i = 0; i < SourceCount; ++i)
+                {
+                    // NaN 도 여기서 걸러짐
+                    if (SourceBone[i] < 0 || SourceBone[i] >= BoneCount || (SourceWeight[i] > 0) == false)
+                        continue;
+
+                    int Slot = 0;
+                    while (Slot < Count && Bones[Slot] != SourceBone[i])
+                        ++Slot;
+
+                    if (Slot == Count)
+                    {
+                        Bones[Count] = SourceBone[i];
+                        Weights[Count] = 0;
+                        ++Count;
+                    }
+
+                    Weights[Slot] += SourceWeight[i];
+                    Sum += SourceWeight[i];
+                }
+
+                // 유효한 가중치가 없으면 첫 유효 본 (없으면 0번 본) 에 전부
+                if (Count == 0)
+                {
+                    Bones[0] = 0;
+                    for (int i = SourceCount - 1; i >= 0; --i)
+                        Bones[0] = SourceBone[i] >= 0 && SourceBone[i] < BoneCount ? SourceBone[i] : Bones[0];
+
+                    Weights[0] = 1.0f;
+                    Sum = 1.0f;
+                    Count = 1;
+                }
+
+                // 큰 가중치 순 (같으면 본 번호 순)
+                for (int i = 1; i < Count; ++i)
+                {
+                    for (int j = i; j > 0 && (Weights[j] > Weights[j - 1] || (Weights[j] == Weights[j - 1] && Bones[j] < Bones[j - 1])); --j)
+                    {
+                        std::swap(Weights[j], Weights[j - 1]);
+                        std::swap(Bones[j], Bones[j - 1]);
+                    }
+                }
+
+                int Kept = 1;
+                while (Kept < Count && Kept < MaxInfluences && Weights[Kept] >= InOptions.PruneThreshold * Sum)
+                    ++Kept;
+
+                for (int k = 0; k < InfluenceWidth; ++k)
+                {
+                    BoneIndex[k][v] = k < Kept ? Bones[k] : 0;
+                    Weight[k][v] = k < Kept ? Weights[k] : 0;
+                }
+            }
+        });
+
+        // 2. SoA 정규화. 분기 없는 슬롯별 루프라 자동 벡터화됨
+        ParallelFor(VertexCount, SkinWeightBatchSize, [&](const int Begin, const int End)
+        {
+            const int Count = End - Begin;
+            std::vector<float> InvSum(Count, 0.0f);
+
+            for (int k = 0; k < InfluenceWidth; ++k)
+            {
+                const float* Slot = Weight[k] + Begin;
+                for (int i = 0; i < Count; ++i)
+                    InvSum[i] += Slot[i];
+            }
+
+            for (int i = 0; i < Count; ++i)
+                InvSum[i] = 1.0f / InvSum[i];
+
+            for (int k = 0; k < InfluenceWidth; ++k)
+            {
+                float* Slot = Weight[k] + Begin;
+                for (int i = 0; i < Count; ++i)
+                    Slot[i] *= InvSum[i];
+            }
+        });
+
+        // 3. 원본과 비교하고 변형 정보에 반영
+        std::atomic<int> Changed(0);
+
+        ParallelFor(VertexCount, SkinWeightBatchSize, [&](const int Begin, const int End)
+        {
+            int BatchChanged = 0;
+
+            for (int v = Begin; v < End; ++v)
+            {
+                VertexData& Vertex = Vertices[v];
+
+                int Count = 0;
+                while (Count < InfluenceWidth && Weight[Count][v] > 0)
+                    ++Count;
+
+                // 결과 변형 방식
+                VertexData::WeightDeformType NewType;
+                if (Vertex.DeformType == VertexData::WeightDeformType::SDEF && InOptions.bCollapseSpecialDeforms == false && Count == 2)
+                    NewType = VertexData::WeightDeformType::SDEF;
+                else if (Vertex.DeformType == VertexData::WeightDeformType::QDEF && InOptions.bCollapseSpecialDeforms == false)
+                    NewType = VertexData::WeightDeformType::QDEF;
+                else if (Count == 1)
+                    NewType = VertexData::WeightDeformType::BDEF1;
+                else if (Count == 2)
+                    NewType = VertexData::WeightDeformType::BDEF2;
+                else
+                    NewType = VertexData::WeightDeformType::BDEF4;
+
+                int NewBone[4] = { 0, 0, 0, 0 };
+                float NewWeight[4] = { 0, 0, 0, 0 };
+
+                for (int k = 0; k < Count && k < 4; ++k)
+                {
+                    NewBone[k] = BoneIndex[k][v];
+                    NewWeight[k] = Weight[k][v];
+                }
+
+                // SDEF 는 C/R0/R1 이 본 순서에 묶여 있으므로 원래 순서 유지
+                const VertexData::SDEF* SourceSDEF = NewType == VertexData::WeightDeformType::SDEF ? static_cast<const VertexData::SDEF*>(Vertex.Deform) : nullptr;
+                if (SourceSDEF != nullptr && NewBone[0] != SourceSDEF->BoneIndex0)
+                {
+                    std::swap(NewBone[0], NewBone[1]);
+                    std::swap(NewWeight[0], NewWeight[1]);
+                }
+
+                // 원본과 비교
+                int SourceBone[4];
+                float SourceWeight[4];
+                const int SourceCount = Vertex.GetBoneWeights(SourceBone, SourceWeight);
+                const int NewCount = NewType == VertexData::WeightDeformType::BDEF1 ? 1 : (NewType == VertexData::WeightDeformType::BDEF2 || NewType == VertexData::WeightDeformType::SDEF ? 2 : 4);
+
+                bool bChanged = NewType != Vertex.DeformType || SourceCount != NewCount;
+                for (int k = 0; k < NewCount && bChanged == false; ++k)
+                    bChanged = SourceBone[k] != NewBone[k] || fabsf(SourceWeight[k] - NewWeight[k]) > SkinWeightCompareTolerance;
+
+                if (bChanged == false)
+                    continue;
+
+                ++BatchChanged;
+
+                if (InOptions.bWriteBack == false)
+                    continue;
+
+                VertexData::WeightDeform* NewDeform = nullptr;
+
+                switch (NewType)
+                {
+                    case VertexData::WeightDeformType::BDEF1:
+                    {
+                        VertexData::BDEF1* Data = new VertexData::BDEF1;
+                        Data->BoneIndex0 = NewBone[0];
+                        NewDeform = Data;
+                        break;
+                    }
+
+                    case VertexData::WeightDeformType::BDEF2:
+                    {
+                        VertexData::BDEF2* Data = new VertexData::BDEF2;
+                        Data->BoneIndex0 = NewBone[0];
+                        Data->BoneIndex1 = NewBone[1];
+                        Data->Weight0 = NewWeight[0];
+                        Data->Weight1 = NewWeight[1];
+                        NewDeform = Data;
+                        break;
+                    }
+
+                    case VertexData::WeightDeformType::SDEF:
+                    {
+                        VertexData::SDEF* Data = new VertexData::SDEF(*SourceSDEF);
+                        Data->BoneIndex0 = NewBone[0];
+                        Data->BoneIndex1 = NewBone[1];
+                        Data->Weight0 = NewWeight[0];
+                        Data->Weight1 = NewWeight[1];
+                        NewDeform = Data;
+                        break;
+                    }
+
+                    case VertexData::WeightDeformType::BDEF4:
+                    {
+                        VertexData::BDEF4* Data = new VertexData::BDEF4;
+                        Data->BoneIndex0 = NewBone[0];
+                        Data->BoneIndex1 = NewBone[1];
+                        Data->BoneIndex2 = NewBone[2];
+                        Data->BoneIndex3 = NewBone[3];
+                        Data->Weight0 = NewWeight[0];
+                        Data->Weight1 = NewWeight[1];
+                        Data->Weight2 = NewWeight[2];
+                        Data->Weight3 = NewWeight[3];
+                        NewDeform = Data;
+                        break;
+                    }
+
+                    case VertexData::WeightDeformType::QDEF:
+                    {
+                        VertexData::QDEF* Data = new VertexData::QDEF;
+                        Data->BoneIndex0 = NewBone[0];
+                        Data->BoneIndex1 = NewBone[1];
+                        Data->BoneIndex2 = NewBone[2];
+                        Data->BoneIndex3 = NewBone[3];
+                        Data->Weight0 = NewWeight[0];
+                        Data->Weight1 = NewWeight[1];
+                        Data->Weight2 = NewWeight[2];
+                        Data->Weight3 = NewWeight[3];
+                        NewDeform = Data;
+                        break;
+                    }
+                }
+
+                PMX_SAFE_DELETE(Vertex.Deform);
+                Vertex.Deform = NewDeform;
+                Vertex.DeformType = NewType;
+            }
+
+            Changed += BatchChanged;
+        });
+
+        ChangedVertexCount = Changed;
+        return true;
+    }
+
+    void SkinWeightCleaner::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(BoneIndexBuffer);
+        PMX_SAFE_DELETE_ARRAY(WeightBuffer);
+
+        for (int k = 0; k < 8; ++k)
+        {
+            BoneIndex[k] = nullptr;
+            Weight[k] = nullptr;
+        }
+
+        VertexCount = 0;
+        InfluenceWidth = 0;
+        ChangedVertexCount = 0;
+    }
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct SkinWeightOptions
+    {
+        // 정규화 후 이 값보다 작은 가중치 제거. 영향 본은 최소 1개 남음
+        float PruneThreshold = 0.01f;
+
+        // 정점당 최대 영향 본 수 (1 ~ 8). 큰 가중치부터 남김
+        // : 결과 SoA 스트림 폭은 4 이하면 4, 그보다 크면 8 입니다.
+        int MaxInfluences = 4;
+
+        // SDEF 는 BDEF2, QDEF 는 BDEF4 로 바꿈
+        bool bCollapseSpecialDeforms = false;
+
+        // 정리 결과를 VertexData 의 변형 정보에 반영
+        bool bWriteBack = true;
+    };
+
+    /**
+     * 스킨 가중치 정리
+     * : 범위를 벗어난 본 / 0 이하 가중치를 버리고, 중복 본을 합치고, 정규화 / 작은 가중치 제거 / 영향 수 제한 후
+     *   정점 순서의 고정 폭 SoA 스트림을 만듭니다. 빈 슬롯은 본 0, 가중치 0 이므로 스키닝 커널이 분기 없이 돌 수 있습니다.
+     */
+    class SkinWeightCleaner
+    {
+    public:
+        ~SkinWeightCleaner();
+
+        bool Process(PMXMeshData& InOutMeshData, const SkinWeightOptions& InOptions = SkinWeightOptions());
+        void Delete();
+
+        // 변형 방식이나 본/가중치가 원본과 달라진 정점 수
+        int GetChangedVertexCount() const { return ChangedVertexCount; }
+
+        int GetVertexCount() const { return VertexCount; }
+        int GetInfluenceWidth() const { return InfluenceWidth; }
+
+    public:
+        // [슬롯][정점]. 슬롯은 가중치가 큰 순서이며 InfluenceWidth 개만 유효
+        int* BoneIndex[8]{ nullptr };
+        float* Weight[8]{ nullptr };
+
+    protected:
+        int VertexCount = 0;
+        int InfluenceWidth = 0;
+        int ChangedVertexCount = 0;
+
+        int* BoneIndexBuffer = nullptr;
+        float* WeightBuffer = nullptr;
+    };
+}
@@ -0,0 +1,175 @@
+﻿#include "PMXTangentGenerator.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    static constexpr int TangentBatchSize = 4096;
+
+    // 법선과 수직인 임의의 단위 벡터
+    static Vector3 GetAnyPerpendicular(const Vector3& InNormal)
+    {
+        const Vector3 Axis = fabsf(InNormal.X) < 0.9f ? Math::MakeVector3(1, 0, 0) : Math::MakeVector3(0, 1, 0);
+        const Vector3 Perpendicular = Math::Normalize(Math::Sub(Axis, Math::Scale(InNormal, Math::Dot(Axis, InNormal))));
+
+        return Math::LengthSquared(Perpendicular) > 0 ? Perpendicular : Math::MakeVector3(1, 0, 0);
+    }
+
+    TangentGenerator::~TangentGenerator()
+    {
+        Delete();
+    }
+
+    bool TangentGenerator::Build(const PMXMeshData& InMeshData)
+    {
+        Delete();
+
+        const int MeshVertexCount = InMeshData.GetVertexCount();
+        const int SurfaceCount = InMeshData.GetSurfaceCount();
+        const VertexData* Vertices = InMeshData.GetVertices();
+        const SurfaceData* Surfaces = InMeshData.GetSurfaces();
+
+        if (MeshVertexCount <= 0 || Vertices == nullptr)
+            return false;
+
+        for (int i = 0; i < SurfaceCount; ++i)
+        {
+            for (const int VertexIndex : Surfaces[i].VertexIndex)
+            {
+                if (VertexIndex < 0 || VertexIndex >= MeshVertexCount)
+                    return false;
+            }
+        }
+
+        VertexCount = MeshVertexCount;
+        Buffer = new float[static_cast<MemSize>(VertexCount) * 4];
+
+        float* Cursor = Buffer;
+        for (float*& Component : Tangent) { Component = Cursor; Cursor += VertexCount; }
+        BitangentSign = Cursor;
+
+        // 1. 삼각형별 UV 미분 방향. UV 면적으로 나눠 크기를 맞추고, UV 가 뒤집힌 삼각형은 부호로 구분
+        std::vector<Vector3> FaceTangent(SurfaceCount);
+        std::vector<Vector3> FaceBitangent(SurfaceCount);
+
+        ParallelFor(SurfaceCount, TangentBatchSize, [&](const int Begin, const int End)
+        {
+            for (int f = Begin; f < End; ++f)
+            {
+                const VertexData& V0 = Vertices[Surfaces[f].VertexIndex[0]];
+                const VertexData& V1 = Vertices[Surfaces[f].VertexIndex[1]];
+                const VertexData& V2 = Vertices[Surfaces[f].VertexIndex[2]];
+
+                const Vector3 D1 = Math::Sub(V1.Position, V0.Position);
+                const Vector3 D2 = Math::Sub(V2.Position, V0.Position);
+
+                const float S1 = V1.UV.X - V0.UV.X;
+                const float T1 = V1.UV.Y - V0.UV.Y;
+                const float S2 = V2.UV.X - V0.UV.X;
+                const float T2 = V2.UV.Y - V0.UV.Y;
+
+                const float SignedArea = S1 * T2 - S2 * T1;
+
+                if (fabsf(SignedArea) > FLT_MIN)
+                {
+                    const float InvArea = 1.0f / SignedArea;
+                    FaceTangent[f] = Math::Scale(Math::Sub(Math::Scale(D1, T2), Math::Scale(D2, T1)), InvArea);
+                    FaceBitangent[f] = Math::Scale(Math::Sub(Math::Scale(D2, S1), Math::Scale(D1, S2)), InvArea);
+                }
+                else
+                {
+                    FaceTangent[f] = Vector3();
+                    FaceBitangent[f] = Vector3();
+                }
+            }
+        });
+
+        // 2. 정점 → 모서리(삼각형 * 3 + k) 목록. 정점마다 한 작업이 소유해서 합산하므로 원자 연산이 필요 없음
+        std::vector<int> CornerOffset(VertexCount + 1, 0);
+        for (int i = 0; i < SurfaceCount; ++i)
+        {
+            for (const int VertexIndex : Surfaces[i].VertexIndex)
+                ++CornerOffset[VertexIndex + 1];
+        }
+
+        for (int v = 0; v < VertexCount; ++v)
+            CornerOffset[v + 1] += CornerOffset[v];
+
+        std::vector<int> Corners(static_cast<MemSize>(SurfaceCount) * 3);
+        {
+            std::vector<int> Fill(CornerOffset.begin(), CornerOffset.end() - 1);
+            for (int i = 0; i < SurfaceCount; ++i)
+            {
+                for (int k = 0; k < 3; ++k)
+                    Corners[Fill[Surfaces[i].VertexIndex[k]]++] = i * 3 + k;
+            }
+        }
+
+        // 3. 정점별로 법선 평면에 투영한 방향을 모서리 각도로 가중 합산 후 정규 직교화
+        ParallelFor(VertexCount, TangentBatchSize, [&](const int Begin, const int End)
+        {
+            for (int v = Begin; v < End; ++v)
+            {
+                Vector3 Normal = Math::Normalize(Vertices[v].Normal);
+                if (Math::LengthSquared(Normal) <= 0)
+                    Normal = Math::MakeVector3(0, 0, 1);
+
+                auto Project = [&Normal](const Vector3& InVector)
+                {
+                    return Math::Sub(InVector, Math::Scale(Normal, Math::Dot(InVector, Normal)));
+                };
+
+                Vector3 SumTangent;
+                Vector3 SumBitangent;
+
+                for (int c = CornerOffset[v]; c < CornerOffset[v + 1]; ++c)
+                {
+                    const int Face = Corners[c] / 3;
+                    const int Corner = Corners[c] % 3;
+
+                    const Vector3& P = Vertices[v].Position;
+                    const Vector3& PNext = Vertices[Surfaces[Face].VertexIndex[(Corner + 1) % 3]].Position;
+                    const Vector3& PPrev = Vertices[Surfaces[Face].VertexIndex[(Corner + 2) % 3]].Position;
+
+                    const Vector3 Edge0 = Math::Normalize(Project(Math::Sub(PNext, P)));
+                    const Vector3 Edge1 = Math::Normalize(Project(Math::Sub(PPrev, P)));
+                    const float Angle = acosf(Math::Clamp(Math::Dot(Edge0, Edge1), -1.0f, 1.0f));
+
+                    SumTangent = Math::Add(SumTangent, Math::Scale(Math::Normalize(Project(FaceTangent[Face])), Angle));
+                    SumBitangent = Math::Add(SumBitangent, Math::Scale(Math::Normalize(Project(FaceBitangent[Face])), Angle));
+                }
+
+                Vector3 Result = Math::Normalize(SumTangent);
+                if (Math::LengthSquared(Result) <= 0)
+                    Result = GetAnyPerpendicular(Normal);
+
+                Tangent[0][v] = Result.X;
+                Tangent[1][v] = Result.Y;
+                Tangent[2][v] = Result.Z;
+                BitangentSign[v] = Math::Dot(Math::Cross(Normal, Result), SumBitangent) < 0 ? -1.0f : 1.0f;
+            }
+        });
+
+        return true;
+    }
+
+    void TangentGenerator::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(Buffer);
+
+        for (float*& Component : Tangent)
+            Component = nullptr;
+
+        BitangentSign = nullptr;
+        VertexCount = 0;
+    }
+
+    Vector3 TangentGenerator::GetTangent(const int InVertexIndex) const
+    {
+        return Math::MakeVector3(Tangent[0][InVertexIndex], Tangent[1][InVertexIndex], Tangent[2][InVertexIndex]);
+    }
+}
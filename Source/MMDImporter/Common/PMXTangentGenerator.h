@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    /**
+     * MikkTSpace 방식의 정점 탄젠트 생성
+     * : 삼각형별 UV 미분 방향을 정점 법선 평면에 투영하고 모서리 각도로 가중 평균합니다.
+     *   정점을 나누지 않으므로 UV 방향이 뒤집히는 이음새 정점은 MikkTSpace 와 결과가 다를 수 있습니다.
+     *   결과는 정점 순서의 SoA 배열이며, 바이탄젠트는 cross(Normal, Tangent) * BitangentSign 입니다.
+     */
+    class TangentGenerator
+    {
+    public:
+        ~TangentGenerator();
+
+        bool Build(const PMXMeshData& InMeshData);
+        void Delete();
+
+        int GetVertexCount() const { return VertexCount; }
+
+        Vector3 GetTangent(const int InVertexIndex) const;
+        float GetBitangentSign(const int InVertexIndex) const { return BitangentSign[InVertexIndex]; }
+
+    public:
+        float* Tangent[3]{ nullptr };
+
+        // +1 / -1
+        float* BitangentSign = nullptr;
+
+    protected:
+        int VertexCount = 0;
+
+        float* Buffer = nullptr;
+    };
+}
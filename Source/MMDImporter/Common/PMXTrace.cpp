@@ -0,0 +1,182 @@
+﻿#include "PMXTrace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace PMX
+{
+    // JSON 문자열 값으로 넣을 수 있게 바꿈
+    static void AppendTraceJsonString(std::string& InOutJson, const char* InText)
+    {
+        InOutJson += '"';
+
+        for (const char* Cursor = InText; *Cursor != 0; ++Cursor)
+        {
+            const unsigned char Char = static_cast<unsigned char>(*Cursor);
+
+            switch (Char)
+            {
+                case '"':  InOutJson += "\\\""; break;
+                case '\\': InOutJson += "\\\\"; break;
+                case '\n': InOutJson += "\\n"; break;
+                case '\r': InOutJson += "\\r"; break;
+                case '\t': InOutJson += "\\t"; break;
+
+                default:
+                    if (Char < 0x20)
+                    {
+                        char Escaped[8];
+                        snprintf(Escaped, sizeof(Escaped), "\\u%04x", Char);
+                        InOutJson += Escaped;
+                    }
+                    else
+                    {
+                        InOutJson += *Cursor;
+                    }
+                    break;
+            }
+        }
+
+        InOutJson += '"';
+    }
+
+    void LoadStats::SetLabel(const std::string& InLabel)
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Label = InLabel;
+    }
+
+    std::string LoadStats::GetLabel() const
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        return Label;
+    }
+
+    void LoadStats::AddEvent(const TraceEvent& InEvent)
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Events.push_back(InEvent);
+    }
+
+    void LoadStats::Reset()
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Events.clear();
+    }
+
+    std::vector<TraceEvent> LoadStats::GetEvents() const
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        return Events;
+    }
+
+    bool LoadStats::GetTotal(const char* InName, TraceEvent& OutTotal) const
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+
+        bool bFound = false;
+        OutTotal = TraceEvent();
+        OutTotal.Name = InName;
+
+        for (const TraceEvent& Event : Events)
+        {
+            if (Event.Name == nullptr || strcmp(Event.Name, InName) != 0)
+                continue;
+
+            if (bFound == false)
+            {
+                OutTotal.BeginNanoseconds = Event.BeginNanoseconds;
+                OutTotal.ThreadID = Event.ThreadID;
+                bFound = true;
+            }
+
+            OutTotal.DurationNanoseconds += Event.DurationNanoseconds;
+            OutTotal.Bytes += Event.Bytes;
+            OutTotal.Count += Event.Count;
+        }
+
+        return bFound;
+    }
+
+    std::string LoadStats::ToChromeTrace() const
+    {
+        const LoadStats* Stats = this;
+        return ToChromeTrace(&Stats, 1);
+    }
+
+    std::string LoadStats::ToChromeTrace(const LoadStats* const* InStats, const int InCount)
+    {
+        std::string Json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool bFirst = true;
+
+        for (int i = 0; i < InCount; ++i)
+        {
+            if (InStats[i] != nullptr)
+                InStats[i]->AppendChromeTraceEvents(Json, bFirst);
+        }
+
+        Json += "\n]}\n";
+        return Json;
+    }
+
+    void LoadStats::AppendChromeTraceEvents(std::string& InOutJson, bool& bInOutFirst) const
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+
+        char Number[128];
+
+        for (const TraceEvent& Event : Events)
+        {
+            InOutJson += bInOutFirst ? "\n" : ",\n";
+            bInOutFirst = false;
+
+            // "X" = 시작 시각과 길이가 있는 완료 이벤트. 시각 단위는 마이크로초
+            InOutJson += "{\"name\":";
+            AppendTraceJsonString(InOutJson, Event.Name != nullptr ? Event.Name : "");
+
+            snprintf(Number, sizeof(Number), ",\"cat\":\"pmx\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+                Event.BeginNanoseconds / 1000.0, Event.DurationNanoseconds / 1000.0, Event.ThreadID);
+            InOutJson += Number;
+
+            InOutJson += ",\"args\":{\"file\":";
+            AppendTraceJsonString(InOutJson, Label.c_str());
+
+            snprintf(Number, sizeof(Number), ",\"bytes\":%llu,\"count\":%lld}}", static_cast<unsigned long long>(Event.Bytes), Event.Count);
+            InOutJson += Number;
+        }
+    }
+
+    UInt64 LoadStats::GetTimeNanoseconds()
+    {
+        static const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+        return static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count());
+    }
+
+    UInt32 LoadStats::GetCurrentThreadID()
+    {
+        return static_cast<UInt32>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    }
+
+    TraceScope::TraceScope(LoadStats* InStats, const char* InName)
+        : Stats(InStats)
+    {
+        if (Stats == nullptr)
+            return;
+
+        Event.Name = InName;
+        Event.ThreadID = LoadStats::GetCurrentThreadID();
+        Event.BeginNanoseconds = LoadStats::GetTimeNanoseconds();
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (Stats == nullptr)
+            return;
+
+        Event.DurationNanoseconds = LoadStats::GetTimeNanoseconds() - Event.BeginNanoseconds;
+        Stats->AddEvent(Event);
+    }
+}
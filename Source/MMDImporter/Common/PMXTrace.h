@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include "PMXTypes.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 0 으로 정의하면 PMX_TRACE_* 매크로가 모두 사라져 측정 비용이 없음
+#ifndef PMX_ENABLE_TRACE
+#define PMX_ENABLE_TRACE 1
+#endif
+
+namespace PMX
+{
+    struct TraceEvent
+    {
+        // 정적 문자열만 사용
+        const char* Name = nullptr;
+
+        // 프로세스에서 처음 시각을 잰 때부터
+        UInt64 BeginNanoseconds = 0;
+        UInt64 DurationNanoseconds = 0;
+
+        // 처리한 바이트 수와 항목 수 (없으면 0)
+        MemSize Bytes = 0;
+        long long Count = 0;
+
+        UInt32 ThreadID = 0;
+    };
+
+    /**
+     * 로드 / 변환 단계별 측정 결과
+     * : 여러 스레드에서 동시에 기록할 수 있습니다. Chrome (chrome://tracing) / Perfetto 에서 여는 JSON 으로 내보냅니다.
+     */
+    class LoadStats
+    {
+    public:
+        LoadStats() = default;
+        explicit LoadStats(const std::string& InLabel) : Label(InLabel) {}
+
+        // 보통 원본 파일 경로. 내보낼 때 이벤트마다 붙음
+        void SetLabel(const std::string& InLabel);
+        std::string GetLabel() const;
+
+        void AddEvent(const TraceEvent& InEvent);
+        void Reset();
+
+        // 기록 순서 (끝난 순서)
+        std::vector<TraceEvent> GetEvents() const;
+
+        // 같은 이름 이벤트의 시간, 바이트, 항목 수 합계. 없으면 false
+        bool GetTotal(const char* InName, TraceEvent& OutTotal) const;
+
+        std::string ToChromeTrace() const;
+
+        // 여러 모델을 한 파일로
+        static std::string ToChromeTrace(const LoadStats* const* InStats, const int InCount);
+
+        static UInt64 GetTimeNanoseconds();
+        static UInt32 GetCurrentThreadID();
+
+    protected:
+        void AppendChromeTraceEvents(std::string& InOutJson, bool& bInOutFirst) const;
+
+    protected:
+        mutable std::mutex Lock;
+
+        std::string Label;
+        std::vector<TraceEvent> Events;
+    };
+
+    /**
+     * 범위가 끝날 때 LoadStats 에 이벤트 하나를 기록
+     * : Stats 가 nullptr 이면 시각도 재지 않습니다. 직접 쓰지 말고 PMX_TRACE_* 매크로를 사용합니다.
+     */
+    class TraceScope
+    {
+    public:
+        TraceScope(LoadStats* InStats, const char* InName);
+        ~TraceScope();
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+        void SetBytes(const MemSize InBytes) { Event.Bytes = InBytes; }
+        void SetCount(const long long InCount) { Event.Count = InCount; }
+
+    protected:
+        LoadStats* Stats = nullptr;
+        TraceEvent Event;
+    };
+}
+
+#if PMX_ENABLE_TRACE
+#define PMX_TRACE_SCOPE(_var_, _stats_, _name_)  PMX::TraceScope _var_(_stats_, _name_)
+#define PMX_TRACE_BYTES(_var_, _bytes_)          _var_.SetBytes(_bytes_)
+#define PMX_TRACE_COUNT(_var_, _count_)          _var_.SetCount(_count_)
+#else
+// 측정 대상만 넘겨받는 매개변수가 쓰이지 않는다는 경고가 나지 않도록 _stats_ 는 남김
+#define PMX_TRACE_SCOPE(_var_, _stats_, _name_)  (void)(_stats_)
+#define PMX_TRACE_BYTES(_var_, _bytes_)          ((void)0)
+#define PMX_TRACE_COUNT(_var_, _count_)          ((void)0)
+#endif
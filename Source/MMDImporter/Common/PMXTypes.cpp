@@ -40,12 +40,12 @@ namespace PMX
         Encoding = (PMX::Text::EncodingType)0;
     }
 
-    PMX::Text::EncodingType PMX::Text::GetEncodingType()
+    PMX::Text::EncodingType PMX::Text::GetEncodingType() const
     {
         return Encoding;
     }
 
-    MemSize PMX::Text::GetBufferSize()
+    MemSize PMX::Text::GetBufferSize() const
     {
         switch (Encoding)
         {
@@ -56,18 +56,86 @@ namespace PMX
         }
     }
 
-    const wchar_t* Text::GetUTF16LE()
+    const wchar_t* Text::GetUTF16LE() const
     {
         return TextData.UTF16LE;
     }
 
-    const char* Text::GetUTF8()
+    const char* Text::GetUTF8() const
     {
         return TextData.UTF8;
     }
 
-    int Text::GetLength()
+    int Text::GetLength() const
     {
         return Length;
     }
-}
\ No newline at end of file
+
+    int VertexData::GetBoneWeights(int OutBoneIndex[4], float OutWeight[4]) const
+    {
+        if (Deform == nullptr)
+            return 0;
+
+        switch (DeformType)
+        {
+            case WeightDeformType::BDEF1:
+            {
+                const BDEF1* Data = static_cast<const BDEF1*>(Deform);
+                OutBoneIndex[0] = Data->BoneIndex0;
+                OutWeight[0] = 1.0f;
+                return 1;
+            }
+
+            case WeightDeformType::BDEF2:
+            {
+                const BDEF2* Data = static_cast<const BDEF2*>(Deform);
+                OutBoneIndex[0] = Data->BoneIndex0;
+                OutBoneIndex[1] = Data->BoneIndex1;
+                OutWeight[0] = Data->Weight0;
+                OutWeight[1] = 1.0f - Data->Weight0;
+                return 2;
+            }
+
+            case WeightDeformType::SDEF:
+            {
+                const SDEF* Data = static_cast<const SDEF*>(Deform);
+                OutBoneIndex[0] = Data->BoneIndex0;
+                OutBoneIndex[1] = Data->BoneIndex1;
+                OutWeight[0] = Data->Weight0;
+                OutWeight[1] = 1.0f - Data->Weight0;
+                return 2;
+            }
+
+            case WeightDeformType::BDEF4:
+            {
+                const BDEF4* Data = static_cast<const BDEF4*>(Deform);
+                OutBoneIndex[0] = Data->BoneIndex0;
+                OutBoneIndex[1] = Data->BoneIndex1;
+                OutBoneIndex[2] = Data->BoneIndex2;
+                OutBoneIndex[3] = Data->BoneIndex3;
+                OutWeight[0] = Data->Weight0;
+                OutWeight[1] = Data->Weight1;
+                OutWeight[2] = Data->Weight2;
+                OutWeight[3] = Data->Weight3;
+                return 4;
+            }
+
+            case WeightDeformType::QDEF:
+            {
+                const QDEF* Data = static_cast<const QDEF*>(Deform);
+                OutBoneIndex[0] = Data->BoneIndex0;
+                OutBoneIndex[1] = Data->BoneIndex1;
+                OutBoneIndex[2] = Data->BoneIndex2;
+                OutBoneIndex[3] = Data->BoneIndex3;
+                OutWeight[0] = Data->Weight0;
+                OutWeight[1] = Data->Weight1;
+                OutWeight[2] = Data->Weight2;
+                OutWeight[3] = Data->Weight3;
+                return 4;
+            }
+
+            default:
+                return 0;
+        }
+    }
+}
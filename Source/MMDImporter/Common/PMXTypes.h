@@ -2,6 +2,8 @@
 
 #include "PMXDefines.h"
 
+#include <cstddef>
+
 namespace PMX
 {
     typedef char            Byte;
@@ -14,6 +16,7 @@ namespace PMX
     typedef unsigned char   UInt8;
     typedef unsigned short  UInt16;
     typedef unsigned int    UInt32;
+    typedef unsigned long long UInt64;
 
     typedef size_t          MemSize;
 
@@ -61,14 +64,14 @@ namespace PMX
         void SetText(Byte* const InBuffer, const MemSize InBufferSize, const Text::EncodingType InEncoding);
         void Delete();
 
-        Text::EncodingType GetEncodingType();
-        const wchar_t* GetUTF16LE();
-        const char* GetUTF8();
+        Text::EncodingType GetEncodingType() const;
+        const wchar_t* GetUTF16LE() const;
+        const char* GetUTF8() const;
 
-        int GetLength();
+        int GetLength() const;
 
         // Null 끝을 포함한 메모리 크기
-        MemSize GetBufferSize();
+        MemSize GetBufferSize() const;
 
     protected:
         int Length = 0;
@@ -192,6 +195,10 @@ namespace PMX
 
         float EdgeScale = 0;
 
+        // 변형 방식에 관계 없이 (본, 가중치) 목록으로 꺼냄. 반환 값은 영향 본 수 (0~4)
+        // : BDEF2/SDEF 의 두번째 가중치는 1.0 - Weight0 으로 채우며, 합을 1.0 으로 맞추지는 않습니다.
+        int GetBoneWeights(int OutBoneIndex[4], float OutWeight[4]) const;
+
         ~VertexData()
         {
             PMX_SAFE_DELETE(Deform);
@@ -281,7 +288,8 @@ namespace PMX
         //   Toon 값은 표준 텍스처 및 환경 텍스처 인덱스와 매우 유사한 텍스처 인덱스가 됩니다.
         //   1인 경우 Toon 값은 10개의 내부 Toon 텍스처 세트를 참조하는 바이트가 됩니다
         //   (대부분 구현은 "toon01.bmp" ~ "toon10.bmp"를 내부 텍스처로 사용합니다. 위의 텍스처에 대해 예약된 이름 참조).
-        UInt8 ToonValue = 0;
+        // : Texture 인 경우 텍스처 인덱스 크기로 저장되므로 int 로 읽습니다.
+        int ToonValue = 0;
 
         // 스크립팅이나 추가 데이터에 사용됩니다.
         Text MetaData;
@@ -311,7 +319,7 @@ namespace PMX
             Enabled              = 1 <<  4,  // ???
             UseIK                = 1 <<  5,  // 역 운동학(물리학) 사용
             //                   = 1 <<  6,  // 뭔가 쓰는 것 같은데 확인 필요 : https://gist.github.com/felixjones/f8a06bd48f9da9a4539f?permalink_comment_id=4559705#gistcomment-4559705
-            //                   = 1 <<  7,  // 안씀
+            LocalInheritance     = 1 <<  7,  // 로컬 부여. InheritEvaluator 는 일반 부여와 같게 계산
 
             // 높은 8bit
             InheritRotation      = 1 <<  8,  // 회전은 다른 뼈에서 상속됩니다.
@@ -327,7 +335,7 @@ namespace PMX
         union
         {
             int BoneIndex;
-            Vector3 Vector3;
+            PMX::Vector3 Vector3;
         } TailPositionData = { 0 };
 
         // InheritRotation/InheritTranslation 플래그 중 하나가 설정된 경우 사용됩니다.
@@ -379,6 +387,10 @@ namespace PMX
 
         ~BoneData()
         {
+            PMX_SAFE_DELETE(InheritBoneData);
+            PMX_SAFE_DELETE(FixedAxisData);
+            PMX_SAFE_DELETE(LocalCoordinateData);
+            PMX_SAFE_DELETE(ExternalParentData);
             PMX_SAFE_DELETE_ARRAY(IKData.ArrayLink);
         }
     };
@@ -520,7 +532,7 @@ namespace PMX
             Sphere,
             Box,
             Capsule
-        } ShapeType = (enum class ShapeType)-1;
+        } ShapeType = (enum ShapeType)-1;
 
         Vector3 ShapeSize;
         Vector3 ShapePosition;
@@ -537,7 +549,7 @@ namespace PMX
             FollowBone,
             Physics,
             PhysicsBone
-        } PhysicsMode = (enum class PhysicsMode)-1;
+        } PhysicsMode = (enum PhysicsMode)-1;
     };
 
     struct JointData
@@ -655,5 +667,11 @@ namespace PMX
         {
             int VertexIndex;
         }* ArrayVertexPin = nullptr;
+
+        ~SoftBodyData()
+        {
+            PMX_SAFE_DELETE_ARRAY(ArrayAnchorRigidbody);
+            PMX_SAFE_DELETE_ARRAY(ArrayVertexPin);
+        }
     };
 }
@@ -0,0 +1,221 @@
+﻿#include "PMXValidator.h"
+
+namespace PMX
+{
+    bool ModelValidator::Validate(const PMXMeshData& InMeshData, const int InMaxRecordedIssues)
+    {
+        typedef LoadProgress::SectionType SectionType;
+
+        Delete();
+        MaxRecordedIssues = InMaxRecordedIssues;
+
+        const int VertexCount = InMeshData.GetVertexCount();
+        const int TextureCount = InMeshData.GetTextureCount();
+        const int MaterialCount = InMeshData.GetMaterialCount();
+        const int BoneCount = InMeshData.GetBoneCount();
+        const int MorphCount = InMeshData.GetMorphCount();
+        const int RigidbodyCount = InMeshData.GetRigidbodyCount();
+
+        // 정점: 가중치가 0 인 빈 슬롯은 -1 이어도 됨 (BDEF4 의 남는 슬롯)
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            const VertexData& Vertex = InMeshData.GetVertices()[i];
+
+            int BoneIndex[4] = { 0, };
+            float Weight[4] = { 0, };
+
+            const int InfluenceCount = Vertex.GetBoneWeights(BoneIndex, Weight);
+            if (InfluenceCount == 0)
+            {
+                Check(SectionType::Vertices, i, "DeformType", static_cast<int>(Vertex.DeformType), 0, static_cast<int>(VertexData::WeightDeformType::QDEF) + 1);
+                continue;
+            }
+
+            for (int j = 0; j < InfluenceCount; ++j)
+            {
+                if (BoneIndex[j] == -1 && Weight[j] == 0)
+                    continue;
+
+                Check(SectionType::Vertices, i, "BoneIndex", BoneIndex[j], 0, BoneCount);
+            }
+        }
+
+        for (int i = 0; i < InMeshData.GetSurfaceCount(); ++i)
+        {
+            for (const int VertexIndex : InMeshData.GetSurfaces()[i].VertexIndex)
+                Check(SectionType::Surfaces, i, "VertexIndex", VertexIndex, 0, VertexCount);
+        }
+
+        // 재질 삼각형 수 합은 전체 인덱스 수와 같아야 함
+        long long MaterialSurfaceCount = 0;
+
+        for (int i = 0; i < MaterialCount; ++i)
+        {
+            const MaterialData& Material = InMeshData.GetMaterials()[i];
+
+            Check(SectionType::Materials, i, "TextureIndex", Material.TextureIndex, -1, TextureCount);
+            Check(SectionType::Materials, i, "EnvironmentTextureIndex", Material.EnvironmentTextureIndex, -1, TextureCount);
+
+            if (Material.ToonReference == MaterialData::ToonReferenceType::Internal)
+                Check(SectionType::Materials, i, "InternalToon", Material.ToonValue, 0, 10);
+            else
+                Check(SectionType::Materials, i, "ToonTextureIndex", Material.ToonValue, -1, TextureCount);
+
+            Check(SectionType::Materials, i, "SurfaceCount", Material.SurfaceCount, 0, 0x7fffffff);
+            MaterialSurfaceCount += Material.SurfaceCount;
+        }
+
+        if (MaterialCount > 0 && MaterialSurfaceCount != static_cast<long long>(InMeshData.GetSurfaceCount()) * 3)
+        {
+            const int Total = MaterialSurfaceCount > 0x7fffffff ? 0x7fffffff : static_cast<int>(MaterialSurfaceCount);
+            Check(SectionType::Materials, MaterialCount - 1, "SurfaceCountTotal", Total, InMeshData.GetSurfaceCount() * 3, InMeshData.GetSurfaceCount() * 3 + 1);
+        }
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            const BoneData& Bone = InMeshData.GetBones()[i];
+
+            Check(SectionType::Bones, i, "ParentBoneIndex", Bone.ParentBoneIndex, -1, BoneCount);
+
+            if (Bone.Flags & BoneData::Flag::IndexedTailPosition)
+                Check(SectionType::Bones, i, "TailBoneIndex", Bone.TailPositionData.BoneIndex, -1, BoneCount);
+
+            if (Bone.InheritBoneData != nullptr)
+                Check(SectionType::Bones, i, "InheritParentBoneIndex", Bone.InheritBoneData->ParentBoneIndex, -1, BoneCount);
+
+            if (Bone.Flags & BoneData::Flag::UseIK)
+            {
+                Check(SectionType::Bones, i, "IKTargetIndex", Bone.IKData.TargetIndex, 0, BoneCount);
+
+                for (int j = 0; j < Bone.IKData.LinkCount && Bone.IKData.ArrayLink != nullptr; ++j)
+                    Check(SectionType::Bones, i, "IKLinkBoneIndex", Bone.IKData.ArrayLink[j].BoneIndex, 0, BoneCount);
+            }
+        }
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            const MorphData& Morph = InMeshData.GetMorphs()[i];
+
+            if (Morph.ArrayOffset == nullptr)
+                continue;
+
+            for (int j = 0; j < Morph.OffsetCount; ++j)
+            {
+                switch (Morph.Type)
+                {
+                    case MorphData::MorphType::Group:
+                        Check(SectionType::Morphs, i, "MorphIndex", static_cast<const MorphData::OffsetGroup*>(Morph.ArrayOffset)[j].MorphIndex, 0, MorphCount);
+                        break;
+
+                    case MorphData::MorphType::Vertex:
+                        Check(SectionType::Morphs, i, "VertexIndex", static_cast<const MorphData::OffsetVertex*>(Morph.ArrayOffset)[j].VertexIndex, 0, VertexCount);
+                        break;
+
+                    case MorphData::MorphType::Bone:
+                        Check(SectionType::Morphs, i, "BoneIndex", static_cast<const MorphData::OffsetBone*>(Morph.ArrayOffset)[j].BoneIndex, 0, BoneCount);
+                        break;
+
+                    case MorphData::MorphType::UV:
+                    case MorphData::MorphType::AdditionalUV1:
+                    case MorphData::MorphType::AdditionalUV2:
+                    case MorphData::MorphType::AdditionalUV3:
+                    case MorphData::MorphType::AdditionalUV4:
+                        Check(SectionType::Morphs, i, "VertexIndex", static_cast<const MorphData::OffsetUV*>(Morph.ArrayOffset)[j].VertexIndex, 0, VertexCount);
+                        break;
+
+                    // -1 은 모든 재질
+                    case MorphData::MorphType::Material:
+                        Check(SectionType::Morphs, i, "MaterialIndex", static_cast<const MorphData::OffsetMaterial*>(Morph.ArrayOffset)[j].MaterialIndex, -1, MaterialCount);
+                        break;
+
+                    case MorphData::MorphType::Flip:
+                        Check(SectionType::Morphs, i, "MorphIndex", static_cast<const MorphData::OffsetFlip*>(Morph.ArrayOffset)[j].MorphIndex, 0, MorphCount);
+                        break;
+
+                    case MorphData::MorphType::Impulse:
+                        Check(SectionType::Morphs, i, "RigidbodyIndex", static_cast<const MorphData::OffsetImpulse*>(Morph.ArrayOffset)[j].RigidbodyIndex, 0, RigidbodyCount);
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+        }
+
+        for (int i = 0; i < InMeshData.GetDisplayFrameCount(); ++i)
+        {
+            const DisplayFrameData& DisplayFrame = InMeshData.GetDisplayFrames()[i];
+
+            for (int j = 0; j < DisplayFrame.FrameCount && DisplayFrame.ArrayFrame != nullptr; ++j)
+            {
+                const DisplayFrameData::Frame& Frame = DisplayFrame.ArrayFrame[j];
+
+                if (Frame.Type == DisplayFrameData::Frame::FrameType::Morph)
+                    Check(SectionType::DisplayFrames, i, "MorphIndex", Frame.Index, 0, MorphCount);
+                else
+                    Check(SectionType::DisplayFrames, i, "BoneIndex", Frame.Index, 0, BoneCount);
+            }
+        }
+
+        for (int i = 0; i < RigidbodyCount; ++i)
+            Check(SectionType::Rigidbodies, i, "BoneIndex", InMeshData.GetRigidbodies()[i].BoneIndexRelated, -1, BoneCount);
+
+        for (int i = 0; i < InMeshData.GetJointCount(); ++i)
+        {
+            const JointData& Joint = InMeshData.GetJoints()[i];
+
+            Check(SectionType::Joints, i, "RigidbodyIndexA", Joint.RigidbodyIndexA, -1, RigidbodyCount);
+            Check(SectionType::Joints, i, "RigidbodyIndexB", Joint.RigidbodyIndexB, -1, RigidbodyCount);
+        }
+
+        for (int i = 0; i < InMeshData.GetSoftBodyCount(); ++i)
+        {
+            const SoftBodyData& SoftBody = InMeshData.GetSoftBodies()[i];
+
+            Check(SectionType::SoftBodies, i, "MaterialIndex", SoftBody.MaterialIndex, -1, MaterialCount);
+
+            for (int j = 0; j < SoftBody.AnchorRigidbodyCount && SoftBody.ArrayAnchorRigidbody != nullptr; ++j)
+            {
+                Check(SectionType::SoftBodies, i, "AnchorRigidbodyIndex", SoftBody.ArrayAnchorRigidbody[j].RigidbodyIndex, 0, RigidbodyCount);
+                Check(SectionType::SoftBodies, i, "AnchorVertexIndex", SoftBody.ArrayAnchorRigidbody[j].VertexIndex, 0, VertexCount);
+            }
+
+            for (int j = 0; j < SoftBody.VertexPinCount && SoftBody.ArrayVertexPin != nullptr; ++j)
+                Check(SectionType::SoftBodies, i, "PinVertexIndex", SoftBody.ArrayVertexPin[j].VertexIndex, 0, VertexCount);
+        }
+
+        return IssueCount == 0;
+    }
+
+    void ModelValidator::Delete()
+    {
+        IssueCount = 0;
+
+        for (int& Count : SectionIssueCount)
+            Count = 0;
+
+        Issues.clear();
+    }
+
+    void ModelValidator::Check(const LoadProgress::SectionType InSection, const int InItem, const char* InField, const int InIndex, const int InMin, const int InLimit)
+    {
+        if (InIndex >= InMin && InIndex < InLimit)
+            return;
+
+        ++IssueCount;
+        ++SectionIssueCount[static_cast<int>(InSection)];
+
+        if (static_cast<int>(Issues.size()) >= MaxRecordedIssues)
+            return;
+
+        IndexIssue Issue;
+        Issue.Section = InSection;
+        Issue.Item = InItem;
+        Issue.Field = InField;
+        Issue.Index = InIndex;
+        Issue.Min = InMin;
+        Issue.Limit = InLimit;
+
+        Issues.push_back(Issue);
+    }
+}
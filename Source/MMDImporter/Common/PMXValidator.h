@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+#include <vector>
+
+namespace PMX
+{
+    // 범위를 벗어난 인덱스 하나
+    struct IndexIssue
+    {
+        LoadProgress::SectionType Section = LoadProgress::SectionType::Header;
+
+        // 섹션 안의 항목 번호 (정점, 삼각형, 본 ...)
+        int Item = 0;
+
+        // 항목 안의 필드 이름 (예: "BoneIndex", "VertexIndex")
+        const char* Field = "";
+
+        // 잘못된 값과 허용 범위 [Min, Limit)
+        int Index = 0;
+        int Min = 0;
+        int Limit = 0;
+    };
+
+    /**
+     * 인덱스 범위 검사
+     * : 모든 섹션의 정점 / 본 / 텍스처 / 재질 / 모프 / 강체 참조가 가리키는 배열 안에 있는지 확인합니다.
+     *   "없음" 을 뜻하는 -1 은 파일 형식이 허용하는 필드에서만 통과시킵니다.
+     */
+    class ModelValidator
+    {
+    public:
+        // 문제가 없으면 true. 문제는 InMaxRecordedIssues 개까지만 기록하고 수는 모두 셈
+        bool Validate(const PMXMeshData& InMeshData, const int InMaxRecordedIssues = 100);
+        void Delete();
+
+        int GetIssueCount() const { return IssueCount; }
+        int GetSectionIssueCount(const LoadProgress::SectionType InSection) const { return SectionIssueCount[static_cast<int>(InSection)]; }
+
+        const std::vector<IndexIssue>& GetIssues() const { return Issues; }
+
+    protected:
+        void Check(const LoadProgress::SectionType InSection, const int InItem, const char* InField, const int InIndex, const int InMin, const int InLimit);
+
+    protected:
+        int MaxRecordedIssues = 0;
+
+        int IssueCount = 0;
+        int SectionIssueCount[static_cast<int>(LoadProgress::SectionType::Count)] = { 0, };
+
+        std::vector<IndexIssue> Issues;
+    };
+}
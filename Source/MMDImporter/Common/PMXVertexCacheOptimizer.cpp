@@ -0,0 +1,372 @@
+﻿#include "PMXVertexCacheOptimizer.h"
+#include "PMXMeshSection.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation" 의 점수 계산
+    static float GetForsythVertexScore(const int InCachePosition, const int InRemainingValence, const int InCacheSize)
+    {
+        if (InRemainingValence <= 0)
+            return -1.0f;
+
+        float Score = 0;
+        if (InCachePosition >= 0)
+        {
+            // 방금 쓴 삼각형의 정점은 다시 쓰면 바로 앞 삼각형과 겹치므로 고정 점수
+            if (InCachePosition < 3)
+                Score = 0.75f;
+            else
+                Score = powf(1.0f - static_cast<float>(InCachePosition - 3) / (InCacheSize - 3), 1.5f);
+        }
+
+        // 남은 삼각형이 적은 정점을 먼저 끝내도록 가산점
+        return Score + 2.0f / sqrtf(static_cast<float>(InRemainingValence));
+    }
+
+    // 로컬 인덱스 기준으로 삼각형 그리기 순서를 OutTriangleOrder 에 기록
+    static void OptimizeForsyth(const int* InIndices, const int InTriangleCount, const int InVertexCount, const int InCacheSize, int* OutTriangleOrder)
+    {
+        std::vector<int> Remaining(InVertexCount, 0);
+        for (int i = 0; i < InTriangleCount * 3; ++i)
+            ++Remaining[InIndices[i]];
+
+        // 정점 → 삼각형 인접 목록. 남은 삼각형은 각 구간 앞쪽에 유지
+        std::vector<int> AdjacencyOffset(InVertexCount + 1, 0);
+        for (int v = 0; v < InVertexCount; ++v)
+            AdjacencyOffset[v + 1] = AdjacencyOffset[v] + Remaining[v];
+
+        std::vector<int> Adjacency(InTriangleCount * 3);
+        {
+            std::vector<int> Fill(AdjacencyOffset.begin(), AdjacencyOffset.end() - 1);
+            for (int t = 0; t < InTriangleCount; ++t)
+            {
+                for (int k = 0; k < 3; ++k)
+                    Adjacency[Fill[InIndices[t * 3 + k]]++] = t;
+            }
+        }
+
+        std::vector<int> CachePosition(InVertexCount, -1);
+        std::vector<float> VertexScore(InVertexCount);
+        for (int v = 0; v < InVertexCount; ++v)
+            VertexScore[v] = GetForsythVertexScore(-1, Remaining[v], InCacheSize);
+
+        std::vector<float> TriangleScore(InTriangleCount);
+        std::vector<UInt8> Emitted(InTriangleCount, 0);
+
+        int Best = -1;
+        float BestScore = -1.0f;
+        for (int t = 0; t < InTriangleCount; ++t)
+        {
+            TriangleScore[t] = VertexScore[InIndices[t * 3]] + VertexScore[InIndices[t * 3 + 1]] + VertexScore[InIndices[t * 3 + 2]];
+            if (TriangleScore[t] > BestScore)
+            {
+                BestScore = TriangleScore[t];
+                Best = t;
+            }
+        }
+
+        std::vector<int> Cache;
+        std::vector<int> NewCache;
+        Cache.reserve(InCacheSize + 3);
+        NewCache.reserve(InCacheSize + 3);
+
+        int ScanCursor = 0;
+
+        for (int Output = 0; Output < InTriangleCount; ++Output)
+        {
+            // 캐시 주변에 후보가 없으면 아직 그리지 않은 삼각형 중 앞의 것부터
+            if (Best < 0)
+            {
+                while (Emitted[ScanCursor] != 0)
+                    ++ScanCursor;
+
+                Best = ScanCursor;
+            }
+
+            OutTriangleOrder[Output] = Best;
+            Emitted[Best] = 1;
+
+            NewCache.clear();
+            for (int k = 0; k < 3; ++k)
+            {
+                const int v = InIndices[Best * 3 + k];
+
+                // 인접 목록의 남은 구간에서 제거
+                int* Begin = Adjacency.data() + AdjacencyOffset[v];
+                int* End = Begin + Remaining[v];
+                std::iter_swap(std::find(Begin, End, Best), End - 1);
+                --Remaining[v];
+
+                NewCache.push_back(v);
+            }
+
+            for (const int v : Cache)
+            {
+                if (v != NewCache[0] && v != NewCache[1] && v != NewCache[2])
+                    NewCache.push_back(v);
+            }
+
+            Cache.swap(NewCache);
+
+            // 캐시 밖으로 밀려난 정점까지 점수 갱신 후, 캐시 정점이 가진 삼각형 중 최고 점수 선택
+            Best = -1;
+            BestScore = -1.0f;
+
+            for (int i = 0; i < static_cast<int>(Cache.size()); ++i)
+            {
+                const int v = Cache[i];
+                CachePosition[v] = i < InCacheSize ? i : -1;
+                VertexScore[v] = GetForsythVertexScore(CachePosition[v], Remaining[v], InCacheSize);
+            }
+
+            for (int i = 0; i < static_cast<int>(Cache.size()); ++i)
+            {
+                const int v = Cache[i];
+
+                for (int a = AdjacencyOffset[v], End = AdjacencyOffset[v] + Remaining[v]; a < End; ++a)
+                {
+                    const int t = Adjacency[a];
+                    TriangleScore[t] = VertexScore[InIndices[t * 3]] + VertexScore[InIndices[t * 3 + 1]] + VertexScore[InIndices[t * 3 + 2]];
+
+                    if (TriangleScore[t] > BestScore)
+                    {
+                        BestScore = TriangleScore[t];
+                        Best = t;
+                    }
+                }
+            }
+
+            if (static_cast<int>(Cache.size()) > InCacheSize)
+                Cache.resize(InCacheSize);
+        }
+    }
+
+    // FIFO 캐시 미스 수
+    static int CountCacheMisses(const int* InIndices, const int* InTriangleOrder, const int InTriangleCount, const int InVertexCount, const int InCacheSize)
+    {
+        std::vector<int> InsertTime(InVertexCount, -InCacheSize - 1);
+        int Misses = 0;
+
+        for (int i = 0; i < InTriangleCount; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const int v = InIndices[InTriangleOrder[i] * 3 + k];
+                if (Misses - InsertTime[v] > InCacheSize)
+                {
+                    InsertTime[v] = Misses;
+                    ++Misses;
+                }
+            }
+        }
+
+        return Misses;
+    }
+
+    // Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" 방식의 묶음 정렬
+    static void OptimizeOverdraw(const int* InIndices, const Vector3* InPositions, const int InTriangleCount, const int InVertexCount, const VertexCacheOptions& InOptions, int* InOutTriangleOrder)
+    {
+        // 세 정점이 모두 캐시 미스인 삼각형에서 묶음을 나눔
+        std::vector<int> ClusterBegin;
+        {
+            std::vector<int> InsertTime(InVertexCount, -InOptions.AnalyzeCacheSize - 1);
+            int Misses = 0;
+
+            for (int i = 0; i < InTriangleCount; ++i)
+            {
+                int TriangleMisses = 0;
+                for (int k = 0; k < 3; ++k)
+                {
+                    const int v = InIndices[InOutTriangleOrder[i] * 3 + k];
+                    if (Misses - InsertTime[v] > InOptions.AnalyzeCacheSize)
+                    {
+                        InsertTime[v] = Misses;
+                        ++Misses;
+                        ++TriangleMisses;
+                    }
+                }
+
+                if (i == 0 || TriangleMisses == 3)
+                    ClusterBegin.push_back(i);
+            }
+        }
+
+        const int ClusterCount = static_cast<int>(ClusterBegin.size());
+        if (ClusterCount <= 1)
+            return;
+
+        ClusterBegin.push_back(InTriangleCount);
+
+        Vector3 MeshCentroid;
+        for (int v = 0; v < InVertexCount; ++v)
+            MeshCentroid = Math::Add(MeshCentroid, InPositions[v]);
+        MeshCentroid = Math::Scale(MeshCentroid, 1.0f / InVertexCount);
+
+        // 바깥을 향하는 묶음이 먼저 그려지도록 (중심 → 묶음) · 묶음 법선 이 큰 순서
+        std::vector<float> SortKey(ClusterCount);
+        for (int c = 0; c < ClusterCount; ++c)
+        {
+            Vector3 Centroid;
+            Vector3 Normal;
+            float Area = 0;
+
+            for (int i = ClusterBegin[c]; i < ClusterBegin[c + 1]; ++i)
+            {
+                const int t = InOutTriangleOrder[i];
+                const Vector3& P0 = InPositions[InIndices[t * 3]];
+                const Vector3& P1 = InPositions[InIndices[t * 3 + 1]];
+                const Vector3& P2 = InPositions[InIndices[t * 3 + 2]];
+
+                const Vector3 FaceNormal = Math::Cross(Math::Sub(P1, P0), Math::Sub(P2, P0));
+                const float FaceArea = Math::Length(FaceNormal);
+
+                Normal = Math::Add(Normal, FaceNormal);
+                Centroid = Math::Add(Centroid, Math::Scale(Math::Add(Math::Add(P0, P1), P2), FaceArea / 3.0f));
+                Area += FaceArea;
+            }
+
+            Centroid = Area > 0 ? Math::Scale(Centroid, 1.0f / Area) : InPositions[InIndices[InOutTriangleOrder[ClusterBegin[c]] * 3]];
+            SortKey[c] = Math::Dot(Math::Sub(Centroid, MeshCentroid), Math::Normalize(Normal));
+        }
+
+        std::vector<int> ClusterOrder(ClusterCount);
+        for (int c = 0; c < ClusterCount; ++c)
+            ClusterOrder[c] = c;
+
+        std::stable_sort(ClusterOrder.begin(), ClusterOrder.end(), [&SortKey](const int A, const int B)
+        {
+            return SortKey[A] > SortKey[B];
+        });
+
+        std::vector<int> Sorted;
+        Sorted.reserve(InTriangleCount);
+        for (const int c : ClusterOrder)
+            Sorted.insert(Sorted.end(), InOutTriangleOrder + ClusterBegin[c], InOutTriangleOrder + ClusterBegin[c + 1]);
+
+        const int MissesBefore = CountCacheMisses(InIndices, InOutTriangleOrder, InTriangleCount, InVertexCount, InOptions.AnalyzeCacheSize);
+        const int MissesAfter = CountCacheMisses(InIndices, Sorted.data(), InTriangleCount, InVertexCount, InOptions.AnalyzeCacheSize);
+
+        if (MissesAfter <= MissesBefore * InOptions.OverdrawThreshold)
+            std::copy(Sorted.begin(), Sorted.end(), InOutTriangleOrder);
+    }
+
+    bool VertexCacheOptimizer::Optimize(PMXMeshData& InOutMeshData, const VertexCacheOptions& InOptions)
+    {
+        const int VertexCount = InOutMeshData.GetVertexCount();
+        const VertexData* Vertices = InOutMeshData.GetVertices();
+        SurfaceData* Surfaces = InOutMeshData.GetSurfaces();
+
+        StatsBefore = Analyze(Surfaces, InOutMeshData.GetSurfaceCount(), VertexCount, InOptions.AnalyzeCacheSize);
+        StatsAfter = StatsBefore;
+
+        MeshSectionBuilder Sections;
+        if (Sections.Build(InOutMeshData) == false)
+            return false;
+
+        const int OptimizeCacheSize = std::max(4, InOptions.OptimizeCacheSize);
+
+        // 재질 구간은 서로 겹치지 않으므로 각각 바로 원본에 기록
+        ParallelFor(Sections.GetSectionCount(), 1, [&](const int Begin, const int End)
+        {
+            for (int s = Begin; s < End; ++s)
+            {
+                const MeshSectionBuilder::Section& CurSection = Sections.GetSections()[s];
+                if (CurSection.TriangleCount <= 0)
+                    continue;
+
+                const int* LocalIndices = Sections.GetIndices() + CurSection.IndexBegin;
+                const int* VertexIndices = Sections.GetVertexIndices() + CurSection.VertexBegin;
+
+                std::vector<int> TriangleOrder(CurSection.TriangleCount);
+                OptimizeForsyth(LocalIndices, CurSection.TriangleCount, CurSection.VertexCount, OptimizeCacheSize, TriangleOrder.data());
+
+                if (InOptions.bOptimizeOverdraw)
+                {
+                    std::vector<Vector3> Positions(CurSection.VertexCount);
+                    for (int v = 0; v < CurSection.VertexCount; ++v)
+                        Positions[v] = Vertices[VertexIndices[v]].Position;
+
+                    OptimizeOverdraw(LocalIndices, Positions.data(), CurSection.TriangleCount, CurSection.VertexCount, InOptions, TriangleOrder.data());
+                }
+
+                SurfaceData* Output = Surfaces + CurSection.FirstSurface;
+                for (int t = 0; t < CurSection.TriangleCount; ++t)
+                {
+                    for (int k = 0; k < 3; ++k)
+                        Output[t].VertexIndex[k] = VertexIndices[LocalIndices[TriangleOrder[t] * 3 + k]];
+                }
+            }
+        });
+
+        if (InOptions.bOptimizeVertexFetch)
+        {
+            // 처음 사용되는 순서로 번호를 매기고, 삼각형이 쓰지 않는 정점은 원래 순서대로 뒤에 둠
+            std::vector<int> OldToNew(VertexCount, -1);
+            int NextIndex = 0;
+
+            for (int i = 0; i < InOutMeshData.GetSurfaceCount(); ++i)
+            {
+                for (const int VertexIndex : Surfaces[i].VertexIndex)
+                {
+                    if (OldToNew[VertexIndex] < 0)
+                        OldToNew[VertexIndex] = NextIndex++;
+                }
+            }
+
+            for (int v = 0; v < VertexCount; ++v)
+            {
+                if (OldToNew[v] < 0)
+                    OldToNew[v] = NextIndex++;
+            }
+
+            if (InOutMeshData.RemapVertices(OldToNew.data(), VertexCount) == false)
+                return false;
+        }
+
+        StatsAfter = Analyze(InOutMeshData.GetSurfaces(), InOutMeshData.GetSurfaceCount(), InOutMeshData.GetVertexCount(), InOptions.AnalyzeCacheSize);
+        return true;
+    }
+
+    VertexCacheStats VertexCacheOptimizer::Analyze(const SurfaceData* InSurfaces, const int InSurfaceCount, const int InVertexCount, const int InCacheSize)
+    {
+        VertexCacheStats Stats;
+        if (InSurfaces == nullptr || InSurfaceCount <= 0 || InVertexCount <= 0)
+            return Stats;
+
+        std::vector<int> InsertTime(InVertexCount, -InCacheSize - 1);
+        std::vector<UInt8> Used(InVertexCount, 0);
+        int Misses = 0;
+        int UsedCount = 0;
+
+        for (int i = 0; i < InSurfaceCount; ++i)
+        {
+            for (const int v : InSurfaces[i].VertexIndex)
+            {
+                if (v < 0 || v >= InVertexCount)
+                    continue;
+
+                if (Used[v] == 0)
+                {
+                    Used[v] = 1;
+                    ++UsedCount;
+                }
+
+                if (Misses - InsertTime[v] > InCacheSize)
+                {
+                    InsertTime[v] = Misses;
+                    ++Misses;
+                }
+            }
+        }
+
+        Stats.ACMR = static_cast<float>(Misses) / InSurfaceCount;
+        Stats.ATVR = UsedCount > 0 ? static_cast<float>(Misses) / UsedCount : 0;
+        return Stats;
+    }
+}
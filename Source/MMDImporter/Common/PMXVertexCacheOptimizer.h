@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct VertexCacheOptions
+    {
+        // Forsyth 점수 계산에 쓰는 LRU 캐시 크기
+        int OptimizeCacheSize = 32;
+
+        // 결과 측정(ACMR/ATVR)에 쓰는 FIFO 캐시 크기. 보수적인 하드웨어 기준
+        int AnalyzeCacheSize = 16;
+
+        // 캐시 최적화 후 삼각형 묶음을 바깥쪽을 향하는 순서로 정렬해 오버드로 감소
+        bool bOptimizeOverdraw = false;
+
+        // 오버드로 정렬로 ACMR 이 이 배율보다 나빠지면 정렬 결과를 버림
+        float OverdrawThreshold = 1.05f;
+
+        // 정점을 처음 사용되는 순서로 다시 번호 매김
+        bool bOptimizeVertexFetch = true;
+    };
+
+    struct VertexCacheStats
+    {
+        // Average Cache Miss Ratio : 삼각형당 캐시 미스 (0.5 ~ 3.0)
+        float ACMR = 0;
+
+        // Average Transformed Vertex Ratio : 정점당 캐시 미스 (1.0 이 최적)
+        float ATVR = 0;
+    };
+
+    /**
+     * 정점 캐시 / 오버드로 / 정점 읽기 순서 최적화
+     * : 재질별 삼각형 구간 안에서만 순서를 바꾸므로 MaterialData::SurfaceCount 는 그대로 유지됩니다.
+     */
+    class VertexCacheOptimizer
+    {
+    public:
+        bool Optimize(PMXMeshData& InOutMeshData, const VertexCacheOptions& InOptions = VertexCacheOptions());
+
+        const VertexCacheStats& GetStatsBefore() const { return StatsBefore; }
+        const VertexCacheStats& GetStatsAfter() const { return StatsAfter; }
+
+        // FIFO 캐시로 인덱스 목록을 그려 보고 ACMR/ATVR 계산
+        static VertexCacheStats Analyze(const SurfaceData* InSurfaces, const int InSurfaceCount, const int InVertexCount, const int InCacheSize);
+
+    protected:
+        VertexCacheStats StatsBefore;
+        VertexCacheStats StatsAfter;
+    };
+}
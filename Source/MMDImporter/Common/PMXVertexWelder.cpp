@@ -0,0 +1,308 @@
+﻿#include "PMXVertexWelder.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace PMX
+{
+    // 정점이 참조되는 정점/UV 모프 오프셋
+    struct WeldMorphReference
+    {
+        int MorphIndex = 0;
+        Vector4 Offset;
+    };
+
+    struct WeldCellEntry
+    {
+        UInt64 Key = 0;
+        int VertexIndex = 0;
+    };
+
+    static inline bool IsNear(const float A, const float B, const float InTolerance)
+    {
+        return fabsf(A - B) <= InTolerance;
+    }
+
+    static inline bool IsNear(const Vector2& A, const Vector2& B, const float InTolerance)
+    {
+        return IsNear(A.X, B.X, InTolerance) && IsNear(A.Y, B.Y, InTolerance);
+    }
+
+    static inline bool IsNear(const Vector3& A, const Vector3& B, const float InTolerance)
+    {
+        return IsNear(A.X, B.X, InTolerance) && IsNear(A.Y, B.Y, InTolerance) && IsNear(A.Z, B.Z, InTolerance);
+    }
+
+    static inline bool IsNear(const Vector4& A, const Vector4& B, const float InTolerance)
+    {
+        return IsNear(A.X, B.X, InTolerance) && IsNear(A.Y, B.Y, InTolerance) && IsNear(A.Z, B.Z, InTolerance) && IsNear(A.W, B.W, InTolerance);
+    }
+
+    static bool IsSameDeform(const VertexData& A, const VertexData& B, const VertexWeldOptions& InOptions)
+    {
+        if (A.DeformType != B.DeformType)
+            return false;
+
+        if (A.Deform == nullptr || B.Deform == nullptr)
+            return A.Deform == B.Deform;
+
+        switch (A.DeformType)
+        {
+            case VertexData::WeightDeformType::BDEF1:
+            {
+                const VertexData::BDEF1* DA = static_cast<const VertexData::BDEF1*>(A.Deform);
+                const VertexData::BDEF1* DB = static_cast<const VertexData::BDEF1*>(B.Deform);
+                return DA->BoneIndex0 == DB->BoneIndex0;
+            }
+
+            case VertexData::WeightDeformType::BDEF2:
+            {
+                const VertexData::BDEF2* DA = static_cast<const VertexData::BDEF2*>(A.Deform);
+                const VertexData::BDEF2* DB = static_cast<const VertexData::BDEF2*>(B.Deform);
+                return DA->BoneIndex0 == DB->BoneIndex0 && DA->BoneIndex1 == DB->BoneIndex1
+                    && IsNear(DA->Weight0, DB->Weight0, InOptions.WeightTolerance);
+            }
+
+            case VertexData::WeightDeformType::BDEF4:
+            {
+                const VertexData::BDEF4* DA = static_cast<const VertexData::BDEF4*>(A.Deform);
+                const VertexData::BDEF4* DB = static_cast<const VertexData::BDEF4*>(B.Deform);
+                return DA->BoneIndex0 == DB->BoneIndex0 && DA->BoneIndex1 == DB->BoneIndex1
+                    && DA->BoneIndex2 == DB->BoneIndex2 && DA->BoneIndex3 == DB->BoneIndex3
+                    && IsNear(DA->Weight0, DB->Weight0, InOptions.WeightTolerance) && IsNear(DA->Weight1, DB->Weight1, InOptions.WeightTolerance)
+                    && IsNear(DA->Weight2, DB->Weight2, InOptions.WeightTolerance) && IsNear(DA->Weight3, DB->Weight3, InOptions.WeightTolerance);
+            }
+
+            case VertexData::WeightDeformType::SDEF:
+            {
+                const VertexData::SDEF* DA = static_cast<const VertexData::SDEF*>(A.Deform);
+                const VertexData::SDEF* DB = static_cast<const VertexData::SDEF*>(B.Deform);
+                return DA->BoneIndex0 == DB->BoneIndex0 && DA->BoneIndex1 == DB->BoneIndex1
+                    && IsNear(DA->Weight0, DB->Weight0, InOptions.WeightTolerance)
+                    && IsNear(DA->C, DB->C, InOptions.PositionTolerance)
+                    && IsNear(DA->R0, DB->R0, InOptions.PositionTolerance)
+                    && IsNear(DA->R1, DB->R1, InOptions.PositionTolerance);
+            }
+
+            case VertexData::WeightDeformType::QDEF:
+            {
+                const VertexData::QDEF* DA = static_cast<const VertexData::QDEF*>(A.Deform);
+                const VertexData::QDEF* DB = static_cast<const VertexData::QDEF*>(B.Deform);
+                return DA->BoneIndex0 == DB->BoneIndex0 && DA->BoneIndex1 == DB->BoneIndex1
+                    && DA->BoneIndex2 == DB->BoneIndex2 && DA->BoneIndex3 == DB->BoneIndex3
+                    && IsNear(DA->Weight0, DB->Weight0, InOptions.WeightTolerance) && IsNear(DA->Weight1, DB->Weight1, InOptions.WeightTolerance)
+                    && IsNear(DA->Weight2, DB->Weight2, InOptions.WeightTolerance) && IsNear(DA->Weight3, DB->Weight3, InOptions.WeightTolerance);
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    // 격자 좌표를 21비트씩 묶은 키. 범위를 넘으면 다른 칸과 겹칠 수 있지만 실제 비교에서 걸러짐
+    static inline UInt64 MakeCellKey(const long long X, const long long Y, const long long Z)
+    {
+        const UInt64 Mask = (1ull << 21) - 1;
+        return ((static_cast<UInt64>(X) & Mask) << 42) | ((static_cast<UInt64>(Y) & Mask) << 21) | (static_cast<UInt64>(Z) & Mask);
+    }
+
+    bool VertexWelder::Weld(PMXMeshData& InOutMeshData, const VertexWeldOptions& InOptions)
+    {
+        RemovedVertexCount = 0;
+
+        const int VertexCount = InOutMeshData.GetVertexCount();
+        const VertexData* Vertices = InOutMeshData.GetVertices();
+        if (VertexCount <= 1 || Vertices == nullptr)
+            return true;
+
+        const int AdditionalCount = std::min<int>(InOutMeshData.GetHeader().AdditionalVectorCount, 4);
+
+        // 정점별 모프 오프셋 목록 (모프 순서)
+        std::vector<int> MorphOffset(VertexCount + 1, 0);
+        std::vector<WeldMorphReference> WeldMorphReferences;
+        {
+            auto ForEachOffset = [&InOutMeshData](auto&& Func)
+            {
+                for (int i = 0; i < InOutMeshData.GetMorphCount(); ++i)
+                {
+                    const MorphData& Morph = InOutMeshData.GetMorphs()[i];
+                    if (Morph.ArrayOffset == nullptr)
+                        continue;
+
+                    if (Morph.Type == MorphData::MorphType::Vertex)
+                    {
+                        const MorphData::OffsetVertex* Offsets = static_cast<const MorphData::OffsetVertex*>(Morph.ArrayOffset);
+                        for (int j = 0; j < Morph.OffsetCount; ++j)
+                            Func(i, Offsets[j].VertexIndex, Vector4{ Offsets[j].PositionOffset.X, Offsets[j].PositionOffset.Y, Offsets[j].PositionOffset.Z, 0 });
+                    }
+                    else if (Morph.Type == MorphData::MorphType::UV || Morph.Type == MorphData::MorphType::AdditionalUV1
+                        || Morph.Type == MorphData::MorphType::AdditionalUV2 || Morph.Type == MorphData::MorphType::AdditionalUV3
+                        || Morph.Type == MorphData::MorphType::AdditionalUV4)
+                    {
+                        const MorphData::OffsetUV* Offsets = static_cast<const MorphData::OffsetUV*>(Morph.ArrayOffset);
+                        for (int j = 0; j < Morph.OffsetCount; ++j)
+                            Func(i, Offsets[j].VertexIndex, Offsets[j].UVOffset);
+                    }
+                }
+            };
+
+            ForEachOffset([&](const int, const int InVertexIndex, const Vector4&)
+            {
+                if (InVertexIndex >= 0 && InVertexIndex < VertexCount)
+                    ++MorphOffset[InVertexIndex + 1];
+            });
+
+            for (int i = 0; i < VertexCount; ++i)
+                MorphOffset[i + 1] += MorphOffset[i];
+
+            WeldMorphReferences.resize(MorphOffset[VertexCount]);
+
+            std::vector<int> Fill(MorphOffset.begin(), MorphOffset.end() - 1);
+            ForEachOffset([&](const int InMorphIndex, const int InVertexIndex, const Vector4& InOffset)
+            {
+                if (InVertexIndex >= 0 && InVertexIndex < VertexCount)
+                {
+                    WeldMorphReference& Reference = WeldMorphReferences[Fill[InVertexIndex]++];
+                    Reference.MorphIndex = InMorphIndex;
+                    Reference.Offset = InOffset;
+                }
+            });
+        }
+
+        auto IsMatch = [&](const int A, const int B)
+        {
+            const VertexData& VA = Vertices[A];
+            const VertexData& VB = Vertices[B];
+
+            if (IsNear(VA.Position, VB.Position, InOptions.PositionTolerance) == false
+                || IsNear(VA.Normal, VB.Normal, InOptions.NormalTolerance) == false
+                || IsNear(VA.UV, VB.UV, InOptions.UVTolerance) == false
+                || VA.EdgeScale != VB.EdgeScale)
+                return false;
+
+            for (int k = 0; k < AdditionalCount; ++k)
+            {
+                if (IsNear(VA.Additional[k], VB.Additional[k], InOptions.UVTolerance) == false)
+                    return false;
+            }
+
+            if (IsSameDeform(VA, VB, InOptions) == false)
+                return false;
+
+            const int CountA = MorphOffset[A + 1] - MorphOffset[A];
+            if (CountA != MorphOffset[B + 1] - MorphOffset[B])
+                return false;
+
+            for (int k = 0; k < CountA; ++k)
+            {
+                const WeldMorphReference& RA = WeldMorphReferences[MorphOffset[A] + k];
+                const WeldMorphReference& RB = WeldMorphReferences[MorphOffset[B] + k];
+
+                if (RA.MorphIndex != RB.MorphIndex || IsNear(RA.Offset, RB.Offset, InOptions.PositionTolerance) == false)
+                    return false;
+            }
+
+            return true;
+        };
+
+        // 공간 해시 : 칸을 허용 오차보다 넉넉하게 잡아 대부분의 정점은 자기 칸만 보면 되도록 함
+        const float CellSize = std::max(InOptions.PositionTolerance * 4.0f, 1e-6f);
+        const float InvCellSize = 1.0f / CellSize;
+
+        auto GetCell = [InvCellSize](const float InValue)
+        {
+            return static_cast<long long>(floor(static_cast<double>(InValue) * InvCellSize));
+        };
+
+        std::vector<WeldCellEntry> Cells(VertexCount);
+        ParallelFor(VertexCount, 4096, [&](const int Begin, const int End)
+        {
+            for (int i = Begin; i < End; ++i)
+            {
+                const Vector3& Position = Vertices[i].Position;
+                Cells[i].Key = MakeCellKey(GetCell(Position.X), GetCell(Position.Y), GetCell(Position.Z));
+                Cells[i].VertexIndex = i;
+            }
+        });
+
+        std::sort(Cells.begin(), Cells.end(), [](const WeldCellEntry& A, const WeldCellEntry& B)
+        {
+            return A.Key != B.Key ? A.Key < B.Key : A.VertexIndex < B.VertexIndex;
+        });
+
+        // 각 정점과 합칠 수 있는 가장 앞 정점
+        std::vector<int> Parent(VertexCount, -1);
+        ParallelFor(VertexCount, 1024, [&](const int Begin, const int End)
+        {
+            for (int i = Begin; i < End; ++i)
+            {
+                // 허용 오차 범위가 걸치는 칸만 확인. 대부분 한 칸
+                const Vector3& Position = Vertices[i].Position;
+                const long long MinX = GetCell(Position.X - InOptions.PositionTolerance), MaxX = GetCell(Position.X + InOptions.PositionTolerance);
+                const long long MinY = GetCell(Position.Y - InOptions.PositionTolerance), MaxY = GetCell(Position.Y + InOptions.PositionTolerance);
+                const long long MinZ = GetCell(Position.Z - InOptions.PositionTolerance), MaxZ = GetCell(Position.Z + InOptions.PositionTolerance);
+
+                int Found = -1;
+
+                for (long long X = MinX; X <= MaxX; ++X)
+                {
+                    for (long long Y = MinY; Y <= MaxY; ++Y)
+                    {
+                        for (long long Z = MinZ; Z <= MaxZ; ++Z)
+                        {
+                            const UInt64 Key = MakeCellKey(X, Y, Z);
+
+                            auto It = std::lower_bound(Cells.begin(), Cells.end(), Key, [](const WeldCellEntry& Entry, const UInt64 InKey)
+                            {
+                                return Entry.Key < InKey;
+                            });
+
+                            // 칸 안은 정점 번호 순이므로 자신보다 앞 정점만, 이미 찾은 것보다 앞일 때만 확인
+                            const int Limit = Found >= 0 ? Found : i;
+                            for (; It != Cells.end() && It->Key == Key && It->VertexIndex < Limit; ++It)
+                            {
+                                if (IsMatch(i, It->VertexIndex))
+                                {
+                                    Found = It->VertexIndex;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                Parent[i] = Found;
+            }
+        });
+
+        // 허용 오차가 연쇄적으로 번지지 않도록 대표 정점과 직접 비교해서 확정
+        std::vector<int> OldToNew(VertexCount, -1);
+        std::vector<int> Representative(VertexCount);
+        int NewVertexCount = 0;
+
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            Representative[i] = i;
+
+            if (Parent[i] >= 0)
+            {
+                const int Candidate = Representative[Parent[i]];
+                if (Candidate == Parent[i] || IsMatch(i, Candidate))
+                    Representative[i] = Candidate;
+            }
+
+            OldToNew[i] = Representative[i] == i ? NewVertexCount++ : OldToNew[Representative[i]];
+        }
+
+        if (NewVertexCount == VertexCount)
+            return true;
+
+        if (InOutMeshData.RemapVertices(OldToNew.data(), NewVertexCount) == false)
+            return false;
+
+        RemovedVertexCount = VertexCount - NewVertexCount;
+        return true;
+    }
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "PMXMeshData.h"
+
+namespace PMX
+{
+    struct VertexWeldOptions
+    {
+        // 위치 허용 오차. 공간 해시 격자 크기로도 사용
+        float PositionTolerance = 1e-5f;
+
+        // 법선 성분별 허용 오차
+        float NormalTolerance = 1e-3f;
+
+        // UV / 추가 UV 성분별 허용 오차. 0 에 가깝게 두면 UV 이음새는 합쳐지지 않음
+        float UVTolerance = 1e-5f;
+
+        // 스킨 가중치 허용 오차
+        float WeightTolerance = 1e-3f;
+    };
+
+    /**
+     * 중복 정점 병합
+     * : 위치를 공간 해시 격자로 나눠 이웃 칸의 정점끼리만 비교하고,
+     *   위치 / 법선 / UV / 추가 UV / 에지 배율 / 스킨 가중치 / 정점·UV 모프 오프셋이 모두 같을 때만 합칩니다.
+     */
+    class VertexWelder
+    {
+    public:
+        bool Weld(PMXMeshData& InOutMeshData, const VertexWeldOptions& InOptions = VertexWeldOptions());
+
+        int GetRemovedVertexCount() const { return RemovedVertexCount; }
+
+    protected:
+        int RemovedVertexCount = 0;
+    };
+}
@@ -0,0 +1,705 @@
+﻿#include "VMDKeyReducer.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PMX
+{
+    static constexpr int ReducerChannelCount = static_cast<int>(BoneKeyframes::Channel::Count);
+    static constexpr int ReducerParamCount = static_cast<int>(BezierParam::Count);
+
+    // 키 하나의 채널별 곡선 [Channel][BezierParam]
+    struct ReducerCurve
+    {
+        float Param[ReducerChannelCount][ReducerParamCount];
+    };
+
+    // 원래 곡선 위의 확인 지점
+    struct ReducerSample
+    {
+        float Frame = 0;
+        float Position[3] = { 0, };
+        Vector4 Rotation;
+    };
+
+    struct ReducedTrack
+    {
+        // 남긴 키의 원래 키 번호 (트랙 안 순서)
+        std::vector<int> Keys;
+
+        // 본 트랙만. Keys 와 같은 길이
+        std::vector<ReducerCurve> Curves;
+
+        TrackReduction Stats;
+    };
+
+    // MMD 기본 직선 (20, 20) (107, 107)
+    static void SetLinearReducerCurve(float OutParam[ReducerParamCount])
+    {
+        OutParam[static_cast<int>(BezierParam::X1)] = 20.0f / 127.0f;
+        OutParam[static_cast<int>(BezierParam::Y1)] = 20.0f / 127.0f;
+        OutParam[static_cast<int>(BezierParam::X2)] = 107.0f / 127.0f;
+        OutParam[static_cast<int>(BezierParam::Y2)] = 107.0f / 127.0f;
+    }
+
+    static float EvaluateReducerCurve(const float InParam[ReducerParamCount], const float InProgress)
+    {
+        return EvaluateMotionBezier(InParam[static_cast<int>(BezierParam::X1)], InParam[static_cast<int>(BezierParam::Y1)],
+            InParam[static_cast<int>(BezierParam::X2)], InParam[static_cast<int>(BezierParam::Y2)], InProgress);
+    }
+
+    // VMD 는 제어점을 0~127 바이트로 저장
+    static float QuantizeReducerParam(const float InValue)
+    {
+        return std::round(Math::Clamp(InValue, 0.0f, 1.0f) * 127.0f) / 127.0f;
+    }
+
+    /**
+     * 진행 비율 (InProgress -> InValue) 에 맞는 Bezier 제어점을 최소 제곱으로 구함
+     * : 매개변수 t 를 시간 비율로 두고 X, Y 제어점을 따로 풀고, 구한 X 곡선으로 t 를 다시 구하는 과정을 몇 번 반복합니다.
+     */
+    static void FitReducerCurve(const std::vector<float>& InProgress, const std::vector<float>& InValue, std::vector<float>& InOutT, float OutParam[ReducerParamCount])
+    {
+        const int Count = static_cast<int>(InProgress.size());
+
+        InOutT.assign(InProgress.begin(), InProgress.end());
+
+        float X1 = 1.0f / 3.0f, X2 = 2.0f / 3.0f;
+        float Y1 = 1.0f / 3.0f, Y2 = 2.0f / 3.0f;
+
+        for (int Iteration = 0; Iteration < 3; ++Iteration)
+        {
+            // B1 = 3(1-t)^2 t, B2 = 3(1-t) t^2, 목표 - t^3 을 B1, B2 로 맞춤
+            double A11 = 0, A12 = 0, A22 = 0;
+            double RX1 = 0, RX2 = 0, RY1 = 0, RY2 = 0;
+
+            for (int k = 0; k < Count; ++k)
+            {
+                const double T = InOutT[k];
+                const double InvT = 1.0 - T;
+                const double B1 = 3.0 * InvT * InvT * T;
+                const double B2 = 3.0 * InvT * T * T;
+                const double T3 = T * T * T;
+
+                A11 += B1 * B1;
+                A12 += B1 * B2;
+                A22 += B2 * B2;
+
+                RX1 += B1 * (InProgress[k] - T3);
+                RX2 += B2 * (InProgress[k] - T3);
+                RY1 += B1 * (InValue[k] - T3);
+                RY2 += B2 * (InValue[k] - T3);
+            }
+
+            const double Determinant = A11 * A22 - A12 * A12;
+            if (fabs(Determinant) < 1.e-12)
+                break;
+
+            X1 = static_cast<float>((RX1 * A22 - RX2 * A12) / Determinant);
+            X2 = static_cast<float>((RX2 * A11 - RX1 * A12) / Determinant);
+            Y1 = static_cast<float>((RY1 * A22 - RY2 * A12) / Determinant);
+            Y2 = static_cast<float>((RY2 * A11 - RY1 * A12) / Determinant);
+
+            // X 가 0~1 을 벗어나면 시간이 되돌아가는 곡선이 됨
+            X1 = Math::Clamp(X1, 0.0f, 1.0f);
+            X2 = Math::Clamp(X2, 0.0f, 1.0f);
+
+            // 다음 반복의 t: X(t) = 진행 비율을 뉴턴법으로 풂
+            for (int k = 0; k < Count; ++k)
+            {
+                float T = InOutT[k];
+
+                for (int Step = 0; Step < 4; ++Step)
+                {
+                    const float InvT = 1.0f - T;
+                    const float X = 3.0f * InvT * InvT * T * X1 + 3.0f * InvT * T * T * X2 + T * T * T;
+                    const float Slope = 3.0f * InvT * InvT * X1 + 6.0f * InvT * T * (X2 - X1) + 3.0f * T * T * (1.0f - X2);
+
+                    if (Slope < 1.e-6f)
+                        break;
+
+                    T = Math::Clamp(T - (X - InProgress[k]) / Slope, 0.0f, 1.0f);
+                }
+
+                InOutT[k] = T;
+            }
+        }
+
+        OutParam[static_cast<int>(BezierParam::X1)] = QuantizeReducerParam(X1);
+        OutParam[static_cast<int>(BezierParam::Y1)] = QuantizeReducerParam(Y1);
+        OutParam[static_cast<int>(BezierParam::X2)] = QuantizeReducerParam(X2);
+        OutParam[static_cast<int>(BezierParam::Y2)] = QuantizeReducerParam(Y2);
+    }
+
+    /**
+     * 본 트랙 하나
+     * : 확인 지점은 원래 키마다 하나와 키 사이 최대 3 개 (프레임 간격이 넓은 손 키 트랙의 곡선 모양 확인용) 입니다.
+     */
+    class BoneTrackReducer
+    {
+    public:
+        BoneTrackReducer(const VMDMotionData& InMotion, const int InTrack, const KeyReductionOptions& InOptions)
+            : Motion(InMotion), Keys(InMotion.GetBoneKeys()), Track(InMotion.GetBoneTracks()[InTrack]), TrackIndex(InTrack), Options(InOptions)
+        {
+        }
+
+        void Reduce(ReducedTrack& OutTrack)
+        {
+            const int KeyCount = Track.KeyCount;
+
+            OutTrack.Stats.SourceKeyCount = KeyCount;
+
+            // 모든 키가 같으면 첫 키 하나로 충분
+            if (IsConstant())
+            {
+                OutTrack.Keys.push_back(0);
+                OutTrack.Curves.push_back(GetSourceCurve(0));
+                OutTrack.Stats.KeyCount = 1;
+                return;
+            }
+
+            BuildSamples();
+
+            OutTrack.Keys.push_back(0);
+            OutTrack.Curves.push_back(GetSourceCurve(0));
+
+            int Begin = 0;
+            while (Begin < KeyCount - 1)
+            {
+                // 바로 다음 키까지는 원래 곡선이라 항상 맞음
+                int Good = Begin + 1;
+                ReducerCurve GoodCurve = GetSourceCurve(Good);
+                float GoodPositionError = 0;
+                float GoodRotationError = 0;
+
+                // 두 배씩 늘려 보고 실패하면 그 사이를 이분 탐색
+                int Bad = KeyCount;
+                for (int Step = 2; ; Step *= 2)
+                {
+                    const int End = std::min(Begin + Step, KeyCount - 1);
+                    if (End <= Good)
+                        break;
+
+                    ReducerCurve Curve;
+                    float PositionError = 0;
+                    float RotationError = 0;
+
+                    if (TrySegment(Begin, End, Curve, PositionError, RotationError) == false)
+                    {
+                        Bad = End;
+                        break;
+                    }
+
+                    Good = End;
+                    GoodCurve = Curve;
+                    GoodPositionError = PositionError;
+                    GoodRotationError = RotationError;
+                }
+
+                while (Bad - Good > 1)
+                {
+                    const int Middle = (Good + Bad) / 2;
+
+                    ReducerCurve Curve;
+                    float PositionError = 0;
+                    float RotationError = 0;
+
+                    if (TrySegment(Begin, Middle, Curve, PositionError, RotationError))
+                    {
+                        Good = Middle;
+                        GoodCurve = Curve;
+                        GoodPositionError = PositionError;
+                        GoodRotationError = RotationError;
+                    }
+                    else
+                    {
+                        Bad = Middle;
+                    }
+                }
+
+                OutTrack.Keys.push_back(Good);
+                OutTrack.Curves.push_back(GoodCurve);
+
+                OutTrack.Stats.MaxPositionError = std::max(OutTrack.Stats.MaxPositionError, GoodPositionError);
+                OutTrack.Stats.MaxRotationError = std::max(OutTrack.Stats.MaxRotationError, GoodRotationError);
+
+                Begin = Good;
+            }
+
+            OutTrack.Stats.KeyCount = static_cast<int>(OutTrack.Keys.size());
+        }
+
+    protected:
+        int GetKey(const int InKey) const { return Track.KeyBegin + InKey; }
+
+        Vector3 GetPosition(const int InKey) const
+        {
+            const int Key = GetKey(InKey);
+            return Math::MakeVector3(Keys.Position[0][Key], Keys.Position[1][Key], Keys.Position[2][Key]);
+        }
+
+        Vector4 GetRotation(const int InKey) const
+        {
+            const int Key = GetKey(InKey);
+            return Math::MakeVector4(Keys.Rotation[0][Key], Keys.Rotation[1][Key], Keys.Rotation[2][Key], Keys.Rotation[3][Key]);
+        }
+
+        ReducerCurve GetSourceCurve(const int InKey) const
+        {
+            ReducerCurve Curve;
+
+            for (int c = 0; c < ReducerChannelCount; ++c)
+            {
+                for (int p = 0; p < ReducerParamCount; ++p)
+                    Curve.Param[c][p] = Keys.Bezier[c][p][GetKey(InKey)];
+            }
+
+            return Curve;
+        }
+
+        bool IsConstant() const
+        {
+            const int First = GetKey(0);
+
+            for (int k = 1; k < Track.KeyCount; ++k)
+            {
+                const int Key = GetKey(k);
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    if (Keys.Position[c][Key] != Keys.Position[c][First])
+                        return false;
+                }
+
+                for (int c = 0; c < 4; ++c)
+                {
+                    if (Keys.Rotation[c][Key] != Keys.Rotation[c][First])
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        void BuildSamples()
+        {
+            SampleBegin.resize(Track.KeyCount + 1);
+
+            for (int k = 0; k < Track.KeyCount; ++k)
+            {
+                SampleBegin[k] = static_cast<int>(Samples.size());
+
+                const Vector3 Position = GetPosition(k);
+
+                ReducerSample KeySample;
+                KeySample.Frame = static_cast<float>(Keys.Frame[GetKey(k)]);
+                KeySample.Position[0] = Position.X;
+                KeySample.Position[1] = Position.Y;
+                KeySample.Position[2] = Position.Z;
+                KeySample.Rotation = GetRotation(k);
+                Samples.push_back(KeySample);
+
+                if (k + 1 == Track.KeyCount)
+                    break;
+
+                const UInt32 Gap = Keys.Frame[GetKey(k + 1)] - Keys.Frame[GetKey(k)];
+                const int Interior = static_cast<int>(std::min<UInt32>(Gap - 1, 3));
+
+                for (int m = 1; m <= Interior; ++m)
+                {
+                    ReducerSample Sample;
+                    Sample.Frame = KeySample.Frame + static_cast<float>(Gap) * m / (Interior + 1);
+
+                    Vector3 SampledPosition;
+                    Motion.SampleBoneTrack(TrackIndex, Sample.Frame, SampledPosition, Sample.Rotation);
+
+                    Sample.Position[0] = SampledPosition.X;
+                    Sample.Position[1] = SampledPosition.Y;
+                    Sample.Position[2] = SampledPosition.Z;
+                    Samples.push_back(Sample);
+                }
+            }
+
+            SampleBegin[Track.KeyCount] = static_cast<int>(Samples.size());
+        }
+
+        // InCandidate 중 InError 가 가장 작은 곡선을 OutParam 에 씀
+        template<typename ErrorFunction>
+        void ChooseCurve(const int InBegin, const int InEnd, const int InChannel, const std::vector<float>& InValue, const ErrorFunction& InError, float OutParam[ReducerParamCount])
+        {
+            float Candidates[3][ReducerParamCount];
+            int CandidateCount = 0;
+
+            // 끝 키의 원래 곡선, 직선, 맞춘 곡선
+            for (int p = 0; p < ReducerParamCount; ++p)
+                Candidates[CandidateCount][p] = Keys.Bezier[InChannel][p][GetKey(InEnd)];
+            ++CandidateCount;
+
+            SetLinearReducerCurve(Candidates[CandidateCount++]);
+
+            if (Options.bRefitBezier && InValue.empty() == false)
+                FitReducerCurve(Progress, InValue, ScratchT, Candidates[CandidateCount++]);
+
+            float BestError = -1.0f;
+            for (int i = 0; i < CandidateCount; ++i)
+            {
+                float Error = 0;
+                for (int s = SampleBegin[InBegin] + 1; s < SampleBegin[InEnd]; ++s)
+                    Error = std::max(Error, InError(Candidates[i], Progress[s - SampleBegin[InBegin] - 1], Samples[s]));
+
+                if (BestError < 0 || Error < BestError)
+                {
+                    BestError = Error;
+                    std::copy(Candidates[i], Candidates[i] + ReducerParamCount, OutParam);
+                }
+            }
+        }
+
+        bool TrySegment(const int InBegin, const int InEnd, ReducerCurve& OutCurve, float& OutPositionError, float& OutRotationError)
+        {
+            const Vector3 BeginPosition = GetPosition(InBegin);
+            const Vector3 EndPosition = GetPosition(InEnd);
+            const Vector4 BeginRotation = GetRotation(InBegin);
+            const Vector4 EndRotation = GetRotation(InEnd);
+
+            const float BeginFrame = static_cast<float>(Keys.Frame[GetKey(InBegin)]);
+            const float Span = static_cast<float>(Keys.Frame[GetKey(InEnd)] - Keys.Frame[GetKey(InBegin)]);
+
+            Progress.clear();
+            for (int s = SampleBegin[InBegin] + 1; s < SampleBegin[InEnd]; ++s)
+                Progress.push_back((Samples[s].Frame - BeginFrame) / Span);
+
+            const float Begin[3] = { BeginPosition.X, BeginPosition.Y, BeginPosition.Z };
+            const float Delta[3] = { EndPosition.X - BeginPosition.X, EndPosition.Y - BeginPosition.Y, EndPosition.Z - BeginPosition.Z };
+
+            // 이동 채널: 값 비율 = (값 - 시작) / (끝 - 시작). 움직이지 않는 채널은 곡선과 무관
+            for (int c = 0; c < 3; ++c)
+            {
+                Values.clear();
+
+                if (fabsf(Delta[c]) > 1.e-6f)
+                {
+                    for (int s = SampleBegin[InBegin] + 1; s < SampleBegin[InEnd]; ++s)
+                        Values.push_back((Samples[s].Position[c] - Begin[c]) / Delta[c]);
+                }
+
+                ChooseCurve(InBegin, InEnd, c, Values, [&](const float InParam[ReducerParamCount], const float InProgress, const ReducerSample& InSample)
+                {
+                    return fabsf(Begin[c] + Delta[c] * EvaluateReducerCurve(InParam, InProgress) - InSample.Position[c]);
+                }, OutCurve.Param[c]);
+            }
+
+            // 회전 채널: 값 비율 = 시작 회전과의 각 / 전체 각
+            const int RotationChannel = static_cast<int>(BoneKeyframes::Channel::Rotation);
+            const float Angle = Math::QuatAngle(BeginRotation, EndRotation);
+
+            Values.clear();
+
+            if (Angle > 1.e-6f)
+            {
+                for (int s = SampleBegin[InBegin] + 1; s < SampleBegin[InEnd]; ++s)
+                    Values.push_back(Math::QuatAngle(BeginRotation, Samples[s].Rotation) / Angle);
+            }
+
+            ChooseCurve(InBegin, InEnd, RotationChannel, Values, [&](const float InParam[ReducerParamCount], const float InProgress, const ReducerSample& InSample)
+            {
+                return Math::QuatAngle(Math::QuatSlerp(BeginRotation, EndRotation, EvaluateReducerCurve(InParam, InProgress)), InSample.Rotation);
+            }, OutCurve.Param[RotationChannel]);
+
+            // 고른 곡선으로 위치는 거리, 회전은 각으로 최종 확인
+            OutPositionError = 0;
+            OutRotationError = 0;
+
+            for (int s = SampleBegin[InBegin] + 1; s < SampleBegin[InEnd]; ++s)
+            {
+                const float SampleProgress = Progress[s - SampleBegin[InBegin] - 1];
+                const ReducerSample& Sample = Samples[s];
+
+                float DistanceSquared = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float Difference = Begin[c] + Delta[c] * EvaluateReducerCurve(OutCurve.Param[c], SampleProgress) - Sample.Position[c];
+                    DistanceSquared += Difference * Difference;
+                }
+
+                OutPositionError = std::max(OutPositionError, sqrtf(DistanceSquared));
+                OutRotationError = std::max(OutRotationError,
+                    Math::QuatAngle(Math::QuatSlerp(BeginRotation, EndRotation, EvaluateReducerCurve(OutCurve.Param[RotationChannel], SampleProgress)), Sample.Rotation));
+
+                if (OutPositionError > Options.PositionTolerance || OutRotationError > Options.RotationTolerance)
+                    return false;
+            }
+
+            return true;
+        }
+
+    protected:
+        const VMDMotionData& Motion;
+        const BoneKeyframes& Keys;
+        const MotionTrack& Track;
+        const int TrackIndex;
+        const KeyReductionOptions& Options;
+
+        std::vector<ReducerSample> Samples;
+
+        // 키 k 의 확인 지점은 Samples[SampleBegin[k]] 부터
+        std::vector<int> SampleBegin;
+
+        // TrySegment 안에서 다시 쓰는 버퍼
+        std::vector<float> Progress;
+        std::vector<float> Values;
+        std::vector<float> ScratchT;
+    };
+
+    // 모프는 선형 보간이라 원래 키 위치만 확인하면 됨
+    static void ReduceMorphTrack(const MorphKeyframes& InKeys, const MotionTrack& InTrack, const KeyReductionOptions& InOptions, ReducedTrack& OutTrack)
+    {
+        const int KeyCount = InTrack.KeyCount;
+        const UInt32* Frame = InKeys.Frame + InTrack.KeyBegin;
+        const float* Weight = InKeys.Weight + InTrack.KeyBegin;
+
+        OutTrack.Stats.SourceKeyCount = KeyCount;
+        OutTrack.Keys.push_back(0);
+
+        if (std::all_of(Weight, Weight + KeyCount, [Weight](const float InWeight) { return InWeight == Weight[0]; }))
+        {
+            OutTrack.Stats.KeyCount = 1;
+            return;
+        }
+
+        auto TrySegment = [&](const int InBegin, const int InEnd, float& OutError)
+        {
+            OutError = 0;
+
+            const float Span = static_cast<float>(Frame[InEnd] - Frame[InBegin]);
+
+            for (int k = InBegin + 1; k < InEnd; ++k)
+            {
+                const float Progress = (Frame[k] - Frame[InBegin]) / Span;
+                OutError = std::max(OutError, fabsf(Weight[InBegin] + (Weight[InEnd] - Weight[InBegin]) * Progress - Weight[k]));
+
+                if (OutError > InOptions.MorphTolerance)
+                    return false;
+            }
+
+            return true;
+        };
+
+        int Begin = 0;
+        while (Begin < KeyCount - 1)
+        {
+            int Good = Begin + 1;
+            float GoodError = 0;
+            int Bad = KeyCount;
+
+            for (int Step = 2; ; Step *= 2)
+            {
+                const int End = std::min(Begin + Step, KeyCount - 1);
+                if (End <= Good)
+                    break;
+
+                float Error = 0;
+                if (TrySegment(Begin, End, Error) == false)
+                {
+                    Bad = End;
+                    break;
+                }
+
+                Good = End;
+                GoodError = Error;
+            }
+
+            while (Bad - Good > 1)
+            {
+                const int Middle = (Good + Bad) / 2;
+
+                float Error = 0;
+                if (TrySegment(Begin, Middle, Error))
+                {
+                    Good = Middle;
+                    GoodError = Error;
+                }
+                else
+                {
+                    Bad = Middle;
+                }
+            }
+
+            OutTrack.Keys.push_back(Good);
+            OutTrack.Stats.MaxWeightError = std::max(OutTrack.Stats.MaxWeightError, GoodError);
+
+            Begin = Good;
+        }
+
+        OutTrack.Stats.KeyCount = static_cast<int>(OutTrack.Keys.size());
+    }
+
+    bool MotionKeyReducer::Build(const VMDMotionData& InMotion, const KeyReductionOptions& InOptions)
+    {
+        Delete();
+
+        const int BoneTrackCount = InMotion.GetBoneTrackCount();
+        const int MorphTrackCount = InMotion.GetMorphTrackCount();
+
+        std::vector<ReducedTrack> BoneTracks(BoneTrackCount);
+        std::vector<ReducedTrack> MorphTracks(MorphTrackCount);
+
+        // 트랙마다 키 수가 크게 달라서 하나씩 가져감
+        ParallelFor(BoneTrackCount, 1, [&](const int InBegin, const int InEnd)
+        {
+            for (int t = InBegin; t < InEnd; ++t)
+            {
+                BoneTrackReducer Reducer(InMotion, t, InOptions);
+                Reducer.Reduce(BoneTracks[t]);
+            }
+        });
+
+        ParallelFor(MorphTrackCount, 4, [&](const int InBegin, const int InEnd)
+        {
+            for (int t = InBegin; t < InEnd; ++t)
+                ReduceMorphTrack(InMotion.GetMorphKeys(), InMotion.GetMorphTracks()[t], InOptions, MorphTracks[t]);
+        });
+
+        // 결과 모션: 트랙 순서와 이름은 그대로, 키만 남긴 것으로
+        Motion.ModelName = InMotion.ModelName;
+        Motion.FrameCount = InMotion.FrameCount;
+        Motion.SourceBoneKeyCount = InMotion.SourceBoneKeyCount;
+        Motion.SourceMorphKeyCount = InMotion.SourceMorphKeyCount;
+        Motion.BoneTrackByName = InMotion.BoneTrackByName;
+        Motion.MorphTrackByName = InMotion.MorphTrackByName;
+
+        Motion.BoneTracks = InMotion.BoneTracks;
+        for (int t = 0; t < BoneTrackCount; ++t)
+        {
+            Motion.BoneTracks[t].KeyBegin = Motion.BoneKeyCount;
+            Motion.BoneTracks[t].KeyCount = BoneTracks[t].Stats.KeyCount;
+            Motion.BoneKeyCount += BoneTracks[t].Stats.KeyCount;
+
+            BoneTrackStats.push_back(BoneTracks[t].Stats);
+        }
+
+        Motion.MorphTracks = InMotion.MorphTracks;
+        for (int t = 0; t < MorphTrackCount; ++t)
+        {
+            Motion.MorphTracks[t].KeyBegin = Motion.MorphKeyCount;
+            Motion.MorphTracks[t].KeyCount = MorphTracks[t].Stats.KeyCount;
+            Motion.MorphKeyCount += MorphTracks[t].Stats.KeyCount;
+
+            MorphTrackStats.push_back(MorphTracks[t].Stats);
+        }
+
+        Motion.CameraKeyCount = InMotion.CameraKeyCount;
+        Motion.LightKeyCount = InMotion.LightKeyCount;
+
+        Motion.AllocateKeys();
+
+        const BoneKeyframes& SourceBones = InMotion.BoneKeys;
+        BoneKeyframes& Bones = Motion.BoneKeys;
+
+        ParallelFor(BoneTrackCount, 4, [&](const int InBegin, const int InEnd)
+        {
+            for (int t = InBegin; t < InEnd; ++t)
+            {
+                const ReducedTrack& Reduced = BoneTracks[t];
+
+                for (int k = 0; k < static_cast<int>(Reduced.Keys.size()); ++k)
+                {
+                    const int Source = InMotion.BoneTracks[t].KeyBegin + Reduced.Keys[k];
+                    const int Destination = Motion.BoneTracks[t].KeyBegin + k;
+
+                    Bones.Frame[Destination] = SourceBones.Frame[Source];
+
+                    for (int c = 0; c < 3; ++c)
+                        Bones.Position[c][Destination] = SourceBones.Position[c][Source];
+
+                    for (int c = 0; c < 4; ++c)
+                        Bones.Rotation[c][Destination] = SourceBones.Rotation[c][Source];
+
+                    for (int c = 0; c < ReducerChannelCount; ++c)
+                    {
+                        for (int p = 0; p < ReducerParamCount; ++p)
+                            Bones.Bezier[c][p][Destination] = Reduced.Curves[k].Param[c][p];
+                    }
+                }
+            }
+        });
+
+        for (int t = 0; t < MorphTrackCount; ++t)
+        {
+            for (int k = 0; k < static_cast<int>(MorphTracks[t].Keys.size()); ++k)
+            {
+                const int Source = InMotion.MorphTracks[t].KeyBegin + MorphTracks[t].Keys[k];
+                const int Destination = Motion.MorphTracks[t].KeyBegin + k;
+
+                Motion.MorphKeys.Frame[Destination] = InMotion.MorphKeys.Frame[Source];
+                Motion.MorphKeys.Weight[Destination] = InMotion.MorphKeys.Weight[Source];
+            }
+        }
+
+        const CameraKeyframes& SourceCamera = InMotion.CameraKeys;
+        CameraKeyframes& Camera = Motion.CameraKeys;
+
+        for (int i = 0; i < Motion.CameraKeyCount; ++i)
+        {
+            Camera.Frame[i] = SourceCamera.Frame[i];
+            Camera.Distance[i] = SourceCamera.Distance[i];
+            Camera.FieldOfView[i] = SourceCamera.FieldOfView[i];
+            Camera.Orthographic[i] = SourceCamera.Orthographic[i];
+
+            for (int c = 0; c < 3; ++c)
+            {
+                Camera.Target[c][i] = SourceCamera.Target[c][i];
+                Camera.Rotation[c][i] = SourceCamera.Rotation[c][i];
+            }
+
+            for (int c = 0; c < static_cast<int>(CameraKeyframes::Channel::Count); ++c)
+            {
+                for (int p = 0; p < ReducerParamCount; ++p)
+                    Camera.Bezier[c][p][i] = SourceCamera.Bezier[c][p][i];
+            }
+        }
+
+        for (int i = 0; i < Motion.LightKeyCount; ++i)
+        {
+            Motion.LightKeys.Frame[i] = InMotion.LightKeys.Frame[i];
+
+            for (int c = 0; c < 3; ++c)
+            {
+                Motion.LightKeys.Color[c][i] = InMotion.LightKeys.Color[c][i];
+                Motion.LightKeys.Direction[c][i] = InMotion.LightKeys.Direction[c][i];
+            }
+        }
+
+        return true;
+    }
+
+    void MotionKeyReducer::Delete()
+    {
+        Motion.Delete();
+
+        BoneTrackStats.clear();
+        MorphTrackStats.clear();
+    }
+
+    float MotionKeyReducer::GetCompressionRatio() const
+    {
+        long long SourceKeyCount = 0;
+        long long KeyCount = 0;
+
+        for (const TrackReduction& Stats : BoneTrackStats)
+        {
+            SourceKeyCount += Stats.SourceKeyCount;
+            KeyCount += Stats.KeyCount;
+        }
+
+        for (const TrackReduction& Stats : MorphTrackStats)
+        {
+            SourceKeyCount += Stats.SourceKeyCount;
+            KeyCount += Stats.KeyCount;
+        }
+
+        return KeyCount > 0 ? static_cast<float>(static_cast<double>(SourceKeyCount) / KeyCount) : 1.0f;
+    }
+}
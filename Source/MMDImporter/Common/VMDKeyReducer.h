@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include "VMDMotionData.h"
+
+#include <vector>
+
+namespace PMX
+{
+    struct KeyReductionOptions
+    {
+        // 원래 곡선과의 최대 차이. 위치는 모델 단위 (MMD 1 = 약 8cm), 회전은 라디안
+        float PositionTolerance = 0.005f;
+        float RotationTolerance = 0.0044f;
+
+        // 모프 가중치 차이 (0~1)
+        float MorphTolerance = 0.002f;
+
+        // 지운 키를 건너뛰는 구간의 Bezier 를 다시 맞춤. false 면 직선과 원래 곡선만 시도
+        bool bRefitBezier = true;
+    };
+
+    // 트랙 하나의 줄이기 결과
+    struct TrackReduction
+    {
+        int SourceKeyCount = 0;
+        int KeyCount = 0;
+
+        // 남긴 키로 다시 계산한 값과 원래 값의 최대 차이. 모프 트랙은 MaxWeightError 만 씀
+        float MaxPositionError = 0;
+        float MaxRotationError = 0;
+        float MaxWeightError = 0;
+
+        float GetCompressionRatio() const { return KeyCount > 0 ? static_cast<float>(SourceKeyCount) / KeyCount : 1.0f; }
+    };
+
+    /**
+     * 오차 한도 안에서 VMD 키프레임 줄이기
+     * : 트랙마다 앞에서부터 한 구간을 키를 건너뛰며 최대한 늘리고, 그 구간을 남긴 두 키와 새 곡선으로 다시 계산해서
+     *   원래 키 위치와 원래 키 사이 몇 지점이 모두 한도 안에 들 때만 가운데 키를 지웁니다.
+     *   곡선은 원래 곡선, 직선, 최소 제곱으로 맞춘 곡선 (VMD 에 저장할 수 있게 1/127 단위로 반올림) 중 가장 잘 맞는 것을 씁니다.
+     *   남긴 키의 값은 바꾸지 않습니다. 카메라, 조명 키는 그대로 복사하며 트랙은 여러 스레드에서 처리합니다.
+     */
+    class MotionKeyReducer
+    {
+    public:
+        bool Build(const VMDMotionData& InMotion, const KeyReductionOptions& InOptions = KeyReductionOptions());
+        void Delete();
+
+        const VMDMotionData& GetMotion() const { return Motion; }
+
+        // 입력 트랙 순서와 같음
+        const std::vector<TrackReduction>& GetBoneTrackStats() const { return BoneTrackStats; }
+        const std::vector<TrackReduction>& GetMorphTrackStats() const { return MorphTrackStats; }
+
+        // 본 + 모프 키 전체 기준 (입력 키 수 / 남은 키 수)
+        float GetCompressionRatio() const;
+
+    protected:
+        VMDMotionData Motion;
+
+        std::vector<TrackReduction> BoneTrackStats;
+        std::vector<TrackReduction> MorphTrackStats;
+    };
+}
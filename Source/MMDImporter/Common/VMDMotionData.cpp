@@ -0,0 +1,634 @@
+﻿#include "VMDMotionData.h"
+#include "PMXMath.h"
+#include "PMXParallel.h"
+#include "PMXShiftJIS.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace PMX
+{
+    // 레코드 크기 (바이트)
+    static constexpr MemSize VMDBoneRecordSize = 15 + 4 + 12 + 16 + 64;
+    static constexpr MemSize VMDMorphRecordSize = 15 + 4 + 4;
+    static constexpr MemSize VMDCameraRecordSize = 4 + 4 + 12 + 12 + 24 + 4 + 1;
+    static constexpr MemSize VMDLightRecordSize = 4 + 12 + 12;
+
+    static constexpr MemSize VMDNameSize = 15;
+
+    template<typename T>
+    static T ReadVMDValue(const Byte* InSource)
+    {
+        T Value;
+        memcpy(&Value, InSource, sizeof(T));
+        return Value;
+    }
+
+    // 0 ~ 127 -> 0 ~ 1
+    static float UnpackVMDBezier(const Byte InValue)
+    {
+        return static_cast<UByte>(InValue) / 127.0f;
+    }
+
+    /**
+     * (프레임 << 32 | 레코드 번호) 를 프레임 바이트만 LSD 기수 정렬
+     * : 안정 정렬이라 같은 프레임은 레코드 순서가 유지됩니다. 이미 정렬된 트랙 (대부분) 은 한 번 훑고 끝냅니다.
+     *   가장 큰 프레임에 필요한 바이트 수만큼만 돌므로 보통 2 번이면 끝납니다.
+     */
+    static void RadixSortVMDKeys(UInt64* InOutKeys, UInt64* InScratch, const int InCount)
+    {
+        bool bSorted = true;
+        UInt64 MaxKey = 0;
+
+        for (int i = 0; i < InCount; ++i)
+        {
+            if (i > 0 && InOutKeys[i] < InOutKeys[i - 1])
+                bSorted = false;
+
+            MaxKey = std::max(MaxKey, InOutKeys[i]);
+        }
+
+        if (bSorted)
+            return;
+
+        const UInt32 MaxFrame = static_cast<UInt32>(MaxKey >> 32);
+
+        UInt64* Source = InOutKeys;
+        UInt64* Destination = InScratch;
+
+        for (int Shift = 32; Shift < 64 && (static_cast<UInt64>(MaxFrame) >> (Shift - 32)) != 0; Shift += 8)
+        {
+            int Offsets[256] = { 0, };
+
+            for (int i = 0; i < InCount; ++i)
+                ++Offsets[(Source[i] >> Shift) & 0xFF];
+
+            int Sum = 0;
+            for (int& Offset : Offsets)
+            {
+                const int Count = Offset;
+                Offset = Sum;
+                Sum += Count;
+            }
+
+            for (int i = 0; i < InCount; ++i)
+                Destination[Offsets[(Source[i] >> Shift) & 0xFF]++] = Source[i];
+
+            std::swap(Source, Destination);
+        }
+
+        if (Source != InOutKeys)
+            memcpy(InOutKeys, Source, sizeof(UInt64) * InCount);
+    }
+
+    // 정렬한 키에서 같은 프레임은 마지막 레코드만 남기고 레코드 번호를 OutRecords 에 씀. 남은 수 반환
+    static int UniqueVMDKeys(const UInt64* InKeys, const int InCount, int* OutRecords)
+    {
+        int UniqueCount = 0;
+
+        for (int i = 0; i < InCount; ++i)
+        {
+            if (i + 1 < InCount && (InKeys[i + 1] >> 32) == (InKeys[i] >> 32))
+                continue;
+
+            OutRecords[UniqueCount++] = static_cast<int>(InKeys[i] & 0xFFFFFFFFull);
+        }
+
+        return UniqueCount;
+    }
+
+    /**
+     * 이름이 있는 레코드 (본 / 모프) 를 트랙별로 모아 프레임 순서의 레코드 번호 목록을 만듦
+     * : 이름 조회만 한 스레드에서 하고, 트랙별 정렬은 여러 스레드에서 처리합니다.
+     *   OutOrder[Track.KeyBegin + k] 가 트랙의 k 번째 키 레코드 번호입니다.
+     */
+    static void GroupVMDTracks(const Byte* InRecords, const int InRecordCount, const MemSize InRecordSize,
+        std::vector<MotionTrack>& OutTracks, std::unordered_map<std::string, int>& OutTrackByName, std::vector<int>& OutOrder)
+    {
+        OutTracks.clear();
+        OutTrackByName.clear();
+        OutOrder.clear();
+
+        if (InRecordCount <= 0)
+            return;
+
+        std::vector<int> RecordTrack(InRecordCount);
+        std::unordered_map<std::string, int> TrackByRawName;
+
+        // NOTE: 같은 본 키가 이어서 저장된 파일이 많아서 앞 레코드 이름과 먼저 비교함
+        const Byte* LastName = nullptr;
+        int LastTrack = -1;
+
+        std::string RawName;
+
+        for (int i = 0; i < InRecordCount; ++i)
+        {
+            const Byte* Name = InRecords + InRecordSize * i;
+
+            if (LastName != nullptr && memcmp(Name, LastName, VMDNameSize) == 0)
+            {
+                RecordTrack[i] = LastTrack;
+                continue;
+            }
+
+            RawName.assign(Name, std::find(Name, Name + VMDNameSize, '\0'));
+
+            auto Found = TrackByRawName.find(RawName);
+            if (Found == TrackByRawName.end())
+            {
+                // 0 뒤의 쓰레기 바이트만 다르거나 잘못된 문자가 같은 U+FFFD 가 된 이름은 한 트랙으로 합침
+                MotionTrack Track;
+                AppendShiftJISAsUTF8(RawName.data(), RawName.size(), Track.Name);
+
+                auto FoundTrack = OutTrackByName.find(Track.Name);
+                if (FoundTrack == OutTrackByName.end())
+                {
+                    FoundTrack = OutTrackByName.emplace(Track.Name, static_cast<int>(OutTracks.size())).first;
+                    OutTracks.push_back(Track);
+                }
+
+                Found = TrackByRawName.emplace(RawName, FoundTrack->second).first;
+            }
+
+            LastName = Name;
+            LastTrack = Found->second;
+
+            RecordTrack[i] = LastTrack;
+        }
+
+        const int TrackCount = static_cast<int>(OutTracks.size());
+
+        // 트랙별 구간 (중복 제거 전)
+        std::vector<int> SourceBegin(TrackCount + 1, 0);
+        for (const int Track : RecordTrack)
+            ++SourceBegin[Track + 1];
+
+        for (int t = 0; t < TrackCount; ++t)
+            SourceBegin[t + 1] += SourceBegin[t];
+
+        std::vector<UInt64> Keys(InRecordCount);
+        std::vector<UInt64> Scratch(InRecordCount);
+        std::vector<int> Cursor(SourceBegin.begin(), SourceBegin.end() - 1);
+
+        for (int i = 0; i < InRecordCount; ++i)
+        {
+            const UInt32 Frame = ReadVMDValue<UInt32>(InRecords + InRecordSize * i + VMDNameSize);
+            Keys[Cursor[RecordTrack[i]]++] = (static_cast<UInt64>(Frame) << 32) | static_cast<UInt32>(i);
+        }
+
+        std::vector<int> UniqueRecords(InRecordCount);
+        std::vector<int> UniqueCount(TrackCount, 0);
+
+        ParallelFor(TrackCount, 4, [&](const int InBegin, const int InEnd)
+        {
+            for (int t = InBegin; t < InEnd; ++t)
+            {
+                const int Begin = SourceBegin[t];
+                const int Count = SourceBegin[t + 1] - Begin;
+
+                RadixSortVMDKeys(Keys.data() + Begin, Scratch.data() + Begin, Count);
+                UniqueCount[t] = UniqueVMDKeys(Keys.data() + Begin, Count, UniqueRecords.data() + Begin);
+            }
+        });
+
+        int KeyCount = 0;
+        for (int t = 0; t < TrackCount; ++t)
+        {
+            OutTracks[t].KeyBegin = KeyCount;
+            OutTracks[t].KeyCount = UniqueCount[t];
+
+            KeyCount += UniqueCount[t];
+        }
+
+        OutOrder.resize(KeyCount);
+
+        for (int t = 0; t < TrackCount; ++t)
+            std::copy(UniqueRecords.begin() + SourceBegin[t], UniqueRecords.begin() + SourceBegin[t] + UniqueCount[t], OutOrder.begin() + OutTracks[t].KeyBegin);
+    }
+
+    // 카메라 / 조명처럼 트랙이 하나인 레코드. 프레임은 레코드 맨 앞
+    static void SortVMDSingleTrack(const Byte* InRecords, const int InRecordCount, const MemSize InRecordSize, std::vector<int>& OutOrder)
+    {
+        std::vector<UInt64> Keys(InRecordCount);
+        std::vector<UInt64> Scratch(InRecordCount);
+
+        for (int i = 0; i < InRecordCount; ++i)
+            Keys[i] = (static_cast<UInt64>(ReadVMDValue<UInt32>(InRecords + InRecordSize * i)) << 32) | static_cast<UInt32>(i);
+
+        RadixSortVMDKeys(Keys.data(), Scratch.data(), InRecordCount);
+
+        OutOrder.resize(InRecordCount);
+        OutOrder.resize(UniqueVMDKeys(Keys.data(), InRecordCount, OutOrder.data()));
+    }
+
+    // 섹션 개수를 읽고 레코드 구간이 버퍼 안에 있는지 확인
+    // : 뒤쪽 섹션 (카메라 이후) 은 없어도 되는 파일이 많아서 bInOptional 이면 남은 바이트가 없을 때 0 개
+    static bool ReadVMDSection(const Byte*& InOutCursor, const Byte* InEnd, const MemSize InRecordSize, const bool bInOptional, const Byte*& OutRecords, int& OutCount)
+    {
+        OutRecords = nullptr;
+        OutCount = 0;
+
+        if (static_cast<MemSize>(InEnd - InOutCursor) < sizeof(UInt32))
+            return bInOptional && InOutCursor == InEnd;
+
+        const UInt32 Count = ReadVMDValue<UInt32>(InOutCursor);
+        InOutCursor += sizeof(UInt32);
+
+        if (Count > 0x7fffffffu || Count > static_cast<MemSize>(InEnd - InOutCursor) / InRecordSize)
+            return false;
+
+        OutRecords = InOutCursor;
+        OutCount = static_cast<int>(Count);
+
+        InOutCursor += InRecordSize * Count;
+        return true;
+    }
+
+    // 3차 Bezier 의 한 축. 시작 0, 끝 1
+    static float EvaluateBezierAxis(const float InT, const float InP1, const float InP2)
+    {
+        const float InvT = 1.0f - InT;
+        return 3.0f * InvT * InvT * InT * InP1 + 3.0f * InvT * InT * InT * InP2 + InT * InT * InT;
+    }
+
+    float EvaluateMotionBezier(const float InX1, const float InY1, const float InX2, const float InY2, const float InProgress)
+    {
+        if (InProgress <= 0.0f)
+            return 0.0f;
+
+        if (InProgress >= 1.0f)
+            return 1.0f;
+
+        if (InX1 == InY1 && InX2 == InY2)
+            return InProgress;
+
+        // 뉴턴법. 구간을 벗어나면 이분법으로 대신함 (X 제어점이 0~1 이면 X(t) 는 단조 증가)
+        float Low = 0.0f;
+        float High = 1.0f;
+        float T = InProgress;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const float Error = EvaluateBezierAxis(T, InX1, InX2) - InProgress;
+            if (fabsf(Error) < 1.e-6f)
+                break;
+
+            if (Error > 0)
+                High = T;
+            else
+                Low = T;
+
+            const float InvT = 1.0f - T;
+            const float Slope = 3.0f * InvT * InvT * InX1 + 6.0f * InvT * T * (InX2 - InX1) + 3.0f * T * T * (1.0f - InX2);
+            const float Next = Slope > 1.e-6f ? T - Error / Slope : -1.0f;
+
+            T = (Next > Low && Next < High) ? Next : (Low + High) * 0.5f;
+        }
+
+        return EvaluateBezierAxis(T, InY1, InY2);
+    }
+
+    // [InBegin, InEnd) 에서 InFrame 보다 큰 첫 키
+    static int FindMotionKeyAfter(const UInt32* InFrames, const int InBegin, const int InEnd, const float InFrame)
+    {
+        return static_cast<int>(std::upper_bound(InFrames + InBegin, InFrames + InEnd, InFrame,
+            [](const float InValue, const UInt32 InKeyFrame) { return InValue < static_cast<float>(InKeyFrame); }) - InFrames);
+    }
+
+    VMDMotionData::~VMDMotionData()
+    {
+        Delete();
+    }
+
+    bool VMDMotionData::LoadBinary(const Byte* const InBuffer, const MemSize InBufferSize, LoadStats* InOutStats)
+    {
+        PMX_TRACE_SCOPE(LoadScope, InOutStats, "LoadBinary");
+        PMX_TRACE_BYTES(LoadScope, InBufferSize);
+
+        Delete();
+
+        static const char Signature[] = "Vocaloid Motion Data ";
+        static constexpr MemSize SignatureSize = 30;
+
+        if (InBuffer == nullptr || InBufferSize < SignatureSize || memcmp(InBuffer, Signature, sizeof(Signature) - 1) != 0)
+            return false;
+
+        // "Vocaloid Motion Data 0002" 는 모델 이름 20 바이트, 예전 "Vocaloid Motion Data file" 은 10 바이트
+        const MemSize ModelNameSize = memcmp(InBuffer + sizeof(Signature) - 1, "0002", 4) == 0 ? 20 : 10;
+
+        const Byte* Cursor = InBuffer + SignatureSize;
+        const Byte* const End = InBuffer + InBufferSize;
+
+        if (static_cast<MemSize>(End - Cursor) < ModelNameSize)
+            return false;
+
+        AppendShiftJISAsUTF8(Cursor, ModelNameSize, ModelName);
+        Cursor += ModelNameSize;
+
+        const Byte* BoneRecords = nullptr;
+        const Byte* MorphRecords = nullptr;
+        const Byte* CameraRecords = nullptr;
+        const Byte* LightRecords = nullptr;
+
+        if (ReadVMDSection(Cursor, End, VMDBoneRecordSize, false, BoneRecords, SourceBoneKeyCount) == false
+            || ReadVMDSection(Cursor, End, VMDMorphRecordSize, true, MorphRecords, SourceMorphKeyCount) == false
+            || ReadVMDSection(Cursor, End, VMDCameraRecordSize, true, CameraRecords, CameraKeyCount) == false
+            || ReadVMDSection(Cursor, End, VMDLightRecordSize, true, LightRecords, LightKeyCount) == false)
+        {
+            Delete();
+            return false;
+        }
+
+        // NOTE: 셀프 섀도, IK 표시 섹션은 읽지 않음
+
+        std::vector<int> BoneOrder;
+        std::vector<int> MorphOrder;
+        std::vector<int> CameraOrder;
+        std::vector<int> LightOrder;
+
+        {
+            PMX_TRACE_SCOPE(SortScope, InOutStats, "SortKeys");
+            PMX_TRACE_COUNT(SortScope, SourceBoneKeyCount + SourceMorphKeyCount + CameraKeyCount + LightKeyCount);
+
+            GroupVMDTracks(BoneRecords, SourceBoneKeyCount, VMDBoneRecordSize, BoneTracks, BoneTrackByName, BoneOrder);
+            GroupVMDTracks(MorphRecords, SourceMorphKeyCount, VMDMorphRecordSize, MorphTracks, MorphTrackByName, MorphOrder);
+            SortVMDSingleTrack(CameraRecords, CameraKeyCount, VMDCameraRecordSize, CameraOrder);
+            SortVMDSingleTrack(LightRecords, LightKeyCount, VMDLightRecordSize, LightOrder);
+        }
+
+        BoneKeyCount = static_cast<int>(BoneOrder.size());
+        MorphKeyCount = static_cast<int>(MorphOrder.size());
+        CameraKeyCount = static_cast<int>(CameraOrder.size());
+        LightKeyCount = static_cast<int>(LightOrder.size());
+
+        AllocateKeys();
+
+        PMX_TRACE_SCOPE(UnpackScope, InOutStats, "UnpackKeys");
+        PMX_TRACE_COUNT(UnpackScope, BoneKeyCount + MorphKeyCount + CameraKeyCount + LightKeyCount);
+
+        // 본: 파일 버퍼에서 바로 SoA 로 풀고 Bezier 제어점을 0~1 로 바꿈
+        // : 보간 64 바이트 중 앞 16 바이트만 씀. X1 4개 (X, Y, Z, 회전), Y1 4개, X2 4개, Y2 4개 순서
+        ParallelFor(BoneKeyCount, 4096, [&](const int InBegin, const int InEnd)
+        {
+            for (int i = InBegin; i < InEnd; ++i)
+            {
+                const Byte* Record = BoneRecords + VMDBoneRecordSize * BoneOrder[i] + VMDNameSize;
+
+                BoneKeys.Frame[i] = ReadVMDValue<UInt32>(Record);
+                Record += 4;
+
+                for (float* Component : BoneKeys.Position)
+                {
+                    Component[i] = ReadVMDValue<float>(Record);
+                    Record += 4;
+                }
+
+                for (float* Component : BoneKeys.Rotation)
+                {
+                    Component[i] = ReadVMDValue<float>(Record);
+                    Record += 4;
+                }
+
+                for (int c = 0; c < static_cast<int>(BoneKeyframes::Channel::Count); ++c)
+                {
+                    BoneKeys.Bezier[c][static_cast<int>(BezierParam::X1)][i] = UnpackVMDBezier(Record[c]);
+                    BoneKeys.Bezier[c][static_cast<int>(BezierParam::Y1)][i] = UnpackVMDBezier(Record[4 + c]);
+                    BoneKeys.Bezier[c][static_cast<int>(BezierParam::X2)][i] = UnpackVMDBezier(Record[8 + c]);
+                    BoneKeys.Bezier[c][static_cast<int>(BezierParam::Y2)][i] = UnpackVMDBezier(Record[12 + c]);
+                }
+            }
+        });
+
+        ParallelFor(MorphKeyCount, 8192, [&](const int InBegin, const int InEnd)
+        {
+            for (int i = InBegin; i < InEnd; ++i)
+            {
+                const Byte* Record = MorphRecords + VMDMorphRecordSize * MorphOrder[i] + VMDNameSize;
+
+                MorphKeys.Frame[i] = ReadVMDValue<UInt32>(Record);
+                MorphKeys.Weight[i] = ReadVMDValue<float>(Record + 4);
+            }
+        });
+
+        // 카메라 보간 24 바이트: 채널마다 X1, X2, Y1, Y2 (X, Y, Z, 회전, 거리, 시야각 순서)
+        for (int i = 0; i < CameraKeyCount; ++i)
+        {
+            const Byte* Record = CameraRecords + VMDCameraRecordSize * CameraOrder[i];
+
+            CameraKeys.Frame[i] = ReadVMDValue<UInt32>(Record);
+            CameraKeys.Distance[i] = ReadVMDValue<float>(Record + 4);
+            Record += 8;
+
+            for (float* Component : CameraKeys.Target)
+            {
+                Component[i] = ReadVMDValue<float>(Record);
+                Record += 4;
+            }
+
+            for (float* Component : CameraKeys.Rotation)
+            {
+                Component[i] = ReadVMDValue<float>(Record);
+                Record += 4;
+            }
+
+            for (int c = 0; c < static_cast<int>(CameraKeyframes::Channel::Count); ++c)
+            {
+                CameraKeys.Bezier[c][static_cast<int>(BezierParam::X1)][i] = UnpackVMDBezier(Record[c * 4 + 0]);
+                CameraKeys.Bezier[c][static_cast<int>(BezierParam::X2)][i] = UnpackVMDBezier(Record[c * 4 + 1]);
+                CameraKeys.Bezier[c][static_cast<int>(BezierParam::Y1)][i] = UnpackVMDBezier(Record[c * 4 + 2]);
+                CameraKeys.Bezier[c][static_cast<int>(BezierParam::Y2)][i] = UnpackVMDBezier(Record[c * 4 + 3]);
+            }
+
+            Record += 24;
+
+            CameraKeys.FieldOfView[i] = static_cast<float>(ReadVMDValue<UInt32>(Record));
+            CameraKeys.Orthographic[i] = static_cast<UInt8>(Record[4]);
+        }
+
+        for (int i = 0; i < LightKeyCount; ++i)
+        {
+            const Byte* Record = LightRecords + VMDLightRecordSize * LightOrder[i];
+
+            LightKeys.Frame[i] = ReadVMDValue<UInt32>(Record);
+            Record += 4;
+
+            for (float* Component : LightKeys.Color)
+            {
+                Component[i] = ReadVMDValue<float>(Record);
+                Record += 4;
+            }
+
+            for (float* Component : LightKeys.Direction)
+            {
+                Component[i] = ReadVMDValue<float>(Record);
+                Record += 4;
+            }
+        }
+
+        // 트랙마다 마지막 키가 가장 큰 프레임
+        for (const MotionTrack& Track : BoneTracks)
+            FrameCount = std::max(FrameCount, BoneKeys.Frame[Track.KeyBegin + Track.KeyCount - 1]);
+
+        for (const MotionTrack& Track : MorphTracks)
+            FrameCount = std::max(FrameCount, MorphKeys.Frame[Track.KeyBegin + Track.KeyCount - 1]);
+
+        if (CameraKeyCount > 0)
+            FrameCount = std::max(FrameCount, CameraKeys.Frame[CameraKeyCount - 1]);
+
+        if (LightKeyCount > 0)
+            FrameCount = std::max(FrameCount, LightKeys.Frame[LightKeyCount - 1]);
+
+        return true;
+    }
+
+    void VMDMotionData::Delete()
+    {
+        ModelName.clear();
+        FrameCount = 0;
+
+        BoneTracks.clear();
+        BoneTrackByName.clear();
+        BoneKeys = BoneKeyframes();
+        BoneKeyCount = 0;
+        SourceBoneKeyCount = 0;
+
+        MorphTracks.clear();
+        MorphTrackByName.clear();
+        MorphKeys = MorphKeyframes();
+        MorphKeyCount = 0;
+        SourceMorphKeyCount = 0;
+
+        CameraKeys = CameraKeyframes();
+        CameraKeyCount = 0;
+
+        LightKeys = LightKeyframes();
+        LightKeyCount = 0;
+
+        std::vector<UInt32>().swap(FrameBuffer);
+        std::vector<float>().swap(FloatBuffer);
+        std::vector<UInt8>().swap(ByteBuffer);
+    }
+
+    int VMDMotionData::FindBoneTrack(const std::string& InName) const
+    {
+        auto Found = BoneTrackByName.find(InName);
+        return Found != BoneTrackByName.end() ? Found->second : -1;
+    }
+
+    int VMDMotionData::FindMorphTrack(const std::string& InName) const
+    {
+        auto Found = MorphTrackByName.find(InName);
+        return Found != MorphTrackByName.end() ? Found->second : -1;
+    }
+
+    void VMDMotionData::SampleBoneTrack(const int InTrack, const float InFrame, Vector3& OutPosition, Vector4& OutRotation) const
+    {
+        const MotionTrack& Track = BoneTracks[InTrack];
+        const int End = Track.KeyBegin + Track.KeyCount;
+        const int Next = FindMotionKeyAfter(BoneKeys.Frame, Track.KeyBegin, End, InFrame);
+
+        if (Next == Track.KeyBegin || Next == End)
+        {
+            const int Key = Next == End ? End - 1 : Next;
+
+            OutPosition = Math::MakeVector3(BoneKeys.Position[0][Key], BoneKeys.Position[1][Key], BoneKeys.Position[2][Key]);
+            OutRotation = Math::MakeVector4(BoneKeys.Rotation[0][Key], BoneKeys.Rotation[1][Key], BoneKeys.Rotation[2][Key], BoneKeys.Rotation[3][Key]);
+            return;
+        }
+
+        const int Previous = Next - 1;
+        const float Progress = (InFrame - BoneKeys.Frame[Previous]) / static_cast<float>(BoneKeys.Frame[Next] - BoneKeys.Frame[Previous]);
+
+        float Alpha[static_cast<int>(BoneKeyframes::Channel::Count)];
+        for (int c = 0; c < static_cast<int>(BoneKeyframes::Channel::Count); ++c)
+        {
+            Alpha[c] = EvaluateMotionBezier(BoneKeys.Bezier[c][static_cast<int>(BezierParam::X1)][Next], BoneKeys.Bezier[c][static_cast<int>(BezierParam::Y1)][Next],
+                BoneKeys.Bezier[c][static_cast<int>(BezierParam::X2)][Next], BoneKeys.Bezier[c][static_cast<int>(BezierParam::Y2)][Next], Progress);
+        }
+
+        float Position[3];
+        for (int c = 0; c < 3; ++c)
+            Position[c] = BoneKeys.Position[c][Previous] + (BoneKeys.Position[c][Next] - BoneKeys.Position[c][Previous]) * Alpha[c];
+
+        OutPosition = Math::MakeVector3(Position[0], Position[1], Position[2]);
+        OutRotation = Math::QuatSlerp(
+            Math::MakeVector4(BoneKeys.Rotation[0][Previous], BoneKeys.Rotation[1][Previous], BoneKeys.Rotation[2][Previous], BoneKeys.Rotation[3][Previous]),
+            Math::MakeVector4(BoneKeys.Rotation[0][Next], BoneKeys.Rotation[1][Next], BoneKeys.Rotation[2][Next], BoneKeys.Rotation[3][Next]),
+            Alpha[static_cast<int>(BoneKeyframes::Channel::Rotation)]);
+    }
+
+    // 모프는 선형 보간
+    float VMDMotionData::SampleMorphTrack(const int InTrack, const float InFrame) const
+    {
+        const MotionTrack& Track = MorphTracks[InTrack];
+        const int End = Track.KeyBegin + Track.KeyCount;
+        const int Next = FindMotionKeyAfter(MorphKeys.Frame, Track.KeyBegin, End, InFrame);
+
+        if (Next == Track.KeyBegin)
+            return MorphKeys.Weight[Next];
+
+        if (Next == End)
+            return MorphKeys.Weight[End - 1];
+
+        const int Previous = Next - 1;
+        const float Progress = (InFrame - MorphKeys.Frame[Previous]) / static_cast<float>(MorphKeys.Frame[Next] - MorphKeys.Frame[Previous]);
+
+        return MorphKeys.Weight[Previous] + (MorphKeys.Weight[Next] - MorphKeys.Weight[Previous]) * Progress;
+    }
+
+    MemSize VMDMotionData::GetKeyMemory() const
+    {
+        return FrameBuffer.size() * sizeof(UInt32) + FloatBuffer.size() * sizeof(float) + ByteBuffer.size() * sizeof(UInt8);
+    }
+
+    void VMDMotionData::AllocateKeys()
+    {
+        static constexpr int BoneBezierCount = static_cast<int>(BoneKeyframes::Channel::Count) * static_cast<int>(BezierParam::Count);
+        static constexpr int CameraBezierCount = static_cast<int>(CameraKeyframes::Channel::Count) * static_cast<int>(BezierParam::Count);
+
+        // 키 하나당 float 수
+        static constexpr int BoneFloatCount = 3 + 4 + BoneBezierCount;
+        static constexpr int MorphFloatCount = 1;
+        static constexpr int CameraFloatCount = 1 + 3 + 3 + 1 + CameraBezierCount;
+        static constexpr int LightFloatCount = 3 + 3;
+
+        const MemSize Bones = BoneKeyCount;
+        const MemSize Morphs = MorphKeyCount;
+        const MemSize Cameras = CameraKeyCount;
+        const MemSize Lights = LightKeyCount;
+
+        FrameBuffer.assign(Bones + Morphs + Cameras + Lights, 0);
+        FloatBuffer.assign(Bones * BoneFloatCount + Morphs * MorphFloatCount + Cameras * CameraFloatCount + Lights * LightFloatCount, 0.0f);
+        ByteBuffer.assign(Cameras, 0);
+
+        UInt32* FrameCursor = FrameBuffer.data();
+        float* FloatCursor = FloatBuffer.data();
+
+        BoneKeys.Frame = FrameCursor;   FrameCursor += Bones;
+        for (float*& Component : BoneKeys.Position) { Component = FloatCursor; FloatCursor += Bones; }
+        for (float*& Component : BoneKeys.Rotation) { Component = FloatCursor; FloatCursor += Bones; }
+        for (auto& Channel : BoneKeys.Bezier)
+        {
+            for (float*& Param : Channel) { Param = FloatCursor; FloatCursor += Bones; }
+        }
+
+        MorphKeys.Frame = FrameCursor;  FrameCursor += Morphs;
+        MorphKeys.Weight = FloatCursor; FloatCursor += Morphs;
+
+        CameraKeys.Frame = FrameCursor; FrameCursor += Cameras;
+        CameraKeys.Distance = FloatCursor; FloatCursor += Cameras;
+        for (float*& Component : CameraKeys.Target) { Component = FloatCursor; FloatCursor += Cameras; }
+        for (float*& Component : CameraKeys.Rotation) { Component = FloatCursor; FloatCursor += Cameras; }
+        CameraKeys.FieldOfView = FloatCursor; FloatCursor += Cameras;
+        for (auto& Channel : CameraKeys.Bezier)
+        {
+            for (float*& Param : Channel) { Param = FloatCursor; FloatCursor += Cameras; }
+        }
+        CameraKeys.Orthographic = ByteBuffer.data();
+
+        LightKeys.Frame = FrameCursor;  FrameCursor += Lights;
+        for (float*& Component : LightKeys.Color) { Component = FloatCursor; FloatCursor += Lights; }
+        for (float*& Component : LightKeys.Direction) { Component = FloatCursor; FloatCursor += Lights; }
+    }
+}
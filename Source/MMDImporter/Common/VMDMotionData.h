@@ -0,0 +1,199 @@
+﻿#pragma once
+
+#include "PMXTypes.h"
+#include "PMXTrace.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PMX
+{
+    /**
+     * VMD 트랙 하나 (본 / 모프 이름별 키프레임 구간)
+     * : 키프레임은 Keys 배열의 [KeyBegin, KeyBegin + KeyCount) 에 프레임 순서로 놓입니다.
+     */
+    struct MotionTrack
+    {
+        // Shift-JIS 에서 바꾼 UTF-8 이름. 파일에는 15 바이트까지만 저장되므로 긴 이름은 잘려 있음
+        std::string Name;
+
+        int KeyBegin = 0;
+        int KeyCount = 0;
+    };
+
+    /**
+     * Bezier 보간 채널
+     * : 키 k 의 곡선은 키 k-1 -> k 구간에 쓰입니다 (MMD 는 도착 키에 저장).
+     *   제어점 (X1, Y1), (X2, Y2) 는 0~1 로 풀어서 저장하고, 시작점 (0, 0) 끝점 (1, 1) 은 생략합니다.
+     */
+    enum class BezierParam : UInt8
+    {
+        X1,
+        Y1,
+        X2,
+        Y2,
+
+        Count
+    };
+
+    // MMD Bezier 보간. 구간 안의 시간 비율 (0~1) -> 값 비율 (0~1)
+    // : X(t) = 시간 비율이 되는 t 를 구해 Y(t) 를 반환합니다. 직선이면 바로 반환
+    float EvaluateMotionBezier(const float InX1, const float InY1, const float InX2, const float InY2, const float InProgress);
+
+    // 본 키프레임 SoA. 모든 배열은 전체 본 키 수 길이
+    struct BoneKeyframes
+    {
+        enum class Channel : UInt8
+        {
+            X,
+            Y,
+            Z,
+            Rotation,
+
+            Count
+        };
+
+        UInt32* Frame = nullptr;
+
+        // 바인드 포즈 기준 이동 / 회전 (쿼터니언 XYZW)
+        float* Position[3]{ nullptr };
+        float* Rotation[4]{ nullptr };
+
+        // [Channel][BezierParam]
+        float* Bezier[static_cast<int>(Channel::Count)][static_cast<int>(BezierParam::Count)]{ { nullptr } };
+    };
+
+    struct MorphKeyframes
+    {
+        UInt32* Frame = nullptr;
+        float* Weight = nullptr;
+    };
+
+    // 카메라는 트랙이 하나
+    struct CameraKeyframes
+    {
+        enum class Channel : UInt8
+        {
+            X,
+            Y,
+            Z,
+            Rotation,
+            Distance,
+            FieldOfView,
+
+            Count
+        };
+
+        UInt32* Frame = nullptr;
+
+        // 주시점과 그 점으로부터의 거리 (MMD 는 음수)
+        float* Distance = nullptr;
+        float* Target[3]{ nullptr };
+
+        // 오일러 각 (라디안)
+        float* Rotation[3]{ nullptr };
+
+        // 도 단위
+        float* FieldOfView = nullptr;
+
+        // 0 이면 원근, 1 이면 직교 (파일 값 그대로)
+        UInt8* Orthographic = nullptr;
+
+        float* Bezier[static_cast<int>(Channel::Count)][static_cast<int>(BezierParam::Count)]{ { nullptr } };
+    };
+
+    struct LightKeyframes
+    {
+        UInt32* Frame = nullptr;
+
+        float* Color[3]{ nullptr };
+        float* Direction[3]{ nullptr };
+    };
+
+    /**
+     * VMD Motion Data
+     * : 호출하는 쪽의 버퍼 (파일을 매핑한 메모리 등) 에서 바로 읽으며 중간 복사본을 만들지 않습니다.
+     *   파일의 키프레임은 트랙이 섞여 있고 정렬되어 있지 않으므로 트랙별로 모은 뒤 프레임 순으로 기수 정렬합니다.
+     *   트랙별 정렬과 키 풀기는 여러 스레드에서 처리합니다. 같은 프레임의 키가 여러 개면 파일에서 뒤에 있는 키를 남깁니다.
+     */
+    class VMDMotionData
+    {
+        friend class MotionKeyReducer;
+
+    public:
+        ~VMDMotionData();
+
+        // InOutStats 가 있으면 정렬 / 풀기 단계 시간을 기록
+        bool LoadBinary(const Byte* const InBuffer, const MemSize InBufferSize, LoadStats* InOutStats = nullptr);
+        void Delete();
+
+        const std::string& GetModelName() const { return ModelName; }
+
+        // 마지막 키의 프레임 (30 fps)
+        UInt32 GetFrameCount() const { return FrameCount; }
+
+        int GetBoneTrackCount() const { return static_cast<int>(BoneTracks.size()); }
+        const MotionTrack* GetBoneTracks() const { return BoneTracks.data(); }
+        const BoneKeyframes& GetBoneKeys() const { return BoneKeys; }
+        int GetBoneKeyCount() const { return BoneKeyCount; }
+
+        int GetMorphTrackCount() const { return static_cast<int>(MorphTracks.size()); }
+        const MotionTrack* GetMorphTracks() const { return MorphTracks.data(); }
+        const MorphKeyframes& GetMorphKeys() const { return MorphKeys; }
+        int GetMorphKeyCount() const { return MorphKeyCount; }
+
+        const CameraKeyframes& GetCameraKeys() const { return CameraKeys; }
+        int GetCameraKeyCount() const { return CameraKeyCount; }
+
+        const LightKeyframes& GetLightKeys() const { return LightKeys; }
+        int GetLightKeyCount() const { return LightKeyCount; }
+
+        // 이름 (UTF-8) 으로 트랙 찾기. 없으면 -1
+        int FindBoneTrack(const std::string& InName) const;
+        int FindMorphTrack(const std::string& InName) const;
+
+        // 한 프레임의 값. 첫 키 앞과 마지막 키 뒤는 그 키의 값
+        // : 키를 매번 이진 탐색하므로 검증과 키 줄이기의 기준값 용도입니다.
+        void SampleBoneTrack(const int InTrack, const float InFrame, Vector3& OutPosition, Vector4& OutRotation) const;
+        float SampleMorphTrack(const int InTrack, const float InFrame) const;
+
+        // 파일에 있던 키 수 (같은 프레임 중복 포함)
+        int GetSourceBoneKeyCount() const { return SourceBoneKeyCount; }
+        int GetSourceMorphKeyCount() const { return SourceMorphKeyCount; }
+
+        // 키 배열이 차지하는 바이트 수
+        MemSize GetKeyMemory() const;
+
+    protected:
+        // 키 배열을 한 번에 잡고 SoA 포인터를 나눠 줌
+        void AllocateKeys();
+
+    protected:
+        std::string ModelName;
+        UInt32 FrameCount = 0;
+
+        std::vector<MotionTrack> BoneTracks;
+        std::unordered_map<std::string, int> BoneTrackByName;
+        BoneKeyframes BoneKeys;
+        int BoneKeyCount = 0;
+        int SourceBoneKeyCount = 0;
+
+        std::vector<MotionTrack> MorphTracks;
+        std::unordered_map<std::string, int> MorphTrackByName;
+        MorphKeyframes MorphKeys;
+        int MorphKeyCount = 0;
+        int SourceMorphKeyCount = 0;
+
+        CameraKeyframes CameraKeys;
+        int CameraKeyCount = 0;
+
+        LightKeyframes LightKeys;
+        int LightKeyCount = 0;
+
+        // 키 배열 전체. 위 SoA 포인터는 이 안을 가리킴
+        std::vector<UInt32> FrameBuffer;
+        std::vector<float> FloatBuffer;
+        std::vector<UInt8> ByteBuffer;
+    };
+}
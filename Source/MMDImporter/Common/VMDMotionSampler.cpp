@@ -0,0 +1,492 @@
+﻿#include "VMDMotionSampler.h"
+#include "PMXParallel.h"
+#include "PMXShiftJIS.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace PMX
+{
+    // VMD 본 / 모프 이름의 최대 Shift-JIS 바이트 수
+    static constexpr int SamplerNameSize = 15;
+
+    // 병렬 처리시 한 작업이 담당할 인스턴스 수
+    static constexpr int SamplerInstanceBatchSize = 256;
+
+    // 스택 버퍼로 한번에 계산하는 인스턴스 수
+    static constexpr int SamplerChunkSize = 64;
+
+    // 커서에서 앞으로 한 키씩 넘겨 보는 횟수. 넘으면 이진 탐색
+    static constexpr int SamplerLinearSeekCount = 4;
+
+    // Bezier 역함수: 이분법으로 범위를 좁힌 뒤 뉴턴법으로 다듬음 (분기 없이 고정 횟수)
+    static constexpr int SamplerBisectionCount = 8;
+    static constexpr int SamplerNewtonCount = 3;
+
+    // 묶은 본 키 하나의 float 수: 이동 3, 회전 4, Bezier [Channel][BezierParam] 16, 빈 칸 1 (96 바이트)
+    static constexpr int SamplerPositionOffset = 0;
+    static constexpr int SamplerRotationOffset = 3;
+    static constexpr int SamplerBezierOffset = 7;
+    static constexpr int SamplerBoneKeyStride = 24;
+
+    static inline float EvaluateSamplerBezierAxis(const float InT, const float InP1, const float InP2)
+    {
+        const float InvT = 1.0f - InT;
+        return 3.0f * InvT * InvT * InT * InP1 + 3.0f * InvT * InT * InT * InP2 + InT * InT * InT;
+    }
+
+    // InCursor 는 InFrame 이하인 마지막 키 (없으면 InBegin). 시간이 앞으로 조금 움직였으면 몇 키만 넘겨 봄
+    static int SeekSamplerKey(const UInt32* InKeyFrames, const int InBegin, const int InEnd, const float InFrame, int InCursor)
+    {
+        if (InCursor < InBegin || InCursor >= InEnd)
+            InCursor = InBegin;
+
+        auto IsBefore = [](const float InValue, const UInt32 InKeyFrame) { return InValue < static_cast<float>(InKeyFrame); };
+
+        // 뒤로 감기
+        if (InFrame < static_cast<float>(InKeyFrames[InCursor]))
+        {
+            const int Next = static_cast<int>(std::upper_bound(InKeyFrames + InBegin, InKeyFrames + InCursor, InFrame, IsBefore) - InKeyFrames);
+            return Next > InBegin ? Next - 1 : InBegin;
+        }
+
+        for (int Step = 0; Step < SamplerLinearSeekCount; ++Step)
+        {
+            if (InCursor + 1 >= InEnd || InFrame < static_cast<float>(InKeyFrames[InCursor + 1]))
+                return InCursor;
+
+            ++InCursor;
+        }
+
+        return static_cast<int>(std::upper_bound(InKeyFrames + InCursor, InKeyFrames + InEnd, InFrame, IsBefore) - InKeyFrames) - 1;
+    }
+
+    // 인스턴스마다 앞 / 뒤 키와 구간 안의 시간 비율. 첫 키 앞과 마지막 키 뒤는 비율 0 (앞 키 값)
+    // : 하나라도 두 키 사이에 있으면 true
+    static bool SeekSamplerSegments(const UInt32* InKeyFrames, const int InBegin, const int InEnd, const float* InFrames, int* InOutCursor, const int InCount,
+        int* OutPrevious, int* OutNext, float* OutProgress)
+    {
+        bool bInterpolate = false;
+
+        for (int i = 0; i < InCount; ++i)
+        {
+            const int Previous = SeekSamplerKey(InKeyFrames, InBegin, InEnd, InFrames[i], InOutCursor[i]);
+            const int Next = Previous + 1 < InEnd ? Previous + 1 : Previous;
+            const UInt32 Span = InKeyFrames[Next] - InKeyFrames[Previous];
+
+            float Progress = Span > 0 ? (InFrames[i] - static_cast<float>(InKeyFrames[Previous])) / static_cast<float>(Span) : 0.0f;
+            Progress = Progress < 0.0f ? 0.0f : (Progress > 1.0f ? 1.0f : Progress);
+
+            InOutCursor[i] = Previous;
+            OutPrevious[i] = Previous;
+            OutNext[i] = Next;
+            OutProgress[i] = Progress;
+
+            bInterpolate |= Progress > 0.0f;
+        }
+
+        return bInterpolate;
+    }
+
+    // EvaluateMotionBezier 의 인스턴스 묶음 버전. 각 단계가 인스턴스 방향 루프라 벡터화됨
+    static void EvaluateSamplerBezier(const float* InX1, const float* InY1, const float* InX2, const float* InY2, const float* InProgress, float* OutAlpha, const int InCount)
+    {
+        float T[SamplerChunkSize];
+        float Low[SamplerChunkSize];
+        float High[SamplerChunkSize];
+
+        for (int i = 0; i < InCount; ++i)
+            T[i] = 0.5f;
+
+        // X 제어점이 0~1 이면 X(t) 는 단조 증가. T 는 남은 구간 [T - Step * 2, T + Step * 2] 의 가운데
+        float Step = 0.25f;
+        for (int s = 0; s < SamplerBisectionCount; ++s, Step *= 0.5f)
+        {
+            for (int i = 0; i < InCount; ++i)
+                T[i] += EvaluateSamplerBezierAxis(T[i], InX1[i], InX2[i]) > InProgress[i] ? -Step : Step;
+        }
+
+        for (int i = 0; i < InCount; ++i)
+        {
+            Low[i] = T[i] - Step * 2.0f;
+            High[i] = T[i] + Step * 2.0f;
+        }
+
+        for (int s = 0; s < SamplerNewtonCount; ++s)
+        {
+            for (int i = 0; i < InCount; ++i)
+            {
+                const float Error = EvaluateSamplerBezierAxis(T[i], InX1[i], InX2[i]) - InProgress[i];
+                const float InvT = 1.0f - T[i];
+                const float Slope = 3.0f * InvT * InvT * InX1[i] + 6.0f * InvT * T[i] * (InX2[i] - InX1[i]) + 3.0f * T[i] * T[i] * (1.0f - InX2[i]);
+                const float Next = T[i] - Error / (Slope > 1.e-6f ? Slope : 1.e-6f);
+
+                T[i] = Next < Low[i] ? Low[i] : (Next > High[i] ? High[i] : Next);
+            }
+        }
+
+        // 직선 곡선과 구간 끝은 시간 비율 그대로. 선택을 0 / 1 가중치로 섞어야 벡터화됨
+        for (int i = 0; i < InCount; ++i)
+        {
+            const float Progress = InProgress[i];
+            const float Y = EvaluateSamplerBezierAxis(T[i], InY1[i], InY2[i]);
+
+            const float Linear = fabsf(InX1[i] - InY1[i]) + fabsf(InX2[i] - InY2[i]) < 1.e-6f ? 1.0f : 0.0f;
+            const float Inside = Progress > 0.0f ? 1.0f : 0.0f;
+            const float End = Progress >= 1.0f ? 1.0f : 0.0f;
+
+            const float Curve = Y + (Progress - Y) * Linear;
+            OutAlpha[i] = (Curve + (1.0f - Curve) * End) * Inside;
+        }
+    }
+
+    MotionSampler::~MotionSampler()
+    {
+        Delete();
+    }
+
+    bool MotionSampler::Build(const VMDMotionData& InMotion, const PMXMeshData& InMeshData)
+    {
+        Delete();
+
+        const int ModelBoneCount = InMeshData.GetBoneCount();
+        const int ModelMorphCount = InMeshData.GetMorphCount();
+
+        if (ModelBoneCount <= 0 || InMeshData.GetBones() == nullptr)
+            return false;
+
+        MotionRef = &InMotion;
+        BoneCount = ModelBoneCount;
+        MorphCount = InMeshData.GetMorphs() != nullptr ? ModelMorphCount : 0;
+
+        ArrayBoneTrack = new int[BoneCount];
+        ArrayMorphTrack = new int[MorphCount > 0 ? MorphCount : 1];
+
+        // VMD 이름은 15 바이트에서 잘려 있으므로 모델 이름도 같은 길이로 잘라서 찾음
+        std::string Name;
+
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            Name.clear();
+            AppendTextAsUTF8(InMeshData.GetBones()[i].NameLocal, Name, SamplerNameSize);
+
+            ArrayBoneTrack[i] = InMotion.FindBoneTrack(Name);
+            BoundBoneCount += ArrayBoneTrack[i] >= 0 ? 1 : 0;
+        }
+
+        for (int i = 0; i < MorphCount; ++i)
+        {
+            Name.clear();
+            AppendTextAsUTF8(InMeshData.GetMorphs()[i].NameLocal, Name, SamplerNameSize);
+
+            ArrayMorphTrack[i] = InMotion.FindMorphTrack(Name);
+            BoundMorphCount += ArrayMorphTrack[i] >= 0 ? 1 : 0;
+        }
+
+        ArrayBoundBone = new int[BoundBoneCount > 0 ? BoundBoneCount : 1];
+        ArrayBoundKeyBegin = new int[BoundBoneCount > 0 ? BoundBoneCount : 1];
+        ArrayBoundMorph = new int[BoundMorphCount > 0 ? BoundMorphCount : 1];
+
+        for (int i = 0, b = 0; i < BoneCount; ++i)
+        {
+            if (ArrayBoneTrack[i] >= 0)
+                ArrayBoundBone[b++] = i;
+        }
+
+        for (int i = 0, m = 0; i < MorphCount; ++i)
+        {
+            if (ArrayMorphTrack[i] >= 0)
+                ArrayBoundMorph[m++] = i;
+        }
+
+        // 연결된 트랙의 키를 키 하나씩 묶어 둠
+        // : 인스턴스마다 시간이 다르면 SoA 키 배열에서는 키 하나를 읽는데 배열 수만큼 캐시 미스가 납니다.
+        //   같은 트랙에 연결된 본이 여럿이면 (잘린 이름) 한번만 묶습니다.
+        const MotionTrack* Tracks = InMotion.GetBoneTracks();
+        const BoneKeyframes& Keys = InMotion.GetBoneKeys();
+
+        std::vector<int> TrackKeyBegin(InMotion.GetBoneTrackCount(), -1);
+        std::vector<int> PackedTracks;
+        int PackedKeyCount = 0;
+
+        for (int b = 0; b < BoundBoneCount; ++b)
+        {
+            const int Track = ArrayBoneTrack[ArrayBoundBone[b]];
+
+            if (TrackKeyBegin[Track] < 0)
+            {
+                TrackKeyBegin[Track] = PackedKeyCount;
+                PackedKeyCount += Tracks[Track].KeyCount;
+                PackedTracks.push_back(Track);
+            }
+
+            ArrayBoundKeyBegin[b] = TrackKeyBegin[Track];
+        }
+
+        ArrayBoneKey = new float[static_cast<MemSize>(PackedKeyCount > 0 ? PackedKeyCount : 1) * SamplerBoneKeyStride];
+
+        for (const int Track : PackedTracks)
+        {
+            for (int k = 0; k < Tracks[Track].KeyCount; ++k)
+            {
+                const int Key = Tracks[Track].KeyBegin + k;
+                float* Out = ArrayBoneKey + static_cast<MemSize>(TrackKeyBegin[Track] + k) * SamplerBoneKeyStride;
+
+                for (int c = 0; c < 3; ++c)
+                    Out[SamplerPositionOffset + c] = Keys.Position[c][Key];
+
+                for (int c = 0; c < 4; ++c)
+                    Out[SamplerRotationOffset + c] = Keys.Rotation[c][Key];
+
+                for (int c = 0; c < static_cast<int>(BoneKeyframes::Channel::Count); ++c)
+                {
+                    for (int p = 0; p < static_cast<int>(BezierParam::Count); ++p)
+                        Out[SamplerBezierOffset + c * static_cast<int>(BezierParam::Count) + p] = Keys.Bezier[c][p][Key];
+                }
+
+                Out[SamplerBoneKeyStride - 1] = 0.0f;
+            }
+        }
+
+        return true;
+    }
+
+    void MotionSampler::Delete()
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayBoneTrack);
+        PMX_SAFE_DELETE_ARRAY(ArrayMorphTrack);
+        PMX_SAFE_DELETE_ARRAY(ArrayBoundBone);
+        PMX_SAFE_DELETE_ARRAY(ArrayBoundKeyBegin);
+        PMX_SAFE_DELETE_ARRAY(ArrayBoneKey);
+        PMX_SAFE_DELETE_ARRAY(ArrayBoundMorph);
+        PMX_SAFE_DELETE_ARRAY(ArrayBoneCursor);
+        PMX_SAFE_DELETE_ARRAY(ArrayMorphCursor);
+
+        MotionRef = nullptr;
+        BoneCount = 0;
+        MorphCount = 0;
+        BoundBoneCount = 0;
+        BoundMorphCount = 0;
+        CursorInstanceCount = 0;
+    }
+
+    void MotionSampler::ResetCursors(const int InInstanceCount)
+    {
+        PMX_SAFE_DELETE_ARRAY(ArrayBoneCursor);
+        PMX_SAFE_DELETE_ARRAY(ArrayMorphCursor);
+        CursorInstanceCount = 0;
+
+        if (MotionRef == nullptr || InInstanceCount <= 0)
+            return;
+
+        CursorInstanceCount = InInstanceCount;
+
+        const MemSize BoneCursorCount = static_cast<MemSize>(BoundBoneCount) * CursorInstanceCount;
+        const MemSize MorphCursorCount = static_cast<MemSize>(BoundMorphCount) * CursorInstanceCount;
+
+        ArrayBoneCursor = new int[BoneCursorCount > 0 ? BoneCursorCount : 1];
+        ArrayMorphCursor = new int[MorphCursorCount > 0 ? MorphCursorCount : 1];
+
+        for (int b = 0; b < BoundBoneCount; ++b)
+            std::fill(ArrayBoneCursor + static_cast<MemSize>(b) * CursorInstanceCount, ArrayBoneCursor + static_cast<MemSize>(b + 1) * CursorInstanceCount,
+                MotionRef->GetBoneTracks()[ArrayBoneTrack[ArrayBoundBone[b]]].KeyBegin);
+
+        for (int m = 0; m < BoundMorphCount; ++m)
+            std::fill(ArrayMorphCursor + static_cast<MemSize>(m) * CursorInstanceCount, ArrayMorphCursor + static_cast<MemSize>(m + 1) * CursorInstanceCount,
+                MotionRef->GetMorphTracks()[ArrayMorphTrack[ArrayBoundMorph[m]]].KeyBegin);
+    }
+
+    void MotionSampler::Sample(const float* InFrames, PoseBatch& InOutPose, float* OutMorphWeights, const int InInstanceBegin, const int InInstanceEnd)
+    {
+        if (MotionRef == nullptr || InOutPose.GetBoneCount() != BoneCount || InOutPose.GetInstanceCount() != CursorInstanceCount)
+            return;
+
+        SampleBones(InFrames, InOutPose, InInstanceBegin, InInstanceEnd);
+
+        if (OutMorphWeights != nullptr)
+            SampleMorphs(InFrames, OutMorphWeights, InInstanceBegin, InInstanceEnd);
+    }
+
+    void MotionSampler::SampleBatch(const float* InFrames, PoseBatch& InOutPose, float* OutMorphWeights)
+    {
+        ParallelFor(InOutPose.GetInstanceCount(), SamplerInstanceBatchSize, [this, InFrames, &InOutPose, OutMorphWeights](const int Begin, const int End)
+        {
+            Sample(InFrames, InOutPose, OutMorphWeights, Begin, End);
+        });
+    }
+
+    void MotionSampler::SampleBones(const float* InFrames, PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd)
+    {
+        const int InstanceCount = InOutPose.GetInstanceCount();
+        const BoneKeyframes& Keys = MotionRef->GetBoneKeys();
+        const MotionTrack* Tracks = MotionRef->GetBoneTracks();
+
+        float* RX = InOutPose.LocalRotation[0];
+        float* RY = InOutPose.LocalRotation[1];
+        float* RZ = InOutPose.LocalRotation[2];
+        float* RW = InOutPose.LocalRotation[3];
+
+        // 트랙이 없는 본은 바인드 포즈
+        for (int Bone = 0; Bone < BoneCount; ++Bone)
+        {
+            if (ArrayBoneTrack[Bone] >= 0)
+                continue;
+
+            const int Base = Bone * InstanceCount;
+
+            std::fill(RX + Base + InInstanceBegin, RX + Base + InInstanceEnd, 0.0f);
+            std::fill(RY + Base + InInstanceBegin, RY + Base + InInstanceEnd, 0.0f);
+            std::fill(RZ + Base + InInstanceBegin, RZ + Base + InInstanceEnd, 0.0f);
+            std::fill(RW + Base + InInstanceBegin, RW + Base + InInstanceEnd, 1.0f);
+
+            for (float* Component : InOutPose.LocalTranslation)
+                std::fill(Component + Base + InInstanceBegin, Component + Base + InInstanceEnd, 0.0f);
+        }
+
+        static constexpr int ChannelCount = static_cast<int>(BoneKeyframes::Channel::Count);
+        static constexpr int RotationChannel = static_cast<int>(BoneKeyframes::Channel::Rotation);
+
+        int Previous[SamplerChunkSize];
+        int Next[SamplerChunkSize];
+        float Progress[SamplerChunkSize];
+        float Alpha[ChannelCount][SamplerChunkSize];
+        float Control[static_cast<int>(BezierParam::Count)][SamplerChunkSize];
+        const float* PreviousKey[SamplerChunkSize];
+        const float* NextKey[SamplerChunkSize];
+        float A[4][SamplerChunkSize];
+        float B[4][SamplerChunkSize];
+
+        for (int b = 0; b < BoundBoneCount; ++b)
+        {
+            const int Bone = ArrayBoundBone[b];
+            const MotionTrack& Track = Tracks[ArrayBoneTrack[Bone]];
+            const int KeyEnd = Track.KeyBegin + Track.KeyCount;
+
+            // 키 배열 기준 번호 -> 묶은 키 번호
+            const int PackedOffset = ArrayBoundKeyBegin[b] - Track.KeyBegin;
+
+            int* Cursor = ArrayBoneCursor + static_cast<MemSize>(b) * CursorInstanceCount;
+
+            for (int ChunkBegin = InInstanceBegin; ChunkBegin < InInstanceEnd; ChunkBegin += SamplerChunkSize)
+            {
+                const int Count = std::min(SamplerChunkSize, InInstanceEnd - ChunkBegin);
+                const int Base = Bone * InstanceCount + ChunkBegin;
+
+                const bool bInterpolate = SeekSamplerSegments(Keys.Frame, Track.KeyBegin, KeyEnd, InFrames + ChunkBegin, Cursor + ChunkBegin, Count, Previous, Next, Progress);
+
+                for (int i = 0; i < Count; ++i)
+                {
+                    PreviousKey[i] = ArrayBoneKey + static_cast<MemSize>(PackedOffset + Previous[i]) * SamplerBoneKeyStride;
+                    NextKey[i] = ArrayBoneKey + static_cast<MemSize>(PackedOffset + Next[i]) * SamplerBoneKeyStride;
+                }
+
+                // 모든 인스턴스가 키 위에 있으면 곡선 계산 생략
+                for (int c = 0; c < ChannelCount; ++c)
+                {
+                    if (bInterpolate == false)
+                    {
+                        std::fill(Alpha[c], Alpha[c] + Count, 0.0f);
+                        continue;
+                    }
+
+                    for (int p = 0; p < static_cast<int>(BezierParam::Count); ++p)
+                    {
+                        const int Offset = SamplerBezierOffset + c * static_cast<int>(BezierParam::Count) + p;
+                        for (int i = 0; i < Count; ++i)
+                            Control[p][i] = NextKey[i][Offset];
+                    }
+
+                    EvaluateSamplerBezier(Control[static_cast<int>(BezierParam::X1)], Control[static_cast<int>(BezierParam::Y1)],
+                        Control[static_cast<int>(BezierParam::X2)], Control[static_cast<int>(BezierParam::Y2)], Progress, Alpha[c], Count);
+                }
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    float* Out = InOutPose.LocalTranslation[c] + Base;
+
+                    for (int i = 0; i < Count; ++i)
+                    {
+                        const float From = PreviousKey[i][SamplerPositionOffset + c];
+                        Out[i] = From + (NextKey[i][SamplerPositionOffset + c] - From) * Alpha[c][i];
+                    }
+                }
+
+                // 키 값을 모은 뒤 Math::QuatSlerp 와 같은 계산을 분기 없이
+                for (int c = 0; c < 4; ++c)
+                {
+                    for (int i = 0; i < Count; ++i)
+                    {
+                        A[c][i] = PreviousKey[i][SamplerRotationOffset + c];
+                        B[c][i] = NextKey[i][SamplerRotationOffset + c];
+                    }
+                }
+
+                const float* T = Alpha[RotationChannel];
+
+                for (int i = 0; i < Count; ++i)
+                {
+                    const float Dot = A[0][i] * B[0][i] + A[1][i] * B[1][i] + A[2][i] * B[2][i] + A[3][i] * B[3][i];
+                    const float Sign = Dot < 0 ? -1.0f : 1.0f;
+                    const float CosTheta = Dot * Sign < 1.0f ? Dot * Sign : 1.0f;
+
+                    // 각이 작으면 선형 보간 계수 사용
+                    const bool bLinear = CosTheta >= 0.9995f;
+                    const float Theta = acosf(CosTheta);
+                    const float InvSin = 1.0f / (bLinear ? 1.0f : sinf(Theta));
+                    const float ScaleA = bLinear ? 1.0f - T[i] : sinf((1.0f - T[i]) * Theta) * InvSin;
+                    const float ScaleB = (bLinear ? T[i] : sinf(T[i] * Theta) * InvSin) * Sign;
+
+                    const float X = A[0][i] * ScaleA + B[0][i] * ScaleB;
+                    const float Y = A[1][i] * ScaleA + B[1][i] * ScaleB;
+                    const float Z = A[2][i] * ScaleA + B[2][i] * ScaleB;
+                    const float W = A[3][i] * ScaleA + B[3][i] * ScaleB;
+                    const float InvLen = 1.0f / sqrtf(X * X + Y * Y + Z * Z + W * W);
+
+                    RX[Base + i] = X * InvLen;
+                    RY[Base + i] = Y * InvLen;
+                    RZ[Base + i] = Z * InvLen;
+                    RW[Base + i] = W * InvLen;
+                }
+            }
+        }
+    }
+
+    // 모프는 선형 보간
+    void MotionSampler::SampleMorphs(const float* InFrames, float* OutMorphWeights, const int InInstanceBegin, const int InInstanceEnd)
+    {
+        const int InstanceCount = CursorInstanceCount;
+        const MorphKeyframes& Keys = MotionRef->GetMorphKeys();
+        const MotionTrack* Tracks = MotionRef->GetMorphTracks();
+
+        for (int Morph = 0; Morph < MorphCount; ++Morph)
+        {
+            if (ArrayMorphTrack[Morph] < 0)
+                std::fill(OutMorphWeights + Morph * InstanceCount + InInstanceBegin, OutMorphWeights + Morph * InstanceCount + InInstanceEnd, 0.0f);
+        }
+
+        int Previous[SamplerChunkSize];
+        int Next[SamplerChunkSize];
+        float Progress[SamplerChunkSize];
+
+        for (int m = 0; m < BoundMorphCount; ++m)
+        {
+            const int Morph = ArrayBoundMorph[m];
+            const MotionTrack& Track = Tracks[ArrayMorphTrack[Morph]];
+
+            int* Cursor = ArrayMorphCursor + static_cast<MemSize>(m) * CursorInstanceCount;
+
+            for (int ChunkBegin = InInstanceBegin; ChunkBegin < InInstanceEnd; ChunkBegin += SamplerChunkSize)
+            {
+                const int Count = std::min(SamplerChunkSize, InInstanceEnd - ChunkBegin);
+                float* Out = OutMorphWeights + Morph * InstanceCount + ChunkBegin;
+
+                SeekSamplerSegments(Keys.Frame, Track.KeyBegin, Track.KeyBegin + Track.KeyCount, InFrames + ChunkBegin, Cursor + ChunkBegin, Count, Previous, Next, Progress);
+
+                for (int i = 0; i < Count; ++i)
+                    Out[i] = Keys.Weight[Previous[i]] + (Keys.Weight[Next[i]] - Keys.Weight[Previous[i]]) * Progress[i];
+            }
+        }
+    }
+}
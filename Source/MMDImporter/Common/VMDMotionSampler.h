@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include "PMXSkeleton.h"
+#include "VMDMotionData.h"
+
+namespace PMX
+{
+    /**
+     * 여러 인스턴스의 VMD 본 / 모프 트랙을 한번에 샘플링
+     * : Build 에서 ArrayBone / ArrayMorph 이름으로 트랙을 한번만 연결합니다 (VMD 에서 15 바이트로 잘린 이름도 맞춤).
+     *   인스턴스 * 트랙마다 마지막 키 위치를 기억해 두므로 시간이 앞으로 조금씩 움직이면 탐색 없이 다음 키를 찾습니다.
+     *   연결된 본 트랙의 키 값과 곡선은 키 하나씩 묶어서 따로 들고 있습니다 (인스턴스마다 시간이 달라도 키당 캐시 라인 2개).
+     *   Bezier 와 Slerp 은 인스턴스 방향 SoA 루프를 분기 없이 계산해서 벡터화되게 합니다.
+     *   결과는 PoseBatch 의 로컬 회전 / 이동이며, 이어서 InheritEvaluator::Apply, IKSolver, InheritEvaluator::ApplyAfterIK 순으로 적용하면 됩니다.
+     */
+    class MotionSampler
+    {
+    public:
+        ~MotionSampler();
+
+        // InMotion 은 샘플러보다 오래 유지되어야 합니다.
+        bool Build(const VMDMotionData& InMotion, const PMXMeshData& InMeshData);
+        void Delete();
+
+        // 키 위치 캐시를 인스턴스 수에 맞게 잡고 처음으로 되돌림. Sample 전에, 그리고 인스턴스 수가 바뀔 때마다 호출
+        void ResetCursors(const int InInstanceCount);
+
+        int GetBoneCount() const { return BoneCount; }
+        int GetMorphCount() const { return MorphCount; }
+
+        // 트랙이 연결된 본 / 모프 수
+        int GetBoundBoneCount() const { return BoundBoneCount; }
+        int GetBoundMorphCount() const { return BoundMorphCount; }
+
+        // 모델 본 / 모프에 연결된 트랙 번호. 없으면 -1
+        int GetBoneTrack(const int InBoneIndex) const { return ArrayBoneTrack[InBoneIndex]; }
+        int GetMorphTrack(const int InMorphIndex) const { return ArrayMorphTrack[InMorphIndex]; }
+
+        // [InInstanceBegin, InInstanceEnd) 인스턴스를 각자의 InFrames[InstanceIndex] 프레임으로 샘플링
+        // : 트랙이 없는 본은 단위 회전 / 0 이동으로 채웁니다.
+        //   OutMorphWeights 는 [MorphIndex * InstanceCount + InstanceIndex] 배열이며 nullptr 이면 모프는 건너뜁니다.
+        void Sample(const float* InFrames, PoseBatch& InOutPose, float* OutMorphWeights, const int InInstanceBegin, const int InInstanceEnd);
+
+        // 전체 인스턴스를 블록 단위로 나눠 병렬로 계산
+        void SampleBatch(const float* InFrames, PoseBatch& InOutPose, float* OutMorphWeights);
+
+    protected:
+        void SampleBones(const float* InFrames, PoseBatch& InOutPose, const int InInstanceBegin, const int InInstanceEnd);
+        void SampleMorphs(const float* InFrames, float* OutMorphWeights, const int InInstanceBegin, const int InInstanceEnd);
+
+    protected:
+        const VMDMotionData* MotionRef = nullptr;
+
+        int BoneCount = 0;
+        int MorphCount = 0;
+        int* ArrayBoneTrack = nullptr;
+        int* ArrayMorphTrack = nullptr;
+
+        // 트랙이 연결된 본 / 모프 목록 (인덱스 순)
+        int BoundBoneCount = 0;
+        int* ArrayBoundBone = nullptr;
+
+        // 연결된 본마다 ArrayBoneKey 에서 트랙 첫 키의 번호
+        int* ArrayBoundKeyBegin = nullptr;
+
+        // 묶은 본 키. 키마다 이동, 회전, Bezier 를 연속으로 둠
+        float* ArrayBoneKey = nullptr;
+
+        int BoundMorphCount = 0;
+        int* ArrayBoundMorph = nullptr;
+
+        // [Bound * CursorInstanceCount + InstanceIndex] 마지막으로 쓴 앞 키 (전체 키 배열 기준)
+        int CursorInstanceCount = 0;
+        int* ArrayBoneCursor = nullptr;
+        int* ArrayMorphCursor = nullptr;
+    };
+}
@@ -39,6 +39,8 @@ public class MMDImporter : ModuleRules
                 "MeshDescription",
                 "StaticMeshDescription",
                 "UnrealEd",
+                "ImageCore",
+                "ImageWrapper",
             }
             );
 
@@ -35,6 +35,36 @@ void UMMDImporterBPLibrary::Import(const FString& AssetName)
     GEditor->SyncBrowserToObjects(ObjectsToSync);
 }
 
+TArray<FPMXImportResult> UMMDImporterBPLibrary::ImportDirectory(const FString& SourceDirectory, const FString& DestinationPath, bool bRecursive)
+{
+    TArray<FString> SourceFiles;
+    FPMXBatchImporter::FindSourceFiles(SourceDirectory, bRecursive, SourceFiles);
+
+    FPMXBatchImportOptions Options;
+    if (DestinationPath.IsEmpty() == false)
+    {
+        Options.DestinationPath = DestinationPath;
+    }
+
+    // 디렉터리 하나를 팩으로 보고 텍스처 색인을 모든 모델이 공유
+    Options.TextureSearchRoot = SourceDirectory;
+
+    FPMXBatchImporter BatchImporter;
+    return BatchImporter.Import(SourceFiles, Options);
+}
+
+TArray<FPMXImportResult> UMMDImporterBPLibrary::ImportFiles(const TArray<FString>& SourceFiles, const FString& DestinationPath)
+{
+    FPMXBatchImportOptions Options;
+    if (DestinationPath.IsEmpty() == false)
+    {
+        Options.DestinationPath = DestinationPath;
+    }
+
+    FPMXBatchImporter BatchImporter;
+    return BatchImporter.Import(SourceFiles, Options);
+}
+
 UObject* UMMDImporterBPLibrary::CreateMeshAsset(UObject* NewOuter, const TCHAR* NewAssetName, const EObjectFlags NewFlags)
 {
     FMeshDescription MeshDesc;
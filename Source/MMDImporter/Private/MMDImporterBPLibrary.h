@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "PMXBatchImporter.h"
 #include "MMDImporterBPLibrary.generated.h"
 
 /*
@@ -33,6 +34,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "MMD Importer")
     static void Import(const FString& AssetName);
 
+    // 디렉터리 안의 PMX 파일을 워커 스레드에서 동시에 파싱해 DestinationPath(/Game/**) 아래에 일괄 임포트
+    UFUNCTION(BlueprintCallable, Category = "MMD Importer")
+    static TArray<FPMXImportResult> ImportDirectory(const FString& SourceDirectory, const FString& DestinationPath, bool bRecursive = true);
+
+    UFUNCTION(BlueprintCallable, Category = "MMD Importer")
+    static TArray<FPMXImportResult> ImportFiles(const TArray<FString>& SourceFiles, const FString& DestinationPath);
+
 protected:
     static UObject* CreateMeshAsset(UObject* OuterObject, const TCHAR* AssetName, EObjectFlags NewFlags);
 };
@@ -0,0 +1,531 @@
+﻿// Practice Unreal by Stiner
+#include "PMXBatchImporter.h"
+#include "PMXMeshConverter.h"
+#include "PMXTexturePrefetcher.h"
+#include "PMXTextureResolver.h"
+#include "MMDImporter/Common/PMXMeshData.h"
+#include "MMDImporter/Common/PMXTrace.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopedSlowTask.h"
+#include "HAL/FileManager.h"
+#include "MeshDescription.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "ImageCore.h"
+#include "ObjectTools.h"
+#include "UObject/SavePackage.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Editor.h"
+
+#define LOCTEXT_NAMESPACE "PMXBatchImporter"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPMXBatchImport, Log, All);
+
+// 파싱 중 읽기를 시작한 텍스처
+struct FPMXPrefetchedTexture
+{
+    FString FilePath;
+    FPMXTexturePrefetcher::FImageFuture Image;
+};
+
+// 워커 스레드 처리 결과
+struct FPMXParsedModel
+{
+    TUniquePtr<FMeshDescription> MeshDesc;
+
+    TArray<FPMXPrefetchedTexture> Textures;
+
+    FString Error;
+
+    float ReadSeconds = 0;
+    float ParseSeconds = 0;
+    float ConvertSeconds = 0;
+};
+
+// 워커 스레드에서 실행. 엔진 오브젝트를 만들지 않음
+static FPMXParsedModel ParseModel(const FString& InSourceFile, const int64 InMemoryBudget, FPMXTextureResolver* InTextureResolver, FPMXTexturePrefetcher* InTexturePrefetcher, PMX::LoadStats* InOutStats)
+{
+    FPMXParsedModel Model;
+
+    double StartTime = FPlatformTime::Seconds();
+
+    // 파일 버퍼도 상한에 포함. 파일만으로 넘으면 읽지도 않음
+    const int64 FileSize = IFileManager::Get().FileSize(*InSourceFile);
+    if (InMemoryBudget > 0 && FileSize >= InMemoryBudget)
+    {
+        Model.Error = FString::Printf(TEXT("File size %.1f MB exceeds memory budget %.1f MB"), FileSize / (1024.0 * 1024.0), InMemoryBudget / (1024.0 * 1024.0));
+        return Model;
+    }
+
+    TArray<uint8> FileData;
+    {
+        PMX_TRACE_SCOPE(ReadScope, InOutStats, "ReadFile");
+
+        if (FFileHelper::LoadFileToArray(FileData, *InSourceFile) == false)
+        {
+            Model.Error = TEXT("Failed to read file");
+            return Model;
+        }
+
+        PMX_TRACE_BYTES(ReadScope, FileData.Num());
+    }
+
+    double EndTime = FPlatformTime::Seconds();
+    Model.ReadSeconds = static_cast<float>(EndTime - StartTime);
+    StartTime = EndTime;
+
+    // NOTE: 텍스처 목록은 정점/삼각형 바로 뒤에 있으므로 읽자마자 텍스처 읽기를 시작해 나머지 파싱, 변환과 겹치게 함.
+    PMX::LoadProgress LoadProgress;
+    LoadProgress.Stats = InOutStats;
+
+    if (InTexturePrefetcher != nullptr && InTextureResolver != nullptr)
+    {
+        const FString ModelDirectory = FPaths::GetPath(InSourceFile);
+
+        // 한 모델 안에서 같은 파일을 여러 번 넣지 않도록
+        TSet<FString> RequestedFiles;
+
+        auto RequestTexture = [&](const FString& InSourcePath, const FString& InResolvedPath)
+        {
+            const FString& FilePath = InResolvedPath.IsEmpty() ? InSourcePath : InResolvedPath;
+
+            bool bAlreadyRequested = false;
+            RequestedFiles.Add(FilePath, &bAlreadyRequested);
+            if (bAlreadyRequested)
+                return;
+
+            FPMXPrefetchedTexture& Texture = Model.Textures.AddDefaulted_GetRef();
+
+            // 찾지 못한 파일은 원래 경로만 남겨 누락으로 보고
+            if (InResolvedPath.IsEmpty())
+            {
+                Texture.FilePath = InSourcePath;
+                return;
+            }
+
+            Texture.FilePath = InResolvedPath;
+            Texture.Image = InTexturePrefetcher->Request(InResolvedPath);
+        };
+
+        LoadProgress.OnSectionLoaded = [&](const PMX::LoadProgress::SectionType InSection, const PMX::PMXMeshData& InMeshData)
+        {
+            if (InSection == PMX::LoadProgress::SectionType::Textures)
+            {
+                // NOTE: 같은 팩 루트를 이미 색인했으면 바로 반환.
+                InTextureResolver->IndexDirectory(ModelDirectory);
+
+                for (int32 t = 0; t < InMeshData.GetTextureCount(); ++t)
+                {
+                    const FString RelativePath = FPMXMeshConverter::ToString(InMeshData.GetTextures()[t].Path);
+                    if (RelativePath.IsEmpty())
+                        continue;
+
+                    RequestTexture(FPaths::Combine(ModelDirectory, RelativePath), InTextureResolver->Resolve(ModelDirectory, RelativePath));
+                }
+            }
+            else if (InSection == PMX::LoadProgress::SectionType::Materials)
+            {
+                // 내부 툰 텍스처는 텍스처 목록에 없으므로 재질을 읽은 뒤 따로 요청
+                for (int32 m = 0; m < InMeshData.GetMaterialCount(); ++m)
+                {
+                    const PMX::MaterialData& Material = InMeshData.GetMaterials()[m];
+                    if (Material.ToonReference != PMX::MaterialData::ToonReferenceType::Internal)
+                        continue;
+
+                    const FString ToonName = FString::Printf(TEXT("toon%02d.bmp"), Material.ToonValue + 1);
+                    RequestTexture(ToonName, InTextureResolver->ResolveToon(ModelDirectory, InMeshData, Material));
+                }
+            }
+        };
+    }
+
+    PMX::LoadOptions LoadOptions;
+    if (InMemoryBudget > 0)
+    {
+        LoadOptions.MemoryBudget = static_cast<PMX::MemSize>(FMath::Max<int64>(InMemoryBudget - FileData.Num(), 1));
+    }
+
+    PMX::PMXMeshData MeshData;
+    if (MeshData.LoadBinary(reinterpret_cast<const PMX::Byte*>(FileData.GetData()), FileData.Num(), &LoadProgress, LoadOptions) == false)
+    {
+        const PMX::MemoryReport& Memory = MeshData.GetMemoryReport();
+
+        if (Memory.bOverBudget)
+            Model.Error = FString::Printf(TEXT("Predicted memory %.1f MB exceeds budget %.1f MB"), (Memory.GetPredictedTotal() + FileData.Num()) / (1024.0 * 1024.0), InMemoryBudget / (1024.0 * 1024.0));
+        else
+            Model.Error = TEXT("Invalid or truncated PMX data");
+
+        return Model;
+    }
+
+    if (MeshData.GetMemoryReport().SkippedSections != 0)
+    {
+        UE_LOG(LogPMXBatchImport, Warning, TEXT("%s: skipped morph / physics sections to fit the memory budget"), *InSourceFile);
+    }
+
+    // 파싱이 끝나면 원본 버퍼는 필요 없음
+    FileData.Empty();
+
+    EndTime = FPlatformTime::Seconds();
+    Model.ParseSeconds = static_cast<float>(EndTime - StartTime);
+    StartTime = EndTime;
+
+    Model.MeshDesc = MakeUnique<FMeshDescription>();
+    if (FPMXMeshConverter::BuildMeshDescription(MeshData, *Model.MeshDesc, &Model.Error, nullptr, InOutStats) == false)
+    {
+        Model.MeshDesc.Reset();
+        return Model;
+    }
+
+    Model.ConvertSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+
+    return Model;
+}
+
+// 게임 스레드에서 실행
+static bool SaveAssetPackage(UPackage* InPackage, UObject* InAsset, const FString& InPackageName)
+{
+    FAssetRegistryModule::AssetCreated(InAsset);
+    InPackage->MarkPackageDirty();
+
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+
+    const FString PackageFileName = FPackageName::LongPackageNameToFilename(InPackageName, FPackageName::GetAssetPackageExtension());
+    return UPackage::SavePackage(InPackage, InAsset, *PackageFileName, SaveArgs);
+}
+
+// 게임 스레드에서 실행
+static UTexture2D* CreateTexture(UObject* InOuter, const FName InName, const EObjectFlags InFlags, const FImage& InImage)
+{
+    UTexture2D* Texture = NewObject<UTexture2D>(InOuter, InName, InFlags);
+    Texture->Source.Init(InImage);
+    Texture->PostEditChange();
+
+    return Texture;
+}
+
+void FPMXBatchImporter::FindSourceFiles(const FString& InDirectory, const bool bInRecursive, TArray<FString>& OutFiles)
+{
+    OutFiles.Reset();
+
+    if (bInRecursive)
+    {
+        IFileManager::Get().FindFilesRecursive(OutFiles, *InDirectory, TEXT("*.pmx"), true, false);
+    }
+    else
+    {
+        IFileManager::Get().FindFiles(OutFiles, *FPaths::Combine(InDirectory, TEXT("*.pmx")), true, false);
+
+        for (FString& File : OutFiles)
+        {
+            File = FPaths::Combine(InDirectory, File);
+        }
+    }
+
+    OutFiles.Sort();
+}
+
+FString FPMXBatchImporter::MakeUniqueAssetName(const FString& InSourceFile, const FString& InDestinationPath)
+{
+    const FString BaseName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(InSourceFile));
+
+    // NOTE: 같은 이름의 모델이 여러 폴더에 있는 경우가 많으므로 이미 쓰였거나 존재하는 패키지는 번호를 붙임.
+    FString AssetName = BaseName;
+    for (int32 Suffix = 1; ; ++Suffix)
+    {
+        const FString PackageName = FPaths::Combine(InDestinationPath, AssetName);
+
+        if (UsedPackageNames.Contains(PackageName) == false && FindPackage(nullptr, *PackageName) == nullptr && FPackageName::DoesPackageExist(PackageName) == false)
+        {
+            UsedPackageNames.Add(PackageName);
+            return AssetName;
+        }
+
+        AssetName = FString::Printf(TEXT("%s_%d"), *BaseName, Suffix);
+    }
+}
+
+void FPMXBatchImporter::ImportTextures(const TArray<FPMXPrefetchedTexture>& InTextures, const FPMXBatchImportOptions& InOptions, FPMXImportResult& InOutResult)
+{
+    const FString TexturePath = FPaths::Combine(InOptions.DestinationPath, TEXT("Textures"));
+
+    for (const FPMXPrefetchedTexture& Texture : InTextures)
+    {
+        if (Texture.FilePath.IsEmpty())
+            continue;
+
+        // 다른 모델이 이미 만든 텍스처
+        const FString Key = FPMXTexturePrefetcher::MakeKey(Texture.FilePath);
+        if (ImportedTextures.Contains(Key))
+            continue;
+
+        // NOTE: 보통 이 시점에는 이미 디코딩이 끝나 있어 기다리지 않음.
+        const TSharedPtr<FImage> Image = Texture.Image.IsValid() ? Texture.Image.Get() : nullptr;
+        if (Image.IsValid() == false)
+        {
+            UE_LOG(LogPMXBatchImport, Warning, TEXT("%s : Failed to load texture %s"), *InOutResult.SourceFile, *Texture.FilePath);
+            ++InOutResult.MissingTextureCount;
+
+            // 실패한 파일도 다시 시도하지 않도록 기록
+            ImportedTextures.Add(Key, nullptr);
+            continue;
+        }
+
+        const FString AssetName = MakeUniqueAssetName(Texture.FilePath, TexturePath);
+        const FString PackageName = FPaths::Combine(TexturePath, AssetName);
+
+        UPackage* NewPackage = CreatePackage(*PackageName);
+        UTexture2D* NewTexture = IsValid(NewPackage) ? CreateTexture(NewPackage, *AssetName, RF_Public | RF_Standalone, *Image) : nullptr;
+
+        TexturePrefetcher->Release(Texture.FilePath);
+
+        // 만들거나 저장하지 못한 텍스처는 읽지 못한 텍스처와 같게 실패로 기록
+        if (NewTexture == nullptr || SaveAssetPackage(NewPackage, NewTexture, PackageName) == false)
+        {
+            UE_LOG(LogPMXBatchImport, Error, TEXT("%s : Failed to create texture asset %s"), *InOutResult.SourceFile, *PackageName);
+            ++InOutResult.MissingTextureCount;
+
+            ImportedTextures.Add(Key, nullptr);
+            continue;
+        }
+
+        ImportedTextures.Add(Key, NewTexture);
+    }
+}
+
+TArray<FPMXImportResult> FPMXBatchImporter::Import(const TArray<FString>& InSourceFiles, const FPMXBatchImportOptions& InOptions)
+{
+    check(IsInGameThread());
+
+    const int32 FileCount = InSourceFiles.Num();
+
+    TArray<FPMXImportResult> Results;
+    Results.SetNum(FileCount);
+
+    for (int32 i = 0; i < FileCount; ++i)
+    {
+        Results[i].SourceFile = InSourceFiles[i];
+    }
+
+    if (FileCount == 0)
+        return Results;
+
+    const int32 MaxInFlight = InOptions.MaxModelsInFlight > 0 ? InOptions.MaxModelsInFlight : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+    FScopedSlowTask SlowTask(static_cast<float>(FileCount), LOCTEXT("ImportingModels", "Importing PMX models..."));
+    SlowTask.MakeDialog(true);
+
+    const double BatchStartTime = FPlatformTime::Seconds();
+
+    TArray<TFuture<FPMXParsedModel>> Futures;
+    Futures.SetNum(FileCount);
+
+    TArray<UObject*> CreatedAssets;
+
+    // 모델별 단계 측정. 워커와 게임 스레드가 같은 모델에 기록함
+    TArray<TUniquePtr<PMX::LoadStats>> ModelStats;
+    if (InOptions.TraceFilePath.IsEmpty() == false)
+    {
+        ModelStats.SetNum(FileCount);
+
+        for (int32 i = 0; i < FileCount; ++i)
+        {
+            ModelStats[i] = MakeUnique<PMX::LoadStats>(std::string(TCHAR_TO_UTF8(*InSourceFiles[i])));
+        }
+    }
+
+    if (InOptions.bImportTextures)
+    {
+        TexturePrefetcher = MakeUnique<FPMXTexturePrefetcher>(InOptions.MaxConcurrentTextureReads);
+
+        // NOTE: 팩 루트를 먼저 색인해 두면 형제 폴더를 가리키는 경로도 한 번의 색인으로 찾음.
+        TextureResolver = MakeUnique<FPMXTextureResolver>();
+        if (InOptions.TextureSearchRoot.IsEmpty() == false)
+        {
+            TextureResolver->IndexDirectory(InOptions.TextureSearchRoot);
+        }
+
+        TextureResolver->SetInternalToonDirectory(InOptions.InternalToonDirectory);
+    }
+
+    int32 NextLaunch = 0;
+    bool bCanceled = false;
+
+    for (int32 i = 0; i < FileCount; ++i)
+    {
+        // NOTE: 게임 스레드가 처리 중인 모델 뒤로 최대 MaxInFlight 개까지 워커에 미리 맡김.
+        while (bCanceled == false && NextLaunch < FileCount && NextLaunch - i < MaxInFlight)
+        {
+            PMX::LoadStats* Stats = ModelStats.IsEmpty() ? nullptr : ModelStats[NextLaunch].Get();
+
+            Futures[NextLaunch] = Async(EAsyncExecution::ThreadPool, [SourceFile = InSourceFiles[NextLaunch], MemoryBudget = InOptions.ModelMemoryBudget, Resolver = TextureResolver.Get(), Prefetcher = TexturePrefetcher.Get(), Stats]()
+            {
+                return ParseModel(SourceFile, MemoryBudget, Resolver, Prefetcher, Stats);
+            });
+
+            ++NextLaunch;
+        }
+
+        if (i >= NextLaunch)
+            break;
+
+        SlowTask.EnterProgressFrame(1, FText::Format(LOCTEXT("ImportingModel", "Importing {0} ({1}/{2})"), FText::FromString(FPaths::GetCleanFilename(InSourceFiles[i])), i + 1, FileCount));
+
+        // 기다리는 동안에도 진행 창을 갱신하고 취소를 받음
+        while (bCanceled == false && Futures[i].WaitFor(FTimespan::FromMilliseconds(50)) == false)
+        {
+            SlowTask.TickProgress();
+            bCanceled = SlowTask.ShouldCancel();
+        }
+
+        // 취소되면 이미 맡긴 모델도 애셋으로 만들지 않음. 남은 작업은 아래에서 기다리기만 하고 Canceled 로 기록
+        bCanceled = bCanceled || SlowTask.ShouldCancel();
+        if (bCanceled)
+            break;
+
+        FPMXParsedModel Model = Futures[i].Consume();
+        FPMXImportResult& Result = Results[i];
+
+        PMX::LoadStats* Stats = ModelStats.IsEmpty() ? nullptr : ModelStats[i].Get();
+
+        Result.ReadSeconds = Model.ReadSeconds;
+        Result.ParseSeconds = Model.ParseSeconds;
+        Result.ConvertSeconds = Model.ConvertSeconds;
+
+        if (Model.MeshDesc.IsValid() == false)
+        {
+            Result.Error = Model.Error;
+            continue;
+        }
+
+        double StartTime = FPlatformTime::Seconds();
+
+        const FString AssetName = MakeUniqueAssetName(InSourceFiles[i], InOptions.DestinationPath);
+        const FString PackageName = FPaths::Combine(InOptions.DestinationPath, AssetName);
+
+        UPackage* NewPackage = CreatePackage(*PackageName);
+        if (IsValid(NewPackage) == false)
+        {
+            Result.Error = TEXT("Failed to create package");
+            continue;
+        }
+
+        UStaticMesh* NewAsset = nullptr;
+        {
+            PMX_TRACE_SCOPE(CreateScope, Stats, "CreateStaticMesh");
+            NewAsset = FPMXMeshConverter::CreateStaticMesh(NewPackage, *AssetName, RF_Public | RF_Standalone, *Model.MeshDesc);
+        }
+
+        // 변환 결과는 빌드 후 필요 없음
+        Model.MeshDesc.Reset();
+
+        if (IsValid(NewAsset) == false)
+        {
+            Result.Error = TEXT("Failed to create static mesh");
+            continue;
+        }
+
+        double EndTime = FPlatformTime::Seconds();
+        Result.CreateSeconds = static_cast<float>(EndTime - StartTime);
+        StartTime = EndTime;
+
+        bool bSaved = false;
+        {
+            PMX_TRACE_SCOPE(SaveScope, Stats, "SavePackage");
+            bSaved = SaveAssetPackage(NewPackage, NewAsset, PackageName);
+        }
+
+        if (bSaved == false)
+        {
+            Result.Error = TEXT("Failed to save package");
+            continue;
+        }
+
+        EndTime = FPlatformTime::Seconds();
+        Result.SaveSeconds = static_cast<float>(EndTime - StartTime);
+        StartTime = EndTime;
+
+        {
+            PMX_TRACE_SCOPE(TextureScope, Stats, "ImportTextures");
+            PMX_TRACE_COUNT(TextureScope, Model.Textures.Num());
+
+            ImportTextures(Model.Textures, InOptions, Result);
+        }
+
+        Result.TextureSeconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+        Result.AssetPath = NewAsset->GetPathName();
+        Result.bSucceeded = true;
+
+        CreatedAssets.Add(NewAsset);
+    }
+
+    // NOTE: 취소로 남은 작업이 프리페처를 참조하므로 끝날 때까지 기다린 뒤 해제.
+    for (int32 i = 0; i < NextLaunch; ++i)
+    {
+        if (Futures[i].IsValid())
+        {
+            Futures[i].Wait();
+        }
+    }
+
+    TexturePrefetcher.Reset();
+    TextureResolver.Reset();
+    ImportedTextures.Reset();
+
+    // 취소로 시작하지 못했거나 애셋으로 만들지 않은 파일
+    for (int32 i = 0; i < FileCount; ++i)
+    {
+        if (Results[i].bSucceeded == false && Results[i].Error.IsEmpty())
+        {
+            Results[i].Error = TEXT("Canceled");
+        }
+    }
+
+    int32 SucceededCount = 0;
+    for (const FPMXImportResult& Result : Results)
+    {
+        if (Result.bSucceeded)
+        {
+            ++SucceededCount;
+            UE_LOG(LogPMXBatchImport, Log, TEXT("%s -> %s (read %.3fs, parse %.3fs, convert %.3fs, create %.3fs, save %.3fs, textures %.3fs)"),
+                *Result.SourceFile, *Result.AssetPath, Result.ReadSeconds, Result.ParseSeconds, Result.ConvertSeconds, Result.CreateSeconds, Result.SaveSeconds, Result.TextureSeconds);
+        }
+        else
+        {
+            UE_LOG(LogPMXBatchImport, Warning, TEXT("%s : %s"), *Result.SourceFile, *Result.Error);
+        }
+    }
+
+    UE_LOG(LogPMXBatchImport, Log, TEXT("Imported %d/%d PMX models in %.2fs"), SucceededCount, FileCount, FPlatformTime::Seconds() - BatchStartTime);
+
+    if (ModelStats.IsEmpty() == false)
+    {
+        TArray<const PMX::LoadStats*> Traces;
+        for (const TUniquePtr<PMX::LoadStats>& Stats : ModelStats)
+        {
+            Traces.Add(Stats.Get());
+        }
+
+        const std::string TraceJson = PMX::LoadStats::ToChromeTrace(Traces.GetData(), Traces.Num());
+
+        if (FFileHelper::SaveStringToFile(FString(UTF8_TO_TCHAR(TraceJson.c_str())), *InOptions.TraceFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+        {
+            UE_LOG(LogPMXBatchImport, Log, TEXT("Wrote load trace to %s"), *InOptions.TraceFilePath);
+        }
+        else
+        {
+            UE_LOG(LogPMXBatchImport, Warning, TEXT("Failed to write load trace to %s"), *InOptions.TraceFilePath);
+        }
+    }
+
+    if (InOptions.bSyncBrowser && CreatedAssets.Num() > 0)
+    {
+        GEditor->SyncBrowserToObjects(CreatedAssets);
+    }
+
+    return Results;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,119 @@
+﻿// Practice Unreal by Stiner
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PMXTexturePrefetcher.h"
+#include "PMXTextureResolver.h"
+#include "PMXBatchImporter.generated.h"
+
+class UTexture2D;
+struct FPMXPrefetchedTexture;
+
+/**
+ * 파일별 임포트 결과
+ */
+USTRUCT(BlueprintType)
+struct FPMXImportResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    FString SourceFile;
+
+    // 생성된 에셋의 오브젝트 경로. 실패 시 비어 있음
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    FString AssetPath;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    bool bSucceeded = false;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    FString Error;
+
+    // 단계별 소요 시간(초). 읽기/파싱/변환은 워커 스레드, 생성/저장은 게임 스레드
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float ReadSeconds = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float ParseSeconds = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float ConvertSeconds = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float CreateSeconds = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float SaveSeconds = 0;
+
+    // 텍스처 디코딩 대기 + 에셋 생성 시간. 선행 읽기가 파싱과 잘 겹치면 대기 시간은 거의 없음
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    float TextureSeconds = 0;
+
+    // 찾지 못했거나 디코딩하지 못한 텍스처 수
+    UPROPERTY(BlueprintReadOnly, Category = "MMD Importer")
+    int32 MissingTextureCount = 0;
+};
+
+struct FPMXBatchImportOptions
+{
+    // 에셋을 만들 패키지 경로
+    FString DestinationPath = TEXT("/Game/MMD");
+
+    // 동시에 읽기/파싱/변환 중인 모델 수 상한 (메모리 제한). 0 이면 워커 수 + 1
+    int32 MaxModelsInFlight = 0;
+
+    // 모델 하나의 파일 + 파싱 데이터 메모리 상한 (바이트). 0 이면 제한 없음
+    // : 할당하기 전에 예상해서 넘으면 물리, 모프 섹션을 빼고 읽고, 그래도 넘으면 그 모델은 실패로 남깁니다.
+    int64 ModelMemoryBudget = 0;
+
+    // 참조 텍스처를 파싱 도중 미리 읽어 DestinationPath/Textures 아래에 임포트
+    bool bImportTextures = true;
+
+    // 텍스처 경로 색인을 만들 팩 루트. 비어 있으면 모델 폴더마다 색인
+    FString TextureSearchRoot;
+
+    // 내부 툰 텍스처(toon01.bmp ~ toon10.bmp)가 있는 폴더. 모델 폴더에 없을 때 사용
+    FString InternalToonDirectory;
+
+    // 동시에 읽고 디코딩하는 텍스처 파일 수 상한
+    int32 MaxConcurrentTextureReads = 4;
+
+    bool bSyncBrowser = true;
+
+    // 비어 있지 않으면 모델별 섹션 / 변환 / 저장 단계 측정을 Chrome trace JSON 으로 저장 (chrome://tracing, ui.perfetto.dev)
+    FString TraceFilePath;
+};
+
+/**
+ * 여러 PMX 파일 일괄 임포트
+ * : 파일 읽기, 파싱, FMeshDescription 변환은 워커 스레드에서 동시에 처리하고
+ *   UObject 생성과 패키지 저장만 게임 스레드에서 파일 순서대로 처리합니다.
+ *   게임 스레드가 앞 모델을 만드는 동안 워커는 뒤 모델을 미리 처리합니다.
+ *   참조 텍스처는 파싱 도중 FPMXTexturePrefetcher 로 미리 읽어 둡니다.
+ */
+class FPMXBatchImporter
+{
+public:
+    // 디렉터리 안의 .pmx 파일 목록 (이름 순)
+    static void FindSourceFiles(const FString& InDirectory, const bool bInRecursive, TArray<FString>& OutFiles);
+
+    // 게임 스레드에서 호출
+    TArray<FPMXImportResult> Import(const TArray<FString>& InSourceFiles, const FPMXBatchImportOptions& InOptions = FPMXBatchImportOptions());
+
+protected:
+    FString MakeUniqueAssetName(const FString& InSourceFile, const FString& InDestinationPath);
+
+    // 모델이 참조하는 텍스처 에셋 생성. 일괄 임포트 안에서 같은 파일은 한 번만 만듦
+    void ImportTextures(const TArray<FPMXPrefetchedTexture>& InTextures, const FPMXBatchImportOptions& InOptions, FPMXImportResult& InOutResult);
+
+protected:
+    TSet<FString> UsedPackageNames;
+
+    TUniquePtr<FPMXTexturePrefetcher> TexturePrefetcher;
+    TUniquePtr<FPMXTextureResolver> TextureResolver;
+
+    // 정규화한 원본 경로 -> 만든 텍스처 (실패하면 nullptr)
+    TMap<FString, UTexture2D*> ImportedTextures;
+};
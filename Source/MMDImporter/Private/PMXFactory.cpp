@@ -1,6 +1,10 @@
 ﻿// Practice Unreal by Stiner
 #include "PMXFactory.h"
+#include "PMXMeshConverter.h"
 #include "MMDImporter/Common/PMXMeshData.h"
+#include "Async/Async.h"
+#include "MeshDescription.h"
+#include "Engine/StaticMesh.h"
 #include "Engine/SkeletalMesh.h"
 #include "Rendering/SkeletalMeshLODModel.h"
 #include "Rendering/SkeletalMeshRenderData.h"
@@ -8,6 +12,28 @@
 #include "UObject/SavePackage.h"
 #include "Serialization/ArchiveCookData.h"
 
+#define LOCTEXT_NAMESPACE "PMXFactory"
+
+static FText GetLoadSectionText(const PMX::LoadProgress::SectionType InSection)
+{
+    switch (InSection)
+    {
+        case PMX::LoadProgress::SectionType::Header:        return LOCTEXT("ReadingHeader", "Reading header...");
+        case PMX::LoadProgress::SectionType::ModelInfo:     return LOCTEXT("ReadingModelInfo", "Reading model info...");
+        case PMX::LoadProgress::SectionType::Vertices:      return LOCTEXT("ReadingVertices", "Reading vertices...");
+        case PMX::LoadProgress::SectionType::Surfaces:      return LOCTEXT("ReadingSurfaces", "Reading surfaces...");
+        case PMX::LoadProgress::SectionType::Textures:      return LOCTEXT("ReadingTextures", "Reading textures...");
+        case PMX::LoadProgress::SectionType::Materials:     return LOCTEXT("ReadingMaterials", "Reading materials...");
+        case PMX::LoadProgress::SectionType::Bones:         return LOCTEXT("ReadingBones", "Reading bones...");
+        case PMX::LoadProgress::SectionType::Morphs:        return LOCTEXT("ReadingMorphs", "Reading morphs...");
+        case PMX::LoadProgress::SectionType::DisplayFrames: return LOCTEXT("ReadingDisplayFrames", "Reading display frames...");
+        case PMX::LoadProgress::SectionType::Rigidbodies:   return LOCTEXT("ReadingRigidbodies", "Reading rigidbodies...");
+        case PMX::LoadProgress::SectionType::Joints:        return LOCTEXT("ReadingJoints", "Reading joints...");
+        case PMX::LoadProgress::SectionType::SoftBodies:    return LOCTEXT("ReadingSoftBodies", "Reading soft bodies...");
+        default:                                            return LOCTEXT("Reading", "Reading...");
+    }
+}
+
 USkeletalMesh* CreateSkeletalMesh(UObject* Outer, USkeleton* Skeleon)
 {
     USkeletalMesh* NewSkeletalMesh = NewObject<USkeletalMesh>(Outer);
@@ -92,6 +118,8 @@ UPMXFactory::UPMXFactory(const FObjectInitializer& ObjectInitializer)
     Formats.Empty();
     Formats.Add(TEXT("pmx;PMX meshes and animations"));
     
+    SupportedClass = UStaticMesh::StaticClass();
+
     bCreateNew = false;
     bText = false;
     bEditorImport = true;
@@ -109,15 +137,81 @@ UObject* UPMXFactory::FactoryCreateBinary(
     FFeedbackContext* Warn,
     bool& bOutOperationCanceled)
 {
-    
+    bOutOperationCanceled = false;
 
+    if (Buffer == nullptr || BufferEnd <= Buffer)
+        return nullptr;
 
-    
+    const PMX::Byte* const SourceBuffer = reinterpret_cast<const PMX::Byte*>(Buffer);
+    const PMX::MemSize SourceSize = static_cast<PMX::MemSize>(BufferEnd - Buffer);
+
+    PMX::LoadProgress LoadProgress;
+    FPMXConvertProgress ConvertProgress;
+    std::atomic<bool> bConverting(false);
+
+    FMeshDescription MeshDesc;
+    FString Error;
+
+    // NOTE: 파싱과 변환은 워커에서, 게임 스레드는 진행 표시와 취소 확인만 함.
+    //       람다가 지역 변수를 참조하므로 작업이 끝날 때까지 반드시 기다려야 함.
+    TFuture<bool> Task = Async(EAsyncExecution::ThreadPool, [&]()
+    {
+        PMX::PMXMeshData MeshData;
+        if (MeshData.LoadBinary(SourceBuffer, SourceSize, &LoadProgress) == false)
+        {
+            Error = LoadProgress.bCancelRequested ? TEXT("Canceled") : TEXT("Invalid or truncated PMX data");
+            return false;
+        }
 
-    return nullptr;
+        bConverting = true;
+
+        return FPMXMeshConverter::BuildMeshDescription(MeshData, MeshDesc, &Error, &ConvertProgress);
+    });
+
+    Warn->BeginSlowTask(FText::Format(LOCTEXT("ImportingModel", "Importing {0}"), FText::FromName(InName)), true, true);
+
+    while (Task.WaitFor(FTimespan::FromMilliseconds(50)) == false)
+    {
+        if (bConverting)
+        {
+            Warn->StatusUpdate(ConvertProgress.SectionsDone, ConvertProgress.SectionCount, LOCTEXT("ConvertingSections", "Converting sections..."));
+        }
+        else
+        {
+            Warn->StatusUpdate(LoadProgress.ItemsRead, LoadProgress.ItemCount, GetLoadSectionText(LoadProgress.Section));
+        }
+
+        if (Warn->ReceivedUserCancel())
+        {
+            LoadProgress.bCancelRequested = true;
+            ConvertProgress.bCancelRequested = true;
+        }
+    }
+
+    Warn->EndSlowTask();
+
+    if (Task.Get() == false)
+    {
+        if (LoadProgress.bCancelRequested || ConvertProgress.bCancelRequested)
+        {
+            bOutOperationCanceled = true;
+        }
+        else
+        {
+            Warn->Logf(ELogVerbosity::Error, TEXT("Failed to import %s : %s"), *InName.ToString(), *Error);
+        }
+
+        return nullptr;
+    }
+
+    Buffer = BufferEnd;
+
+    return FPMXMeshConverter::CreateStaticMesh(InParent, InName, Flags, MeshDesc);
 }
 
 UClass* UPMXFactory::ResolveSupportedClass()
 {
-    return UPMXFactory::StaticClass();
+    return UStaticMesh::StaticClass();
 }
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,184 @@
+﻿// Practice Unreal by Stiner
+#include "PMXMeshConverter.h"
+#include "MMDImporter/Common/PMXMeshData.h"
+#include "MMDImporter/Common/PMXMeshSection.h"
+#include "MMDImporter/Common/PMXTrace.h"
+#include "StaticMeshAttributes.h"
+#include "Engine/StaticMesh.h"
+
+static const TCHAR* GetSectionErrorText(const PMX::MeshSectionBuilder::ErrorType InError)
+{
+    switch (InError)
+    {
+        case PMX::MeshSectionBuilder::ErrorType::NoGeometry:                        return TEXT("No geometry");
+        case PMX::MeshSectionBuilder::ErrorType::SurfaceCountNotMultipleOfThree:    return TEXT("Material surface count is not a multiple of three");
+        case PMX::MeshSectionBuilder::ErrorType::SurfaceCountMismatch:              return TEXT("Material surface counts do not match the index count");
+        case PMX::MeshSectionBuilder::ErrorType::VertexIndexOutOfRange:             return TEXT("Vertex index out of range");
+        default:                                                                    return TEXT("Unknown error");
+    }
+}
+
+FString FPMXMeshConverter::ToString(const PMX::Text& InText)
+{
+    if (InText.GetLength() <= 0)
+        return FString();
+
+    // NOTE: UTF-16LE 는 wchar_t 로 저장되어 있지만 실제로는 2바이트 단위. wchar_t 가 4바이트인 플랫폼에서도 맞게 읽음.
+    if (InText.GetEncodingType() == PMX::Text::EncodingType::UTF16LE)
+    {
+        const auto Converted = StringCast<TCHAR>(reinterpret_cast<const UTF16CHAR*>(InText.GetUTF16LE()), InText.GetLength());
+        return FString(Converted.Length(), Converted.Get());
+    }
+
+    return FString(UTF8_TO_TCHAR(InText.GetUTF8()));
+}
+
+bool FPMXMeshConverter::BuildMeshDescription(const PMX::PMXMeshData& InMeshData, FMeshDescription& OutMeshDesc, FString* OutError, FPMXConvertProgress* InOutProgress, PMX::LoadStats* InOutStats)
+{
+    PMX_TRACE_SCOPE(ConvertScope, InOutStats, "BuildMeshDescription");
+    PMX_TRACE_COUNT(ConvertScope, InMeshData.GetSurfaceCount());
+
+    PMX::MeshSectionBuilder SectionBuilder;
+    {
+        PMX_TRACE_SCOPE(SectionScope, InOutStats, "BuildSections");
+
+        if (SectionBuilder.Build(InMeshData) == false)
+        {
+            if (OutError != nullptr)
+                *OutError = GetSectionErrorText(SectionBuilder.GetError());
+
+            return false;
+        }
+
+        PMX_TRACE_COUNT(SectionScope, SectionBuilder.GetSectionCount());
+    }
+
+    FStaticMeshAttributes MeshAttributes(OutMeshDesc);
+    MeshAttributes.Register();
+
+    const int32 VertexCount = InMeshData.GetVertexCount();
+    const PMX::VertexData* Vertices = InMeshData.GetVertices();
+
+    // NOTE: 위치는 원본 정점 하나당 하나. 섹션 경계에서도 위치를 공유해야 빌드 시 법선이 갈라지지 않음.
+    {
+        PMX_TRACE_SCOPE(VertexScope, InOutStats, "CreateVertices");
+        PMX_TRACE_COUNT(VertexScope, VertexCount);
+
+        OutMeshDesc.ReserveNewVertices(VertexCount);
+
+        TVertexAttributesRef<FVector3f> Positions = MeshAttributes.GetVertexPositions();
+        for (int32 v = 0; v < VertexCount; ++v)
+        {
+            const FVertexID VertexID = OutMeshDesc.CreateVertex();
+            Positions[VertexID] = ConvertPosition(Vertices[v].Position.X, Vertices[v].Position.Y, Vertices[v].Position.Z);
+        }
+    }
+
+    const int32 SectionCount = SectionBuilder.GetSectionCount();
+    const PMX::MeshSectionBuilder::Section* Sections = SectionBuilder.GetSections();
+    const int* VertexIndices = SectionBuilder.GetVertexIndices();
+    const int* Indices = SectionBuilder.GetIndices();
+
+    OutMeshDesc.ReserveNewVertexInstances(SectionBuilder.GetVertexIndexCount());
+    OutMeshDesc.ReserveNewTriangles(SectionBuilder.GetIndexCount() / 3);
+    OutMeshDesc.ReserveNewPolygonGroups(InMeshData.GetMaterialCount());
+
+    TVertexInstanceAttributesRef<FVector3f> Normals = MeshAttributes.GetVertexInstanceNormals();
+    TVertexInstanceAttributesRef<FVector2f> UVs = MeshAttributes.GetVertexInstanceUVs();
+    TPolygonGroupAttributesRef<FName> MaterialSlotNames = MeshAttributes.GetPolygonGroupMaterialSlotNames();
+
+    // 재질 순서대로 폴리곤 그룹을 만들어 재질 번호와 그룹 번호를 맞춤 (빈 재질도 그룹은 만듦)
+    for (int32 m = 0; m < InMeshData.GetMaterialCount(); ++m)
+    {
+        const FPolygonGroupID GroupID = OutMeshDesc.CreatePolygonGroup();
+        MaterialSlotNames[GroupID] = FName(*FString::Printf(TEXT("Material_%d"), m));
+    }
+
+    TArray<FVertexInstanceID> SectionInstances;
+
+    PMX_TRACE_SCOPE(PolygonScope, InOutStats, "CreatePolygons");
+    PMX_TRACE_COUNT(PolygonScope, SectionBuilder.GetIndexCount() / 3);
+
+    if (InOutProgress != nullptr)
+    {
+        InOutProgress->SectionsDone = 0;
+        InOutProgress->SectionCount = SectionCount;
+    }
+
+    for (int32 s = 0; s < SectionCount; ++s)
+    {
+        if (InOutProgress != nullptr)
+        {
+            if (InOutProgress->bCancelRequested)
+            {
+                if (OutError != nullptr)
+                    *OutError = TEXT("Canceled");
+
+                return false;
+            }
+
+            InOutProgress->SectionsDone = s;
+        }
+
+        const PMX::MeshSectionBuilder::Section& Section = Sections[s];
+
+        SectionInstances.Reset(Section.VertexCount);
+
+        for (int32 i = 0; i < Section.VertexCount; ++i)
+        {
+            const int32 SourceVertex = VertexIndices[Section.VertexBegin + i];
+            const PMX::VertexData& Vertex = Vertices[SourceVertex];
+
+            const FVertexInstanceID InstanceID = OutMeshDesc.CreateVertexInstance(FVertexID(SourceVertex));
+            Normals[InstanceID] = ConvertDirection(Vertex.Normal.X, Vertex.Normal.Y, Vertex.Normal.Z).GetSafeNormal();
+            UVs[InstanceID] = FVector2f(Vertex.UV.X, Vertex.UV.Y);
+
+            SectionInstances.Add(InstanceID);
+        }
+
+        const FPolygonGroupID GroupID(Section.MaterialIndex);
+        const int* SectionIndices = Indices + Section.IndexBegin;
+
+        for (int32 t = 0; t < Section.TriangleCount; ++t)
+        {
+            const int* Triangle = SectionIndices + t * 3;
+
+            // 퇴화 삼각형은 엣지를 만들 수 없으므로 건너뜀
+            if (Triangle[0] == Triangle[1] || Triangle[1] == Triangle[2] || Triangle[2] == Triangle[0])
+                continue;
+
+            const FVertexInstanceID Corners[3] =
+            {
+                SectionInstances[Triangle[0]],
+                SectionInstances[Triangle[1]],
+                SectionInstances[Triangle[2]],
+            };
+
+            OutMeshDesc.CreateTriangle(GroupID, Corners);
+        }
+    }
+
+    return true;
+}
+
+UStaticMesh* FPMXMeshConverter::CreateStaticMesh(UObject* InOuter, const FName InName, const EObjectFlags InFlags, FMeshDescription& InMeshDesc)
+{
+    UStaticMesh* StaticMesh = NewObject<UStaticMesh>(InOuter, InName, InFlags);
+
+    FStaticMeshConstAttributes MeshAttributes(InMeshDesc);
+    TPolygonGroupAttributesConstRef<FName> MaterialSlotNames = MeshAttributes.GetPolygonGroupMaterialSlotNames();
+
+    for (const FPolygonGroupID GroupID : InMeshDesc.PolygonGroups().GetElementIDs())
+    {
+        StaticMesh->GetStaticMaterials().Add(FStaticMaterial(nullptr, MaterialSlotNames[GroupID], MaterialSlotNames[GroupID]));
+    }
+
+    UStaticMesh::FBuildMeshDescriptionsParams BuildMeshDescParams;
+    BuildMeshDescParams.bBuildSimpleCollision = true;
+
+    StaticMesh->NaniteSettings.bEnabled = true;
+
+    StaticMesh->BuildFromMeshDescriptions({ &InMeshDesc }, BuildMeshDescParams);
+
+    return StaticMesh;
+}
@@ -0,0 +1,52 @@
+﻿// Practice Unreal by Stiner
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+struct FMeshDescription;
+class UStaticMesh;
+
+namespace PMX
+{
+    class PMXMeshData;
+    class Text;
+    class LoadStats;
+}
+
+// 변환 진행 상황과 취소 요청. 다른 스레드에서 읽고 쓸 수 있음
+struct FPMXConvertProgress
+{
+    std::atomic<int32> SectionsDone { 0 };
+    std::atomic<int32> SectionCount { 0 };
+
+    std::atomic<bool> bCancelRequested { false };
+};
+
+/**
+ * PMX 데이터를 엔진 메시 데이터로 변환
+ * : BuildMeshDescription 은 UObject 를 만들지 않으므로 워커 스레드에서 호출할 수 있습니다.
+ */
+class FPMXMeshConverter
+{
+public:
+    // MMD 1 단위는 약 8cm
+    static constexpr float MMDToUnrealScale = 8.0f;
+
+    // MMD(Y-up, -Z 정면) -> 언리얼(Z-up, +Y 정면). 회전만 하므로 감김 순서는 그대로
+    static FVector3f ConvertPosition(float X, float Y, float Z) { return FVector3f(X, -Z, Y) * MMDToUnrealScale; }
+    static FVector3f ConvertDirection(float X, float Y, float Z) { return FVector3f(X, -Z, Y); }
+
+    // 헤더의 인코딩(UTF-16LE/UTF-8)에 맞춰 변환
+    static FString ToString(const PMX::Text& InText);
+
+    // 재질별 폴리곤 그룹으로 FMeshDescription 생성. 실패 시 OutError 에 이유를 기록
+    // : InOutProgress 가 있으면 섹션 사이에서 진행을 보고하고 취소 요청을 확인합니다.
+    //   InOutStats 가 있으면 변환 단계별 시간과 항목 수를 기록합니다.
+    static bool BuildMeshDescription(const PMX::PMXMeshData& InMeshData, FMeshDescription& OutMeshDesc, FString* OutError = nullptr, FPMXConvertProgress* InOutProgress = nullptr, PMX::LoadStats* InOutStats = nullptr);
+
+    // 폴리곤 그룹마다 재질 슬롯을 만들고 빌드. 게임 스레드에서 호출
+    static UStaticMesh* CreateStaticMesh(UObject* InOuter, const FName InName, const EObjectFlags InFlags, FMeshDescription& InMeshDesc);
+};
@@ -0,0 +1,120 @@
+﻿// Practice Unreal by Stiner
+#include "PMXTexturePrefetcher.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "ImageCore.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+static FPMXTexturePrefetcher::FImageFuture MakeReadyFuture(TSharedPtr<FImage> InImage)
+{
+    TPromise<TSharedPtr<FImage>> Promise;
+    Promise.SetValue(MoveTemp(InImage));
+    return Promise.GetFuture().Share();
+}
+
+FPMXTexturePrefetcher::FPMXTexturePrefetcher(const int32 InMaxConcurrentReads)
+    : MaxConcurrentReads(FMath::Max(InMaxConcurrentReads, 1))
+{
+    // NOTE: 모듈 로드는 게임 스레드에서만 가능하므로 미리 로드해 둠.
+    ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+}
+
+FPMXTexturePrefetcher::~FPMXTexturePrefetcher()
+{
+    // 읽기 작업이 this 를 참조하므로 모두 끝날 때까지 기다림
+    for (;;)
+    {
+        {
+            FScopeLock ScopeLock(&Lock);
+            if (ActiveReads == 0)
+                break;
+        }
+
+        FPlatformProcess::Sleep(0.001f);
+    }
+}
+
+FString FPMXTexturePrefetcher::MakeKey(const FString& InFilePath)
+{
+    FString Key = FPaths::ConvertRelativePathToFull(InFilePath);
+    FPaths::NormalizeFilename(Key);
+
+    return Key.ToLower();
+}
+
+FPMXTexturePrefetcher::FImageFuture FPMXTexturePrefetcher::Request(const FString& InFilePath)
+{
+    const FString Key = MakeKey(InFilePath);
+
+    FScopeLock ScopeLock(&Lock);
+
+    if (const FEntry* Entry = Entries.Find(Key))
+        return Entry->Future;
+
+    FPendingRead Read;
+    Read.FilePath = InFilePath;
+    Read.Promise = MakeShared<TPromise<TSharedPtr<FImage>>>();
+
+    FEntry& NewEntry = Entries.Add(Key);
+    NewEntry.Future = Read.Promise->GetFuture().Share();
+
+    if (ActiveReads < MaxConcurrentReads)
+    {
+        ++ActiveReads;
+        StartRead(MoveTemp(Read));
+    }
+    else
+    {
+        PendingReads.Enqueue(MoveTemp(Read));
+    }
+
+    return NewEntry.Future;
+}
+
+void FPMXTexturePrefetcher::Release(const FString& InFilePath)
+{
+    const FString Key = MakeKey(InFilePath);
+
+    FScopeLock ScopeLock(&Lock);
+
+    FEntry& Entry = Entries.FindOrAdd(Key);
+    if (Entry.bReleased)
+        return;
+
+    // NOTE: 아직 읽는 중이면 결과를 기다리는 쪽이 있으므로 공유 상태는 그대로 두고 참조만 끊음.
+    Entry.Future = MakeReadyFuture(nullptr);
+    Entry.bReleased = true;
+}
+
+void FPMXTexturePrefetcher::StartRead(FPendingRead&& InRead)
+{
+    Async(EAsyncExecution::ThreadPool, [this, Read = MoveTemp(InRead)]() mutable
+    {
+        for (;;)
+        {
+            TSharedPtr<FImage> Image;
+
+            TArray<uint8> FileData;
+            if (FFileHelper::LoadFileToArray(FileData, *Read.FilePath, FILEREAD_Silent))
+            {
+                Image = MakeShared<FImage>();
+                if (ImageWrapperModule->DecompressImage(FileData.GetData(), FileData.Num(), *Image) == false)
+                {
+                    Image.Reset();
+                }
+            }
+
+            Read.Promise->SetValue(MoveTemp(Image));
+
+            // 대기 중인 다음 파일을 같은 작업에서 이어서 처리해 동시 읽기 수를 유지
+            FScopeLock ScopeLock(&Lock);
+
+            if (PendingReads.Dequeue(Read) == false)
+            {
+                --ActiveReads;
+                return;
+            }
+        }
+    });
+}
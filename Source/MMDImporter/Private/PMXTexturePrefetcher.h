@@ -0,0 +1,63 @@
+﻿// Practice Unreal by Stiner
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+
+struct FImage;
+class IImageWrapperModule;
+
+/**
+ * 텍스처 파일 선행 읽기/디코딩
+ * : 파싱 도중 (ReadTextures 직후) 요청해 나머지 파싱, 변환과 텍스처 I/O 를 겹치게 합니다.
+ *   같은 파일은 일괄 임포트 전체에서 한 번만 읽고, 동시에 읽는 파일 수를 제한합니다.
+ *   게임 스레드에서 만들고, Request 는 어느 스레드에서나 호출할 수 있습니다.
+ */
+class FPMXTexturePrefetcher
+{
+public:
+    typedef TSharedFuture<TSharedPtr<FImage>> FImageFuture;
+
+public:
+    explicit FPMXTexturePrefetcher(const int32 InMaxConcurrentReads = 4);
+
+    // 진행 중인 읽기가 끝날 때까지 기다림
+    ~FPMXTexturePrefetcher();
+
+    // 파일을 읽고 디코딩한 이미지. 실패하면 nullptr
+    FImageFuture Request(const FString& InFilePath);
+
+    // 에셋을 만든 뒤 호출. 디코딩된 이미지를 해제하며 이후 같은 파일 요청은 nullptr 을 바로 돌려줌
+    void Release(const FString& InFilePath);
+
+    // 같은 파일을 가리키는 경로를 같은 키로 (절대 경로, 대소문자 무시)
+    static FString MakeKey(const FString& InFilePath);
+
+protected:
+    struct FPendingRead
+    {
+        FString FilePath;
+        TSharedPtr<TPromise<TSharedPtr<FImage>>> Promise;
+    };
+
+    struct FEntry
+    {
+        FImageFuture Future;
+        bool bReleased = false;
+    };
+
+    void StartRead(FPendingRead&& InRead);
+
+protected:
+    IImageWrapperModule* ImageWrapperModule = nullptr;
+
+    const int32 MaxConcurrentReads;
+
+    FCriticalSection Lock;
+
+    TMap<FString, FEntry> Entries;
+    TQueue<FPendingRead> PendingReads;
+    int32 ActiveReads = 0;
+};
@@ -0,0 +1,161 @@
+﻿// Practice Unreal by Stiner
+#include "PMXTextureResolver.h"
+#include "PMXMeshConverter.h"
+#include "MMDImporter/Common/PMXMeshData.h"
+#include "HAL/FileManager.h"
+
+FString FPMXTextureResolver::MakeKey(const FString& InPath)
+{
+    FString Key = InPath.Replace(TEXT("\\"), TEXT("/"));
+    Key = FPaths::ConvertRelativePathToFull(Key);
+    FPaths::CollapseRelativeDirectories(Key);
+    FPaths::RemoveDuplicateSlashes(Key);
+
+    return Key.ToLower();
+}
+
+void FPMXTextureResolver::IndexDirectory(const FString& InDirectory)
+{
+    FString RootKey = MakeKey(InDirectory);
+    if (RootKey.EndsWith(TEXT("/")) == false)
+    {
+        RootKey += TEXT('/');
+    }
+
+    {
+        FReadScopeLock ReadLock(Lock);
+
+        for (const FString& IndexedRoot : IndexedRoots)
+        {
+            if (RootKey.StartsWith(IndexedRoot, ESearchCase::CaseSensitive))
+                return;
+        }
+    }
+
+    // NOTE: 디렉터리 순회는 잠금 밖에서. 다른 스레드가 같은 디렉터리를 동시에 색인해도 결과는 같음.
+    TArray<TPair<FString, FString>> FoundFiles;
+
+    IFileManager::Get().IterateDirectoryRecursively(*InDirectory, [&FoundFiles](const TCHAR* InPath, const bool bInIsDirectory)
+    {
+        if (bInIsDirectory == false)
+        {
+            FoundFiles.Emplace(MakeKey(InPath), FString(InPath));
+        }
+
+        return true;
+    });
+
+    FWriteScopeLock WriteLock(Lock);
+
+    // 하위 디렉터리를 먼저 색인했으면 루트 목록에서 뺌
+    IndexedRoots.RemoveAll([&RootKey](const FString& IndexedRoot)
+    {
+        return IndexedRoot.StartsWith(RootKey, ESearchCase::CaseSensitive);
+    });
+
+    IndexedRoots.Add(RootKey);
+
+    for (TPair<FString, FString>& Found : FoundFiles)
+    {
+        if (Files.Contains(Found.Key))
+            continue;
+
+        FilesByName.Add(FPaths::GetCleanFilename(Found.Key), Found.Key);
+        Files.Add(MoveTemp(Found.Key), MoveTemp(Found.Value));
+    }
+}
+
+void FPMXTextureResolver::SetInternalToonDirectory(const FString& InDirectory)
+{
+    if (InDirectory.IsEmpty() == false)
+    {
+        IndexDirectory(InDirectory);
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    InternalToonDirectory = InDirectory;
+}
+
+FString FPMXTextureResolver::FindByKey(const FString& InKey, const FString& InModelDirectoryKey) const
+{
+    if (const FString* Found = Files.Find(InKey))
+        return *Found;
+
+    // 같은 이름의 파일 중 모델 폴더 아래에 있고 가장 얕은 것
+    // : 팩 전체를 색인해도 다른 모델의 같은 이름 텍스처(face.png 등)를 쓰지 않도록 모델 폴더 밖은 찾지 않음
+    FString DirectoryPrefix = InModelDirectoryKey;
+    if (DirectoryPrefix.EndsWith(TEXT("/")) == false)
+    {
+        DirectoryPrefix += TEXT('/');
+    }
+
+    TArray<const FString*, TInlineAllocator<4>> Candidates;
+    FilesByName.MultiFindPointer(FPaths::GetCleanFilename(InKey), Candidates);
+
+    const FString* BestKey = nullptr;
+    int32 BestDepth = MAX_int32;
+
+    for (const FString* Candidate : Candidates)
+    {
+        if (Candidate->StartsWith(DirectoryPrefix, ESearchCase::CaseSensitive) == false)
+            continue;
+
+        // 모델 폴더 아래의 경로 단계 수
+        int32 Depth = 0;
+        for (int32 i = DirectoryPrefix.Len(); i < Candidate->Len(); ++i)
+        {
+            Depth += (*Candidate)[i] == TEXT('/') ? 1 : 0;
+        }
+
+        if (Depth < BestDepth)
+        {
+            BestKey = Candidate;
+            BestDepth = Depth;
+        }
+    }
+
+    return BestKey != nullptr ? Files.FindChecked(*BestKey) : FString();
+}
+
+FString FPMXTextureResolver::Resolve(const FString& InModelDirectory, const FString& InRelativePath) const
+{
+    if (InRelativePath.IsEmpty())
+        return FString();
+
+    const FString ModelDirectoryKey = MakeKey(InModelDirectory);
+    const FString Key = MakeKey(FPaths::Combine(InModelDirectory, InRelativePath));
+
+    FReadScopeLock ReadLock(Lock);
+    return FindByKey(Key, ModelDirectoryKey);
+}
+
+FString FPMXTextureResolver::ResolveToon(const FString& InModelDirectory, const PMX::PMXMeshData& InMeshData, const PMX::MaterialData& InMaterial) const
+{
+    if (InMaterial.ToonReference == PMX::MaterialData::ToonReferenceType::Texture)
+    {
+        if (InMaterial.ToonValue < 0 || InMaterial.ToonValue >= InMeshData.GetTextureCount())
+            return FString();
+
+        return Resolve(InModelDirectory, FPMXMeshConverter::ToString(InMeshData.GetTextures()[InMaterial.ToonValue].Path));
+    }
+
+    if (InMaterial.ToonReference != PMX::MaterialData::ToonReferenceType::Internal || InMaterial.ToonValue < 0 || InMaterial.ToonValue >= InternalToonCount)
+        return FString();
+
+    const FString ToonName = FString::Printf(TEXT("toon%02d.bmp"), InMaterial.ToonValue + 1);
+    const FString ModelDirectoryKey = MakeKey(InModelDirectory);
+
+    FReadScopeLock ReadLock(Lock);
+
+    // NOTE: 모델이 같은 이름의 툰을 직접 포함하는 경우가 많으므로 모델 폴더를 먼저 봄. 이름 검색으로 넘어가지 않도록 정확한 경로만 확인.
+    if (const FString* Found = Files.Find(ModelDirectoryKey / ToonName))
+        return *Found;
+
+    if (InternalToonDirectory.IsEmpty() == false)
+    {
+        if (const FString* Found = Files.Find(MakeKey(InternalToonDirectory) / ToonName))
+            return *Found;
+    }
+
+    return FString();
+}
@@ -0,0 +1,59 @@
+﻿// Practice Unreal by Stiner
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace PMX
+{
+    class PMXMeshData;
+    struct MaterialData;
+}
+
+/**
+ * 텍스처 경로 색인
+ * : PMX 텍스처 경로는 역슬래시를 쓰는 윈도우식 상대 경로이고 대소문자가 제각각이라
+ *   대소문자를 구분하는 파일 시스템에서는 그대로 찾을 수 없습니다.
+ *   디렉터리 트리를 한 번만 훑어 정규화하고 소문자로 바꾼 경로로 색인한 뒤, 이후 조회는 해시 맵으로만 처리합니다.
+ *   같은 팩의 모델끼리 공유하도록 만들었으며 모든 함수는 스레드 안전합니다.
+ */
+class FPMXTextureResolver
+{
+public:
+    // 내부 툰 텍스처 수 (toon01.bmp ~ toon10.bmp)
+    static constexpr int32 InternalToonCount = 10;
+
+public:
+    // 디렉터리 트리 색인. 이미 색인한 디렉터리 아래면 아무 것도 하지 않음
+    void IndexDirectory(const FString& InDirectory);
+
+    // 내부 툰 텍스처가 있는 디렉터리 (예: MMD 의 Data 폴더). 모델 폴더에 없을 때 사용
+    void SetInternalToonDirectory(const FString& InDirectory);
+
+    // 모델 폴더 기준 상대 경로 -> 실제 파일 경로. 없으면 빈 문자열
+    // : 경로대로 없으면 모델 폴더 아래에서 같은 이름의 파일 중 가장 얕은 파일을 사용합니다. 모델 폴더 밖은 찾지 않습니다.
+    FString Resolve(const FString& InModelDirectory, const FString& InRelativePath) const;
+
+    // 재질의 툰 텍스처 경로. Internal 이면 toon01.bmp ~ toon10.bmp 를 모델 폴더, 내부 툰 디렉터리 순으로 찾음
+    FString ResolveToon(const FString& InModelDirectory, const PMX::PMXMeshData& InMeshData, const PMX::MaterialData& InMaterial) const;
+
+    // 절대 경로, '/' 구분자, 소문자
+    static FString MakeKey(const FString& InPath);
+
+protected:
+    FString FindByKey(const FString& InKey, const FString& InModelDirectoryKey) const;
+
+protected:
+    mutable FRWLock Lock;
+
+    // 색인한 디렉터리 (키, 끝에 '/')
+    TArray<FString> IndexedRoots;
+
+    // 경로 키 -> 실제 경로
+    TMap<FString, FString> Files;
+
+    // 파일 이름 키 -> 경로 키
+    TMultiMap<FString, FString> FilesByName;
+
+    FString InternalToonDirectory;
+};
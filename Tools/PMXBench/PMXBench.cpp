@@ -0,0 +1,743 @@
+﻿// Practice Unreal by Stiner
+//
+// PMX 로더 벤치마크
+// : 전체 로드와 섹션별 Read* 시간을 재고 MB/s, 항목/s, 할당 횟수, (리눅스) 하드웨어 카운터를 출력합니다.
+//   --save 로 결과를 기준값으로 저장하고 --baseline 으로 비교하면 변화가 표로 나옵니다.
+//
+//   PMXBench [옵션] <파일 또는 디렉터리>...
+//     --iterations N        파일마다 반복 횟수 (기본 5, 중앙값 사용)
+//     --perf                perf_event 카운터 (cycles, instructions, cache-misses)
+//     --save FILE           결과를 기준값 파일로 저장
+//     --baseline FILE       기준값과 비교
+//     --threshold PERCENT   이보다 느려지면 회귀로 표시 (기본 5)
+//     --min-delta MS        차이가 이보다 작으면 비율과 무관하게 무시 (기본 0.05, 짧은 섹션의 잡음 제거)
+//     --fail-on-regression  회귀가 있으면 종료 코드 1
+//     --trace FILE          파일마다 한 번 더 읽으며 섹션별 측정을 Chrome trace JSON 으로 저장
+//     --memory              섹션별 예상 / 실제 메모리와 실제로 할당한 바이트 비교
+//     --budget MB           --memory 에서 메모리 상한을 두고 읽어 빠진 섹션이나 거부 여부를 출력
+
+#include "PMXMeshData.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 할당 횟수. 로드는 한 스레드에서만 하므로 전역 카운터로 충분
+static std::atomic<unsigned long long> AllocationCount(0);
+static std::atomic<unsigned long long> AllocationBytes(0);
+
+static void* CountedAlloc(std::size_t InSize)
+{
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    AllocationBytes.fetch_add(InSize, std::memory_order_relaxed);
+
+    void* Memory = std::malloc(InSize != 0 ? InSize : 1);
+    if (Memory == nullptr)
+        throw std::bad_alloc();
+
+    return Memory;
+}
+
+void* operator new(std::size_t InSize) { return CountedAlloc(InSize); }
+void* operator new[](std::size_t InSize) { return CountedAlloc(InSize); }
+void operator delete(void* InMemory) noexcept { std::free(InMemory); }
+void operator delete[](void* InMemory) noexcept { std::free(InMemory); }
+void operator delete(void* InMemory, std::size_t) noexcept { std::free(InMemory); }
+void operator delete[](void* InMemory, std::size_t) noexcept { std::free(InMemory); }
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using SectionType = PMX::LoadProgress::SectionType;
+
+    static constexpr int SectionCount = static_cast<int>(SectionType::Count);
+
+    // 섹션별 결과 뒤에 전체 결과를 둠
+    static constexpr int TotalIndex = SectionCount;
+
+    static const char* const SectionNames[SectionCount + 1] =
+    {
+        "Header", "ModelInfo", "Vertices", "Surfaces", "Textures", "Materials", "Bones",
+        "Morphs", "DisplayFrames", "Rigidbodies", "Joints", "SoftBodies", "Total",
+    };
+
+    enum CounterType
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+
+        CounterCount
+    };
+
+    /**
+     * perf_event 하드웨어 카운터 묶음
+     * : 권한이 없거나 리눅스가 아니면 IsValid() 가 false 이고 값은 0 입니다.
+     */
+    class PerfCounters
+    {
+    public:
+        ~PerfCounters()
+        {
+#if defined(__linux__)
+            for (int i = 0; i < CounterCount; ++i)
+            {
+                if (Descriptors[i] >= 0)
+                    close(Descriptors[i]);
+            }
+#endif
+        }
+
+        bool Open()
+        {
+#if defined(__linux__)
+            static const unsigned long long Configs[CounterCount] =
+            {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES,
+            };
+
+            for (int i = 0; i < CounterCount; ++i)
+            {
+                perf_event_attr Attr;
+                memset(&Attr, 0, sizeof(Attr));
+                Attr.type = PERF_TYPE_HARDWARE;
+                Attr.size = sizeof(Attr);
+                Attr.config = Configs[i];
+                Attr.disabled = i == 0 ? 1 : 0;
+                Attr.exclude_kernel = 1;
+                Attr.exclude_hv = 1;
+                Attr.read_format = PERF_FORMAT_GROUP;
+
+                Descriptors[i] = static_cast<int>(syscall(__NR_perf_event_open, &Attr, 0, -1, i == 0 ? -1 : Descriptors[0], 0));
+                if (Descriptors[i] < 0)
+                    return false;
+            }
+
+            ioctl(Descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(Descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+            bValid = true;
+#endif
+            return bValid;
+        }
+
+        bool IsValid() const { return bValid; }
+
+        void Read(unsigned long long OutValues[CounterCount]) const
+        {
+            for (int i = 0; i < CounterCount; ++i)
+                OutValues[i] = 0;
+
+#if defined(__linux__)
+            if (bValid == false)
+                return;
+
+            unsigned long long Buffer[1 + CounterCount] = { 0 };
+            if (read(Descriptors[0], Buffer, sizeof(Buffer)) == static_cast<ssize_t>(sizeof(Buffer)))
+            {
+                for (int i = 0; i < CounterCount; ++i)
+                    OutValues[i] = Buffer[1 + i];
+            }
+#endif
+        }
+
+    private:
+        int Descriptors[CounterCount] = { -1, -1, -1 };
+        bool bValid = false;
+    };
+
+    struct Sample
+    {
+        double Seconds = 0;
+        unsigned long long Bytes = 0;
+        unsigned long long Allocations = 0;
+        unsigned long long AllocatedBytes = 0;
+        unsigned long long Counters[CounterCount] = { 0 };
+    };
+
+    struct FileResult
+    {
+        std::string Path;
+        unsigned long long FileSize = 0;
+        bool bLoaded = false;
+
+        // 반복별 중앙값
+        Sample Sections[SectionCount + 1];
+        long long Elements[SectionCount + 1] = { 0 };
+
+        // --trace 일 때만
+        std::shared_ptr<PMX::LoadStats> Trace;
+
+        // --memory 일 때만
+        bool bMemory = false;
+        PMX::MemoryReport Memory;
+    };
+
+    struct Options
+    {
+        int Iterations = 5;
+        bool bPerf = false;
+        std::string SavePath;
+        std::string BaselinePath;
+        double Threshold = 5.0;
+        double MinDeltaMs = 0.05;
+        bool bFailOnRegression = false;
+        std::string TracePath;
+        bool bMemory = false;
+        double BudgetMB = 0;
+        std::vector<std::string> Inputs;
+    };
+
+    // 섹션별 항목 수 (항목/s 계산용)
+    void CountElements(const PMX::PMXMeshData& InMeshData, long long OutElements[SectionCount + 1])
+    {
+        // 헤더는 ModelInfo 에 포함해 잼
+        OutElements[static_cast<int>(SectionType::Header)] = 0;
+        OutElements[static_cast<int>(SectionType::ModelInfo)] = 1;
+        OutElements[static_cast<int>(SectionType::Vertices)] = InMeshData.GetVertexCount();
+        OutElements[static_cast<int>(SectionType::Surfaces)] = InMeshData.GetSurfaceCount();
+        OutElements[static_cast<int>(SectionType::Textures)] = InMeshData.GetTextureCount();
+        OutElements[static_cast<int>(SectionType::Materials)] = InMeshData.GetMaterialCount();
+        OutElements[static_cast<int>(SectionType::Bones)] = InMeshData.GetBoneCount();
+        OutElements[static_cast<int>(SectionType::Morphs)] = InMeshData.GetMorphCount();
+        OutElements[static_cast<int>(SectionType::DisplayFrames)] = InMeshData.GetDisplayFrameCount();
+        OutElements[static_cast<int>(SectionType::Rigidbodies)] = InMeshData.GetRigidbodyCount();
+        OutElements[static_cast<int>(SectionType::Joints)] = InMeshData.GetJointCount();
+        OutElements[static_cast<int>(SectionType::SoftBodies)] = InMeshData.GetSoftBodyCount();
+
+        OutElements[TotalIndex] = 0;
+        for (int s = 0; s < SectionCount; ++s)
+            OutElements[TotalIndex] += OutElements[s];
+    }
+
+    // 한 번 로드하며 섹션 경계마다 시간/바이트/할당/카운터를 기록
+    bool LoadOnce(const std::vector<char>& InBuffer, const PerfCounters& InCounters, Sample OutSections[SectionCount + 1], long long OutElements[SectionCount + 1], PMX::LoadStats* InOutStats = nullptr)
+    {
+        for (int s = 0; s <= SectionCount; ++s)
+            OutSections[s] = Sample();
+
+        struct Mark
+        {
+            Clock::time_point Time;
+            unsigned long long Bytes = 0;
+            unsigned long long Allocations = 0;
+            unsigned long long AllocatedBytes = 0;
+            unsigned long long Counters[CounterCount] = { 0 };
+        };
+
+        auto TakeMark = [&InCounters](Mark& OutMark, const unsigned long long InBytes)
+        {
+            InCounters.Read(OutMark.Counters);
+            OutMark.Allocations = AllocationCount.load(std::memory_order_relaxed);
+            OutMark.AllocatedBytes = AllocationBytes.load(std::memory_order_relaxed);
+            OutMark.Bytes = InBytes;
+            OutMark.Time = Clock::now();
+        };
+
+        auto Accumulate = [](Sample& OutSample, const Mark& InBegin, const Mark& InEnd)
+        {
+            OutSample.Seconds += std::chrono::duration<double>(InEnd.Time - InBegin.Time).count();
+            OutSample.Bytes += InEnd.Bytes - InBegin.Bytes;
+            OutSample.Allocations += InEnd.Allocations - InBegin.Allocations;
+            OutSample.AllocatedBytes += InEnd.AllocatedBytes - InBegin.AllocatedBytes;
+
+            for (int c = 0; c < CounterCount; ++c)
+                OutSample.Counters[c] += InEnd.Counters[c] - InBegin.Counters[c];
+        };
+
+        PMX::LoadProgress Progress;
+        Progress.Stats = InOutStats;
+
+        Mark Start;
+        Mark Last;
+
+        // NOTE: 헤더는 섹션 콜백이 없으므로 ModelInfo 에 포함됨.
+        Progress.OnSectionLoaded = [&](const SectionType InSection, const PMX::PMXMeshData&)
+        {
+            Mark Now;
+            TakeMark(Now, Progress.BytesRead);
+            Accumulate(OutSections[static_cast<int>(InSection)], Last, Now);
+            Last = Now;
+        };
+
+        PMX::PMXMeshData MeshData;
+
+        TakeMark(Start, 0);
+        Last = Start;
+
+        const bool bLoaded = MeshData.LoadBinary(InBuffer.data(), InBuffer.size(), &Progress);
+
+        Mark End;
+        TakeMark(End, InBuffer.size());
+        Accumulate(OutSections[TotalIndex], Start, End);
+
+        if (bLoaded)
+            CountElements(MeshData, OutElements);
+
+        return bLoaded;
+    }
+
+    template <typename T>
+    T Median(std::vector<T> InValues)
+    {
+        std::sort(InValues.begin(), InValues.end());
+        return InValues[InValues.size() / 2];
+    }
+
+    bool ReadFile(const std::string& InPath, std::vector<char>& OutBuffer)
+    {
+        std::ifstream Stream(InPath, std::ios::binary | std::ios::ate);
+        if (Stream.is_open() == false)
+            return false;
+
+        OutBuffer.resize(static_cast<std::size_t>(Stream.tellg()));
+        Stream.seekg(0);
+        Stream.read(OutBuffer.data(), static_cast<std::streamsize>(OutBuffer.size()));
+
+        return Stream.good() || Stream.eof();
+    }
+
+    FileResult RunFile(const std::string& InPath, const Options& InOptions, const PerfCounters& InCounters)
+    {
+        FileResult Result;
+        Result.Path = InPath;
+
+        std::vector<char> Buffer;
+        if (ReadFile(InPath, Buffer) == false)
+            return Result;
+
+        Result.FileSize = Buffer.size();
+
+        // 캐시 예열용 1회
+        Sample Sections[SectionCount + 1];
+        if (LoadOnce(Buffer, InCounters, Sections, Result.Elements) == false)
+            return Result;
+
+        std::vector<Sample> Runs[SectionCount + 1];
+
+        for (int i = 0; i < InOptions.Iterations; ++i)
+        {
+            LoadOnce(Buffer, InCounters, Sections, Result.Elements);
+
+            for (int s = 0; s <= SectionCount; ++s)
+                Runs[s].push_back(Sections[s]);
+        }
+
+        // 항목별 중앙값
+        for (int s = 0; s <= SectionCount; ++s)
+        {
+            std::vector<double> Seconds;
+            std::vector<unsigned long long> Values[3 + CounterCount];
+
+            for (const Sample& Run : Runs[s])
+            {
+                Seconds.push_back(Run.Seconds);
+                Values[0].push_back(Run.Bytes);
+                Values[1].push_back(Run.Allocations);
+                Values[2].push_back(Run.AllocatedBytes);
+
+                for (int c = 0; c < CounterCount; ++c)
+                    Values[3 + c].push_back(Run.Counters[c]);
+            }
+
+            Result.Sections[s].Seconds = Median(Seconds);
+            Result.Sections[s].Bytes = Median(Values[0]);
+            Result.Sections[s].Allocations = Median(Values[1]);
+            Result.Sections[s].AllocatedBytes = Median(Values[2]);
+
+            for (int c = 0; c < CounterCount; ++c)
+                Result.Sections[s].Counters[c] = Median(Values[3 + c]);
+        }
+
+        // 측정 기록이 반복 결과에 섞이지 않도록 따로 한 번 더 읽음
+        if (InOptions.TracePath.empty() == false)
+        {
+            Result.Trace = std::make_shared<PMX::LoadStats>(InPath);
+            LoadOnce(Buffer, InCounters, Sections, Result.Elements, Result.Trace.get());
+        }
+
+        // 상한이 없으면 실제값을 채우도록 빼는 섹션 없이 상한만 최대로 둠
+        if (InOptions.bMemory)
+        {
+            PMX::LoadOptions MemoryOptions;
+            MemoryOptions.MemoryBudget = InOptions.BudgetMB > 0 ? static_cast<PMX::MemSize>(InOptions.BudgetMB * 1024.0 * 1024.0) : ~static_cast<PMX::MemSize>(0);
+
+            PMX::PMXMeshData MeshData;
+            MeshData.LoadBinary(Buffer.data(), Buffer.size(), nullptr, MemoryOptions);
+
+            Result.bMemory = true;
+            Result.Memory = MeshData.GetMemoryReport();
+        }
+
+        Result.bLoaded = true;
+        return Result;
+    }
+
+    const char* GetSizeClass(const unsigned long long InFileSize)
+    {
+        if (InFileSize < (1ull << 20))
+            return "small";
+
+        if (InFileSize < (16ull << 20))
+            return "typical";
+
+        return "huge";
+    }
+
+    void PrintFile(const FileResult& InResult, const bool bInPerf)
+    {
+        printf("\n%s (%.2f MB, %s)\n", InResult.Path.c_str(), InResult.FileSize / (1024.0 * 1024.0), GetSizeClass(InResult.FileSize));
+
+        if (InResult.bLoaded == false)
+        {
+            printf("  FAILED to load\n");
+            return;
+        }
+
+        printf("  %-14s %10s %10s %14s %10s", "section", "ms", "MB/s", "elements/s", "allocs");
+        if (bInPerf)
+            printf(" %14s %14s %12s %6s", "cycles", "instructions", "cache-miss", "IPC");
+        printf("\n");
+
+        for (int s = 0; s <= SectionCount; ++s)
+        {
+            const Sample& Section = InResult.Sections[s];
+
+            // 비어 있는 섹션은 생략
+            if (s != TotalIndex && Section.Bytes == 0 && InResult.Elements[s] == 0)
+                continue;
+
+            const double Seconds = std::max(Section.Seconds, 1.e-9);
+
+            printf("  %-14s %10.3f %10.1f %14.0f %10llu", SectionNames[s], Section.Seconds * 1000.0, Section.Bytes / Seconds / (1024.0 * 1024.0), InResult.Elements[s] / Seconds, Section.Allocations);
+
+            if (bInPerf)
+            {
+                const double IPC = Section.Counters[Cycles] > 0 ? static_cast<double>(Section.Counters[Instructions]) / Section.Counters[Cycles] : 0.0;
+                printf(" %14llu %14llu %12llu %6.2f", Section.Counters[Cycles], Section.Counters[Instructions], Section.Counters[CacheMisses], IPC);
+            }
+
+            printf("\n");
+        }
+    }
+
+    // 예상, 실제, 반복 측정에서 실제로 할당한 바이트 (섹션을 빼지 않은 로드)
+    void PrintMemory(const FileResult& InResult)
+    {
+        if (InResult.bLoaded == false || InResult.bMemory == false)
+            return;
+
+        const PMX::MemoryReport& Memory = InResult.Memory;
+
+        if (Memory.bOverBudget)
+        {
+            printf("  memory: predicted %.2f MB is over budget, rejected before allocating\n", Memory.GetPredictedTotal() / (1024.0 * 1024.0));
+            return;
+        }
+
+        printf("  %-14s %14s %14s %14s\n", "section", "predicted", "actual", "allocated");
+
+        unsigned long long Predicted = 0;
+        unsigned long long Actual = 0;
+
+        for (int s = 0; s < SectionCount; ++s)
+        {
+            if (Memory.PredictedBytes[s] == 0 && InResult.Sections[s].AllocatedBytes == 0)
+                continue;
+
+            Predicted += Memory.PredictedBytes[s];
+            Actual += Memory.ActualBytes[s];
+
+            printf("  %-14s %14llu %14llu %14llu%s\n", SectionNames[s], static_cast<unsigned long long>(Memory.PredictedBytes[s]), static_cast<unsigned long long>(Memory.ActualBytes[s]),
+                InResult.Sections[s].AllocatedBytes, Memory.IsSkipped(static_cast<SectionType>(s)) ? "  skipped" : "");
+        }
+
+        printf("  %-14s %14llu %14llu %14llu\n", SectionNames[TotalIndex], Predicted, Actual, InResult.Sections[TotalIndex].AllocatedBytes);
+    }
+
+    void PrintSummary(const std::vector<FileResult>& InResults)
+    {
+        static const char* const Classes[] = { "small", "typical", "huge" };
+
+        printf("\nsummary\n");
+        printf("  %-8s %6s %12s %10s\n", "class", "files", "total ms", "MB/s");
+
+        for (const char* Class : Classes)
+        {
+            int Files = 0;
+            double Seconds = 0;
+            double Bytes = 0;
+
+            for (const FileResult& Result : InResults)
+            {
+                if (Result.bLoaded == false || strcmp(GetSizeClass(Result.FileSize), Class) != 0)
+                    continue;
+
+                ++Files;
+                Seconds += Result.Sections[TotalIndex].Seconds;
+                Bytes += static_cast<double>(Result.FileSize);
+            }
+
+            if (Files > 0)
+                printf("  %-8s %6d %12.3f %10.1f\n", Class, Files, Seconds * 1000.0, Bytes / std::max(Seconds, 1.e-9) / (1024.0 * 1024.0));
+        }
+    }
+
+    // 기준값 파일: 파일 경로, 섹션, 초, 할당 수 (탭 구분)
+    bool SaveBaseline(const std::string& InPath, const std::vector<FileResult>& InResults)
+    {
+        std::ofstream Stream(InPath);
+        if (Stream.is_open() == false)
+            return false;
+
+        Stream.precision(9);
+
+        for (const FileResult& Result : InResults)
+        {
+            if (Result.bLoaded == false)
+                continue;
+
+            for (int s = 0; s <= SectionCount; ++s)
+            {
+                if (s != TotalIndex && Result.Sections[s].Bytes == 0 && Result.Elements[s] == 0)
+                    continue;
+
+                Stream << Result.Path << '\t' << SectionNames[s] << '\t' << Result.Sections[s].Seconds << '\t' << Result.Sections[s].Allocations << '\n';
+            }
+        }
+
+        return true;
+    }
+
+    // 회귀 수 반환. 기준값을 읽지 못하면 -1
+    int CompareBaseline(const std::string& InPath, const std::vector<FileResult>& InResults, const double InThreshold, const double InMinDeltaMs)
+    {
+        std::ifstream Stream(InPath);
+        if (Stream.is_open() == false)
+            return -1;
+
+        struct BaselineEntry
+        {
+            double Seconds = 0;
+            unsigned long long Allocations = 0;
+        };
+
+        std::map<std::string, BaselineEntry> Baseline;
+
+        std::string Line;
+        while (std::getline(Stream, Line))
+        {
+            std::istringstream Fields(Line);
+            std::string Path, Section, Seconds, Allocations;
+
+            if (std::getline(Fields, Path, '\t') && std::getline(Fields, Section, '\t') && std::getline(Fields, Seconds, '\t') && std::getline(Fields, Allocations, '\t'))
+                Baseline[Path + '\t' + Section] = { std::atof(Seconds.c_str()), std::strtoull(Allocations.c_str(), nullptr, 10) };
+        }
+
+        printf("\ncompared with %s (threshold %.1f%%)\n", InPath.c_str(), InThreshold);
+        printf("  %-40s %-14s %10s %10s %9s %12s\n", "file", "section", "base ms", "ms", "change", "allocs");
+
+        int Regressions = 0;
+
+        for (const FileResult& Result : InResults)
+        {
+            if (Result.bLoaded == false)
+                continue;
+
+            // 긴 경로는 뒤쪽만
+            std::string ShortPath = Result.Path;
+            if (ShortPath.size() > 40)
+                ShortPath = "..." + ShortPath.substr(ShortPath.size() - 37);
+
+            for (int s = 0; s <= SectionCount; ++s)
+            {
+                const auto Found = Baseline.find(Result.Path + '\t' + SectionNames[s]);
+                if (Found == Baseline.end())
+                    continue;
+
+                const Sample& Section = Result.Sections[s];
+                const double Change = Found->second.Seconds > 0 ? (Section.Seconds / Found->second.Seconds - 1.0) * 100.0 : 0.0;
+
+                const bool bSignificant = fabs(Section.Seconds - Found->second.Seconds) * 1000.0 >= InMinDeltaMs;
+
+                const char* Mark = "";
+                if (bSignificant && Change > InThreshold)
+                {
+                    Mark = "  REGRESSION";
+                    ++Regressions;
+                }
+                else if (bSignificant && Change < -InThreshold)
+                {
+                    Mark = "  improved";
+                }
+
+                const long long AllocationDelta = static_cast<long long>(Section.Allocations) - static_cast<long long>(Found->second.Allocations);
+
+                printf("  %-40s %-14s %10.3f %10.3f %+8.1f%% %+12lld%s\n", ShortPath.c_str(), SectionNames[s], Found->second.Seconds * 1000.0, Section.Seconds * 1000.0, Change, AllocationDelta, Mark);
+            }
+        }
+
+        printf("  %d regression(s)\n", Regressions);
+        return Regressions;
+    }
+
+    void CollectInputs(const std::string& InPath, std::vector<std::string>& OutFiles)
+    {
+        namespace fs = std::filesystem;
+
+        std::error_code Error;
+        if (fs::is_directory(InPath, Error) == false)
+        {
+            OutFiles.push_back(InPath);
+            return;
+        }
+
+        std::vector<std::string> Found;
+        for (const fs::directory_entry& Entry : fs::recursive_directory_iterator(InPath, fs::directory_options::skip_permission_denied, Error))
+        {
+            if (Entry.is_regular_file(Error) == false)
+                continue;
+
+            std::string Extension = Entry.path().extension().string();
+            std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](const unsigned char C) { return static_cast<char>(std::tolower(C)); });
+
+            if (Extension == ".pmx")
+                Found.push_back(Entry.path().string());
+        }
+
+        std::sort(Found.begin(), Found.end());
+        OutFiles.insert(OutFiles.end(), Found.begin(), Found.end());
+    }
+
+    bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+    {
+        for (int i = 1; i < InArgc; ++i)
+        {
+            const std::string Arg = InArgv[i];
+            const bool bHasValue = i + 1 < InArgc;
+
+            if (Arg == "--iterations" && bHasValue)
+                OutOptions.Iterations = std::max(std::atoi(InArgv[++i]), 1);
+            else if (Arg == "--perf")
+                OutOptions.bPerf = true;
+            else if (Arg == "--save" && bHasValue)
+                OutOptions.SavePath = InArgv[++i];
+            else if (Arg == "--baseline" && bHasValue)
+                OutOptions.BaselinePath = InArgv[++i];
+            else if (Arg == "--threshold" && bHasValue)
+                OutOptions.Threshold = std::atof(InArgv[++i]);
+            else if (Arg == "--min-delta" && bHasValue)
+                OutOptions.MinDeltaMs = std::atof(InArgv[++i]);
+            else if (Arg == "--fail-on-regression")
+                OutOptions.bFailOnRegression = true;
+            else if (Arg == "--trace" && bHasValue)
+                OutOptions.TracePath = InArgv[++i];
+            else if (Arg == "--memory")
+                OutOptions.bMemory = true;
+            else if (Arg == "--budget" && bHasValue)
+                OutOptions.BudgetMB = std::atof(InArgv[++i]);
+            else if (Arg.compare(0, 2, "--") == 0)
+                return false;
+            else
+                CollectInputs(Arg, OutOptions.Inputs);
+        }
+
+        return OutOptions.Inputs.empty() == false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options BenchOptions;
+    if (ParseOptions(argc, argv, BenchOptions) == false)
+    {
+        fprintf(stderr, "usage: %s [--iterations N] [--perf] [--save FILE] [--baseline FILE] [--threshold PERCENT] [--min-delta MS] [--fail-on-regression] [--trace FILE] [--memory] [--budget MB] <file|directory>...\n", argv[0]);
+        return 2;
+    }
+
+    PerfCounters Counters;
+    if (BenchOptions.bPerf && Counters.Open() == false)
+    {
+        fprintf(stderr, "perf_event counters are not available (check /proc/sys/kernel/perf_event_paranoid); continuing without them\n");
+        BenchOptions.bPerf = false;
+    }
+
+    std::vector<FileResult> Results;
+    Results.reserve(BenchOptions.Inputs.size());
+
+    for (const std::string& Input : BenchOptions.Inputs)
+    {
+        Results.push_back(RunFile(Input, BenchOptions, Counters));
+        PrintFile(Results.back(), BenchOptions.bPerf);
+        PrintMemory(Results.back());
+    }
+
+    PrintSummary(Results);
+
+    int ExitCode = 0;
+
+    if (BenchOptions.BaselinePath.empty() == false)
+    {
+        const int Regressions = CompareBaseline(BenchOptions.BaselinePath, Results, BenchOptions.Threshold, BenchOptions.MinDeltaMs);
+        if (Regressions < 0)
+        {
+            fprintf(stderr, "failed to read baseline %s\n", BenchOptions.BaselinePath.c_str());
+            ExitCode = 2;
+        }
+        else if (Regressions > 0 && BenchOptions.bFailOnRegression)
+        {
+            ExitCode = 1;
+        }
+    }
+
+    if (BenchOptions.SavePath.empty() == false && SaveBaseline(BenchOptions.SavePath, Results) == false)
+    {
+        fprintf(stderr, "failed to write %s\n", BenchOptions.SavePath.c_str());
+        ExitCode = 2;
+    }
+
+    if (BenchOptions.TracePath.empty() == false)
+    {
+        std::vector<const PMX::LoadStats*> Traces;
+        for (const FileResult& Result : Results)
+            Traces.push_back(Result.Trace.get());
+
+        std::ofstream Stream(BenchOptions.TracePath, std::ios::binary | std::ios::trunc);
+        Stream << PMX::LoadStats::ToChromeTrace(Traces.data(), static_cast<int>(Traces.size()));
+
+        if (Stream.good() == false)
+        {
+            fprintf(stderr, "failed to write %s\n", BenchOptions.TracePath.c_str());
+            ExitCode = 2;
+        }
+    }
+
+    for (const FileResult& Result : Results)
+    {
+        if (Result.bLoaded == false)
+            ExitCode = ExitCode != 0 ? ExitCode : 1;
+    }
+
+    return ExitCode;
+}
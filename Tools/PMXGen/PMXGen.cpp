@@ -0,0 +1,264 @@
+﻿// Practice Unreal by Stiner
+//
+// PMX 합성 / 다시 저장
+// : 부하 테스트용 모델을 만들거나 (--from 이 없을 때) 기존 PMX 를 읽어 가장 작은 인덱스 크기로 다시 저장합니다.
+//   --verify 는 저장한 파일을 다시 읽고 한 번 더 저장해 바이트가 같은지 확인합니다.
+//
+//   PMXGen [옵션] <출력 파일>
+//     --from FILE            합성하지 않고 FILE 을 다시 저장
+//     --vertices N           정점 수 (기본 100000)
+//     --bones N              본 수 (기본 64)
+//     --morphs N             모프 수 (기본 32)
+//     --morph-offsets N      정점/UV 모프 하나의 오프셋 수 (기본 1000)
+//     --materials N          재질 수 (기본 4)
+//     --additional-uv N      추가 UV 수 0~4 (기본 0)
+//     --rigidbodies N        강체 수 (기본 0)
+//     --softbodies N         소프트 바디 수 (기본 0, 있으면 2.1)
+//     --deform A,B,C,D,E     BDEF1,BDEF2,BDEF4,SDEF,QDEF 비율 (기본 0.3,0.4,0.2,0.1,0)
+//     --seed N               난수 시드 (기본 1)
+//     --version 2.0|2.1      저장 버전 (기본: 필요할 때만 2.1)
+//     --utf8                 UTF-8 로 저장
+//     --verify               저장 후 다시 읽어 확인
+
+#include "PMXMeshData.h"
+#include "PMXModelGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        PMX::StressModelOptions Model;
+        PMX::SaveOptions Save;
+
+        std::string FromPath;
+        std::string OutputPath;
+        bool bVerify = false;
+    };
+
+    double SecondsSince(const Clock::time_point& InStart)
+    {
+        return std::chrono::duration<double>(Clock::now() - InStart).count();
+    }
+
+    bool ReadFile(const std::string& InPath, std::vector<char>& OutBuffer)
+    {
+        std::ifstream Stream(InPath, std::ios::binary | std::ios::ate);
+        if (Stream.is_open() == false)
+            return false;
+
+        OutBuffer.resize(static_cast<std::size_t>(Stream.tellg()));
+        Stream.seekg(0);
+        Stream.read(OutBuffer.data(), static_cast<std::streamsize>(OutBuffer.size()));
+
+        return Stream.good() || Stream.eof();
+    }
+
+    bool ParseDeformMix(const char* InText, float OutMix[5])
+    {
+        const char* Cursor = InText;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            char* End = nullptr;
+            OutMix[i] = std::strtof(Cursor, &End);
+
+            if (End == Cursor || OutMix[i] < 0)
+                return false;
+
+            Cursor = End;
+            if (i < 4)
+            {
+                if (*Cursor != ',')
+                    return false;
+
+                ++Cursor;
+            }
+        }
+
+        return *Cursor == 0;
+    }
+
+    bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+    {
+        for (int i = 1; i < InArgc; ++i)
+        {
+            const std::string Arg = InArgv[i];
+            const bool bHasValue = i + 1 < InArgc;
+
+            if (Arg == "--from" && bHasValue)
+                OutOptions.FromPath = InArgv[++i];
+            else if (Arg == "--vertices" && bHasValue)
+                OutOptions.Model.VertexCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--bones" && bHasValue)
+                OutOptions.Model.BoneCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--morphs" && bHasValue)
+                OutOptions.Model.MorphCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--morph-offsets" && bHasValue)
+                OutOptions.Model.MorphOffsetCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--materials" && bHasValue)
+                OutOptions.Model.MaterialCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--additional-uv" && bHasValue)
+                OutOptions.Model.AdditionalVectorCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--rigidbodies" && bHasValue)
+                OutOptions.Model.RigidbodyCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--softbodies" && bHasValue)
+                OutOptions.Model.SoftBodyCount = std::atoi(InArgv[++i]);
+            else if (Arg == "--deform" && bHasValue)
+            {
+                if (ParseDeformMix(InArgv[++i], OutOptions.Model.DeformMix) == false)
+                    return false;
+            }
+            else if (Arg == "--seed" && bHasValue)
+                OutOptions.Model.Seed = static_cast<unsigned int>(std::strtoul(InArgv[++i], nullptr, 10));
+            else if (Arg == "--version" && bHasValue)
+                OutOptions.Save.Version = std::strtof(InArgv[++i], nullptr);
+            else if (Arg == "--utf8")
+            {
+                OutOptions.Model.TextEncoding = PMX::Text::UTF8;
+                OutOptions.Save.bKeepTextEncoding = false;
+                OutOptions.Save.TextEncoding = PMX::Text::UTF8;
+            }
+            else if (Arg == "--verify")
+                OutOptions.bVerify = true;
+            else if (Arg.compare(0, 2, "--") == 0 || OutOptions.OutputPath.empty() == false)
+                return false;
+            else
+                OutOptions.OutputPath = Arg;
+        }
+
+        return OutOptions.OutputPath.empty() == false;
+    }
+
+    // 다시 읽어서 같은 옵션으로 저장했을 때 바이트가 같아야 함
+    bool Verify(const std::string& InPath, const PMX::SaveOptions& InSaveOptions)
+    {
+        std::vector<char> Saved;
+        if (ReadFile(InPath, Saved) == false)
+        {
+            fprintf(stderr, "verify: failed to read %s\n", InPath.c_str());
+            return false;
+        }
+
+        PMX::PMXMeshData Reloaded;
+        if (Reloaded.LoadBinary(Saved.data(), Saved.size()) == false)
+        {
+            fprintf(stderr, "verify: %s does not load\n", InPath.c_str());
+            return false;
+        }
+
+        std::vector<char> Resaved;
+        if (Reloaded.SaveBinary(Resaved, InSaveOptions) == false)
+        {
+            fprintf(stderr, "verify: failed to save the reloaded model\n");
+            return false;
+        }
+
+        if (Resaved != Saved)
+        {
+            std::size_t Offset = 0;
+            while (Offset < Saved.size() && Offset < Resaved.size() && Saved[Offset] == Resaved[Offset])
+                ++Offset;
+
+            fprintf(stderr, "verify: round trip differs at byte %zu (%zu -> %zu bytes)\n", Offset, Saved.size(), Resaved.size());
+            return false;
+        }
+
+        printf("verify: ok (%d vertices, %d bones, %d morphs reloaded)\n", Reloaded.GetVertexCount(), Reloaded.GetBoneCount(), Reloaded.GetMorphCount());
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options GenOptions;
+    if (ParseOptions(argc, argv, GenOptions) == false)
+    {
+        fprintf(stderr, "usage: %s [--from FILE] [--vertices N] [--bones N] [--morphs N] [--morph-offsets N] [--materials N] [--additional-uv N] "
+                        "[--rigidbodies N] [--softbodies N] [--deform A,B,C,D,E] [--seed N] [--version 2.0|2.1] [--utf8] [--verify] <output.pmx>\n", argv[0]);
+        return 2;
+    }
+
+    PMX::PMXMeshData MeshData;
+    Clock::time_point Start = Clock::now();
+
+    if (GenOptions.FromPath.empty() == false)
+    {
+        std::vector<char> Buffer;
+        if (ReadFile(GenOptions.FromPath, Buffer) == false || MeshData.LoadBinary(Buffer.data(), Buffer.size()) == false)
+        {
+            fprintf(stderr, "failed to load %s\n", GenOptions.FromPath.c_str());
+            return 1;
+        }
+
+        printf("loaded %s in %.1f ms\n", GenOptions.FromPath.c_str(), SecondsSince(Start) * 1000.0);
+    }
+    else
+    {
+        if (PMX::GenerateStressModel(GenOptions.Model, MeshData) == false)
+        {
+            fprintf(stderr, "invalid generator options\n");
+            return 2;
+        }
+
+        printf("generated %d vertices, %d triangles, %d bones, %d morphs in %.1f ms\n",
+            MeshData.GetVertexCount(), MeshData.GetSurfaceCount(), MeshData.GetBoneCount(), MeshData.GetMorphCount(), SecondsSince(Start) * 1000.0);
+    }
+
+    // 저장에 실패해도 빈 파일이 남거나 기존 파일이 지워지지 않도록 임시 파일에 쓰고 성공하면 바꿈
+    const std::string TempPath = GenOptions.OutputPath + ".tmp";
+
+    std::ofstream Stream(TempPath, std::ios::binary | std::ios::trunc);
+    if (Stream.is_open() == false)
+    {
+        fprintf(stderr, "failed to open %s\n", TempPath.c_str());
+        return 1;
+    }
+
+    // 메모리에 전체를 만들지 않고 바로 파일로
+    unsigned long long BytesWritten = 0;
+    Start = Clock::now();
+
+    const bool bSaved = MeshData.SaveBinary([&](const PMX::Byte* InData, const PMX::MemSize InSize)
+    {
+        Stream.write(InData, static_cast<std::streamsize>(InSize));
+        BytesWritten += InSize;
+        return Stream.good();
+    }, GenOptions.Save);
+
+    Stream.close();
+
+    if (bSaved == false || Stream.fail())
+    {
+        std::remove(TempPath.c_str());
+        fprintf(stderr, "failed to save %s (index out of range, missing deform data or version 2.0 requested for 2.1 data)\n", GenOptions.OutputPath.c_str());
+        return 1;
+    }
+
+    // NOTE: Windows 의 rename 은 대상 파일이 있으면 실패하므로 먼저 지움.
+    std::remove(GenOptions.OutputPath.c_str());
+    if (std::rename(TempPath.c_str(), GenOptions.OutputPath.c_str()) != 0)
+    {
+        std::remove(TempPath.c_str());
+        fprintf(stderr, "failed to rename %s to %s\n", TempPath.c_str(), GenOptions.OutputPath.c_str());
+        return 1;
+    }
+
+    const double SaveSeconds = SecondsSince(Start);
+    printf("saved %s: %llu bytes in %.1f ms (%.1f MB/s)\n", GenOptions.OutputPath.c_str(), BytesWritten, SaveSeconds * 1000.0,
+        SaveSeconds > 0 ? BytesWritten / SaveSeconds / (1024.0 * 1024.0) : 0.0);
+
+    if (GenOptions.bVerify && Verify(GenOptions.OutputPath, GenOptions.Save) == false)
+        return 1;
+
+    return 0;
+}
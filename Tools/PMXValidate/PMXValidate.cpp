@@ -0,0 +1,580 @@
+﻿// Practice Unreal by Stiner
+//
+// PMX 모음 검사
+// : 여러 파일을 모든 코어에서 동시에 읽어 파싱 성공 여부, 항목 수, 인덱스 범위 위반, 파일별 시간을 보고합니다.
+//   에디터에 넣기 전에 들어온 모델 팩을 걸러내는 용도입니다.
+//
+//   PMXValidate [옵션] <파일 또는 디렉터리>...
+//     --json FILE        결과를 JSON 으로 저장 ("-" 면 표준 출력으로 내보내고 파일별 줄은 생략)
+//     --threads N        동시에 처리할 파일 수 (기본: 코어 수)
+//     --budget MB        파싱 데이터 예상 메모리가 이보다 크면 읽지 않고 over-budget 으로 보고
+//     --max-issues N     파일마다 기록할 위반 수 (기본 20, 수는 모두 셈)
+//     --shared           읽은 모델을 모두 PMX::ModelLibrary 에 넣어 모델 사이에 겹치는 텍스처 / 재질 / 스켈레톤 수를 보고
+//                        (텍스처는 파일 내용까지 비교. 모든 모델을 메모리에 들고 있으므로 큰 모음은 --budget 과 같이 사용)
+//
+//   종료 코드: 모두 통과하면 0, 읽지 못했거나 위반이 있는 파일이 있으면 1, 사용법 오류는 2
+
+#include "PMXMeshData.h"
+#include "PMXModelLibrary.h"
+#include "PMXParallel.h"
+#include "PMXValidator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using SectionType = PMX::LoadProgress::SectionType;
+
+    static constexpr int SectionCount = static_cast<int>(SectionType::Count);
+
+    enum class FileStatus
+    {
+        OK,
+        Issues,
+        ReadError,
+        Malformed,
+        OverBudget,
+    };
+
+    const char* GetStatusName(const FileStatus InStatus)
+    {
+        switch (InStatus)
+        {
+            case FileStatus::OK:            return "ok";
+            case FileStatus::Issues:        return "issues";
+            case FileStatus::ReadError:     return "read-error";
+            case FileStatus::Malformed:     return "malformed";
+            case FileStatus::OverBudget:    return "over-budget";
+            default:                        return "unknown";
+        }
+    }
+
+    struct FileResult
+    {
+        std::string Path;
+        unsigned long long FileSize = 0;
+        FileStatus Status = FileStatus::ReadError;
+
+        float Version = 0;
+        bool bUTF8 = false;
+
+        // LoadProgress::SectionType 순서. 헤더 칸은 비어 있음
+        int Counts[SectionCount] = { 0 };
+
+        unsigned long long PredictedBytes = 0;
+
+        double ReadSeconds = 0;
+        double LoadSeconds = 0;
+        double ValidateSeconds = 0;
+
+        int IssueCount = 0;
+        int SectionIssueCount[SectionCount] = { 0 };
+        std::vector<PMX::IndexIssue> Issues;
+
+        // --shared 일 때만 남김
+        std::unique_ptr<PMX::PMXMeshData> MeshData;
+    };
+
+    struct Options
+    {
+        std::string JsonPath;
+        int Threads = 0;
+        double BudgetMB = 0;
+        int MaxIssues = 20;
+        bool bShared = false;
+        std::vector<std::string> Inputs;
+    };
+
+    double SecondsSince(const Clock::time_point& InStart)
+    {
+        return std::chrono::duration<double>(Clock::now() - InStart).count();
+    }
+
+    bool ReadFile(const std::string& InPath, std::vector<char>& OutBuffer)
+    {
+        std::ifstream Stream(InPath, std::ios::binary | std::ios::ate);
+        if (Stream.is_open() == false)
+            return false;
+
+        OutBuffer.resize(static_cast<std::size_t>(Stream.tellg()));
+        Stream.seekg(0);
+        Stream.read(OutBuffer.data(), static_cast<std::streamsize>(OutBuffer.size()));
+
+        return Stream.good() || Stream.eof();
+    }
+
+    void ValidateFile(const std::string& InPath, const Options& InOptions, FileResult& OutResult)
+    {
+        OutResult.Path = InPath;
+
+        Clock::time_point Start = Clock::now();
+
+        std::vector<char> Buffer;
+        if (ReadFile(InPath, Buffer) == false || Buffer.empty())
+        {
+            OutResult.Status = FileStatus::ReadError;
+            return;
+        }
+
+        OutResult.FileSize = Buffer.size();
+        OutResult.ReadSeconds = SecondsSince(Start);
+
+        // NOTE: 상한이 없어도 예상은 항상 돌림. 깨진 파일의 잘못된 개수로 큰 배열을 잡기 전에 걸러냄.
+        PMX::LoadOptions LoadOptions;
+        LoadOptions.MemoryBudget = InOptions.BudgetMB > 0 ? static_cast<PMX::MemSize>(InOptions.BudgetMB * 1024.0 * 1024.0) : ~static_cast<PMX::MemSize>(0);
+        LoadOptions.bSkipSectionsOverBudget = false;
+
+        Start = Clock::now();
+
+        std::unique_ptr<PMX::PMXMeshData> MeshData(new PMX::PMXMeshData());
+        const bool bLoaded = MeshData->LoadBinary(Buffer.data(), Buffer.size(), nullptr, LoadOptions);
+
+        OutResult.LoadSeconds = SecondsSince(Start);
+
+        const PMX::MemoryReport& Memory = MeshData->GetMemoryReport();
+        OutResult.PredictedBytes = Memory.bPredicted ? Memory.GetPredictedTotal() : 0;
+
+        if (bLoaded == false)
+        {
+            OutResult.Status = Memory.bOverBudget ? FileStatus::OverBudget : FileStatus::Malformed;
+            return;
+        }
+
+        // 원본 버퍼는 검사에 필요 없음
+        std::vector<char>().swap(Buffer);
+
+        OutResult.Version = MeshData->GetHeader().Version;
+        OutResult.bUTF8 = MeshData->GetHeader().TextEncoding == PMX::Text::UTF8;
+
+        OutResult.Counts[static_cast<int>(SectionType::ModelInfo)] = 1;
+        OutResult.Counts[static_cast<int>(SectionType::Vertices)] = MeshData->GetVertexCount();
+        OutResult.Counts[static_cast<int>(SectionType::Surfaces)] = MeshData->GetSurfaceCount();
+        OutResult.Counts[static_cast<int>(SectionType::Textures)] = MeshData->GetTextureCount();
+        OutResult.Counts[static_cast<int>(SectionType::Materials)] = MeshData->GetMaterialCount();
+        OutResult.Counts[static_cast<int>(SectionType::Bones)] = MeshData->GetBoneCount();
+        OutResult.Counts[static_cast<int>(SectionType::Morphs)] = MeshData->GetMorphCount();
+        OutResult.Counts[static_cast<int>(SectionType::DisplayFrames)] = MeshData->GetDisplayFrameCount();
+        OutResult.Counts[static_cast<int>(SectionType::Rigidbodies)] = MeshData->GetRigidbodyCount();
+        OutResult.Counts[static_cast<int>(SectionType::Joints)] = MeshData->GetJointCount();
+        OutResult.Counts[static_cast<int>(SectionType::SoftBodies)] = MeshData->GetSoftBodyCount();
+
+        Start = Clock::now();
+
+        PMX::ModelValidator Validator;
+        Validator.Validate(*MeshData, InOptions.MaxIssues);
+
+        OutResult.ValidateSeconds = SecondsSince(Start);
+
+        OutResult.IssueCount = Validator.GetIssueCount();
+        for (int s = 0; s < SectionCount; ++s)
+            OutResult.SectionIssueCount[s] = Validator.GetSectionIssueCount(static_cast<SectionType>(s));
+
+        OutResult.Issues = Validator.GetIssues();
+        OutResult.Status = OutResult.IssueCount > 0 ? FileStatus::Issues : FileStatus::OK;
+
+        if (InOptions.bShared)
+            OutResult.MeshData = std::move(MeshData);
+    }
+
+    // 텍스처 파일 내용 해시. 없는 파일은 경로로만 비교
+    bool HashTextureFile(const std::string& InPath, PMX::UInt64& OutHash)
+    {
+        std::vector<char> Buffer;
+        if (ReadFile(InPath, Buffer) == false)
+            return false;
+
+        OutHash = PMX::HashBytes(Buffer.data(), Buffer.size());
+        return true;
+    }
+
+    struct SharedSummary
+    {
+        int Models = 0;
+
+        int TextureReferences = 0;
+        int UniqueTextures = 0;
+        int MaterialReferences = 0;
+        int UniqueMaterials = 0;
+        int SkeletonReferences = 0;
+        int UniqueSkeletons = 0;
+    };
+
+    // 결과 순서대로 넣어서 공유 번호가 실행마다 같음
+    void BuildSharedSummary(std::vector<FileResult>& InOutResults, SharedSummary& OutSummary)
+    {
+        PMX::ModelLibraryOptions LibraryOptions;
+        LibraryOptions.HashTextureContent = HashTextureFile;
+
+        PMX::ModelLibrary Library(LibraryOptions);
+
+        for (FileResult& Result : InOutResults)
+        {
+            if (Result.MeshData == nullptr)
+                continue;
+
+            const std::string Directory = std::filesystem::path(Result.Path).parent_path().string();
+            Library.AddModel(Result.MeshData.release(), Directory);
+        }
+
+        OutSummary.Models = Library.GetModelCount();
+        OutSummary.TextureReferences = Library.GetTextureReferenceCount();
+        OutSummary.UniqueTextures = static_cast<int>(Library.GetTextures().size());
+        OutSummary.MaterialReferences = Library.GetMaterialReferenceCount();
+        OutSummary.UniqueMaterials = static_cast<int>(Library.GetMaterials().size());
+        OutSummary.SkeletonReferences = Library.GetSkeletonReferenceCount();
+        OutSummary.UniqueSkeletons = static_cast<int>(Library.GetSkeletons().size());
+    }
+
+    void AppendJsonString(std::string& InOutJson, const std::string& InText)
+    {
+        InOutJson += '"';
+
+        for (const char C : InText)
+        {
+            const unsigned char Char = static_cast<unsigned char>(C);
+
+            switch (Char)
+            {
+                case '"':   InOutJson += "\\\""; break;
+                case '\\':  InOutJson += "\\\\"; break;
+                case '\n':  InOutJson += "\\n"; break;
+                case '\r':  InOutJson += "\\r"; break;
+                case '\t':  InOutJson += "\\t"; break;
+                default:
+                    if (Char < 0x20)
+                    {
+                        char Escaped[8];
+                        snprintf(Escaped, sizeof(Escaped), "\\u%04x", Char);
+                        InOutJson += Escaped;
+                    }
+                    else
+                    {
+                        InOutJson += C;
+                    }
+                    break;
+            }
+        }
+
+        InOutJson += '"';
+    }
+
+    // 섹션 이름을 JSON 키로 (첫 글자 소문자)
+    std::string GetSectionKey(const int InSection)
+    {
+        std::string Key = PMX::LoadProgress::GetSectionName(static_cast<SectionType>(InSection));
+        if (Key.empty() == false)
+            Key[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(Key[0])));
+
+        return Key;
+    }
+
+    std::string ToJson(const std::vector<FileResult>& InResults, const SharedSummary* InShared, const int InThreads, const double InWallSeconds)
+    {
+        std::string Json;
+        Json.reserve(InResults.size() * 512);
+
+        char Number[128];
+
+        int StatusCount[5] = { 0 };
+        unsigned long long TotalBytes = 0;
+
+        for (const FileResult& Result : InResults)
+        {
+            ++StatusCount[static_cast<int>(Result.Status)];
+            TotalBytes += Result.FileSize;
+        }
+
+        Json += "{\"summary\":{";
+        snprintf(Number, sizeof(Number), "\"files\":%zu,\"threads\":%d,\"bytes\":%llu,\"wallSeconds\":%.6f,\"mbPerSecond\":%.1f",
+            InResults.size(), InThreads, TotalBytes, InWallSeconds, TotalBytes / std::max(InWallSeconds, 1.e-9) / (1024.0 * 1024.0));
+        Json += Number;
+
+        for (int s = 0; s < 5; ++s)
+        {
+            Json += ',';
+            AppendJsonString(Json, GetStatusName(static_cast<FileStatus>(s)));
+            Json += ':' + std::to_string(StatusCount[s]);
+        }
+
+        if (InShared != nullptr)
+        {
+            snprintf(Number, sizeof(Number), ",\"shared\":{\"models\":%d,\"textureReferences\":%d,\"uniqueTextures\":%d,",
+                InShared->Models, InShared->TextureReferences, InShared->UniqueTextures);
+            Json += Number;
+
+            snprintf(Number, sizeof(Number), "\"materialReferences\":%d,\"uniqueMaterials\":%d,\"skeletonReferences\":%d,\"uniqueSkeletons\":%d}",
+                InShared->MaterialReferences, InShared->UniqueMaterials, InShared->SkeletonReferences, InShared->UniqueSkeletons);
+            Json += Number;
+        }
+
+        Json += "},\"files\":[";
+
+        for (std::size_t i = 0; i < InResults.size(); ++i)
+        {
+            const FileResult& Result = InResults[i];
+
+            Json += i == 0 ? "\n{" : ",\n{";
+
+            Json += "\"path\":";
+            AppendJsonString(Json, Result.Path);
+
+            Json += ",\"status\":";
+            AppendJsonString(Json, GetStatusName(Result.Status));
+
+            snprintf(Number, sizeof(Number), ",\"bytes\":%llu,\"predictedMemory\":%llu,\"readMs\":%.3f,\"loadMs\":%.3f,\"validateMs\":%.3f",
+                Result.FileSize, Result.PredictedBytes, Result.ReadSeconds * 1000.0, Result.LoadSeconds * 1000.0, Result.ValidateSeconds * 1000.0);
+            Json += Number;
+
+            if (Result.Status == FileStatus::OK || Result.Status == FileStatus::Issues)
+            {
+                snprintf(Number, sizeof(Number), ",\"version\":%.1f,\"encoding\":\"%s\"", Result.Version, Result.bUTF8 ? "utf8" : "utf16le");
+                Json += Number;
+
+                Json += ",\"counts\":{";
+                for (int s = static_cast<int>(SectionType::Vertices); s < SectionCount; ++s)
+                {
+                    if (s != static_cast<int>(SectionType::Vertices))
+                        Json += ',';
+
+                    AppendJsonString(Json, GetSectionKey(s));
+                    Json += ':' + std::to_string(Result.Counts[s]);
+                }
+
+                Json += "},\"issueCount\":" + std::to_string(Result.IssueCount);
+
+                Json += ",\"sectionIssues\":{";
+                bool bFirst = true;
+                for (int s = 0; s < SectionCount; ++s)
+                {
+                    if (Result.SectionIssueCount[s] == 0)
+                        continue;
+
+                    if (bFirst == false)
+                        Json += ',';
+                    bFirst = false;
+
+                    AppendJsonString(Json, GetSectionKey(s));
+                    Json += ':' + std::to_string(Result.SectionIssueCount[s]);
+                }
+
+                Json += "},\"issues\":[";
+                for (std::size_t j = 0; j < Result.Issues.size(); ++j)
+                {
+                    const PMX::IndexIssue& Issue = Result.Issues[j];
+
+                    if (j > 0)
+                        Json += ',';
+
+                    Json += "{\"section\":";
+                    AppendJsonString(Json, GetSectionKey(static_cast<int>(Issue.Section)));
+                    Json += ",\"field\":";
+                    AppendJsonString(Json, Issue.Field);
+
+                    snprintf(Number, sizeof(Number), ",\"item\":%d,\"index\":%d,\"min\":%d,\"limit\":%d}", Issue.Item, Issue.Index, Issue.Min, Issue.Limit);
+                    Json += Number;
+                }
+
+                Json += ']';
+            }
+
+            Json += '}';
+        }
+
+        Json += "\n]}\n";
+        return Json;
+    }
+
+    void PrintFile(const FileResult& InResult)
+    {
+        printf("%-11s %9.3f ms  %s", GetStatusName(InResult.Status), (InResult.ReadSeconds + InResult.LoadSeconds + InResult.ValidateSeconds) * 1000.0, InResult.Path.c_str());
+
+        if (InResult.Status == FileStatus::OK || InResult.Status == FileStatus::Issues)
+        {
+            printf("  (%d vertices, %d triangles, %d materials, %d bones, %d morphs)",
+                InResult.Counts[static_cast<int>(SectionType::Vertices)], InResult.Counts[static_cast<int>(SectionType::Surfaces)], InResult.Counts[static_cast<int>(SectionType::Materials)],
+                InResult.Counts[static_cast<int>(SectionType::Bones)], InResult.Counts[static_cast<int>(SectionType::Morphs)]);
+        }
+
+        if (InResult.IssueCount > 0)
+        {
+            printf("  %d issue(s)", InResult.IssueCount);
+
+            const PMX::IndexIssue& Issue = InResult.Issues.front();
+            printf(", first: %s[%d].%s = %d not in [%d, %d)", PMX::LoadProgress::GetSectionName(Issue.Section), Issue.Item, Issue.Field, Issue.Index, Issue.Min, Issue.Limit);
+        }
+
+        if (InResult.Status == FileStatus::OverBudget)
+            printf("  predicted %.1f MB", InResult.PredictedBytes / (1024.0 * 1024.0));
+
+        printf("\n");
+    }
+
+    void CollectInputs(const std::string& InPath, std::vector<std::string>& OutFiles)
+    {
+        namespace fs = std::filesystem;
+
+        std::error_code Error;
+        if (fs::is_directory(InPath, Error) == false)
+        {
+            OutFiles.push_back(InPath);
+            return;
+        }
+
+        std::vector<std::string> Found;
+        for (const fs::directory_entry& Entry : fs::recursive_directory_iterator(InPath, fs::directory_options::skip_permission_denied, Error))
+        {
+            if (Entry.is_regular_file(Error) == false)
+                continue;
+
+            std::string Extension = Entry.path().extension().string();
+            std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](const unsigned char C) { return static_cast<char>(std::tolower(C)); });
+
+            if (Extension == ".pmx")
+                Found.push_back(Entry.path().string());
+        }
+
+        std::sort(Found.begin(), Found.end());
+        OutFiles.insert(OutFiles.end(), Found.begin(), Found.end());
+    }
+
+    bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+    {
+        for (int i = 1; i < InArgc; ++i)
+        {
+            const std::string Arg = InArgv[i];
+            const bool bHasValue = i + 1 < InArgc;
+
+            if (Arg == "--json" && bHasValue)
+                OutOptions.JsonPath = InArgv[++i];
+            else if (Arg == "--threads" && bHasValue)
+                OutOptions.Threads = std::max(std::atoi(InArgv[++i]), 1);
+            else if (Arg == "--budget" && bHasValue)
+                OutOptions.BudgetMB = std::atof(InArgv[++i]);
+            else if (Arg == "--max-issues" && bHasValue)
+                OutOptions.MaxIssues = std::max(std::atoi(InArgv[++i]), 0);
+            else if (Arg == "--shared")
+                OutOptions.bShared = true;
+            else if (Arg.compare(0, 2, "--") == 0)
+                return false;
+            else
+                CollectInputs(Arg, OutOptions.Inputs);
+        }
+
+        return OutOptions.Inputs.empty() == false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options ValidateOptions;
+    if (ParseOptions(argc, argv, ValidateOptions) == false)
+    {
+        fprintf(stderr, "usage: %s [--json FILE|-] [--threads N] [--budget MB] [--max-issues N] [--shared] <file|directory>...\n", argv[0]);
+        return 2;
+    }
+
+    const int FileCount = static_cast<int>(ValidateOptions.Inputs.size());
+    const int ThreadCount = std::min(ValidateOptions.Threads > 0 ? ValidateOptions.Threads : PMX::GetWorkerCount(), FileCount);
+
+    const bool bJsonToStdout = ValidateOptions.JsonPath == "-";
+
+    std::vector<FileResult> Results(FileCount);
+
+    // NOTE: 파일마다 크기가 크게 달라서 묶지 않고 한 개씩 가져감. 큰 파일 하나가 한 스레드를 잡고 있어도 나머지가 계속 돎.
+    std::atomic<int> NextFile(0);
+    std::atomic<int> FinishedCount(0);
+
+    const Clock::time_point Start = Clock::now();
+
+    auto Worker = [&]()
+    {
+        for (int i = NextFile++; i < FileCount; i = NextFile++)
+        {
+            ValidateFile(ValidateOptions.Inputs[i], ValidateOptions, Results[i]);
+
+            const int Finished = ++FinishedCount;
+            if (bJsonToStdout == false)
+                fprintf(stderr, "\r%d / %d", Finished, FileCount);
+        }
+    };
+
+    std::vector<std::thread> Threads;
+    for (int i = 1; i < ThreadCount; ++i)
+        Threads.emplace_back(Worker);
+
+    Worker();
+
+    for (std::thread& Thread : Threads)
+        Thread.join();
+
+    const double WallSeconds = SecondsSince(Start);
+
+    SharedSummary Shared;
+    if (ValidateOptions.bShared)
+        BuildSharedSummary(Results, Shared);
+
+    const SharedSummary* SharedPtr = ValidateOptions.bShared ? &Shared : nullptr;
+
+    int FailedCount = 0;
+    int IssueFileCount = 0;
+    unsigned long long TotalBytes = 0;
+
+    for (const FileResult& Result : Results)
+    {
+        TotalBytes += Result.FileSize;
+
+        if (Result.Status == FileStatus::Issues)
+            ++IssueFileCount;
+        else if (Result.Status != FileStatus::OK)
+            ++FailedCount;
+    }
+
+    if (bJsonToStdout)
+    {
+        fputs(ToJson(Results, SharedPtr, ThreadCount, WallSeconds).c_str(), stdout);
+    }
+    else
+    {
+        fprintf(stderr, "\n");
+
+        for (const FileResult& Result : Results)
+            PrintFile(Result);
+
+        printf("\n%d file(s), %d ok, %d with index issues, %d failed, %.1f MB in %.2f s on %d thread(s) (%.1f MB/s)\n",
+            FileCount, FileCount - IssueFileCount - FailedCount, IssueFileCount, FailedCount,
+            TotalBytes / (1024.0 * 1024.0), WallSeconds, ThreadCount, TotalBytes / std::max(WallSeconds, 1.e-9) / (1024.0 * 1024.0));
+
+        if (SharedPtr != nullptr)
+        {
+            printf("shared across %d model(s): textures %d -> %d, materials %d -> %d, skeletons %d -> %d\n",
+                Shared.Models, Shared.TextureReferences, Shared.UniqueTextures, Shared.MaterialReferences, Shared.UniqueMaterials,
+                Shared.SkeletonReferences, Shared.UniqueSkeletons);
+        }
+    }
+
+    if (ValidateOptions.JsonPath.empty() == false && bJsonToStdout == false)
+    {
+        std::ofstream Stream(ValidateOptions.JsonPath, std::ios::binary | std::ios::trunc);
+        Stream << ToJson(Results, SharedPtr, ThreadCount, WallSeconds);
+
+        if (Stream.good() == false)
+        {
+            fprintf(stderr, "failed to write %s\n", ValidateOptions.JsonPath.c_str());
+            return 2;
+        }
+    }
+
+    return FailedCount > 0 || IssueFileCount > 0 ? 1 : 0;
+}
@@ -0,0 +1,439 @@
+﻿// Practice Unreal by Stiner
+//
+// VMD 모션 로더 벤치마크
+// : 파일을 메모리에 매핑해 (리눅스 / 맥은 mmap) 복사 없이 읽고, 반복 로드 시간의 중앙값과 MB/s, 키/s, 트랙 / 키 수, 키 메모리를 출력합니다.
+//
+//   VMDBench [옵션] <파일.vmd>...
+//     --iterations N     파일마다 반복 횟수 (기본 5, 중앙값 사용)
+//     --trace FILE       파일마다 한 번 더 읽으며 정렬 / 풀기 단계를 Chrome trace JSON 으로 저장
+//     --tracks           본 / 모프 트랙별 키 수 출력 (--reduce 와 같이 쓰면 트랙별 줄인 결과)
+//     --reduce           오차 한도 안에서 키 줄이기. 압축률, 시간, 모든 정수 프레임에서 다시 잰 최대 오차 출력
+//     --position-tolerance UNITS   --reduce 위치 한도 (기본 0.005)
+//     --rotation-tolerance DEGREES --reduce 회전 한도 (기본 0.25)
+//     --model FILE.pmx   모델 본 / 모프에 트랙을 연결해 여러 인스턴스를 샘플링. 재생 / 임의 위치 탐색의 포즈/ms 와
+//                        인스턴스마다 키를 이진 탐색하는 기준 샘플과의 최대 차이 출력
+//     --instances N      --model 인스턴스 수 (기본 1024, 인스턴스마다 시작 프레임이 다름)
+
+#include "PMXMath.h"
+#include "PMXMeshData.h"
+#include "PMXSkeleton.h"
+#include "VMDKeyReducer.h"
+#include "VMDMotionData.h"
+#include "VMDMotionSampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 읽기 전용 파일 매핑
+     * : mmap 이 없는 플랫폼에서는 통째로 읽어 둡니다.
+     */
+    class MappedFile
+    {
+    public:
+        ~MappedFile()
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            if (Mapped != nullptr)
+                munmap(Mapped, Size);
+#endif
+        }
+
+        bool Open(const std::string& InPath)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            const int File = open(InPath.c_str(), O_RDONLY);
+            if (File < 0)
+                return false;
+
+            struct stat Stat;
+            if (fstat(File, &Stat) != 0 || Stat.st_size <= 0)
+            {
+                close(File);
+                return false;
+            }
+
+            Size = static_cast<std::size_t>(Stat.st_size);
+            Mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0);
+            close(File);
+
+            if (Mapped == MAP_FAILED)
+            {
+                Mapped = nullptr;
+                return false;
+            }
+
+            // 한 번 훑고 지나가므로 미리 읽기를 늘림
+            madvise(Mapped, Size, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+            Data = static_cast<const PMX::Byte*>(Mapped);
+            return true;
+#else
+            std::ifstream Stream(InPath, std::ios::binary | std::ios::ate);
+            if (Stream.is_open() == false)
+                return false;
+
+            Buffer.resize(static_cast<std::size_t>(Stream.tellg()));
+            Stream.seekg(0);
+            Stream.read(Buffer.data(), static_cast<std::streamsize>(Buffer.size()));
+
+            Data = Buffer.data();
+            Size = Buffer.size();
+            return Stream.good() || Stream.eof();
+#endif
+        }
+
+        const PMX::Byte* GetData() const { return Data; }
+        std::size_t GetSize() const { return Size; }
+
+    protected:
+        const PMX::Byte* Data = nullptr;
+        std::size_t Size = 0;
+
+#if defined(__unix__) || defined(__APPLE__)
+        void* Mapped = nullptr;
+#else
+        std::vector<char> Buffer;
+#endif
+    };
+
+    struct Options
+    {
+        int Iterations = 5;
+        std::string TracePath;
+        bool bTracks = false;
+
+        bool bReduce = false;
+        PMX::KeyReductionOptions Reduction;
+
+        std::string ModelPath;
+        int InstanceCount = 1024;
+        std::vector<std::string> Inputs;
+    };
+
+    double Median(std::vector<double> InValues)
+    {
+        std::sort(InValues.begin(), InValues.end());
+        return InValues.empty() ? 0 : InValues[InValues.size() / 2];
+    }
+
+    void PrintTracks(const char* InLabel, const PMX::MotionTrack* InTracks, const int InTrackCount)
+    {
+        for (int i = 0; i < InTrackCount; ++i)
+            printf("    %s %-24s %8d keys\n", InLabel, InTracks[i].Name.c_str(), InTracks[i].KeyCount);
+    }
+
+    // 모든 정수 프레임에서 두 모션의 본 / 모프 트랙 차이 (트랙 순서가 같아야 함)
+    void MeasureReducedError(const PMX::VMDMotionData& InSource, const PMX::VMDMotionData& InReduced, float& OutPosition, float& OutRotation, float& OutWeight)
+    {
+        OutPosition = 0;
+        OutRotation = 0;
+        OutWeight = 0;
+
+        for (int t = 0; t < InSource.GetBoneTrackCount(); ++t)
+        {
+            for (PMX::UInt32 Frame = 0; Frame <= InSource.GetFrameCount(); ++Frame)
+            {
+                PMX::Vector3 SourcePosition, ReducedPosition;
+                PMX::Vector4 SourceRotation, ReducedRotation;
+
+                InSource.SampleBoneTrack(t, static_cast<float>(Frame), SourcePosition, SourceRotation);
+                InReduced.SampleBoneTrack(t, static_cast<float>(Frame), ReducedPosition, ReducedRotation);
+
+                OutPosition = std::max(OutPosition, PMX::Math::Length(PMX::Math::Sub(SourcePosition, ReducedPosition)));
+                OutRotation = std::max(OutRotation, PMX::Math::QuatAngle(SourceRotation, ReducedRotation));
+            }
+        }
+
+        for (int t = 0; t < InSource.GetMorphTrackCount(); ++t)
+        {
+            for (PMX::UInt32 Frame = 0; Frame <= InSource.GetFrameCount(); ++Frame)
+                OutWeight = std::max(OutWeight, std::fabs(InSource.SampleMorphTrack(t, static_cast<float>(Frame)) - InReduced.SampleMorphTrack(t, static_cast<float>(Frame))));
+        }
+    }
+
+    void ReduceMotion(const PMX::VMDMotionData& InMotion, const Options& InOptions)
+    {
+        PMX::MotionKeyReducer Reducer;
+
+        const Clock::time_point Start = Clock::now();
+        Reducer.Build(InMotion, InOptions.Reduction);
+        const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+
+        const PMX::VMDMotionData& Reduced = Reducer.GetMotion();
+
+        float PositionError = 0, RotationError = 0, WeightError = 0;
+        MeasureReducedError(InMotion, Reduced, PositionError, RotationError, WeightError);
+
+        printf("  reduce %.3f ms  bone keys %d -> %d, morph keys %d -> %d (%.2fx)  key memory %.2f MB\n",
+            Seconds * 1000.0, InMotion.GetBoneKeyCount(), Reduced.GetBoneKeyCount(), InMotion.GetMorphKeyCount(), Reduced.GetMorphKeyCount(),
+            Reducer.GetCompressionRatio(), Reduced.GetKeyMemory() / (1024.0 * 1024.0));
+        printf("  measured max error: position %.5f, rotation %.4f deg, morph %.5f\n", PositionError, RotationError * 57.29578f, WeightError);
+
+        if (InOptions.bTracks == false)
+            return;
+
+        for (int t = 0; t < InMotion.GetBoneTrackCount(); ++t)
+        {
+            const PMX::TrackReduction& Stats = Reducer.GetBoneTrackStats()[t];
+            printf("    bone  %-24s %8d -> %6d (%6.2fx)  position %.5f  rotation %.4f deg\n", InMotion.GetBoneTracks()[t].Name.c_str(),
+                Stats.SourceKeyCount, Stats.KeyCount, Stats.GetCompressionRatio(), Stats.MaxPositionError, Stats.MaxRotationError * 57.29578f);
+        }
+
+        for (int t = 0; t < InMotion.GetMorphTrackCount(); ++t)
+        {
+            const PMX::TrackReduction& Stats = Reducer.GetMorphTrackStats()[t];
+            printf("    morph %-24s %8d -> %6d (%6.2fx)  weight %.5f\n", InMotion.GetMorphTracks()[t].Name.c_str(),
+                Stats.SourceKeyCount, Stats.KeyCount, Stats.GetCompressionRatio(), Stats.MaxWeightError);
+        }
+    }
+
+    // 모든 인스턴스를 InSteps 번 샘플링한 시간 (초). InAdvance 로 다음 프레임을 정함
+    template<typename AdvanceType>
+    double SampleSteps(PMX::MotionSampler& InOutSampler, PMX::PoseBatch& InOutPose, std::vector<float>& InOutFrames, std::vector<float>& OutWeights,
+        const int InSteps, const AdvanceType& InAdvance)
+    {
+        const Clock::time_point Start = Clock::now();
+
+        for (int s = 0; s < InSteps; ++s)
+        {
+            for (int i = 0; i < static_cast<int>(InOutFrames.size()); ++i)
+                InOutFrames[i] = InAdvance(i, InOutFrames[i]);
+
+            InOutSampler.SampleBatch(InOutFrames.data(), InOutPose, OutWeights.data());
+        }
+
+        return std::chrono::duration<double>(Clock::now() - Start).count();
+    }
+
+    void SampleMotion(const PMX::VMDMotionData& InMotion, const PMX::PMXMeshData& InMeshData, const Options& InOptions)
+    {
+        PMX::MotionSampler Sampler;
+        if (Sampler.Build(InMotion, InMeshData) == false)
+        {
+            fprintf(stderr, "  failed to bind %s\n", InOptions.ModelPath.c_str());
+            return;
+        }
+
+        const int Instances = InOptions.InstanceCount;
+        const float FrameCount = static_cast<float>(std::max(InMotion.GetFrameCount(), 1u));
+
+        PMX::PoseBatch Pose;
+        Pose.Allocate(Sampler.GetBoneCount(), Instances);
+        Sampler.ResetCursors(Instances);
+
+        std::vector<float> Frames(Instances);
+        std::vector<float> Weights(static_cast<size_t>(std::max(Sampler.GetMorphCount(), 1)) * Instances);
+
+        for (int i = 0; i < Instances; ++i)
+            Frames[i] = std::fmod(i * 37.25f, FrameCount);
+
+        // 30fps 모션을 60fps 로 재생, 끝에서 처음으로 되감기
+        const int Steps = 240;
+        const double PlaySeconds = std::max(SampleSteps(Sampler, Pose, Frames, Weights, Steps,
+            [FrameCount](const int, const float InFrame) { return InFrame + 0.5f < FrameCount ? InFrame + 0.5f : 0.0f; }), 1.e-9);
+
+        // 매번 다른 위치로 탐색
+        unsigned int Seed = 12345;
+        const double SeekSeconds = std::max(SampleSteps(Sampler, Pose, Frames, Weights, Steps,
+            [FrameCount, &Seed](const int, const float) { Seed = Seed * 1664525u + 1013904223u; return (Seed >> 8) * (1.0f / 16777216.0f) * FrameCount; }), 1.e-9);
+
+        const double Poses = static_cast<double>(Instances) * Steps;
+
+        printf("  sample %d/%d bones, %d/%d morphs bound  %d instances\n", Sampler.GetBoundBoneCount(), Sampler.GetBoneCount(),
+            Sampler.GetBoundMorphCount(), Sampler.GetMorphCount(), Instances);
+        printf("  playback %.1f poses/ms  seek %.1f poses/ms  (%.1f M bone samples/s)\n",
+            Poses / (PlaySeconds * 1000.0), Poses / (SeekSeconds * 1000.0), Poses * Sampler.GetBoundBoneCount() / PlaySeconds / 1.e6);
+
+        // 마지막 포즈를 기준 샘플과 비교
+        float PositionError = 0, RotationError = 0, WeightError = 0;
+
+        for (int Bone = 0; Bone < Sampler.GetBoneCount(); ++Bone)
+        {
+            const int Track = Sampler.GetBoneTrack(Bone);
+            if (Track < 0)
+                continue;
+
+            for (int i = 0; i < Instances; ++i)
+            {
+                PMX::Vector3 Position;
+                PMX::Vector4 Rotation;
+                InMotion.SampleBoneTrack(Track, Frames[i], Position, Rotation);
+
+                const PMX::Vector4 Sampled = Pose.GetLocalRotation(Pose.GetIndex(Bone, i));
+                PositionError = std::max(PositionError, PMX::Math::Length(PMX::Math::Sub(Pose.GetLocalTranslation(Pose.GetIndex(Bone, i)), Position)));
+                RotationError = std::max(RotationError, PMX::Math::QuatAngle(Sampled, Rotation));
+            }
+        }
+
+        for (int Morph = 0; Morph < Sampler.GetMorphCount(); ++Morph)
+        {
+            const int Track = Sampler.GetMorphTrack(Morph);
+            if (Track < 0)
+                continue;
+
+            for (int i = 0; i < Instances; ++i)
+                WeightError = std::max(WeightError, std::fabs(Weights[static_cast<size_t>(Morph) * Instances + i] - InMotion.SampleMorphTrack(Track, Frames[i])));
+        }
+
+        printf("  max difference from reference: position %.6f, rotation %.5f deg, morph %.6f\n", PositionError, RotationError * 57.29578f, WeightError);
+    }
+
+    bool BenchFile(const std::string& InPath, const Options& InOptions, const PMX::PMXMeshData* InMeshData, std::vector<std::unique_ptr<PMX::LoadStats>>& InOutTraces)
+    {
+        MappedFile File;
+        if (File.Open(InPath) == false)
+        {
+            fprintf(stderr, "failed to open %s\n", InPath.c_str());
+            return false;
+        }
+
+        PMX::VMDMotionData Motion;
+        std::vector<double> Seconds;
+
+        for (int i = 0; i < InOptions.Iterations; ++i)
+        {
+            const Clock::time_point Start = Clock::now();
+            const bool bLoaded = Motion.LoadBinary(File.GetData(), File.GetSize());
+            Seconds.push_back(std::chrono::duration<double>(Clock::now() - Start).count());
+
+            if (bLoaded == false)
+            {
+                fprintf(stderr, "failed to parse %s\n", InPath.c_str());
+                return false;
+            }
+        }
+
+        const double LoadSeconds = std::max(Median(Seconds), 1.e-9);
+        const int SourceKeys = Motion.GetSourceBoneKeyCount() + Motion.GetSourceMorphKeyCount() + Motion.GetCameraKeyCount() + Motion.GetLightKeyCount();
+
+        printf("%s  \"%s\"\n", InPath.c_str(), Motion.GetModelName().c_str());
+        printf("  bone     %6d tracks %9d keys (%d in file)\n", Motion.GetBoneTrackCount(), Motion.GetBoneKeyCount(), Motion.GetSourceBoneKeyCount());
+        printf("  morph    %6d tracks %9d keys (%d in file)\n", Motion.GetMorphTrackCount(), Motion.GetMorphKeyCount(), Motion.GetSourceMorphKeyCount());
+        printf("  camera   %9d keys, light %d keys, %u frames\n", Motion.GetCameraKeyCount(), Motion.GetLightKeyCount(), Motion.GetFrameCount());
+        printf("  load %.3f ms  %.1f MB/s  %.1f M keys/s  key memory %.2f MB (file %.2f MB)\n",
+            LoadSeconds * 1000.0, File.GetSize() / LoadSeconds / (1024.0 * 1024.0), SourceKeys / LoadSeconds / 1.e6,
+            Motion.GetKeyMemory() / (1024.0 * 1024.0), File.GetSize() / (1024.0 * 1024.0));
+
+        if (InOptions.bReduce)
+        {
+            ReduceMotion(Motion, InOptions);
+        }
+        else if (InOptions.bTracks)
+        {
+            PrintTracks("bone ", Motion.GetBoneTracks(), Motion.GetBoneTrackCount());
+            PrintTracks("morph", Motion.GetMorphTracks(), Motion.GetMorphTrackCount());
+        }
+
+        if (InMeshData != nullptr)
+            SampleMotion(Motion, *InMeshData, InOptions);
+
+        if (InOptions.TracePath.empty() == false)
+        {
+            InOutTraces.emplace_back(new PMX::LoadStats(InPath));
+            Motion.LoadBinary(File.GetData(), File.GetSize(), InOutTraces.back().get());
+        }
+
+        return true;
+    }
+
+    bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+    {
+        for (int i = 1; i < InArgc; ++i)
+        {
+            const std::string Arg = InArgv[i];
+            const bool bHasValue = i + 1 < InArgc;
+
+            if (Arg == "--iterations" && bHasValue)
+                OutOptions.Iterations = std::max(std::atoi(InArgv[++i]), 1);
+            else if (Arg == "--trace" && bHasValue)
+                OutOptions.TracePath = InArgv[++i];
+            else if (Arg == "--tracks")
+                OutOptions.bTracks = true;
+            else if (Arg == "--reduce")
+                OutOptions.bReduce = true;
+            else if (Arg == "--position-tolerance" && bHasValue)
+                OutOptions.Reduction.PositionTolerance = static_cast<float>(std::atof(InArgv[++i]));
+            else if (Arg == "--rotation-tolerance" && bHasValue)
+                OutOptions.Reduction.RotationTolerance = static_cast<float>(std::atof(InArgv[++i]) / 57.29578);
+            else if (Arg == "--model" && bHasValue)
+                OutOptions.ModelPath = InArgv[++i];
+            else if (Arg == "--instances" && bHasValue)
+                OutOptions.InstanceCount = std::max(std::atoi(InArgv[++i]), 1);
+            else if (Arg.compare(0, 2, "--") == 0)
+                return false;
+            else
+                OutOptions.Inputs.push_back(Arg);
+        }
+
+        return OutOptions.Inputs.empty() == false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options BenchOptions;
+    if (ParseOptions(argc, argv, BenchOptions) == false)
+    {
+        fprintf(stderr, "usage: %s [--iterations N] [--trace FILE] [--tracks] [--reduce] [--position-tolerance UNITS] [--rotation-tolerance DEGREES] [--model FILE.pmx] [--instances N] <file.vmd>...\n", argv[0]);
+        return 2;
+    }
+
+    // 샘플링할 모델. 모델이 버퍼를 참조할 수 있으므로 끝까지 매핑 유지
+    MappedFile ModelFile;
+    PMX::PMXMeshData MeshData;
+
+    if (BenchOptions.ModelPath.empty() == false)
+    {
+        if (ModelFile.Open(BenchOptions.ModelPath) == false || MeshData.LoadBinary(ModelFile.GetData(), ModelFile.GetSize()) == false)
+        {
+            fprintf(stderr, "failed to load %s\n", BenchOptions.ModelPath.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<std::unique_ptr<PMX::LoadStats>> Traces;
+    int FailedCount = 0;
+
+    for (const std::string& Input : BenchOptions.Inputs)
+    {
+        if (BenchFile(Input, BenchOptions, BenchOptions.ModelPath.empty() ? nullptr : &MeshData, Traces) == false)
+            ++FailedCount;
+    }
+
+    if (BenchOptions.TracePath.empty() == false)
+    {
+        std::vector<const PMX::LoadStats*> TracePointers;
+        for (const std::unique_ptr<PMX::LoadStats>& Trace : Traces)
+            TracePointers.push_back(Trace.get());
+
+        std::ofstream Stream(BenchOptions.TracePath, std::ios::binary | std::ios::trunc);
+        Stream << PMX::LoadStats::ToChromeTrace(TracePointers.data(), static_cast<int>(TracePointers.size()));
+
+        if (Stream.good() == false)
+        {
+            fprintf(stderr, "failed to write %s\n", BenchOptions.TracePath.c_str());
+            return 2;
+        }
+    }
+
+    return FailedCount > 0 ? 1 : 0;
+}